@@ -7,6 +7,7 @@
 #include "AbilitySystem/LyraAbilitySourceInterface.h"
 #include "Engine/World.h"
 #include "LyraLogChannels.h"
+#include "Performance/LyraHitchDetector.h"
 #include "Teams/LyraTeamSubsystem.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(LyraDamageExecution)
@@ -36,6 +37,8 @@ ULyraDamageExecution::ULyraDamageExecution()
 void ULyraDamageExecution::Execute_Implementation(const FGameplayEffectCustomExecutionParameters& ExecutionParams, FGameplayEffectCustomExecutionOutput& OutExecutionOutput) const
 {
 #if WITH_SERVER_CODE
+	LYRA_HITCH_SCOPE(DamageExecution);
+
 	const FGameplayEffectSpec& Spec = ExecutionParams.GetOwningSpec();
 	FLyraGameplayEffectContext* TypedContext = FLyraGameplayEffectContext::ExtractEffectContext(Spec.GetContext());
 	check(TypedContext);
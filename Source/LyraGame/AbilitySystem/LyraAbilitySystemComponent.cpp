@@ -4,11 +4,15 @@
 
 #include "AbilitySystem/Abilities/LyraGameplayAbility.h"
 #include "AbilitySystem/LyraAbilityTagRelationshipMapping.h"
+#include "AbilitySystemGlobals.h"
 #include "Animation/LyraAnimInstance.h"
+#include "Containers/Ticker.h"
 #include "Engine/World.h"
 #include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
 #include "LyraGlobalAbilitySystem.h"
 #include "LyraLogChannels.h"
+#include "Performance/LyraHitchDetector.h"
 #include "System/LyraAssetManager.h"
 #include "System/LyraGameData.h"
 
@@ -16,6 +20,19 @@
 
 UE_DEFINE_GAMEPLAY_TAG(TAG_Gameplay_AbilityInputBlocked, "Gameplay.AbilityInputBlocked");
 
+DEFINE_STAT(STAT_LyraInputAbilitiesActivated);
+DEFINE_STAT(STAT_LyraInputActivationServerRPCs);
+
+namespace LyraAbilitySystemCVars
+{
+	static bool bBatchInputActivationRPCs = true;
+	static FAutoConsoleVariableRef CVarBatchInputActivationRPCs(
+		TEXT("Lyra.AbilitySystem.BatchInputActivationRPCs"),
+		bBatchInputActivationRPCs,
+		TEXT("Should clients send the activate, target data and end RPCs of an input activated ability to the server as one batched RPC?"),
+		ECVF_Default);
+}
+
 ULyraAbilitySystemComponent::ULyraAbilitySystemComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
@@ -218,19 +235,8 @@ void ULyraAbilitySystemComponent::AbilityInputTagReleased(const FGameplayTag& In
 	}
 }
 
-void ULyraAbilitySystemComponent::ProcessAbilityInput(float DeltaTime, bool bGamePaused)
+void ULyraAbilitySystemComponent::GatherInputAbilitiesToActivate(FInputAbilityHandleArray& OutAbilitiesToActivate)
 {
-	if (HasMatchingGameplayTag(TAG_Gameplay_AbilityInputBlocked))
-	{
-		ClearAbilityInput();
-		return;
-	}
-
-	static TArray<FGameplayAbilitySpecHandle> AbilitiesToActivate;
-	AbilitiesToActivate.Reset();
-
-	//@TODO: See if we can use FScopedServerAbilityRPCBatcher ScopedRPCBatcher in some of these loops
-
 	//
 	// Process all abilities that activate when the input is held.
 	//
@@ -243,7 +249,7 @@ void ULyraAbilitySystemComponent::ProcessAbilityInput(float DeltaTime, bool bGam
 				const ULyraGameplayAbility* LyraAbilityCDO = Cast<ULyraGameplayAbility>(AbilitySpec->Ability);
 				if (LyraAbilityCDO && LyraAbilityCDO->GetActivationPolicy() == ELyraAbilityActivationPolicy::WhileInputActive)
 				{
-					AbilitiesToActivate.AddUnique(AbilitySpec->Handle);
+					OutAbilitiesToActivate.AddUnique(AbilitySpec->Handle);
 				}
 			}
 		}
@@ -271,22 +277,85 @@ void ULyraAbilitySystemComponent::ProcessAbilityInput(float DeltaTime, bool bGam
 
 					if (LyraAbilityCDO && LyraAbilityCDO->GetActivationPolicy() == ELyraAbilityActivationPolicy::OnInputTriggered)
 					{
-						AbilitiesToActivate.AddUnique(AbilitySpec->Handle);
+						OutAbilitiesToActivate.AddUnique(AbilitySpec->Handle);
 					}
 				}
 			}
 		}
 	}
+}
+
+void ULyraAbilitySystemComponent::ProcessAbilityInput(float DeltaTime, bool bGamePaused)
+{
+	LYRA_HITCH_SCOPE(AbilityActivation);
+
+	if (HasMatchingGameplayTag(TAG_Gameplay_AbilityInputBlocked))
+	{
+		ClearAbilityInput();
+		return;
+	}
+
+	// Inline storage covers any realistic number of bound abilities, so this doesn't allocate
+	FInputAbilityHandleArray AbilitiesToActivate;
+	GatherInputAbilitiesToActivate(AbilitiesToActivate);
+
+#if !UE_BUILD_SHIPPING
+	InputActivationOrderLog.Reset();
+	TGuardValue<bool> ProcessingAbilityInputGuard(bProcessingAbilityInput, true);
+#endif
 
 	//
 	// Try to activate all the abilities that are from presses and holds.
 	// We do it all at once so that held inputs don't activate the ability
 	// and then also send a input event to the ability because of the press.
 	//
+	// On clients each activation is batched, so the activate, target data and end
+	// RPCs of an ability go to the server as one RPC. Batches are sent as soon as
+	// each activation returns to keep the server's activation order the same.
+	//
+	// STAT_LyraInputActivationServerRPCs is counted where the RPCs are actually sent,
+	// see CallServerTryActivateAbility and EndServerAbilityRPCBatch.
+	//
+	const bool bBatchServerRPCs = !IsOwnerActorAuthoritative() && ShouldDoServerAbilityRPCBatch();
+
 	for (const FGameplayAbilitySpecHandle& AbilitySpecHandle : AbilitiesToActivate)
 	{
-		TryActivateAbility(AbilitySpecHandle);
+		if (bBatchServerRPCs)
+		{
+			FScopedServerAbilityRPCBatcher ScopedRPCBatcher(this, AbilitySpecHandle);
+			TryActivateAbility(AbilitySpecHandle);
+		}
+		else
+		{
+			TryActivateAbility(AbilitySpecHandle);
+		}
 	}
+	INC_DWORD_STAT_BY(STAT_LyraInputAbilitiesActivated, AbilitiesToActivate.Num());
+
+#if !UE_BUILD_SHIPPING
+	if (bVerifyInputActivationOrder)
+	{
+		// Abilities may fail to activate or trigger others, but the ones we asked for must have activated in the order we asked
+		int32 LastActivationIndex = INDEX_NONE;
+		for (const FGameplayAbilitySpecHandle& ActivatedHandle : InputActivationOrderLog)
+		{
+			const int32 ActivationIndex = AbilitiesToActivate.IndexOfByKey(ActivatedHandle);
+			if (ActivationIndex == INDEX_NONE)
+			{
+				continue;
+			}
+
+			if (ActivationIndex < LastActivationIndex)
+			{
+				const FGameplayAbilitySpec* ActivatedSpec = FindAbilitySpecFromHandle(ActivatedHandle);
+				UE_LOG(LogLyraAbilitySystem, Error, TEXT("ProcessAbilityInput: %s activated out of order on %s"), ActivatedSpec ? *GetNameSafe(ActivatedSpec->Ability) : TEXT("None"), *GetNameSafe(GetOwner()));
+				++NumInputActivationOrderMismatches;
+				break;
+			}
+			LastActivationIndex = ActivationIndex;
+		}
+	}
+#endif
 
 	//
 	// Process all abilities that had their input released this frame.
@@ -315,6 +384,48 @@ void ULyraAbilitySystemComponent::ProcessAbilityInput(float DeltaTime, bool bGam
 	InputReleasedSpecHandles.Reset();
 }
 
+bool ULyraAbilitySystemComponent::ShouldDoServerAbilityRPCBatch() const
+{
+	return LyraAbilitySystemCVars::bBatchInputActivationRPCs;
+}
+
+void ULyraAbilitySystemComponent::CallServerTryActivateAbility(FGameplayAbilitySpecHandle AbilityToActivate, bool InputPressed, FPredictionKey PredictionKey)
+{
+#if !UE_BUILD_SHIPPING
+	// Inside a batch that hasn't started yet the activation is only queued, EndServerAbilityRPCBatch sends it
+	const FServerAbilityRPCBatch* Batch = LocalServerAbilityRPCBatchData.FindByKey(AbilityToActivate);
+	if (bProcessingAbilityInput && ((Batch == nullptr) || Batch->Started))
+	{
+		INC_DWORD_STAT(STAT_LyraInputActivationServerRPCs);
+	}
+#endif
+
+	Super::CallServerTryActivateAbility(AbilityToActivate, InputPressed, PredictionKey);
+}
+
+void ULyraAbilitySystemComponent::EndServerAbilityRPCBatch(FGameplayAbilitySpecHandle AbilityHandle)
+{
+#if !UE_BUILD_SHIPPING
+	// Batches that never got as far as calling the server are dropped without an RPC
+	const FServerAbilityRPCBatch* Batch = LocalServerAbilityRPCBatchData.FindByKey(AbilityHandle);
+	if (bProcessingAbilityInput && (Batch != nullptr) && Batch->Started)
+	{
+		INC_DWORD_STAT(STAT_LyraInputActivationServerRPCs);
+	}
+#endif
+
+	Super::EndServerAbilityRPCBatch(AbilityHandle);
+}
+
+#if !UE_BUILD_SHIPPING
+void ULyraAbilitySystemComponent::SetVerifyInputActivationOrder(bool bEnable)
+{
+	bVerifyInputActivationOrder = bEnable;
+	NumInputActivationOrderMismatches = 0;
+	InputActivationOrderLog.Reset();
+}
+#endif
+
 void ULyraAbilitySystemComponent::ClearAbilityInput()
 {
 	InputPressedSpecHandles.Reset();
@@ -326,6 +437,13 @@ void ULyraAbilitySystemComponent::NotifyAbilityActivated(const FGameplayAbilityS
 {
 	Super::NotifyAbilityActivated(Handle, Ability);
 
+#if !UE_BUILD_SHIPPING
+	if (bVerifyInputActivationOrder && bProcessingAbilityInput)
+	{
+		InputActivationOrderLog.Add(Handle);
+	}
+#endif
+
 	if (ULyraGameplayAbility* LyraAbility = Cast<ULyraGameplayAbility>(Ability))
 	{
 		AddAbilityToActivationGroup(LyraAbility->GetActivationGroup(), LyraAbility);
@@ -541,3 +659,83 @@ void ULyraAbilitySystemComponent::GetAbilityTargetData(const FGameplayAbilitySpe
 		OutTargetDataHandle = ReplicatedData->TargetData;
 	}
 }
+
+//////////////////////////////////////////////////////////////////////
+
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommandWithWorldAndArgs LyraScriptedAbilityInputCmd(
+	TEXT("Lyra.AbilitySystem.RunScriptedInput"),
+	TEXT("Usage: Lyra.AbilitySystem.RunScriptedInput <Frame> [<Frame> ...], where each frame is a comma separated list of +InputTag (press) or -InputTag (release). ")
+	TEXT("Feeds one frame per tick to the first local player's ability system and checks abilities activate in the order their input was processed."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		APlayerController* PC = World ? World->GetFirstPlayerController() : nullptr;
+		ULyraAbilitySystemComponent* ASC = PC ? Cast<ULyraAbilitySystemComponent>(UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(PC->GetPawn())) : nullptr;
+		if (ASC == nullptr)
+		{
+			UE_LOG(LogLyraAbilitySystem, Warning, TEXT("RunScriptedInput: No local player ability system component"));
+			return;
+		}
+
+		struct FScriptedInputFrame
+		{
+			TArray<FGameplayTag> Pressed;
+			TArray<FGameplayTag> Released;
+		};
+
+		TArray<FScriptedInputFrame> Frames;
+		for (const FString& FrameArg : Args)
+		{
+			FScriptedInputFrame& Frame = Frames.AddDefaulted_GetRef();
+
+			TArray<FString> Entries;
+			FrameArg.ParseIntoArray(Entries, TEXT(","));
+			for (const FString& Entry : Entries)
+			{
+				const bool bPressed = Entry.StartsWith(TEXT("+"));
+				const FGameplayTag InputTag = FGameplayTag::RequestGameplayTag(FName(*Entry.RightChop(1)), /*ErrorIfNotFound=*/ false);
+				if (!InputTag.IsValid() || (!bPressed && !Entry.StartsWith(TEXT("-"))))
+				{
+					UE_LOG(LogLyraAbilitySystem, Warning, TEXT("RunScriptedInput: Ignoring '%s', expected +InputTag or -InputTag"), *Entry);
+					continue;
+				}
+
+				(bPressed ? Frame.Pressed : Frame.Released).Add(InputTag);
+			}
+		}
+
+		ASC->SetVerifyInputActivationOrder(true);
+
+		// Input is processed by the player controller after the ticker has run, so each tick feeds the next frame
+		TWeakObjectPtr<ULyraAbilitySystemComponent> WeakASC(ASC);
+		int32 FrameIndex = 0;
+		FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([WeakASC, Frames, FrameIndex](float DeltaTime) mutable
+		{
+			ULyraAbilitySystemComponent* ASC = WeakASC.Get();
+			if (ASC == nullptr)
+			{
+				return false;
+			}
+
+			if (!Frames.IsValidIndex(FrameIndex))
+			{
+				const int32 NumMismatches = ASC->GetNumInputActivationOrderMismatches();
+				UE_LOG(LogLyraAbilitySystem, Display, TEXT("RunScriptedInput: %d frames, %d out of order activations: %s"), Frames.Num(), NumMismatches, (NumMismatches == 0) ? TEXT("PASSED") : TEXT("FAILED"));
+				ASC->SetVerifyInputActivationOrder(false);
+				return false;
+			}
+
+			const FScriptedInputFrame& Frame = Frames[FrameIndex++];
+			for (const FGameplayTag& InputTag : Frame.Pressed)
+			{
+				ASC->AbilityInputTagPressed(InputTag);
+			}
+			for (const FGameplayTag& InputTag : Frame.Released)
+			{
+				ASC->AbilityInputTagReleased(InputTag);
+			}
+
+			return true;
+		}));
+	}));
+#endif // !UE_BUILD_SHIPPING
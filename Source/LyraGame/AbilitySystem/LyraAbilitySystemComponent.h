@@ -4,6 +4,7 @@
 
 #include "Abilities/LyraGameplayAbility.h"
 #include "NativeGameplayTags.h"
+#include "Stats/Stats.h"
 
 #include "AbilitySystem/NinjaGASAbilitySystemComponent.h"
 
@@ -20,6 +21,10 @@ struct FGameplayAbilityTargetDataHandle;
 
 LYRAGAME_API UE_DECLARE_GAMEPLAY_TAG_EXTERN(TAG_Gameplay_AbilityInputBlocked);
 
+DECLARE_STATS_GROUP(TEXT("Lyra Ability System"), STATGROUP_LyraAbilitySystem, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Input Abilities Activated"), STAT_LyraInputAbilitiesActivated, STATGROUP_LyraAbilitySystem, LYRAGAME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Input Activation Server RPCs"), STAT_LyraInputActivationServerRPCs, STATGROUP_LyraAbilitySystem, LYRAGAME_API);
+
 /**
  * ULyraAbilitySystemComponent
  *
@@ -39,6 +44,8 @@ public:
 	//~End of UActorComponent interface
 
 	UE_API virtual void InitAbilityActorInfo(AActor* InOwnerActor, AActor* InAvatarActor) override;
+	UE_API virtual void CallServerTryActivateAbility(FGameplayAbilitySpecHandle AbilityToActivate, bool InputPressed, FPredictionKey PredictionKey) override;
+	UE_API virtual void EndServerAbilityRPCBatch(FGameplayAbilitySpecHandle AbilityHandle) override;
 
 	typedef TFunctionRef<bool(const ULyraGameplayAbility* LyraAbility, FGameplayAbilitySpecHandle Handle)> TShouldCancelAbilityFunc;
 	UE_API void CancelAbilitiesByFunc(TShouldCancelAbilityFunc ShouldCancelFunc, bool bReplicateCancelAbility);
@@ -73,8 +80,21 @@ public:
 
 	UE_API void TryActivateAbilitiesOnSpawn();
 
+#if !UE_BUILD_SHIPPING
+	/** While enabled, every ProcessAbilityInput checks that abilities activated in the order they were gathered in. Returns the number of out of order frames since enabling. */
+	UE_API void SetVerifyInputActivationOrder(bool bEnable);
+	int32 GetNumInputActivationOrderMismatches() const { return NumInputActivationOrderMismatches; }
+#endif
+
 protected:
 
+	UE_API virtual bool ShouldDoServerAbilityRPCBatch() const override;
+
+	typedef TArray<FGameplayAbilitySpecHandle, TInlineAllocator<16>> FInputAbilityHandleArray;
+
+	/** Passes this frame's presses on to active abilities and fills OutAbilitiesToActivate with the ones to activate, in activation order */
+	UE_API void GatherInputAbilitiesToActivate(FInputAbilityHandleArray& OutAbilitiesToActivate);
+
 	UE_API virtual void AbilitySpecInputPressed(FGameplayAbilitySpec& Spec) override;
 	UE_API virtual void AbilitySpecInputReleased(FGameplayAbilitySpec& Spec) override;
 
@@ -96,16 +116,24 @@ protected:
 	TObjectPtr<ULyraAbilityTagRelationshipMapping> TagRelationshipMapping;
 
 	// Handles to abilities that had their input pressed this frame.
-	TArray<FGameplayAbilitySpecHandle> InputPressedSpecHandles;
+	TArray<FGameplayAbilitySpecHandle, TInlineAllocator<8>> InputPressedSpecHandles;
 
 	// Handles to abilities that had their input released this frame.
-	TArray<FGameplayAbilitySpecHandle> InputReleasedSpecHandles;
+	TArray<FGameplayAbilitySpecHandle, TInlineAllocator<8>> InputReleasedSpecHandles;
 
 	// Handles to abilities that have their input held.
-	TArray<FGameplayAbilitySpecHandle> InputHeldSpecHandles;
+	TArray<FGameplayAbilitySpecHandle, TInlineAllocator<8>> InputHeldSpecHandles;
 
 	// Number of abilities running in each activation group.
 	int32 ActivationGroupCounts[static_cast<uint8>(ELyraAbilityActivationGroup::MAX)];
+
+#if !UE_BUILD_SHIPPING
+	// Abilities activated while processing input, in the order they activated. Only recorded while verifying activation order.
+	TArray<FGameplayAbilitySpecHandle> InputActivationOrderLog;
+	bool bVerifyInputActivationOrder = false;
+	bool bProcessingAbilityInput = false;
+	int32 NumInputActivationOrderMismatches = 0;
+#endif
 };
 
 #undef UE_API
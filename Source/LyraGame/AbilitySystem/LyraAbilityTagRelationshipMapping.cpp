@@ -2,12 +2,129 @@
 
 #include "AbilitySystem/LyraAbilityTagRelationshipMapping.h"
 
+#include "GameplayTagsManager.h"
+#include "LyraGameplayTags.h"
+#include "LyraLogChannels.h"
+#include "Misc/AutomationTest.h"
+#include "UObject/UObjectIterator.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(LyraAbilityTagRelationshipMapping)
 
+void ULyraAbilityTagRelationshipMapping::PostLoad()
+{
+	Super::PostLoad();
+
+	RebuildIndex();
+}
+
+#if WITH_EDITOR
+void ULyraAbilityTagRelationshipMapping::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	bIndexDirty = true;
+}
+#endif
+
+void ULyraAbilityTagRelationshipMapping::RebuildIndex() const
+{
+	RelationshipsByTag.Reset();
+	ResolvedRelationshipCache.Reset();
+
+	for (const FLyraAbilityTagRelationship& Relationship : AbilityTagRelationships)
+	{
+		if (!Relationship.AbilityTag.IsValid())
+		{
+			continue;
+		}
+
+		FLyraAbilityTagRelationship& Merged = RelationshipsByTag.FindOrAdd(Relationship.AbilityTag);
+		Merged.AbilityTag = Relationship.AbilityTag;
+		Merged.AbilityTagsToBlock.AppendTags(Relationship.AbilityTagsToBlock);
+		Merged.AbilityTagsToCancel.AppendTags(Relationship.AbilityTagsToCancel);
+		Merged.ActivationRequiredTags.AppendTags(Relationship.ActivationRequiredTags);
+		Merged.ActivationBlockedTags.AppendTags(Relationship.ActivationBlockedTags);
+	}
+
+	bIndexDirty = false;
+}
+
+const FLyraAbilityTagRelationship& ULyraAbilityTagRelationshipMapping::ResolveRelationships(const FGameplayTagContainer& AbilityTags) const
+{
+	if (bIndexDirty)
+	{
+		RebuildIndex();
+	}
+
+	if (const FLyraAbilityTagRelationship* Cached = ResolvedRelationshipCache.Find(AbilityTags))
+	{
+		return *Cached;
+	}
+
+	FLyraAbilityTagRelationship Resolved;
+	for (const FGameplayTag& Tag : AbilityTags)
+	{
+		// AbilityTags.HasTag(RelationshipTag) also matches when RelationshipTag is a parent of one of the ability tags
+		for (FGameplayTag CurrentTag = Tag; CurrentTag.IsValid(); CurrentTag = CurrentTag.RequestDirectParent())
+		{
+			if (const FLyraAbilityTagRelationship* Merged = RelationshipsByTag.Find(CurrentTag))
+			{
+				Resolved.AbilityTagsToBlock.AppendTags(Merged->AbilityTagsToBlock);
+				Resolved.AbilityTagsToCancel.AppendTags(Merged->AbilityTagsToCancel);
+				Resolved.ActivationRequiredTags.AppendTags(Merged->ActivationRequiredTags);
+				Resolved.ActivationBlockedTags.AppendTags(Merged->ActivationBlockedTags);
+			}
+		}
+	}
+
+	return ResolvedRelationshipCache.Add(AbilityTags, MoveTemp(Resolved));
+}
+
 void ULyraAbilityTagRelationshipMapping::GetAbilityTagsToBlockAndCancel(const FGameplayTagContainer& AbilityTags, FGameplayTagContainer* OutTagsToBlock, FGameplayTagContainer* OutTagsToCancel) const
 {
-	// Simple iteration for now
+	const FLyraAbilityTagRelationship& Resolved = ResolveRelationships(AbilityTags);
+
+	if (OutTagsToBlock)
+	{
+		OutTagsToBlock->AppendTags(Resolved.AbilityTagsToBlock);
+	}
+	if (OutTagsToCancel)
+	{
+		OutTagsToCancel->AppendTags(Resolved.AbilityTagsToCancel);
+	}
+}
+
+void ULyraAbilityTagRelationshipMapping::GetRequiredAndBlockedActivationTags(const FGameplayTagContainer& AbilityTags, FGameplayTagContainer* OutActivationRequired, FGameplayTagContainer* OutActivationBlocked) const
+{
+	const FLyraAbilityTagRelationship& Resolved = ResolveRelationships(AbilityTags);
+
+	if (OutActivationRequired)
+	{
+		OutActivationRequired->AppendTags(Resolved.ActivationRequiredTags);
+	}
+	if (OutActivationBlocked)
+	{
+		OutActivationBlocked->AppendTags(Resolved.ActivationBlockedTags);
+	}
+}
+
+bool ULyraAbilityTagRelationshipMapping::IsAbilityCancelledByTag(const FGameplayTagContainer& AbilityTags, const FGameplayTag& ActionTag) const
+{
+	if (bIndexDirty)
+	{
+		RebuildIndex();
+	}
+
+	// Only an exact match on the action tag counts here, so no need to walk parents
+	const FLyraAbilityTagRelationship* Merged = RelationshipsByTag.Find(ActionTag);
+	return Merged && Merged->AbilityTagsToCancel.HasAny(AbilityTags);
+}
+
+//////////////////////////////////////////////////////////////////////
+
+#if WITH_DEV_AUTOMATION_TESTS
+void ULyraAbilityTagRelationshipMapping::GetAbilityTagsToBlockAndCancel_Linear(const FGameplayTagContainer& AbilityTags, FGameplayTagContainer* OutTagsToBlock, FGameplayTagContainer* OutTagsToCancel) const
+{
 	for (int32 i = 0; i < AbilityTagRelationships.Num(); i++)
 	{
 		const FLyraAbilityTagRelationship& Tags = AbilityTagRelationships[i];
@@ -25,9 +142,8 @@ void ULyraAbilityTagRelationshipMapping::GetAbilityTagsToBlockAndCancel(const FG
 	}
 }
 
-void ULyraAbilityTagRelationshipMapping::GetRequiredAndBlockedActivationTags(const FGameplayTagContainer& AbilityTags, FGameplayTagContainer* OutActivationRequired, FGameplayTagContainer* OutActivationBlocked) const
+void ULyraAbilityTagRelationshipMapping::GetRequiredAndBlockedActivationTags_Linear(const FGameplayTagContainer& AbilityTags, FGameplayTagContainer* OutActivationRequired, FGameplayTagContainer* OutActivationBlocked) const
 {
-	// Simple iteration for now
 	for (int32 i = 0; i < AbilityTagRelationships.Num(); i++)
 	{
 		const FLyraAbilityTagRelationship& Tags = AbilityTagRelationships[i];
@@ -45,9 +161,8 @@ void ULyraAbilityTagRelationshipMapping::GetRequiredAndBlockedActivationTags(con
 	}
 }
 
-bool ULyraAbilityTagRelationshipMapping::IsAbilityCancelledByTag(const FGameplayTagContainer& AbilityTags, const FGameplayTag& ActionTag) const
+bool ULyraAbilityTagRelationshipMapping::IsAbilityCancelledByTag_Linear(const FGameplayTagContainer& AbilityTags, const FGameplayTag& ActionTag) const
 {
-	// Simple iteration for now
 	for (int32 i = 0; i < AbilityTagRelationships.Num(); i++)
 	{
 		const FLyraAbilityTagRelationship& Tags = AbilityTagRelationships[i];
@@ -61,3 +176,159 @@ bool ULyraAbilityTagRelationshipMapping::IsAbilityCancelledByTag(const FGameplay
 	return false;
 }
 
+int32 ULyraAbilityTagRelationshipMapping::VerifyIndexMatchesLinearScan() const
+{
+	UGameplayTagsManager& TagsManager = UGameplayTagsManager::Get();
+
+	// Every tag the relationships mention, plus the parents and children of the ability tags so parent matching gets exercised
+	FGameplayTagContainer TagPool;
+	for (const FLyraAbilityTagRelationship& Relationship : AbilityTagRelationships)
+	{
+		if (Relationship.AbilityTag.IsValid())
+		{
+			TagPool.AddTag(Relationship.AbilityTag);
+			TagPool.AppendTags(Relationship.AbilityTag.GetGameplayTagParents());
+			TagPool.AppendTags(TagsManager.RequestGameplayTagChildren(Relationship.AbilityTag));
+		}
+		TagPool.AppendTags(Relationship.AbilityTagsToBlock);
+		TagPool.AppendTags(Relationship.AbilityTagsToCancel);
+	}
+
+	TArray<FGameplayTag> PoolTags;
+	TagPool.GetGameplayTagArray(PoolTags);
+
+	TArray<FGameplayTagContainer> TestContainers;
+	TestContainers.AddDefaulted();
+	for (const FGameplayTag& Tag : PoolTags)
+	{
+		TestContainers.Add(FGameplayTagContainer(Tag));
+	}
+
+	FRandomStream Random(1234);
+	if (PoolTags.Num() > 0)
+	{
+		for (int32 Index = 0; Index < 256; ++Index)
+		{
+			FGameplayTagContainer& Container = TestContainers.AddDefaulted_GetRef();
+			const int32 NumTags = Random.RandRange(2, 4);
+			for (int32 TagIndex = 0; TagIndex < NumTags; ++TagIndex)
+			{
+				Container.AddTag(PoolTags[Random.RandHelper(PoolTags.Num())]);
+			}
+		}
+	}
+
+	int32 NumMismatches = 0;
+	auto ReportMismatch = [this, &NumMismatches](const TCHAR* Function, const FGameplayTagContainer& AbilityTags)
+	{
+		++NumMismatches;
+		UE_LOG(LogLyraAbilitySystem, Warning, TEXT("%s: %s differs from the linear scan for [%s]"), *GetPathName(), Function, *AbilityTags.ToStringSimple());
+	};
+
+	for (const FGameplayTagContainer& AbilityTags : TestContainers)
+	{
+		FGameplayTagContainer IndexedBlock, IndexedCancel, LinearBlock, LinearCancel;
+		GetAbilityTagsToBlockAndCancel(AbilityTags, &IndexedBlock, &IndexedCancel);
+		GetAbilityTagsToBlockAndCancel_Linear(AbilityTags, &LinearBlock, &LinearCancel);
+		if ((IndexedBlock != LinearBlock) || (IndexedCancel != LinearCancel))
+		{
+			ReportMismatch(TEXT("GetAbilityTagsToBlockAndCancel"), AbilityTags);
+		}
+
+		FGameplayTagContainer IndexedRequired, IndexedBlocked, LinearRequired, LinearBlocked;
+		GetRequiredAndBlockedActivationTags(AbilityTags, &IndexedRequired, &IndexedBlocked);
+		GetRequiredAndBlockedActivationTags_Linear(AbilityTags, &LinearRequired, &LinearBlocked);
+		if ((IndexedRequired != LinearRequired) || (IndexedBlocked != LinearBlocked))
+		{
+			ReportMismatch(TEXT("GetRequiredAndBlockedActivationTags"), AbilityTags);
+		}
+
+		for (const FGameplayTag& ActionTag : PoolTags)
+		{
+			if (IsAbilityCancelledByTag(AbilityTags, ActionTag) != IsAbilityCancelledByTag_Linear(AbilityTags, ActionTag))
+			{
+				ReportMismatch(TEXT("IsAbilityCancelledByTag"), AbilityTags);
+			}
+		}
+	}
+
+	UE_LOG(LogLyraAbilitySystem, Verbose, TEXT("%s: checked %d ability tag containers against %d relationships, %d mismatches"),
+		*GetPathName(), TestContainers.Num(), AbilityTagRelationships.Num(), NumMismatches);
+
+	return NumMismatches;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLyraAbilityTagRelationshipMappingTest, "Lyra.AbilitySystem.TagRelationshipMapping", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FLyraAbilityTagRelationshipMappingTest::RunTest(const FString& Parameters)
+{
+	using namespace LyraGameplayTags;
+
+	auto MakeRelationship = [](FGameplayTag AbilityTag, FGameplayTagContainer ToBlock, FGameplayTagContainer ToCancel, FGameplayTagContainer Required, FGameplayTagContainer Blocked)
+	{
+		FLyraAbilityTagRelationship Relationship;
+		Relationship.AbilityTag = AbilityTag;
+		Relationship.AbilityTagsToBlock = ToBlock;
+		Relationship.AbilityTagsToCancel = ToCancel;
+		Relationship.ActivationRequiredTags = Required;
+		Relationship.ActivationBlockedTags = Blocked;
+		return Relationship;
+	};
+
+	// Covers parent matching (Status.Death applies to Status.Death.Dying) and two relationships for the same tag being merged
+	ULyraAbilityTagRelationshipMapping* Mapping = NewObject<ULyraAbilityTagRelationshipMapping>(GetTransientPackage());
+	Mapping->AbilityTagRelationships = {
+		MakeRelationship(Status_Death, FGameplayTagContainer(InputTag_Move), FGameplayTagContainer(InputTag_Crouch), FGameplayTagContainer(), FGameplayTagContainer(Status_Crouching)),
+		MakeRelationship(Status_Death_Dying, FGameplayTagContainer(), FGameplayTagContainer(InputTag_AutoRun), FGameplayTagContainer(Movement_Mode_Walking), FGameplayTagContainer()),
+		MakeRelationship(Status_Death, FGameplayTagContainer(Movement_Mode_Falling), FGameplayTagContainer(), FGameplayTagContainer(), FGameplayTagContainer()),
+		MakeRelationship(InputTag_Crouch, FGameplayTagContainer(InputTag_AutoRun), FGameplayTagContainer(), FGameplayTagContainer(Movement_Mode_Walking), FGameplayTagContainer(Status_Death)),
+	};
+
+	auto MakeContainer = [](std::initializer_list<FGameplayTag> Tags)
+	{
+		FGameplayTagContainer Container;
+		for (const FGameplayTag& Tag : Tags)
+		{
+			Container.AddTag(Tag);
+		}
+		return Container;
+	};
+
+	// Asked twice so the second answer comes from the resolved cache
+	for (int32 Pass = 0; Pass < 2; ++Pass)
+	{
+		FGameplayTagContainer ToBlock, ToCancel, Required, Blocked;
+		Mapping->GetAbilityTagsToBlockAndCancel(FGameplayTagContainer(Status_Death_Dying), &ToBlock, &ToCancel);
+		Mapping->GetRequiredAndBlockedActivationTags(FGameplayTagContainer(Status_Death_Dying), &Required, &Blocked);
+		TestTrue(TEXT("A child ability tag blocks what its own and its parent's relationships block"), ToBlock == MakeContainer({ InputTag_Move, Movement_Mode_Falling }));
+		TestTrue(TEXT("A child ability tag cancels what its own and its parent's relationships cancel"), ToCancel == MakeContainer({ InputTag_Crouch, InputTag_AutoRun }));
+		TestTrue(TEXT("A child ability tag gets its own required tags"), Required == FGameplayTagContainer(Movement_Mode_Walking));
+		TestTrue(TEXT("A child ability tag gets its parent's blocked tags"), Blocked == FGameplayTagContainer(Status_Crouching));
+	}
+
+	FGameplayTagContainer ParentToCancel;
+	Mapping->GetAbilityTagsToBlockAndCancel(FGameplayTagContainer(Status_Death), nullptr, &ParentToCancel);
+	TestTrue(TEXT("A child tag's relationship doesn't apply to its parent"), ParentToCancel == FGameplayTagContainer(InputTag_Crouch));
+
+	FGameplayTagContainer NoneToBlock;
+	Mapping->GetAbilityTagsToBlockAndCancel(FGameplayTagContainer(Cheat_GodMode), &NoneToBlock, nullptr);
+	TestTrue(TEXT("An ability tag without relationships blocks nothing"), NoneToBlock.IsEmpty());
+
+	TestTrue(TEXT("Crouch is cancelled by Status.Death"), Mapping->IsAbilityCancelledByTag(FGameplayTagContainer(InputTag_Crouch), Status_Death));
+	TestTrue(TEXT("AutoRun is cancelled by Status.Death.Dying"), Mapping->IsAbilityCancelledByTag(FGameplayTagContainer(InputTag_AutoRun), Status_Death_Dying));
+	TestFalse(TEXT("Cancelling only matches the exact action tag"), Mapping->IsAbilityCancelledByTag(FGameplayTagContainer(InputTag_Crouch), Status_Death_Dying));
+
+	TestEqual(TEXT("The index matches the linear scan for generated ability tags"), Mapping->VerifyIndexMatchesLinearScan(), 0);
+
+	// And for whatever mappings the project has loaded
+	for (TObjectIterator<ULyraAbilityTagRelationshipMapping> It; It; ++It)
+	{
+		if (*It != Mapping)
+		{
+			TestEqual(FString::Printf(TEXT("The index matches the linear scan for %s"), *It->GetPathName()), It->VerifyIndexMatchesLinearScan(), 0);
+		}
+	}
+
+	return true;
+}
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -37,6 +37,25 @@ struct FLyraAbilityTagRelationship
 };
 
 
+/** Hashes an ability tag container independently of tag order, to match FGameplayTagContainer::operator== */
+struct FLyraAbilityTagContainerKeyFuncs : TDefaultMapKeyFuncs<FGameplayTagContainer, FLyraAbilityTagRelationship, /*bInAllowDuplicateKeys=*/ false>
+{
+	static FORCEINLINE bool Matches(const FGameplayTagContainer& A, const FGameplayTagContainer& B)
+	{
+		return A == B;
+	}
+
+	static FORCEINLINE uint32 GetKeyHash(const FGameplayTagContainer& Key)
+	{
+		uint32 Hash = Key.Num();
+		for (const FGameplayTag& Tag : Key)
+		{
+			Hash ^= GetTypeHash(Tag);
+		}
+		return Hash;
+	}
+};
+
 /** Mapping of how ability tags block or cancel other abilities */
 UCLASS()
 class ULyraAbilityTagRelationshipMapping : public UDataAsset
@@ -49,6 +68,13 @@ private:
 	TArray<FLyraAbilityTagRelationship> AbilityTagRelationships;
 
 public:
+	//~UObject interface
+	virtual void PostLoad() override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+	//~End of UObject interface
+
 	/** Given a set of ability tags, parse the tag relationship and fill out tags to block and cancel */
 	void GetAbilityTagsToBlockAndCancel(const FGameplayTagContainer& AbilityTags, FGameplayTagContainer* OutTagsToBlock, FGameplayTagContainer* OutTagsToCancel) const;
 
@@ -57,4 +83,33 @@ public:
 
 	/** Returns true if the specified ability tags are canceled by the passed in action tag */
 	bool IsAbilityCancelledByTag(const FGameplayTagContainer& AbilityTags, const FGameplayTag& ActionTag) const;
+
+#if WITH_DEV_AUTOMATION_TESTS
+	/** Compares the indexed lookups against a linear scan of the relationships for a set of generated ability tags, returns the number of mismatches */
+	int32 VerifyIndexMatchesLinearScan() const;
+#endif
+
+private:
+	/** Rebuilds RelationshipsByTag and clears the resolved cache */
+	void RebuildIndex() const;
+
+	/** Returns every relationship that applies to the ability tags merged together, cached per unique container */
+	const FLyraAbilityTagRelationship& ResolveRelationships(const FGameplayTagContainer& AbilityTags) const;
+
+#if WITH_DEV_AUTOMATION_TESTS
+	// The original linear scans, kept as the reference the index is verified against
+	void GetAbilityTagsToBlockAndCancel_Linear(const FGameplayTagContainer& AbilityTags, FGameplayTagContainer* OutTagsToBlock, FGameplayTagContainer* OutTagsToCancel) const;
+	void GetRequiredAndBlockedActivationTags_Linear(const FGameplayTagContainer& AbilityTags, FGameplayTagContainer* OutActivationRequired, FGameplayTagContainer* OutActivationBlocked) const;
+	bool IsAbilityCancelledByTag_Linear(const FGameplayTagContainer& AbilityTags, const FGameplayTag& ActionTag) const;
+#endif
+
+	/** All relationships for the same AbilityTag merged into one entry */
+	mutable TMap<FGameplayTag, FLyraAbilityTagRelationship> RelationshipsByTag;
+
+	/** Resolved relationships for each ability tag container seen so far, there are only as many as there are distinct abilities */
+	mutable TMap<FGameplayTagContainer, FLyraAbilityTagRelationship, FDefaultSetAllocator, FLyraAbilityTagContainerKeyFuncs> ResolvedRelationshipCache;
+
+	mutable bool bIndexDirty = true;
+
+	friend class FLyraAbilityTagRelationshipMappingTest;
 };
@@ -18,6 +18,7 @@ struct FLyraGameplayAbilityTargetData_SingleTargetHit : public FGameplayAbilityT
 
 	FLyraGameplayAbilityTargetData_SingleTargetHit()
 		: CartridgeID(-1)
+		, Timestamp(0.0)
 	{ }
 
 	virtual void AddTargetDataToContext(FGameplayEffectContextHandle& Context, bool bIncludeActorArray) const override;
@@ -26,6 +27,10 @@ struct FLyraGameplayAbilityTargetData_SingleTargetHit : public FGameplayAbilityT
 	UPROPERTY()
 	int32 CartridgeID;
 
+	/** Server world time as seen by the client when the shot was fired, used to rewind the target for lag compensation */
+	UPROPERTY()
+	double Timestamp;
+
 	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
 
 	virtual UScriptStruct* GetScriptStruct() const override
@@ -1,9 +1,11 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "LyraAnimInstance.h"
+#include "AbilitySystemComponent.h"
 #include "AbilitySystemGlobals.h"
 #include "Character/LyraCharacter.h"
 #include "Character/LyraCharacterMovementComponent.h"
+#include "LyraLogChannels.h"
 
 #if WITH_EDITOR
 #include "Misc/DataValidation.h"
@@ -11,6 +13,17 @@
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(LyraAnimInstance)
 
+DECLARE_CYCLE_STAT(TEXT("LyraAnimInstance GatherGameplaySnapshot"), STAT_LyraAnimInstance_GatherGameplaySnapshot, STATGROUP_Anim);
+DECLARE_CYCLE_STAT(TEXT("LyraAnimInstance ThreadSafeUpdate"), STAT_LyraAnimInstance_ThreadSafeUpdate, STATGROUP_Anim);
+
+namespace LyraAnimInstance
+{
+	static bool IsSupportedTagBindingProperty(const FProperty* Property)
+	{
+		return CastField<FBoolProperty>(Property) || CastField<FIntProperty>(Property) || CastField<FFloatProperty>(Property) || CastField<FDoubleProperty>(Property);
+	}
+}
+
 
 ULyraAnimInstance::ULyraAnimInstance(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -22,6 +35,26 @@ void ULyraAnimInstance::InitializeWithAbilitySystem(UAbilitySystemComponent* ASC
 	check(ASC);
 
 	GameplayTagPropertyMap.Initialize(this, ASC);
+
+	// Only the pointer changes here, the bound arrays are read by NativeThreadSafeUpdateAnimation and are sized once in NativeInitializeAnimation
+	BoundAbilitySystem = ASC;
+}
+
+void ULyraAnimInstance::ResolveThreadSafeTagBindings()
+{
+	BoundTagProperties.Reset(ThreadSafeGameplayTagBindings.Num());
+	BoundTagCounts.Init(0, ThreadSafeGameplayTagBindings.Num());
+
+	for (const FLyraAnimGameplayTagBinding& Binding : ThreadSafeGameplayTagBindings)
+	{
+		FProperty* Property = FindFProperty<FProperty>(GetClass(), Binding.PropertyName);
+		if (!LyraAnimInstance::IsSupportedTagBindingProperty(Property))
+		{
+			UE_LOG(LogLyra, Warning, TEXT("%s: thread safe gameplay tag binding for [%s] has no bool, int or float variable named [%s]"), *GetPathNameSafe(GetClass()), *Binding.Tag.ToString(), *Binding.PropertyName.ToString());
+			Property = nullptr;
+		}
+		BoundTagProperties.Add(Property);
+	}
 }
 
 #if WITH_EDITOR
@@ -31,6 +64,19 @@ EDataValidationResult ULyraAnimInstance::IsDataValid(FDataValidationContext& Con
 
 	GameplayTagPropertyMap.IsDataValid(this, Context);
 
+	for (const FLyraAnimGameplayTagBinding& Binding : ThreadSafeGameplayTagBindings)
+	{
+		if (!Binding.Tag.IsValid())
+		{
+			Context.AddError(FText::Format(NSLOCTEXT("LyraAnimInstance", "TagBindingMissingTag", "Thread safe gameplay tag binding for variable [{0}] has no tag"), FText::FromName(Binding.PropertyName)));
+		}
+
+		if (!LyraAnimInstance::IsSupportedTagBindingProperty(FindFProperty<FProperty>(GetClass(), Binding.PropertyName)))
+		{
+			Context.AddError(FText::Format(NSLOCTEXT("LyraAnimInstance", "TagBindingBadProperty", "Thread safe gameplay tag binding for [{0}] needs a bool, int or float variable, [{1}] isn't one"), FText::FromString(Binding.Tag.ToString()), FText::FromName(Binding.PropertyName)));
+		}
+	}
+
 	return ((Context.GetNumErrors() > 0) ? EDataValidationResult::Invalid : EDataValidationResult::Valid);
 }
 #endif // WITH_EDITOR
@@ -39,6 +85,8 @@ void ULyraAnimInstance::NativeInitializeAnimation()
 {
 	Super::NativeInitializeAnimation();
 
+	ResolveThreadSafeTagBindings();
+
 	if (AActor* OwningActor = GetOwningActor())
 	{
 		if (UAbilitySystemComponent* ASC = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(OwningActor))
@@ -52,6 +100,13 @@ void ULyraAnimInstance::NativeUpdateAnimation(float DeltaSeconds)
 {
 	Super::NativeUpdateAnimation(DeltaSeconds);
 
+	GatherGameplaySnapshot();
+}
+
+void ULyraAnimInstance::GatherGameplaySnapshot()
+{
+	SCOPE_CYCLE_COUNTER(STAT_LyraAnimInstance_GatherGameplaySnapshot);
+
 	const ALyraCharacter* Character = Cast<ALyraCharacter>(GetOwningActor());
 	if (!Character)
 	{
@@ -60,6 +115,61 @@ void ULyraAnimInstance::NativeUpdateAnimation(float DeltaSeconds)
 
 	ULyraCharacterMovementComponent* CharMoveComp = CastChecked<ULyraCharacterMovementComponent>(Character->GetCharacterMovement());
 	const FLyraCharacterGroundInfo& GroundInfo = CharMoveComp->GetGroundInfo();
-	GroundDistance = GroundInfo.GroundDistance;
+
+	GameplaySnapshot.Velocity = CharMoveComp->Velocity;
+	GameplaySnapshot.Acceleration = CharMoveComp->GetCurrentAcceleration();
+	GameplaySnapshot.ActorRotation = Character->GetActorRotation();
+	GameplaySnapshot.GroundDistance = GroundInfo.GroundDistance;
+	GameplaySnapshot.MovementMode = CharMoveComp->MovementMode;
+	GameplaySnapshot.bIsOnGround = CharMoveComp->IsMovingOnGround();
+	GameplaySnapshot.bIsFalling = CharMoveComp->IsFalling();
+	GameplaySnapshot.bIsCrouched = Character->IsCrouched();
+
+	if (const UAbilitySystemComponent* ASC = BoundAbilitySystem.Get())
+	{
+		for (int32 Index = 0; Index < BoundTagCounts.Num(); ++Index)
+		{
+			BoundTagCounts[Index] = ASC->GetTagCount(ThreadSafeGameplayTagBindings[Index].Tag);
+		}
+	}
+}
+
+void ULyraAnimInstance::NativeThreadSafeUpdateAnimation(float DeltaSeconds)
+{
+	Super::NativeThreadSafeUpdateAnimation(DeltaSeconds);
+
+	SCOPE_CYCLE_COUNTER(STAT_LyraAnimInstance_ThreadSafeUpdate);
+
+	// Only the snapshot is read from here on, the owning character may be ticking on the game thread at the same time
+	GroundDistance = GameplaySnapshot.GroundDistance;
+
+	for (int32 Index = 0; Index < BoundTagProperties.Num(); ++Index)
+	{
+		FProperty* Property = BoundTagProperties[Index];
+		if (Property == nullptr)
+		{
+			continue;
+		}
+
+		const int32 TagCount = BoundTagCounts[Index];
+		void* ValuePtr = Property->ContainerPtrToValuePtr<void>(this);
+
+		if (const FBoolProperty* BoolProperty = CastField<FBoolProperty>(Property))
+		{
+			BoolProperty->SetPropertyValue(ValuePtr, TagCount > 0);
+		}
+		else if (const FIntProperty* IntProperty = CastField<FIntProperty>(Property))
+		{
+			IntProperty->SetPropertyValue(ValuePtr, TagCount);
+		}
+		else if (const FFloatProperty* FloatProperty = CastField<FFloatProperty>(Property))
+		{
+			FloatProperty->SetPropertyValue(ValuePtr, (float)TagCount);
+		}
+		else if (const FDoubleProperty* DoubleProperty = CastField<FDoubleProperty>(Property))
+		{
+			DoubleProperty->SetPropertyValue(ValuePtr, (double)TagCount);
+		}
+	}
 }
 
@@ -3,16 +3,75 @@
 #pragma once
 
 #include "Animation/AnimInstance.h"
+#include "Engine/EngineTypes.h"
 #include "GameplayEffectTypes.h"
 #include "LyraAnimInstance.generated.h"
 
 class UAbilitySystemComponent;
 
 
+/**
+ * FLyraAnimGameplaySnapshot
+ *
+ *	The gameplay state the animation graph reads, gathered once per frame on the game thread.
+ */
+USTRUCT(BlueprintType)
+struct FLyraAnimGameplaySnapshot
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Character State Data")
+	FVector Velocity = FVector::ZeroVector;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Character State Data")
+	FVector Acceleration = FVector::ZeroVector;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Character State Data")
+	FRotator ActorRotation = FRotator::ZeroRotator;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Character State Data")
+	float GroundDistance = -1.0f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Character State Data")
+	TEnumAsByte<EMovementMode> MovementMode = MOVE_None;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Character State Data")
+	bool bIsOnGround = false;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Character State Data")
+	bool bIsFalling = false;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Character State Data")
+	bool bIsCrouched = false;
+};
+
+
+/**
+ * FLyraAnimGameplayTagBinding
+ *
+ *	Maps a gameplay tag on the owner's ability system to a bool, int or float variable of the animation blueprint.
+ */
+USTRUCT()
+struct FLyraAnimGameplayTagBinding
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditDefaultsOnly, Category = "GameplayTags")
+	FGameplayTag Tag;
+
+	// Bool variables are set while the tag is present, numeric ones to its count
+	UPROPERTY(EditDefaultsOnly, Category = "GameplayTags")
+	FName PropertyName;
+};
+
+
 /**
  * ULyraAnimInstance
  *
  *	The base game animation instance class used by this project.
+ *
+ *	NativeUpdateAnimation only gathers GameplaySnapshot from the owning character on the game thread, everything derived from it
+ *	is done in NativeThreadSafeUpdateAnimation so the graph can update on a worker thread.
  */
 UCLASS(Config = Game)
 class ULyraAnimInstance : public UAnimInstance
@@ -33,6 +92,15 @@ protected:
 
 	virtual void NativeInitializeAnimation() override;
 	virtual void NativeUpdateAnimation(float DeltaSeconds) override;
+	virtual void NativeThreadSafeUpdateAnimation(float DeltaSeconds) override;
+
+	// Fills GameplaySnapshot (and the thread safe tag binding counts) from the owning character, on the game thread
+	void GatherGameplaySnapshot();
+
+private:
+
+	// Fills BoundTagProperties and sizes BoundTagCounts, neither is reallocated after this
+	void ResolveThreadSafeTagBindings();
 
 protected:
 
@@ -41,6 +109,24 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = "GameplayTags")
 	FGameplayTagBlueprintPropertyMap GameplayTagPropertyMap;
 
+	// Like GameplayTagPropertyMap, but the variables are only written during the thread safe update instead of on the game thread
+	// whenever the tags change, so graphs that update on worker threads never see them change mid-update.
+	UPROPERTY(EditDefaultsOnly, Category = "GameplayTags")
+	TArray<FLyraAnimGameplayTagBinding> ThreadSafeGameplayTagBindings;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Character State Data")
+	FLyraAnimGameplaySnapshot GameplaySnapshot;
+
 	UPROPERTY(BlueprintReadOnly, Category = "Character State Data")
 	float GroundDistance = -1.0f;
+
+private:
+
+	TWeakObjectPtr<UAbilitySystemComponent> BoundAbilitySystem;
+
+	// Resolved from ThreadSafeGameplayTagBindings (null where the variable is missing or of an unsupported type), in the same order
+	TArray<FProperty*> BoundTagProperties;
+
+	// Gathered with the snapshot, in the same order
+	TArray<int32> BoundTagCounts;
 };
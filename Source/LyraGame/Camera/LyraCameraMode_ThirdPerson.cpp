@@ -11,6 +11,7 @@
 #include "GameFramework/Controller.h"
 #include "GameFramework/Character.h"
 #include "Math/RotationMatrix.h"
+#include "Physics/LyraAsyncTraceSubsystem.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(LyraCameraMode_ThirdPerson)
 
@@ -201,10 +202,19 @@ void ULyraCameraMode_ThirdPerson::PreventCameraPenetration(class AActor const& V
 	FCollisionShape SphereShape = FCollisionShape::MakeSphere(0.f);
 	UWorld* World = GetWorld();
 
+	// The predictive feelers can make do with last frame's sweeps, which ULyraAsyncTraceSubsystem batches and throttles
+	ULyraAsyncTraceSubsystem* AsyncTraces = World->GetSubsystem<ULyraAsyncTraceSubsystem>();
+	const bool bAsyncFeelers = AsyncTraces && ULyraAsyncTraceSubsystem::ShouldTraceCameraFeelersAsync();
+	if (bAsyncFeelers)
+	{
+		AsyncFeelerQueries.SetNum(PenetrationAvoidanceFeelers.Num());
+	}
+
 	for (int32 RayIdx = 0; RayIdx < NumRaysToShoot; ++RayIdx)
 	{
 		FLyraPenetrationAvoidanceFeeler& Feeler = PenetrationAvoidanceFeelers[RayIdx];
-		if (Feeler.FramesUntilNextTrace <= 0)
+		const bool bAsyncFeeler = bAsyncFeelers && (RayIdx > 0);
+		if (bAsyncFeeler || (Feeler.FramesUntilNextTrace <= 0))
 		{
 			// calc ray target
 			FVector RayTarget;
@@ -219,23 +229,62 @@ void ULyraCameraMode_ThirdPerson::PreventCameraPenetration(class AActor const& V
 			SphereShape.Sphere.Radius = Feeler.Extent;
 			ECollisionChannel TraceChannel = ECC_Camera;		//(Feeler.PawnWeight > 0.f) ? ECC_Pawn : ECC_Camera;
 
-			// do multi-line check to make sure the hits we throw out aren't
-			// masking real hits behind (these are important rays).
-
-			// MT-> passing camera as actor so that camerablockingvolumes know when it's the camera doing traces
 			FHitResult Hit;
-			const bool bHit = World->SweepSingleByChannel(Hit, SafeLoc, RayTarget, FQuat::Identity, TraceChannel, SphereShape, SphereParams);
+			bool bHit = false;
+			FVector TraceStart = SafeLoc;
+			FVector TraceEnd = RayTarget;
+
+			if (bAsyncFeeler)
+			{
+				// The subsystem applies the feeler's TraceInterval, staggered against the other feelers and cameras
+				FLyraAsyncTraceRequest Request;
+				Request.Start = SafeLoc;
+				Request.End = RayTarget;
+				Request.Shape = SphereShape;
+				Request.Channel = TraceChannel;
+				Request.QueryParams = SphereParams;
+
+				FAsyncFeelerQuery& Query = AsyncFeelerQueries[RayIdx];
+				AsyncTraces->RequestTrace(Query.Handle, Request, Query.bHitLastTrace ? 0 : Feeler.TraceInterval);
+
+				// Only a result from last frame's batch is new, otherwise the feeler is between traces
+				FLyraAsyncTraceResult Result;
+				if (!AsyncTraces->GetResult(Query.Handle, Result) || Result.bStale)
+				{
+					continue;
+				}
+
+				Hit = Result.Hit;
+				bHit = Hit.bBlockingHit;
+				TraceStart = Result.Start;
+				TraceEnd = Result.End;
+				Query.bHitLastTrace = false;
+			}
+			else
+			{
+				// do multi-line check to make sure the hits we throw out aren't
+				// masking real hits behind (these are important rays).
+
+				// MT-> passing camera as actor so that camerablockingvolumes know when it's the camera doing traces
+				bHit = World->SweepSingleByChannel(Hit, SafeLoc, RayTarget, FQuat::Identity, TraceChannel, SphereShape, SphereParams);
+
+				if (AsyncTraces)
+				{
+					AsyncTraces->RecordSyncTrace();
+				}
+
+				Feeler.FramesUntilNextTrace = Feeler.TraceInterval;
+			}
+
 #if ENABLE_DRAW_DEBUG
 			if (World->TimeSince(LastDrawDebugTime) < 1.f)
 			{
-				DrawDebugSphere(World, SafeLoc, SphereShape.Sphere.Radius, 8, FColor::Red);
-				DrawDebugSphere(World, bHit ? Hit.Location : RayTarget, SphereShape.Sphere.Radius, 8, FColor::Red);
-				DrawDebugLine(World, SafeLoc, bHit ? Hit.Location : RayTarget, FColor::Red);
+				DrawDebugSphere(World, TraceStart, SphereShape.Sphere.Radius, 8, FColor::Red);
+				DrawDebugSphere(World, bHit ? Hit.Location : TraceEnd, SphereShape.Sphere.Radius, 8, FColor::Red);
+				DrawDebugLine(World, TraceStart, bHit ? Hit.Location : TraceEnd, FColor::Red);
 			}
 #endif // ENABLE_DRAW_DEBUG
 
-			Feeler.FramesUntilNextTrace = Feeler.TraceInterval;
-
 			const AActor* HitActor = Hit.GetActor();
 
 			if (bHit && HitActor)
@@ -277,11 +326,15 @@ void ULyraCameraMode_ThirdPerson::PreventCameraPenetration(class AActor const& V
 					NewBlockPct += (1.f - NewBlockPct) * (1.f - Weight);
 
 					// Recompute blocked pct taking into account pushout distance.
-					NewBlockPct = ((Hit.Location - SafeLoc).Size() - CollisionPushOutDistance) / (RayTarget - SafeLoc).Size();
+					NewBlockPct = ((Hit.Location - TraceStart).Size() - CollisionPushOutDistance) / (TraceEnd - TraceStart).Size();
 					DistBlockedPctThisFrame = FMath::Min(NewBlockPct, DistBlockedPctThisFrame);
 
 					// This feeler got a hit, so do another trace next frame
 					Feeler.FramesUntilNextTrace = 0;
+					if (bAsyncFeeler)
+					{
+						AsyncFeelerQueries[RayIdx].bHitLastTrace = true;
+					}
 
 #if ENABLE_DRAW_DEBUG
 					DebugActorsHitDuringCameraPenetration.AddUnique(TObjectPtr<const AActor>(HitActor));
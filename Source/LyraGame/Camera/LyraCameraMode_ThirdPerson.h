@@ -101,6 +101,15 @@ public:
 	mutable float LastDrawDebugTime = -MAX_FLT;
 #endif
 
+private:
+	// Queries of the predictive feelers (index 1+) in ULyraAsyncTraceSubsystem
+	struct FAsyncFeelerQuery
+	{
+		int32 Handle = INDEX_NONE;
+		bool bHitLastTrace = false;
+	};
+	TArray<FAsyncFeelerQuery> AsyncFeelerQueries;
+
 protected:
 	
 	void SetTargetCrouchOffset(FVector NewTargetOffset);
@@ -6,8 +6,10 @@
 #include "Camera/LyraCameraComponent.h"
 #include "Character/LyraHealthComponent.h"
 #include "Character/LyraPawnExtensionComponent.h"
+#include "Character/LyraPawnPoolSubsystem.h"
 #include "Components/CapsuleComponent.h"
 #include "Components/SkeletalMeshComponent.h"
+#include "HAL/IConsoleManager.h"
 #include "LyraCharacterMovementComponent.h"
 #include "LyraGameplayTags.h"
 #include "LyraLogChannels.h"
@@ -18,6 +20,7 @@
 #include "Player/LyraPlayerState.h"
 #include "System/LyraSignificanceManager.h"
 #include "TimerManager.h"
+#include "Weapons/LyraLagCompensationSubsystem.h"
 
 #include "Components/ArrowComponent.h"
 #include "Components/NinjaCombatManagerComponent.h"
@@ -29,6 +32,30 @@ class FLifetimeProperty;
 class IRepChangedPropertyTracker;
 class UInputComponent;
 
+namespace LyraConsoleVariables
+{
+	static bool bCompactSharedMovement = true;
+	static FAutoConsoleVariableRef CVarCompactSharedMovement(
+		TEXT("lyra.SharedMovement.Compact"),
+		bCompactSharedMovement,
+		TEXT("Should FastShared movement updates use the compact format (location delta from a shared baseline, packed rotation) instead of a full FRepMovement?"),
+		ECVF_Default);
+
+	static int32 SharedMovementBaselineInterval = 30;
+	static FAutoConsoleVariableRef CVarSharedMovementBaselineInterval(
+		TEXT("lyra.SharedMovement.BaselineInterval"),
+		SharedMovementBaselineInterval,
+		TEXT("Number of compact FastShared updates sent against a baseline before moving to a new one"),
+		ECVF_Default);
+
+	static int32 SharedMovementBaselineRepeats = 8;
+	static FAutoConsoleVariableRef CVarSharedMovementBaselineRepeats(
+		TEXT("lyra.SharedMovement.BaselineRepeats"),
+		SharedMovementBaselineRepeats,
+		TEXT("Number of updates after a baseline change that carry the absolute baseline, so connections on a slower FastShared rate tier still receive it"),
+		ECVF_Default);
+}
+
 static FName NAME_LyraCharacterCollisionProfile_Capsule(TEXT("LyraPawnCapsule"));
 static FName NAME_LyraCharacterCollisionProfile_Mesh(TEXT("LyraPawnMesh"));
 
@@ -114,6 +141,14 @@ void ALyraCharacter::BeginPlay()
 			//@TODO: SignificanceManager->RegisterObject(this, (EFortSignificanceType)SignificanceType);
 		}
 	}
+
+	if (HasAuthority())
+	{
+		if (ULyraLagCompensationSubsystem* LagCompensation = World->GetSubsystem<ULyraLagCompensationSubsystem>())
+		{
+			LagCompensation->RegisterPawn(this);
+		}
+	}
 }
 
 void ALyraCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
@@ -130,6 +165,11 @@ void ALyraCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
 			SignificanceManager->UnregisterObject(this);
 		}
 	}
+
+	if (ULyraLagCompensationSubsystem* LagCompensation = World->GetSubsystem<ULyraLagCompensationSubsystem>())
+	{
+		LagCompensation->UnregisterPawn(this);
+	}
 }
 
 void ALyraCharacter::Reset()
@@ -379,6 +419,28 @@ void ALyraCharacter::DisableMovementAndCollision()
 	LyraMoveComp->DisableMovement();
 }
 
+void ALyraCharacter::RestoreMovementAndCollision()
+{
+	UCapsuleComponent* CapsuleComp = GetCapsuleComponent();
+	check(CapsuleComp);
+	CapsuleComp->SetCollisionProfileName(NAME_LyraCharacterCollisionProfile_Capsule);
+
+	// Death may have left the mesh ragdolling, put it back on the capsule where the defaults have it
+	USkeletalMeshComponent* MeshComp = GetMesh();
+	check(MeshComp);
+	if (MeshComp->IsSimulatingPhysics())
+	{
+		MeshComp->SetSimulatePhysics(false);
+		MeshComp->AttachToComponent(CapsuleComp, FAttachmentTransformRules::SnapToTargetNotIncludingScale);
+
+		const USkeletalMeshComponent* DefaultMeshComp = GetDefault<ALyraCharacter>(GetClass())->GetMesh();
+		MeshComp->SetRelativeLocationAndRotation(DefaultMeshComp->GetRelativeLocation(), DefaultMeshComp->GetRelativeRotation());
+	}
+
+	ULyraCharacterMovementComponent* LyraMoveComp = CastChecked<ULyraCharacterMovementComponent>(GetCharacterMovement());
+	LyraMoveComp->SetDefaultMovementMode();
+}
+
 void ALyraCharacter::DestroyDueToDeath()
 {
 	K2_OnDeathFinished();
@@ -392,7 +454,6 @@ void ALyraCharacter::UninitAndDestroy()
 	if (GetLocalRole() == ROLE_Authority)
 	{
 		DetachFromControllerPendingDestroy();
-		SetLifeSpan(0.1f);
 	}
 
 	// Uninitialize the ASC if we're still the avatar actor (otherwise another pawn already did it when they became the avatar actor)
@@ -405,6 +466,20 @@ void ALyraCharacter::UninitAndDestroy()
 	}
 
 	SetActorHiddenInGame(true);
+
+	if (GetLocalRole() == ROLE_Authority)
+	{
+		// Let the pawn pool keep us for a later respawn, otherwise go away as usual
+		ULyraPawnPoolSubsystem* PawnPool = GetWorld()->GetSubsystem<ULyraPawnPoolSubsystem>();
+		if (PawnPool && PawnPool->ReturnPawn(this))
+		{
+			RestoreMovementAndCollision();
+		}
+		else
+		{
+			SetLifeSpan(0.1f);
+		}
+	}
 }
 
 void ALyraCharacter::OnMovementModeChanged(EMovementMode PrevMovementMode, uint8 PreviousCustomMode)
@@ -553,6 +628,7 @@ bool ALyraCharacter::UpdateSharedReplication()
 			// it, will get it this frame)
 			if (!SharedMovement.Equals(LastSharedReplication, this))
 			{
+				SharedRepBaseline.Apply(SharedMovement, LyraConsoleVariables::bCompactSharedMovement);
 				LastSharedReplication = SharedMovement;
 				SetReplicatedMovementMode(SharedMovement.RepMovementMode);
 
@@ -596,6 +672,13 @@ void ALyraCharacter::FastSharedReplication_Implementation(const FSharedRepMoveme
 	// Timestamp is checked to reject old moves.
 	if (GetLocalRole() == ROLE_SimulatedProxy)
 	{
+		// Compact updates sent against a baseline we never got can't be used, the next baseline will catch us up
+		FSharedRepMovement ResolvedMovement = SharedRepMovement;
+		if (!ResolvedMovement.ResolveLocation(ReceivedSharedRepBaselineId, ReceivedSharedRepBaselineLocation))
+		{
+			return;
+		}
+
 		// Timestamp
 		SetReplicatedServerLastTransformUpdateTimeStamp(SharedRepMovement.RepTimeStamp);
 
@@ -609,7 +692,7 @@ void ALyraCharacter::FastSharedReplication_Implementation(const FSharedRepMoveme
 
 		// Location, Rotation, Velocity, etc.
 		FRepMovement& MutableRepMovement = GetReplicatedMovement_Mutable();
-		MutableRepMovement = SharedRepMovement.RepMovement;
+		MutableRepMovement = ResolvedMovement.RepMovement;
 
 		// This also sets LastRepMovement
 		OnRep_ReplicatedMovement();
@@ -694,10 +777,181 @@ bool FSharedRepMovement::Equals(const FSharedRepMovement& Other, ACharacter* Cha
 	return true;
 }
 
+namespace LyraSharedMovement
+{
+	// The three smallest components of a unit quaternion lie within +-1/sqrt(2)
+	static constexpr uint32 QuatComponentBits = 9;
+	static constexpr uint32 QuatComponentSteps = 1u << QuatComponentBits;
+
+	static void SerializeSmallestThree(FArchive& Ar, FQuat& Quat)
+	{
+		uint8 LargestIndex = 0;
+		uint32 Packed[3] = { 0, 0, 0 };
+
+		if (Ar.IsSaving())
+		{
+			const FQuat Normalized = Quat.GetNormalized();
+			const double Components[4] = { Normalized.X, Normalized.Y, Normalized.Z, Normalized.W };
+
+			for (uint8 Index = 1; Index < 4; ++Index)
+			{
+				if (FMath::Abs(Components[Index]) > FMath::Abs(Components[LargestIndex]))
+				{
+					LargestIndex = Index;
+				}
+			}
+
+			// Q and -Q are the same rotation, flip so the dropped component is positive
+			const double Sign = (Components[LargestIndex] < 0.0) ? -1.0 : 1.0;
+
+			int32 PackedIndex = 0;
+			for (uint8 Index = 0; Index < 4; ++Index)
+			{
+				if (Index != LargestIndex)
+				{
+					const double Alpha = ((Components[Index] * Sign * UE_SQRT_2) + 1.0) * 0.5;
+					Packed[PackedIndex++] = (uint32)FMath::Clamp<int64>(FMath::RoundToInt64(Alpha * (QuatComponentSteps - 1)), 0, QuatComponentSteps - 1);
+				}
+			}
+		}
+
+		Ar.SerializeBits(&LargestIndex, 2);
+		for (uint32& Value : Packed)
+		{
+			Ar.SerializeInt(Value, QuatComponentSteps);
+		}
+
+		if (Ar.IsLoading())
+		{
+			double Components[4];
+			double SumSquared = 0.0;
+			int32 PackedIndex = 0;
+			for (uint8 Index = 0; Index < 4; ++Index)
+			{
+				if (Index != LargestIndex)
+				{
+					const double Alpha = (double)Packed[PackedIndex++] / (QuatComponentSteps - 1);
+					Components[Index] = ((Alpha * 2.0) - 1.0) * UE_INV_SQRT_2;
+					SumSquared += FMath::Square(Components[Index]);
+				}
+			}
+			Components[LargestIndex & 3] = FMath::Sqrt(FMath::Max(0.0, 1.0 - SumSquared));
+
+			Quat = FQuat(Components[0], Components[1], Components[2], Components[3]).GetNormalized();
+		}
+	}
+
+	static void SerializeRotation(FArchive& Ar, FRotator& Rotation)
+	{
+		// Characters are almost always upright, in which case the yaw is all that needs sending
+		uint8 bYawOnly = (FRotator::CompressAxisToByte(Rotation.Pitch) == 0) && (FRotator::CompressAxisToByte(Rotation.Roll) == 0);
+		Ar.SerializeBits(&bYawOnly, 1);
+
+		if (bYawOnly)
+		{
+			uint8 Yaw = FRotator::CompressAxisToByte(Rotation.Yaw);
+			Ar << Yaw;
+
+			if (Ar.IsLoading())
+			{
+				Rotation = FRotator(0.0, FRotator::DecompressAxisFromByte(Yaw), 0.0);
+			}
+		}
+		else
+		{
+			FQuat Quat = Rotation.Quaternion();
+			SerializeSmallestThree(Ar, Quat);
+
+			if (Ar.IsLoading())
+			{
+				Rotation = Quat.Rotator();
+			}
+		}
+	}
+}
+
+void FSharedRepMovementBaseline::Apply(FSharedRepMovement& Movement, bool bUseCompactFormat)
+{
+	Movement.bCompact = bUseCompactFormat;
+	if (!Movement.bCompact)
+	{
+		// Start over with a fresh baseline if the compact format is turned back on
+		Id = 0;
+		return;
+	}
+
+	if ((Id == 0) || (UpdatesSinceChange >= FMath::Max(LyraConsoleVariables::SharedMovementBaselineInterval, 1)))
+	{
+		Id = (Id % FSharedRepMovement::MaxBaselineId) + 1;
+		Location = Movement.RepMovement.Location;
+		UpdatesSinceChange = 0;
+	}
+
+	Movement.BaselineId = Id;
+	Movement.BaselineLocation = Location;
+	Movement.bSendBaseline = (UpdatesSinceChange < FMath::Max(LyraConsoleVariables::SharedMovementBaselineRepeats, 1));
+
+	++UpdatesSinceChange;
+}
+
+bool FSharedRepMovement::ResolveLocation(uint8& InOutBaselineId, FVector& InOutBaselineLocation)
+{
+	if (!bCompact)
+	{
+		return true;
+	}
+
+	if (bSendBaseline)
+	{
+		InOutBaselineId = BaselineId;
+		InOutBaselineLocation = BaselineLocation;
+	}
+
+	if ((BaselineId == 0) || (BaselineId != InOutBaselineId))
+	{
+		return false;
+	}
+
+	RepMovement.Location = InOutBaselineLocation + LocationDelta;
+	return true;
+}
+
 bool FSharedRepMovement::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
 {
 	bOutSuccess = true;
-	RepMovement.NetSerialize(Ar, Map, bOutSuccess);
+
+	uint8 bCompactFormat = bCompact;
+	Ar.SerializeBits(&bCompactFormat, 1);
+	bCompact = (bCompactFormat != 0);
+
+	if (bCompact)
+	{
+		uint8 bHasBaseline = bSendBaseline;
+		Ar.SerializeBits(&bHasBaseline, 1);
+		bSendBaseline = (bHasBaseline != 0);
+
+		Ar.SerializeBits(&BaselineId, 3);
+
+		if (bSendBaseline)
+		{
+			bOutSuccess &= SerializePackedVector<100, 30>(BaselineLocation, Ar);
+		}
+
+		// Millimeters are plenty for a delta that is only ever added to a centimeter accurate baseline
+		if (Ar.IsSaving())
+		{
+			LocationDelta = RepMovement.Location - BaselineLocation;
+		}
+		bOutSuccess &= SerializePackedVector<10, 24>(LocationDelta, Ar);
+
+		LyraSharedMovement::SerializeRotation(Ar, RepMovement.Rotation);
+		bOutSuccess &= SerializePackedVector<1, 24>(RepMovement.LinearVelocity, Ar);
+	}
+	else
+	{
+		RepMovement.NetSerialize(Ar, Map, bOutSuccess);
+	}
+
 	Ar << RepMovementMode;
 	Ar << bProxyIsJumpForceApplied;
 	Ar << bIsCrouched;
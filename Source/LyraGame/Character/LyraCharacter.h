@@ -53,7 +53,14 @@ struct FLyraReplicatedAcceleration
 	int8 AccelZ = 0;	// Raw Z accel rate component, quantized to represent [-MaxAcceleration, MaxAcceleration]
 };
 
-/** The type we use to send FastShared movement updates. */
+/**
+ * The type we use to send FastShared movement updates.
+ *
+ * The bunch is serialized once and shared by every connection, so there is no per connection acked state to delta against.
+ * Instead the compact format (lyra.SharedMovement.Compact) sends the location as a small delta from a shared baseline. The
+ * absolute baseline goes along with the first few updates after it changes, and receivers that missed it drop deltas until
+ * the next one. Rotation is sent as a byte yaw when the character is upright and as a smallest-three quaternion otherwise.
+ */
 USTRUCT()
 struct FSharedRepMovement
 {
@@ -66,6 +73,9 @@ struct FSharedRepMovement
 
 	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
 
+	/** Works out the received location of a compact update from the last baseline received, returns false if that isn't the baseline it was sent against */
+	bool ResolveLocation(uint8& InOutBaselineId, FVector& InOutBaselineLocation);
+
 	UPROPERTY(Transient)
 	FRepMovement RepMovement;
 
@@ -80,6 +90,39 @@ struct FSharedRepMovement
 
 	UPROPERTY(Transient)
 	bool bIsCrouched = false;
+
+	// Which format NetSerialize writes, set by the sender
+	UPROPERTY(Transient)
+	bool bCompact = false;
+
+	// Compact format: id of the baseline the location delta is against, 0 when there is none
+	UPROPERTY(Transient)
+	uint8 BaselineId = 0;
+
+	// Compact format: whether the absolute baseline location is sent along with this update
+	UPROPERTY(Transient)
+	bool bSendBaseline = false;
+
+	// Compact format: the baseline itself, in the same space as RepMovement.Location
+	UPROPERTY(Transient)
+	FVector BaselineLocation = FVector::ZeroVector;
+
+	// Compact format: RepMovement.Location - BaselineLocation, only filled in on the receiving end until ResolveLocation
+	UPROPERTY(Transient)
+	FVector LocationDelta = FVector::ZeroVector;
+
+	static constexpr uint8 MaxBaselineId = 7;
+};
+
+/** Sender side baseline for compact FSharedRepMovement updates */
+struct FSharedRepMovementBaseline
+{
+	FVector Location = FVector::ZeroVector;
+	uint8 Id = 0;
+	int32 UpdatesSinceChange = 0;
+
+	/** Moves on to a new baseline when it is time to, and fills in the compact fields of Movement */
+	void Apply(FSharedRepMovement& Movement, bool bUseCompactFormat);
 };
 
 template<>
@@ -153,6 +196,16 @@ public:
 
 	UE_API virtual bool UpdateSharedReplication();
 
+private:
+	// Baseline compact FastShared updates are sent against (server)
+	FSharedRepMovementBaseline SharedRepBaseline;
+
+	// Last baseline received from the server (simulated proxies)
+	FVector ReceivedSharedRepBaselineLocation = FVector::ZeroVector;
+	uint8 ReceivedSharedRepBaselineId = 0;
+
+public:
+
 	// -- Begin CombatSystem implementation
 	UE_API virtual UNinjaCombatManagerComponent* GetCombatManager_Implementation() const override;
 	UE_API virtual USceneComponent* GetCombatForwardReference_Implementation() const override;
@@ -181,11 +234,12 @@ protected:
 	UFUNCTION()
 	UE_API virtual void OnDeathStarted(AActor* OwningActor);
 
-	// Ends the death sequence for the character (detaches controller, destroys pawn, etc...)
+	// Ends the death sequence for the character (detaches controller, destroys or pools pawn, etc...)
 	UFUNCTION()
 	UE_API virtual void OnDeathFinished(AActor* OwningActor);
 
 	UE_API void DisableMovementAndCollision();
+	UE_API void RestoreMovementAndCollision();
 	UE_API void DestroyDueToDeath();
 	UE_API void UninitAndDestroy();
 
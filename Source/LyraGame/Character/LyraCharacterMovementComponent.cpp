@@ -7,6 +7,7 @@
 #include "Components/CapsuleComponent.h"
 #include "Engine/World.h"
 #include "GameFramework/Character.h"
+#include "Physics/LyraAsyncTraceSubsystem.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(LyraCharacterMovementComponent)
 
@@ -77,8 +78,35 @@ const FLyraCharacterGroundInfo& ULyraCharacterMovementComponent::GetGroundInfo()
 		FCollisionResponseParams ResponseParam;
 		InitCollisionParams(QueryParams, ResponseParam);
 
+		ULyraAsyncTraceSubsystem* AsyncTraces = GetWorld()->GetSubsystem<ULyraAsyncTraceSubsystem>();
+		const bool bTraceAsync = AsyncTraces && ULyraAsyncTraceSubsystem::ShouldTraceGroundInfoAsync();
+		if (bTraceAsync)
+		{
+			FLyraAsyncTraceRequest Request;
+			Request.Start = TraceStart;
+			Request.End = TraceEnd;
+			Request.Channel = CollisionChannel;
+			Request.QueryParams = QueryParams;
+			Request.ResponseParams = ResponseParam;
+			AsyncTraces->RequestTrace(GroundTraceHandle, Request);
+		}
+
+		// Last frame's async trace if there is one, otherwise (just left the ground, async traces off) trace now
 		FHitResult HitResult;
-		GetWorld()->LineTraceSingleByChannel(HitResult, TraceStart, TraceEnd, CollisionChannel, QueryParams, ResponseParam);
+		FLyraAsyncTraceResult AsyncResult;
+		if (bTraceAsync && AsyncTraces->GetResult(GroundTraceHandle, AsyncResult) && !AsyncResult.bStale)
+		{
+			HitResult = AsyncResult.Hit;
+		}
+		else
+		{
+			GetWorld()->LineTraceSingleByChannel(HitResult, TraceStart, TraceEnd, CollisionChannel, QueryParams, ResponseParam);
+
+			if (AsyncTraces)
+			{
+				AsyncTraces->RecordSyncTrace();
+			}
+		}
 
 		CachedGroundInfo.GroundHitResult = HitResult;
 		CachedGroundInfo.GroundDistance = LyraCharacter::GroundTraceDistance;
@@ -89,7 +117,9 @@ const FLyraCharacterGroundInfo& ULyraCharacterMovementComponent::GetGroundInfo()
 		}
 		else if (HitResult.bBlockingHit)
 		{
-			CachedGroundInfo.GroundDistance = FMath::Max((HitResult.Distance - CapsuleHalfHeight), 0.0f);
+			// Measured from where the character is now, since an async hit was traced from last frame's location
+			const float HitDistance = (TraceStart.Z - HitResult.Location.Z);
+			CachedGroundInfo.GroundDistance = FMath::Max((HitDistance - CapsuleHalfHeight), 0.0f);
 		}
 	}
 
@@ -78,6 +78,9 @@ protected:
 	// Cached ground info for the character.  Do not access this directly!  It's only updated when accessed via GetGroundInfo().
 	FLyraCharacterGroundInfo CachedGroundInfo;
 
+	// Query of the ground trace in ULyraAsyncTraceSubsystem while airborne
+	int32 GroundTraceHandle = INDEX_NONE;
+
 	UPROPERTY(Transient)
 	bool bHasReplicatedAcceleration = false;
 };
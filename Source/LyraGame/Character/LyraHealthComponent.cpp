@@ -276,6 +276,13 @@ void ULyraHealthComponent::FinishDeath()
 	Owner->ForceNetUpdate();
 }
 
+void ULyraHealthComponent::ResetDeathState()
+{
+	ClearGameplayTags();
+
+	DeathState = ELyraDeathState::NotDead;
+}
+
 void ULyraHealthComponent::DamageSelfDestruct(bool bFellOutOfWorld)
 {
 	if ((DeathState == ELyraDeathState::NotDead) && AbilitySystemComponent)
@@ -86,6 +86,9 @@ public:
 	// Applies enough damage to kill the owner.
 	UE_API virtual void DamageSelfDestruct(bool bFellOutOfWorld = false);
 
+	// Puts the owner back to not dead without going through the death sequence, used when a dead pawn is pooled for reuse.
+	UE_API void ResetDeathState();
+
 public:
 
 	// Delegate fired when the health value has changed. This is called on the client but the instigator may not be valid
@@ -222,6 +222,26 @@ void ULyraHeroComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 	Super::EndPlay(EndPlayReason);
 }
 
+void ULyraHeroComponent::OnPawnParked()
+{
+	UnregisterInitStateFeature();
+
+	// Input is bound again for whoever possesses the pawn next, and the camera mode belonged to the previous life's abilities
+	bReadyToBindInputs = false;
+	AbilityCameraMode = nullptr;
+	AbilityCameraModeOwningSpecHandle = FGameplayAbilitySpecHandle();
+}
+
+void ULyraHeroComponent::OnPawnTakenFromPool()
+{
+	// What OnRegister and BeginPlay do
+	RegisterInitStateFeature();
+	BindOnActorInitStateChanged(ULyraPawnExtensionComponent::NAME_ActorFeatureName, FGameplayTag(), false);
+
+	ensure(TryToChangeInitState(LyraGameplayTags::InitState_Spawned));
+	CheckDefaultInitialization();
+}
+
 void ULyraHeroComponent::InitializePlayerInput(UInputComponent* PlayerInputComponent)
 {
 	check(PlayerInputComponent);
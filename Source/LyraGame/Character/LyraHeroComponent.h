@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include "Character/LyraPooledPawnComponentInterface.h"
 #include "Components/GameFrameworkInitStateInterface.h"
 #include "Components/PawnComponent.h"
 #include "GameFeatures/GameFeatureAction_AddInputContextMapping.h"
@@ -29,7 +30,7 @@ struct FInputActionValue;
  * This depends on a PawnExtensionComponent to coordinate initialization.
  */
 UCLASS(MinimalAPI, Blueprintable, Meta=(BlueprintSpawnableComponent))
-class ULyraHeroComponent : public UPawnComponent, public IGameFrameworkInitStateInterface
+class ULyraHeroComponent : public UPawnComponent, public IGameFrameworkInitStateInterface, public ILyraPooledPawnComponentInterface
 {
 	GENERATED_BODY()
 
@@ -68,6 +69,11 @@ public:
 	UE_API virtual void HandleChangeInitState(UGameFrameworkComponentManager* Manager, FGameplayTag CurrentState, FGameplayTag DesiredState) override;
 	UE_API virtual void OnActorInitStateChanged(const FActorInitStateChangedParams& Params) override;
 	UE_API virtual void CheckDefaultInitialization() override;
+
+	//~ILyraPooledPawnComponentInterface interface
+	UE_API virtual void OnPawnParked() override;
+	UE_API virtual void OnPawnTakenFromPool() override;
+	//~End of ILyraPooledPawnComponentInterface interface
 	//~ End IGameFrameworkInitStateInterface interface
 
 protected:
@@ -73,6 +73,23 @@ void ULyraPawnExtensionComponent::EndPlay(const EEndPlayReason::Type EndPlayReas
 	Super::EndPlay(EndPlayReason);
 }
 
+void ULyraPawnExtensionComponent::OnPawnParked()
+{
+	// What EndPlay does, the pawn stays in the world but leaves the init state system until it is reused
+	UninitializeAbilitySystem();
+	UnregisterInitStateFeature();
+}
+
+void ULyraPawnExtensionComponent::OnPawnTakenFromPool()
+{
+	// What OnRegister and BeginPlay do, so the reused pawn goes through the init state chain from InitState_Spawned again
+	RegisterInitStateFeature();
+	BindOnActorInitStateChanged(NAME_None, FGameplayTag(), false);
+
+	ensure(TryToChangeInitState(LyraGameplayTags::InitState_Spawned));
+	CheckDefaultInitialization();
+}
+
 void ULyraPawnExtensionComponent::SetPawnData(const ULyraPawnData* InPawnData)
 {
 	check(InPawnData);
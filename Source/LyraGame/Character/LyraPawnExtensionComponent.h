@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include "Character/LyraPooledPawnComponentInterface.h"
 #include "Components/GameFrameworkInitStateInterface.h"
 #include "Components/PawnComponent.h"
 
@@ -24,7 +25,7 @@ struct FGameplayTag;
  * This coordinates the initialization of other components.
  */
 UCLASS(MinimalAPI)
-class ULyraPawnExtensionComponent : public UPawnComponent, public IGameFrameworkInitStateInterface
+class ULyraPawnExtensionComponent : public UPawnComponent, public IGameFrameworkInitStateInterface, public ILyraPooledPawnComponentInterface
 {
 	GENERATED_BODY()
 
@@ -43,6 +44,11 @@ public:
 	UE_API virtual void CheckDefaultInitialization() override;
 	//~ End IGameFrameworkInitStateInterface interface
 
+	//~ILyraPooledPawnComponentInterface interface
+	UE_API virtual void OnPawnParked() override;
+	UE_API virtual void OnPawnTakenFromPool() override;
+	//~End of ILyraPooledPawnComponentInterface interface
+
 	/** Returns the pawn extension component if one exists on the specified actor. */
 	UFUNCTION(BlueprintPure, Category = "Lyra|Pawn")
 	static ULyraPawnExtensionComponent* FindPawnExtensionComponent(const AActor* Actor) { return (Actor ? Actor->FindComponentByClass<ULyraPawnExtensionComponent>() : nullptr); }
@@ -0,0 +1,279 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "LyraPawnPoolSubsystem.h"
+
+#include "AbilitySystemComponent.h"
+#include "AbilitySystemGlobals.h"
+#include "AttributeSet.h"
+#include "Character/LyraHealthComponent.h"
+#include "Character/LyraPawnData.h"
+#include "Character/LyraPawnExtensionComponent.h"
+#include "Character/LyraPooledPawnComponentInterface.h"
+#include "Components/ActorComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "HAL/IConsoleManager.h"
+#include "LyraLogChannels.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(LyraPawnPoolSubsystem)
+
+namespace LyraConsoleVariables
+{
+	static bool bEnablePawnPool = true;
+	static FAutoConsoleVariableRef CVarEnablePawnPool(
+		TEXT("lyra.PawnPool.Enable"),
+		bEnablePawnPool,
+		TEXT("Should the game mode hand out pooled pawns instead of spawning new ones when it has them?"),
+		ECVF_Default);
+
+	static bool bRecyclePawnsOnDeath = false;
+	static FAutoConsoleVariableRef CVarRecyclePawnsOnDeath(
+		TEXT("lyra.PawnPool.RecycleOnDeath"),
+		bRecyclePawnsOnDeath,
+		TEXT("Should pawns that finished dying go back into the pawn pool to be reused on respawn, rather than being destroyed?"),
+		ECVF_Default);
+
+	static int32 MaxPooledPawns = 32;
+	static FAutoConsoleVariableRef CVarMaxPooledPawns(
+		TEXT("lyra.PawnPool.MaxPooledPawns"),
+		MaxPooledPawns,
+		TEXT("Dead pawns are destroyed as usual once the pool holds this many"),
+		ECVF_Default);
+}
+
+namespace LyraPawnPool
+{
+	// Out of the way of the level while parked
+	static const FVector ParkingLocation(0.0, 0.0, -50000.0);
+}
+
+bool ULyraPawnPoolSubsystem::IsEnabled()
+{
+	return LyraConsoleVariables::bEnablePawnPool;
+}
+
+bool ULyraPawnPoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void ULyraPawnPoolSubsystem::Deinitialize()
+{
+	for (FPooledPawn& Pooled : PooledPawns)
+	{
+		if (APawn* Pawn = Pooled.Pawn.Get())
+		{
+			Pawn->Destroy();
+		}
+	}
+	PooledPawns.Reset();
+
+	Super::Deinitialize();
+}
+
+bool ULyraPawnPoolSubsystem::PrewarmPawn(const ULyraPawnData* PawnData)
+{
+	UWorld* World = GetWorld();
+	if ((PawnData == nullptr) || (PawnData->PawnClass == nullptr) || (World->GetNetMode() == NM_Client))
+	{
+		return false;
+	}
+
+	// Same as ALyraGameMode::SpawnDefaultPawnAtTransform, minus the controller
+	FActorSpawnParameters SpawnInfo;
+	SpawnInfo.ObjectFlags |= RF_Transient;
+	SpawnInfo.bDeferConstruction = true;
+	SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	const FTransform SpawnTransform(LyraPawnPool::ParkingLocation);
+	APawn* Pawn = World->SpawnActor<APawn>(PawnData->PawnClass, SpawnTransform, SpawnInfo);
+	if (Pawn == nullptr)
+	{
+		return false;
+	}
+
+	if (ULyraPawnExtensionComponent* PawnExtComp = ULyraPawnExtensionComponent::FindPawnExtensionComponent(Pawn))
+	{
+		PawnExtComp->SetPawnData(PawnData);
+	}
+
+	Pawn->FinishSpawning(SpawnTransform);
+
+	ResetPawnForReuse(Pawn);
+
+	FPooledPawn& Pooled = PooledPawns.AddDefaulted_GetRef();
+	Pooled.Pawn = Pawn;
+	Pooled.PawnClass = PawnData->PawnClass.Get();
+	Pooled.PawnData = PawnData;
+	ParkPawn(Pooled);
+
+	return true;
+}
+
+bool ULyraPawnPoolSubsystem::ReturnPawn(APawn* Pawn)
+{
+	if (!IsEnabled() || !LyraConsoleVariables::bRecyclePawnsOnDeath || (PooledPawns.Num() >= LyraConsoleVariables::MaxPooledPawns))
+	{
+		return false;
+	}
+
+	if ((Pawn == nullptr) || !Pawn->HasAuthority() || Pawn->IsActorBeingDestroyed() || (Pawn->GetController() != nullptr) || IsPooled(Pawn))
+	{
+		return false;
+	}
+
+	// Only pawns that can be matched up again by the game mode are worth keeping
+	const ULyraPawnExtensionComponent* PawnExtComp = ULyraPawnExtensionComponent::FindPawnExtensionComponent(Pawn);
+	const ULyraPawnData* PawnData = PawnExtComp ? PawnExtComp->GetPawnData<ULyraPawnData>() : nullptr;
+	if (PawnData == nullptr)
+	{
+		return false;
+	}
+
+	ResetPawnForReuse(Pawn);
+
+	FPooledPawn& Pooled = PooledPawns.AddDefaulted_GetRef();
+	Pooled.Pawn = Pawn;
+	Pooled.PawnClass = Pawn->GetClass();
+	Pooled.PawnData = PawnData;
+	ParkPawn(Pooled);
+
+	UE_LOG(LogLyra, Verbose, TEXT("Pawn pool: took back [%s], %d pawns pooled"), *GetNameSafe(Pawn), PooledPawns.Num());
+
+	return true;
+}
+
+bool ULyraPawnPoolSubsystem::IsPooled(const APawn* Pawn) const
+{
+	return PooledPawns.ContainsByPredicate([Pawn](const FPooledPawn& Pooled) { return Pooled.Pawn.Get() == Pawn; });
+}
+
+void ULyraPawnPoolSubsystem::ResetPawnForReuse(APawn* Pawn)
+{
+	// Equipment (and the abilities it granted, wherever the ability system lives), init states, input and so on.
+	// The pawn may be handed to a different controller next, so nothing from the previous life can carry over
+	for (UActorComponent* Component : Pawn->GetComponents())
+	{
+		if (ILyraPooledPawnComponentInterface* PooledComponent = Cast<ILyraPooledPawnComponentInterface>(Component))
+		{
+			PooledComponent->OnPawnParked();
+		}
+	}
+
+	// Abilities, effects and attributes only need resetting when the ability system lives on the pawn itself,
+	// one owned by the player state carries over between pawns just like it does without the pool
+	UAbilitySystemComponent* ASC = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(Pawn);
+	if (ASC && (ASC->GetOwnerActor() == Pawn))
+	{
+		ASC->CancelAllAbilities();
+		ASC->RemoveActiveEffects(FGameplayEffectQuery());
+
+		for (UAttributeSet* AttributeSet : ASC->GetSpawnedAttributes())
+		{
+			if (AttributeSet == nullptr)
+			{
+				continue;
+			}
+
+			const UAttributeSet* DefaultSet = AttributeSet->GetClass()->GetDefaultObject<UAttributeSet>();
+			for (TFieldIterator<FProperty> It(AttributeSet->GetClass()); It; ++It)
+			{
+				if (FGameplayAttribute::IsGameplayAttributeDataProperty(*It))
+				{
+					const FGameplayAttribute Attribute(*It);
+					ASC->SetNumericAttributeBase(Attribute, Attribute.GetNumericValue(DefaultSet));
+				}
+			}
+		}
+	}
+
+	if (ULyraHealthComponent* HealthComponent = ULyraHealthComponent::FindHealthComponent(Pawn))
+	{
+		HealthComponent->ResetDeathState();
+	}
+}
+
+APawn* ULyraPawnPoolSubsystem::TakePawn(const UClass* PawnClass, const ULyraPawnData* PawnData, const FTransform& SpawnTransform)
+{
+	if (!IsEnabled())
+	{
+		return nullptr;
+	}
+
+	for (int32 Index = PooledPawns.Num() - 1; Index >= 0; --Index)
+	{
+		FPooledPawn& Pooled = PooledPawns[Index];
+		if (!Pooled.Pawn.IsValid())
+		{
+			PooledPawns.RemoveAtSwap(Index);
+			continue;
+		}
+
+		if ((Pooled.PawnClass == PawnClass) && (Pooled.PawnData == PawnData))
+		{
+			FPooledPawn Taken = MoveTemp(Pooled);
+			PooledPawns.RemoveAtSwap(Index);
+
+			WakePawn(Taken, SpawnTransform);
+			return Taken.Pawn.Get();
+		}
+	}
+
+	return nullptr;
+}
+
+void ULyraPawnPoolSubsystem::ParkPawn(FPooledPawn& Pooled)
+{
+	APawn* Pawn = Pooled.Pawn.Get();
+	check(Pawn);
+
+	Pooled.TickingComponents.Reset();
+	for (UActorComponent* Component : Pawn->GetComponents())
+	{
+		if (Component && Component->IsComponentTickEnabled())
+		{
+			Pooled.TickingComponents.Add(Component);
+			Component->SetComponentTickEnabled(false);
+		}
+	}
+
+	Pawn->SetActorTickEnabled(false);
+	Pawn->SetActorHiddenInGame(true);
+	Pawn->SetActorEnableCollision(false);
+	Pawn->SetActorLocation(LyraPawnPool::ParkingLocation, /*bSweep=*/ false, nullptr, ETeleportType::ResetPhysics);
+
+	// Clients drop their copy, a reused pawn shows up for them as a new actor
+	Pawn->SetReplicates(false);
+}
+
+void ULyraPawnPoolSubsystem::WakePawn(FPooledPawn& Pooled, const FTransform& SpawnTransform)
+{
+	APawn* Pawn = Pooled.Pawn.Get();
+	check(Pawn);
+
+	Pawn->SetActorTransform(SpawnTransform, /*bSweep=*/ false, nullptr, ETeleportType::ResetPhysics);
+	Pawn->SetActorEnableCollision(true);
+	Pawn->SetActorHiddenInGame(false);
+	Pawn->SetActorTickEnabled(true);
+
+	for (const TWeakObjectPtr<UActorComponent>& WeakComponent : Pooled.TickingComponents)
+	{
+		if (UActorComponent* Component = WeakComponent.Get())
+		{
+			Component->SetComponentTickEnabled(true);
+		}
+	}
+	Pooled.TickingComponents.Reset();
+
+	Pawn->SetReplicates(true);
+
+	for (UActorComponent* Component : Pawn->GetComponents())
+	{
+		if (ILyraPooledPawnComponentInterface* PooledComponent = Cast<ILyraPooledPawnComponentInterface>(Component))
+		{
+			PooledComponent->OnPawnTakenFromPool();
+		}
+	}
+
+	Pawn->ForceNetUpdate();
+}
@@ -0,0 +1,76 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+
+#include "LyraPawnPoolSubsystem.generated.h"
+
+class APawn;
+class UActorComponent;
+class ULyraPawnData;
+
+/**
+ * ULyraPawnPoolSubsystem
+ *
+ * Server side pool of dormant pawns. Pawns are either spawned ahead of time (e.g. by ULyraBotCreationComponent while the
+ * match is starting) or handed back by ALyraCharacter once its death sequence is over, instead of being destroyed.
+ * ALyraGameMode::SpawnDefaultPawnAtTransform takes a matching pawn from here before spawning a new one.
+ *
+ * While parked a pawn is hidden, has collision and ticking off and doesn't replicate, so clients drop their copy of it.
+ * Components implementing ILyraPooledPawnComponentInterface release their per-life state when the pawn is parked (equipment
+ * is unequipped, init state features leave the init state system) and start over when it is taken, so a reused pawn goes
+ * through the same init state chain as a freshly spawned one.
+ */
+UCLASS()
+class ULyraPawnPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~USubsystem interface
+	virtual void Deinitialize() override;
+	//~End of USubsystem interface
+
+	static bool IsEnabled();
+
+	/** Spawns one dormant pawn of PawnData's pawn class into the pool, returns false if it couldn't be spawned */
+	bool PrewarmPawn(const ULyraPawnData* PawnData);
+
+	/**
+	 * Takes a dead, unpossessed pawn into the pool instead of destroying it, resetting its ability system and health.
+	 * Returns false if the pool doesn't want it, in which case the caller should destroy it as usual.
+	 */
+	bool ReturnPawn(APawn* Pawn);
+
+	/** Wakes up a pooled pawn made from PawnData at SpawnTransform, or returns null if none are pooled */
+	APawn* TakePawn(const UClass* PawnClass, const ULyraPawnData* PawnData, const FTransform& SpawnTransform);
+
+	int32 GetNumPooledPawns() const { return PooledPawns.Num(); }
+
+protected:
+	//~UWorldSubsystem interface
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	//~End of UWorldSubsystem interface
+
+private:
+	struct FPooledPawn
+	{
+		TWeakObjectPtr<APawn> Pawn;
+		TObjectKey<UClass> PawnClass;
+		TObjectKey<ULyraPawnData> PawnData;
+
+		// Components that were ticking when the pawn was parked, to turn back on when it is taken
+		TArray<TWeakObjectPtr<UActorComponent>> TickingComponents;
+	};
+
+	bool IsPooled(const APawn* Pawn) const;
+
+	void ResetPawnForReuse(APawn* Pawn);
+
+	void ParkPawn(FPooledPawn& Pooled);
+	void WakePawn(FPooledPawn& Pooled, const FTransform& SpawnTransform);
+
+	TArray<FPooledPawn> PooledPawns;
+};
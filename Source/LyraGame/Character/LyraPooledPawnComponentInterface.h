@@ -0,0 +1,30 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+
+#include "LyraPooledPawnComponentInterface.generated.h"
+
+/** Interface for pawn components that hold state which has to be cleared when ULyraPawnPoolSubsystem recycles their pawn */
+UINTERFACE(MinimalAPI, meta = (CannotImplementInterfaceInBlueprint))
+class ULyraPooledPawnComponentInterface : public UInterface
+{
+	GENERATED_BODY()
+};
+
+class ILyraPooledPawnComponentInterface
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Called on the server when the pawn goes into the pool after dying. Anything tied to the previous life (equipment,
+	 * granted abilities, init states, input) should be released here, the pawn may be handed to a different controller next.
+	 */
+	virtual void OnPawnParked() {}
+
+	/** Called on the server when a parked pawn is taken to be reused, before it is possessed. Start over as if just spawned */
+	virtual void OnPawnTakenFromPool() {}
+};
@@ -92,6 +92,7 @@ ULyraEquipmentInstance* FLyraEquipmentList::AddEntry(TSubclassOf<ULyraEquipmentD
 		{
 			AbilitySet->GiveToAbilitySystem(ASC, /*inout*/ &NewEntry.GrantedHandles, Result);
 		}
+		NewEntry.GrantedAbilitySystem = ASC;
 	}
 	else
 	{
@@ -113,7 +114,8 @@ void FLyraEquipmentList::RemoveEntry(ULyraEquipmentInstance* Instance)
 		FLyraAppliedEquipmentEntry& Entry = *EntryIt;
 		if (Entry.Instance == Instance)
 		{
-			if (ULyraAbilitySystemComponent* ASC = GetAbilitySystemComponent())
+			// Not GetAbilitySystemComponent(), the pawn is no longer the avatar once it has died
+			if (ULyraAbilitySystemComponent* ASC = Entry.GrantedAbilitySystem.Get())
 			{
 				Entry.GrantedHandles.TakeFromAbilitySystem(ASC);
 			}
@@ -201,6 +203,19 @@ void ULyraEquipmentManagerComponent::InitializeComponent()
 }
 
 void ULyraEquipmentManagerComponent::UninitializeComponent()
+{
+	UnequipAllItems();
+
+	Super::UninitializeComponent();
+}
+
+void ULyraEquipmentManagerComponent::OnPawnParked()
+{
+	// The pawn may go to a different controller next, which shouldn't get the previous owner's gear
+	UnequipAllItems();
+}
+
+void ULyraEquipmentManagerComponent::UnequipAllItems()
 {
 	TArray<ULyraEquipmentInstance*> AllEquipmentInstances;
 
@@ -214,8 +229,6 @@ void ULyraEquipmentManagerComponent::UninitializeComponent()
 	{
 		UnequipItem(EquipInstance);
 	}
-
-	Super::UninitializeComponent();
 }
 
 void ULyraEquipmentManagerComponent::ReadyForReplication()
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "AbilitySystem/LyraAbilitySet.h"
+#include "Character/LyraPooledPawnComponentInterface.h"
 #include "Components/PawnComponent.h"
 #include "Net/Serialization/FastArraySerializer.h"
 
@@ -46,6 +47,10 @@ private:
 	// Authority-only list of granted handles
 	UPROPERTY(NotReplicated)
 	FLyraAbilitySet_GrantedHandles GrantedHandles;
+
+	// Authority-only ability system the handles were granted to, which a dying pawn may no longer be the avatar of
+	UPROPERTY(NotReplicated)
+	TWeakObjectPtr<ULyraAbilitySystemComponent> GrantedAbilitySystem;
 };
 
 /** List of applied equipment */
@@ -112,7 +117,7 @@ struct TStructOpsTypeTraits<FLyraEquipmentList> : public TStructOpsTypeTraitsBas
  * Manages equipment applied to a pawn
  */
 UCLASS(MinimalAPI, BlueprintType, Const)
-class ULyraEquipmentManagerComponent : public UPawnComponent
+class ULyraEquipmentManagerComponent : public UPawnComponent, public ILyraPooledPawnComponentInterface
 {
 	GENERATED_BODY()
 
@@ -125,6 +130,9 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly)
 	UE_API void UnequipItem(ULyraEquipmentInstance* ItemInstance);
 
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly)
+	UE_API void UnequipAllItems();
+
 	//~UObject interface
 	UE_API virtual bool ReplicateSubobjects(class UActorChannel* Channel, class FOutBunch* Bunch, FReplicationFlags* RepFlags) override;
 	//~End of UObject interface
@@ -136,6 +144,10 @@ public:
 	UE_API virtual void ReadyForReplication() override;
 	//~End of UActorComponent interface
 
+	//~ILyraPooledPawnComponentInterface interface
+	UE_API virtual void OnPawnParked() override;
+	//~End of ILyraPooledPawnComponentInterface interface
+
 	/** Returns the first equipped instance of a given type, or nullptr if none are found */
 	UFUNCTION(BlueprintCallable, BlueprintPure)
 	UE_API ULyraEquipmentInstance* GetFirstInstanceOfType(TSubclassOf<ULyraEquipmentInstance> InstanceType);
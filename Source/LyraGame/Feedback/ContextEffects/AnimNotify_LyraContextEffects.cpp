@@ -158,7 +158,11 @@ void UAnimNotify_LyraContextEffects::Notify(USkeletalMeshComponent* MeshComp, UA
 							TArray<UNiagaraSystem*> TotalNiagaraSystems;
 
 							// Attempt to load the Effect Library content (will cache in Transient data on the Effect Library Asset)
-							EffectLibrary->LoadEffects();
+							// Only kick this off once, the load may be async so previews start playing once it completes
+							if (EffectLibrary->GetContextEffectsLibraryLoadState() == EContextEffectsLibraryLoadState::Unloaded)
+							{
+								EffectLibrary->LoadEffects();
+							}
 
 							// If the Effect Library is valid and marked as Loaded, Get Effects from it
 							if (EffectLibrary && EffectLibrary->GetContextEffectsLibraryLoadState() == EContextEffectsLibraryLoadState::Loaded)
@@ -3,8 +3,10 @@
 
 #include "LyraContextEffectComponent.h"
 
+#include "Components/AudioComponent.h"
 #include "Engine/World.h"
 #include "LyraContextEffectsSubsystem.h"
+#include "NiagaraComponent.h"
 #include "PhysicalMaterials/PhysicalMaterial.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(LyraContextEffectComponent)
@@ -63,15 +65,10 @@ void ULyraContextEffectComponent::AnimMotionEffect_Implementation(const FName Bo
 	const bool bHitSuccess, const FHitResult HitResult, FGameplayTagContainer Contexts,
 	FVector VFXScale, float AudioVolume, float AudioPitch)
 {
-	// Prep Components
-	TArray<UAudioComponent*> AudioComponentsToAdd;
-	TArray<UNiagaraComponent*> NiagaraComponentsToAdd;
-
-	FGameplayTagContainer TotalContexts;
-
-	// Aggregate contexts
-	TotalContexts.AppendTags(Contexts);
-	TotalContexts.AppendTags(CurrentContexts);
+	// Aggregate contexts, reusing the scratch container so footsteps don't allocate
+	ScratchTotalContexts.Reset();
+	ScratchTotalContexts.AppendTags(Contexts);
+	ScratchTotalContexts.AppendTags(CurrentContexts);
 
 	// Check if converting Physical Surface Type to Context
 	if (bConvertPhysicalSurfaceToContext)
@@ -93,29 +90,15 @@ void ULyraContextEffectComponent::AnimMotionEffect_Implementation(const FName Bo
 				{
 					FGameplayTag SurfaceContext = *SurfaceContextPtr;
 
-					TotalContexts.AddTag(SurfaceContext);
+					ScratchTotalContexts.AddTag(SurfaceContext);
 				}
 			}
 		}
 	}
 
-	// Cycle through Active Audio Components and cache
-	for (UAudioComponent* ActiveAudioComponent : ActiveAudioComponents)
-	{
-		if (ActiveAudioComponent)
-		{
-			AudioComponentsToAdd.Add(ActiveAudioComponent);
-		}
-	}
-
-	// Cycle through Active Niagara Components and cache
-	for (UNiagaraComponent* ActiveNiagaraComponent : ActiveNiagaraComponents)
-	{
-		if (ActiveNiagaraComponent)
-		{
-			NiagaraComponentsToAdd.Add(ActiveNiagaraComponent);
-		}
-	}
+	// Drop Active Components that have finished or since been destroyed
+	ActiveAudioComponents.RemoveAll([](const TObjectPtr<UAudioComponent>& AudioComponent) { return !IsValid(AudioComponent) || !AudioComponent->IsPlaying(); });
+	ActiveNiagaraComponents.RemoveAll([](const TObjectPtr<UNiagaraComponent>& NiagaraComponent) { return !IsValid(NiagaraComponent) || !NiagaraComponent->IsActive(); });
 
 	// Get World
 	if (const UWorld* World = GetWorld())
@@ -124,28 +107,31 @@ void ULyraContextEffectComponent::AnimMotionEffect_Implementation(const FName Bo
 		if (ULyraContextEffectsSubsystem* LyraContextEffectsSubsystem = World->GetSubsystem<ULyraContextEffectsSubsystem>())
 		{
 			// Set up Audio Components and Niagara
-			TArray<UAudioComponent*> AudioComponents;
-			TArray<UNiagaraComponent*> NiagaraComponents;
+			FLyraContextEffectAudioComponents AudioComponents;
+			FLyraContextEffectNiagaraComponents NiagaraComponents;
 
 			// Spawn effects
 			LyraContextEffectsSubsystem->SpawnContextEffects(GetOwner(), StaticMeshComponent, Bone, 
-				LocationOffset, RotationOffset, MotionEffect, TotalContexts,
+				LocationOffset, RotationOffset, MotionEffect, ScratchTotalContexts,
 				AudioComponents, NiagaraComponents, VFXScale, AudioVolume, AudioPitch);
 
-			// Append resultant effects
-			AudioComponentsToAdd.Append(AudioComponents);
-			NiagaraComponentsToAdd.Append(NiagaraComponents);
+			// Append resultant effects. Pooled ones aren't ours to keep, once finished they are handed to other actors
+			for (UAudioComponent* AudioComponent : AudioComponents)
+			{
+				if (AudioComponent && AudioComponent->bAutoDestroy)
+				{
+					ActiveAudioComponents.Add(AudioComponent);
+				}
+			}
+			for (UNiagaraComponent* NiagaraComponent : NiagaraComponents)
+			{
+				if (NiagaraComponent && (NiagaraComponent->PoolingMethod == ENCPoolMethod::None))
+				{
+					ActiveNiagaraComponents.Add(NiagaraComponent);
+				}
+			}
 		}
 	}
-
-	// Append Active Audio Components
-	ActiveAudioComponents.Empty();
-	ActiveAudioComponents.Append(AudioComponentsToAdd);
-
-	// Append Active
-	ActiveNiagaraComponents.Empty();
-	ActiveNiagaraComponents.Append(NiagaraComponentsToAdd);
-
 }
 
 void ULyraContextEffectComponent::UpdateEffectContexts(FGameplayTagContainer NewEffectContexts)
@@ -74,6 +74,9 @@ private:
 
 	UPROPERTY(Transient)
 	TArray<TObjectPtr<UNiagaraComponent>> ActiveNiagaraComponents;
+
+	// Reused by AnimMotionEffect to aggregate contexts without allocating per effect
+	FGameplayTagContainer ScratchTotalContexts;
 };
 
 #undef UE_API
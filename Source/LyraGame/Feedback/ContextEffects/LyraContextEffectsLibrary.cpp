@@ -2,29 +2,119 @@
 
 #include "Feedback/ContextEffects/LyraContextEffectsLibrary.h"
 
+#include "Engine/AssetManager.h"
+#include "HAL/IConsoleManager.h"
 #include "NiagaraSystem.h"
 #include "Sound/SoundBase.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(LyraContextEffectsLibrary)
 
+namespace LyraConsoleVariables
+{
+	static bool bAsyncLoadContextEffects = true;
+	static FAutoConsoleVariableRef CVarAsyncLoadContextEffects(
+		TEXT("lyra.ContextEffects.AsyncLoad"),
+		bAsyncLoadContextEffects,
+		TEXT("Should context effect libraries stream their sounds and Niagara systems in asynchronously? Effects requested before the load completes are skipped."),
+		ECVF_Default);
+}
+
 
 void ULyraContextEffectsLibrary::GetEffects(const FGameplayTag Effect, const FGameplayTagContainer Context, 
 	TArray<USoundBase*>& Sounds, TArray<UNiagaraSystem*>& NiagaraSystems)
+{
+	const FLyraCompiledContextEffects* CompiledEffects = FindCompiledEffects(Effect, Context);
+	if (CompiledEffects == nullptr)
+	{
+		return;
+	}
+
+	// Contexts that weren't authored in the library aren't compiled, so match those the slow way
+	FLyraCompiledContextEffects GatheredEffects;
+	if (CompiledEffects->IsEmpty())
+	{
+		GatherEffects(Effect, Context, GatheredEffects);
+		CompiledEffects = &GatheredEffects;
+	}
+
+	// Get all Matching Sounds and Niagara Systems
+	Sounds.Append(CompiledEffects->Sounds);
+	NiagaraSystems.Append(CompiledEffects->NiagaraSystems);
+}
+
+const FLyraCompiledContextEffects* ULyraContextEffectsLibrary::FindCompiledEffects(const FGameplayTag Effect, const FGameplayTagContainer& Context) const
 {
 	// Make sure Effect is valid and Library is loaded
-	if (Effect.IsValid() && Context.IsValid() && EffectsLoadState == EContextEffectsLibraryLoadState::Loaded)
+	if (!Effect.IsValid() || !Context.IsValid() || EffectsLoadState != EContextEffectsLibraryLoadState::Loaded)
+	{
+		return nullptr;
+	}
+
+	if (const TArray<FLyraCompiledContextEffects>* CompiledEffectsForTag = CompiledLookup.Find(Effect))
 	{
-		// Loop through Context Effects
-		for (const auto& ActiveContextEffect : ActiveContextEffects)
+		for (const FLyraCompiledContextEffects& CompiledEffects : *CompiledEffectsForTag)
 		{
-			// Make sure the Effect is an exact Tag Match and ensure the Context has all tags in the Effect (and neither or both are empty)
-			if (Effect.MatchesTagExact(ActiveContextEffect->EffectTag)
-				&& Context.HasAllExact(ActiveContextEffect->Context)
+			// Container equality doesn't depend on tag order
+			if (CompiledEffects.Context == Context)
+			{
+				return &CompiledEffects;
+			}
+		}
+	}
+
+	static const FLyraCompiledContextEffects EmptyEffects;
+	return &EmptyEffects;
+}
+
+void ULyraContextEffectsLibrary::GatherEffects(const FGameplayTag Effect, const FGameplayTagContainer& Context, FLyraCompiledContextEffects& OutEffects) const
+{
+	OutEffects.EffectTag = Effect;
+	OutEffects.Context = Context;
+
+	if (const TArray<int32>* EffectIndices = ActiveContextEffectsByTag.Find(Effect))
+	{
+		for (const int32 EffectIndex : *EffectIndices)
+		{
+			const ULyraActiveContextEffects* ActiveContextEffect = ActiveContextEffects[EffectIndex];
+
+			// Ensure the Context has all tags in the Effect (and neither or both are empty)
+			if (Context.HasAllExact(ActiveContextEffect->Context)
 				&& (ActiveContextEffect->Context.IsEmpty() == Context.IsEmpty()))
 			{
-				// Get all Matching Sounds and Niagara Systems
-				Sounds.Append(ActiveContextEffect->Sounds);
-				NiagaraSystems.Append(ActiveContextEffect->NiagaraSystems);
+				OutEffects.Sounds.Append(ActiveContextEffect->Sounds);
+				OutEffects.NiagaraSystems.Append(ActiveContextEffect->NiagaraSystems);
+			}
+		}
+	}
+}
+
+void ULyraContextEffectsLibrary::CompileLookupTables()
+{
+	ActiveContextEffectsByTag.Reset();
+	CompiledLookup.Reset();
+
+	for (int32 EffectIndex = 0; EffectIndex < ActiveContextEffects.Num(); ++EffectIndex)
+	{
+		if (const ULyraActiveContextEffects* ActiveContextEffect = ActiveContextEffects[EffectIndex])
+		{
+			ActiveContextEffectsByTag.FindOrAdd(ActiveContextEffect->EffectTag).Add(EffectIndex);
+		}
+	}
+
+	// Queries usually use one of the authored contexts, so compile each of those once
+	for (const TObjectPtr<ULyraActiveContextEffects>& ActiveContextEffect : ActiveContextEffects)
+	{
+		if (ActiveContextEffect && ActiveContextEffect->EffectTag.IsValid() && ActiveContextEffect->Context.IsValid())
+		{
+			TArray<FLyraCompiledContextEffects>& CompiledEffectsForTag = CompiledLookup.FindOrAdd(ActiveContextEffect->EffectTag);
+			const bool bAlreadyCompiled = CompiledEffectsForTag.ContainsByPredicate([&ActiveContextEffect](const FLyraCompiledContextEffects& CompiledEffects)
+			{
+				return CompiledEffects.Context == ActiveContextEffect->Context;
+			});
+
+			if (!bAlreadyCompiled)
+			{
+				GatherEffects(ActiveContextEffect->EffectTag, ActiveContextEffect->Context, CompiledEffectsForTag.AddDefaulted_GetRef());
 			}
 		}
 	}
@@ -40,6 +130,7 @@ void ULyraContextEffectsLibrary::LoadEffects()
 
 		// Clear out any old Active Effects
 		ActiveContextEffects.Empty();
+		CompileLookupTables();
 
 		// Call internal loading function
 		LoadEffectsInternal();
@@ -54,16 +145,50 @@ EContextEffectsLibraryLoadState ULyraContextEffectsLibrary::GetContextEffectsLib
 
 void ULyraContextEffectsLibrary::LoadEffectsInternal()
 {
-	// TODO Add Async Loading for Libraries
+	// Gather everything the library references so it streams in as one request
+	TArray<FSoftObjectPath> EffectPaths;
+	for (const FLyraContextEffects& ContextEffect : ContextEffects)
+	{
+		if (ContextEffect.EffectTag.IsValid() && ContextEffect.Context.IsValid())
+		{
+			for (const FSoftObjectPath& Effect : ContextEffect.Effects)
+			{
+				if (!Effect.IsNull())
+				{
+					EffectPaths.AddUnique(Effect);
+				}
+			}
+		}
+	}
+
+	EffectsLoadHandle.Reset();
+
+	if (LyraConsoleVariables::bAsyncLoadContextEffects && (EffectPaths.Num() > 0))
+	{
+		FStreamableManager& StreamableManager = UAssetManager::GetStreamableManager();
+		EffectsLoadHandle = StreamableManager.RequestAsyncLoad(EffectPaths, FStreamableDelegate::CreateUObject(this, &ThisClass::OnEffectsAsyncLoadComplete),
+			FStreamableManager::DefaultAsyncLoadPriority, false, false, TEXT("LyraContextEffectsLibrary"));
+	}
+	else
+	{
+		// Mark loading complete
+		LyraContextEffectLibraryLoadingComplete(CreateActiveContextEffects());
+	}
+}
 
-	// Copy data for async load
-	TArray<FLyraContextEffects> LocalContextEffects = ContextEffects;
+void ULyraContextEffectsLibrary::OnEffectsAsyncLoadComplete()
+{
+	// Everything is resident now, so this only resolves the loaded objects
+	LyraContextEffectLibraryLoadingComplete(CreateActiveContextEffects());
+}
 
+TArray<ULyraActiveContextEffects*> ULyraContextEffectsLibrary::CreateActiveContextEffects()
+{
 	// Prepare Active Context Effects Array
 	TArray<ULyraActiveContextEffects*> ActiveContextEffectsArray;
 
 	// Loop through Context Effects
-	for (const FLyraContextEffects& ContextEffect : LocalContextEffects)
+	for (const FLyraContextEffects& ContextEffect : ContextEffects)
 	{
 		// Make sure Tags are Valid
 		if (ContextEffect.EffectTag.IsValid() && ContextEffect.Context.IsValid())
@@ -102,9 +227,7 @@ void ULyraContextEffectsLibrary::LoadEffectsInternal()
 		}
 	}
 
-	// TODO Call Load Complete after Async Load
-	// Mark loading complete
-	this->LyraContextEffectLibraryLoadingComplete(ActiveContextEffectsArray);
+	return ActiveContextEffectsArray;
 }
 
 void ULyraContextEffectsLibrary::LyraContextEffectLibraryLoadingComplete(
@@ -115,5 +238,8 @@ void ULyraContextEffectsLibrary::LyraContextEffectLibraryLoadingComplete(
 
 	// Append incoming Context Effects Array to current list of Active Context Effects
 	ActiveContextEffects.Append(LyraActiveContextEffects);
+
+	// Build the lookups now, rather than on the first footstep
+	CompileLookupTables();
 }
 
@@ -10,9 +10,11 @@
 
 #define UE_API LYRAGAME_API
 
+class ULyraContextEffectsLibrary;
 class UNiagaraSystem;
 class USoundBase;
 struct FFrame;
+struct FStreamableHandle;
 
 /**
  *
@@ -65,6 +67,20 @@ public:
 	TArray<TObjectPtr<UNiagaraSystem>> NiagaraSystems;
 };
 
+/**
+ * All effects in a library matching one effect tag and one of the contexts authored for it, compiled when the library finishes loading
+ */
+struct FLyraCompiledContextEffects
+{
+	FGameplayTag EffectTag;
+	FGameplayTagContainer Context;
+
+	TArray<TObjectPtr<USoundBase>> Sounds;
+	TArray<TObjectPtr<UNiagaraSystem>> NiagaraSystems;
+
+	bool IsEmpty() const { return Sounds.IsEmpty() && NiagaraSystems.IsEmpty(); }
+};
+
 DECLARE_DYNAMIC_DELEGATE_OneParam(FLyraContextEffectLibraryLoadingComplete, TArray<ULyraActiveContextEffects*>, LyraActiveContextEffects);
 
 /**
@@ -88,9 +104,29 @@ public:
 
 	UE_API EContextEffectsLibraryLoadState GetContextEffectsLibraryLoadState();
 
+	/**
+	 * Native version of GetEffects that doesn't copy, returns null if the library isn't loaded or the query is invalid.
+	 * Only contexts authored in the library are compiled, any other context gets a shared empty result (GatherEffects
+	 * handles those). The result is owned by the library and is valid until the next LoadEffects call or until the
+	 * library is destroyed, so don't hold on to it past the current frame.
+	 */
+	UE_API const FLyraCompiledContextEffects* FindCompiledEffects(const FGameplayTag Effect, const FGameplayTagContainer& Context) const;
+
+	/** Appends every loaded effect matching the effect tag and context, for contexts that FindCompiledEffects doesn't have compiled */
+	UE_API void GatherEffects(const FGameplayTag Effect, const FGameplayTagContainer& Context, FLyraCompiledContextEffects& OutEffects) const;
+
 private:
 	void LoadEffectsInternal();
 
+	/** Called by the streamable manager once every effect referenced by the library is resident */
+	void OnEffectsAsyncLoadComplete();
+
+	/** Builds the active effects from ContextEffects, loading anything that isn't resident yet */
+	TArray<ULyraActiveContextEffects*> CreateActiveContextEffects();
+
+	/** Rebuilds the lookups from ActiveContextEffects, they aren't modified again until the next load */
+	void CompileLookupTables();
+
 	void LyraContextEffectLibraryLoadingComplete(TArray<ULyraActiveContextEffects*> LyraActiveContextEffects);
 
 	UPROPERTY(Transient)
@@ -98,6 +134,15 @@ private:
 
 	UPROPERTY(Transient)
 	EContextEffectsLibraryLoadState EffectsLoadState = EContextEffectsLibraryLoadState::Unloaded;
+
+	// Keeps the effects streamed in by LoadEffects resident
+	TSharedPtr<FStreamableHandle> EffectsLoadHandle;
+
+	// Indices into ActiveContextEffects for each effect tag
+	TMap<FGameplayTag, TArray<int32>> ActiveContextEffectsByTag;
+
+	// Compiled results for each effect tag, one per distinct authored context. The objects are kept alive by ActiveContextEffects.
+	TMap<FGameplayTag, TArray<FLyraCompiledContextEffects>> CompiledLookup;
 };
 
 #undef UE_API
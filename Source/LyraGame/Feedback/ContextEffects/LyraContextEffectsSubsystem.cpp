@@ -3,14 +3,59 @@
 
 #include "LyraContextEffectsSubsystem.h"
 
+#include "AudioDevice.h"
+#include "Components/AudioComponent.h"
+#include "Engine/World.h"
 #include "Feedback/ContextEffects/LyraContextEffectsLibrary.h"
 #include "Feedback/ContextEffects/LyraContextEffectsSubsystem.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/WorldSettings.h"
+#include "HAL/IConsoleManager.h"
 #include "Kismet/GameplayStatics.h"
+#include "LyraLogChannels.h"
 #include "NiagaraFunctionLibrary.h"
 #include "NiagaraSystem.h"
+#include "Performance/LyraHitchDetector.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(LyraContextEffectsSubsystem)
 
+DEFINE_STAT(STAT_LyraContextEffectsSpawned);
+DEFINE_STAT(STAT_LyraContextEffectsDropped);
+DEFINE_STAT(STAT_LyraContextEffectsAudioReused);
+
+namespace LyraConsoleVariables
+{
+	static bool bPoolContextEffects = true;
+	static FAutoConsoleVariableRef CVarPoolContextEffects(
+		TEXT("lyra.ContextEffects.UsePooling"),
+		bPoolContextEffects,
+		TEXT("Should context effects spawn Niagara systems from the world component pool and replay sounds on recycled audio components?"),
+		ECVF_Default);
+
+	static int32 MaxPooledAudioComponentsPerSound = 8;
+	static FAutoConsoleVariableRef CVarMaxPooledAudioComponentsPerSound(
+		TEXT("lyra.ContextEffects.MaxPooledAudioPerSound"),
+		MaxPooledAudioComponentsPerSound,
+		TEXT("How many audio components are kept for each context effect sound. Once they are all playing, further plays of that sound spawn a throwaway component."),
+		ECVF_Default);
+
+	static int32 MaxContextEffectSpawnsPerFrame = 24;
+	static FAutoConsoleVariableRef CVarMaxContextEffectSpawnsPerFrame(
+		TEXT("lyra.ContextEffects.MaxSpawnsPerFrame"),
+		MaxContextEffectSpawnsPerFrame,
+		TEXT("Once this many context effects have spawned in a frame, only significant ones (locally controlled or close to a local viewer) spawn for the rest of it (0 = no budget)"),
+		ECVF_Default);
+
+	static float ContextEffectSignificantDistance = 1500.0f;
+	static FAutoConsoleVariableRef CVarContextEffectSignificantDistance(
+		TEXT("lyra.ContextEffects.SignificantDistance"),
+		ContextEffectSignificantDistance,
+		TEXT("Context effects closer than this (in cm) to a local player's view are still spawned when over the per frame budget"),
+		ECVF_Default);
+}
+
 class AActor;
 class UAudioComponent;
 class UNiagaraSystem;
@@ -31,15 +76,44 @@ void ULyraContextEffectsSubsystem::SpawnContextEffects(
 	, float AudioVolume
 	, float AudioPitch)
 {
+	SpawnContextEffectsInternal(SpawningActor, AttachToComponent, AttachPoint, LocationOffset, RotationOffset, Effect, Contexts, AudioOut, NiagaraOut, VFXScale, AudioVolume, AudioPitch);
+}
+
+void ULyraContextEffectsSubsystem::SpawnContextEffects(
+	const AActor* SpawningActor
+	, USceneComponent* AttachToComponent
+	, const FName AttachPoint
+	, const FVector LocationOffset
+	, const FRotator RotationOffset
+	, FGameplayTag Effect
+	, const FGameplayTagContainer& Contexts
+	, FLyraContextEffectAudioComponents& AudioOut
+	, FLyraContextEffectNiagaraComponents& NiagaraOut
+	, FVector VFXScale
+	, float AudioVolume
+	, float AudioPitch)
+{
+	SpawnContextEffectsInternal(SpawningActor, AttachToComponent, AttachPoint, LocationOffset, RotationOffset, Effect, Contexts, AudioOut, NiagaraOut, VFXScale, AudioVolume, AudioPitch);
+}
+
+template <typename AudioArrayType, typename NiagaraArrayType>
+void ULyraContextEffectsSubsystem::SpawnContextEffectsInternal(const AActor* SpawningActor, USceneComponent* AttachToComponent, const FName AttachPoint, const FVector& LocationOffset, const FRotator& RotationOffset,
+	FGameplayTag Effect, const FGameplayTagContainer& Contexts, AudioArrayType& AudioOut, NiagaraArrayType& NiagaraOut, const FVector& VFXScale, float AudioVolume, float AudioPitch)
+{
+	LYRA_HITCH_SCOPE(ContextEffects);
+
+	TArray<const FLyraCompiledContextEffects*, TInlineAllocator<4>> MatchingEffects;
+
+	// Matches for contexts the libraries don't have compiled, MatchingEffects points into this so it never reallocates
+	TArray<FLyraCompiledContextEffects, TInlineAllocator<4>> GatheredEffects;
+
 	// First determine if this Actor has a matching Set of Libraries
 	if (TObjectPtr<ULyraContextEffectsSet>* EffectsLibrariesSetPtr = ActiveActorEffectsMap.Find(SpawningActor))
 	{
 		// Validate the pointers from the Map Find
 		if (ULyraContextEffectsSet* EffectsLibraries = *EffectsLibrariesSetPtr)
 		{
-			// Prepare Arrays for Sounds and Niagara Systems
-			TArray<USoundBase*> TotalSounds;
-			TArray<UNiagaraSystem*> TotalNiagaraSystems;
+			GatheredEffects.Reserve(EffectsLibraries->LyraContextEffectsLibraries.Num());
 
 			// Cycle through Effect Libraries
 			for (ULyraContextEffectsLibrary* EffectLibrary : EffectsLibraries->LyraContextEffectsLibraries)
@@ -47,16 +121,19 @@ void ULyraContextEffectsSubsystem::SpawnContextEffects(
 				// Check if the Effect Library is valid and data Loaded
 				if (EffectLibrary && EffectLibrary->GetContextEffectsLibraryLoadState() == EContextEffectsLibraryLoadState::Loaded)
 				{
-					// Set up local list of Sounds and Niagara Systems
-					TArray<USoundBase*> Sounds;
-					TArray<UNiagaraSystem*> NiagaraSystems;
-
-					// Get Sounds and Niagara Systems
-					EffectLibrary->GetEffects(Effect, Contexts, Sounds, NiagaraSystems);
+					// Collect the compiled lookups, nothing is spawned until the budget has been checked
+					const FLyraCompiledContextEffects* CompiledEffects = EffectLibrary->FindCompiledEffects(Effect, Contexts);
+					if (CompiledEffects && CompiledEffects->IsEmpty())
+					{
+						FLyraCompiledContextEffects& Gathered = GatheredEffects.AddDefaulted_GetRef();
+						EffectLibrary->GatherEffects(Effect, Contexts, Gathered);
+						CompiledEffects = &Gathered;
+					}
 
-					// Append to accumulating array
-					TotalSounds.Append(Sounds);
-					TotalNiagaraSystems.Append(NiagaraSystems);
+					if (CompiledEffects && !CompiledEffects->IsEmpty())
+					{
+						MatchingEffects.Add(CompiledEffects);
+					}
 				}
 				else if (EffectLibrary && EffectLibrary->GetContextEffectsLibraryLoadState() == EContextEffectsLibraryLoadState::Unloaded)
 				{
@@ -64,28 +141,184 @@ void ULyraContextEffectsSubsystem::SpawnContextEffects(
 					EffectLibrary->LoadEffects();
 				}
 			}
+		}
+	}
 
-			// Cycle through found Sounds
-			for (USoundBase* Sound : TotalSounds)
-			{
-				// Spawn Sounds Attached, add Audio Component to List of ACs
-				UAudioComponent* AudioComponent = UGameplayStatics::SpawnSoundAttached(Sound, AttachToComponent, AttachPoint, LocationOffset, RotationOffset, EAttachLocation::KeepRelativeOffset,
+	if (MatchingEffects.IsEmpty() || !ConsumeSpawnBudget(SpawningActor, AttachToComponent))
+	{
+		return;
+	}
+
+	const bool bUsePooling = LyraConsoleVariables::bPoolContextEffects;
+	for (const FLyraCompiledContextEffects* CompiledEffects : MatchingEffects)
+	{
+		// Cycle through found Sounds
+		for (USoundBase* Sound : CompiledEffects->Sounds)
+		{
+			// Spawn Sounds Attached, add Audio Component to List of ACs
+			UAudioComponent* AudioComponent = bUsePooling
+				? SpawnPooledSound(Sound, AttachToComponent, AttachPoint, LocationOffset, RotationOffset, AudioVolume, AudioPitch)
+				: UGameplayStatics::SpawnSoundAttached(Sound, AttachToComponent, AttachPoint, LocationOffset, RotationOffset, EAttachLocation::KeepRelativeOffset,
 					false, AudioVolume, AudioPitch, 0.0f, nullptr, nullptr, true);
 
-				AudioOut.Add(AudioComponent);
-			}
+			AudioOut.Add(AudioComponent);
+		}
+
+		// Cycle through found Niagara Systems
+		for (UNiagaraSystem* NiagaraSystem : CompiledEffects->NiagaraSystems)
+		{
+			// Spawn Niagara Systems Attached, add Niagara Component to List of NCs
+			UNiagaraComponent* NiagaraComponent = UNiagaraFunctionLibrary::SpawnSystemAttached(NiagaraSystem, AttachToComponent, AttachPoint, LocationOffset,
+				RotationOffset, VFXScale, EAttachLocation::KeepRelativeOffset, true, bUsePooling ? ENCPoolMethod::AutoRelease : ENCPoolMethod::None, true, true);
+
+			NiagaraOut.Add(NiagaraComponent);
+		}
+	}
+}
+
+bool ULyraContextEffectsSubsystem::ConsumeSpawnBudget(const AActor* SpawningActor, const USceneComponent* AttachToComponent)
+{
+	if (SpawnBudgetFrame != GFrameCounter)
+	{
+		SpawnBudgetFrame = GFrameCounter;
+		NumSpawnsThisFrame = 0;
+	}
+
+	const int32 MaxSpawns = LyraConsoleVariables::MaxContextEffectSpawnsPerFrame;
+	if ((MaxSpawns <= 0) || (NumSpawnsThisFrame < MaxSpawns) || IsSignificantEffect(SpawningActor, AttachToComponent))
+	{
+		++NumSpawnsThisFrame;
+		INC_DWORD_STAT(STAT_LyraContextEffectsSpawned);
+		return true;
+	}
+
+	INC_DWORD_STAT(STAT_LyraContextEffectsDropped);
+	return false;
+}
 
-			// Cycle through found Niagara Systems
-			for (UNiagaraSystem* NiagaraSystem : TotalNiagaraSystems)
+bool ULyraContextEffectsSubsystem::IsSignificantEffect(const AActor* SpawningActor, const USceneComponent* AttachToComponent) const
+{
+	// Effects on the pawn the player is controlling always play
+	if (const APawn* Pawn = Cast<APawn>(SpawningActor))
+	{
+		if (Pawn->IsLocallyControlled())
+		{
+			return true;
+		}
+	}
+
+	const USceneComponent* LocationComponent = AttachToComponent ? AttachToComponent : (SpawningActor ? SpawningActor->GetRootComponent() : nullptr);
+	if (LocationComponent == nullptr)
+	{
+		return false;
+	}
+
+	const FVector EffectLocation = LocationComponent->GetComponentLocation();
+	const float SignificantDistanceSquared = FMath::Square(LyraConsoleVariables::ContextEffectSignificantDistance);
+
+	for (FConstPlayerControllerIterator Iterator = GetWorld()->GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		const APlayerController* PlayerController = Iterator->Get();
+		if (PlayerController && PlayerController->IsLocalController())
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+			if (FVector::DistSquared(ViewLocation, EffectLocation) <= SignificantDistanceSquared)
 			{
-				// Spawn Niagara Systems Attached, add Niagara Component to List of NCs
-				UNiagaraComponent* NiagaraComponent = UNiagaraFunctionLibrary::SpawnSystemAttached(NiagaraSystem, AttachToComponent, AttachPoint, LocationOffset,
-					RotationOffset, VFXScale, EAttachLocation::KeepRelativeOffset, true, ENCPoolMethod::None, true, true);
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+UAudioComponent* ULyraContextEffectsSubsystem::SpawnPooledSound(USoundBase* Sound, USceneComponent* AttachToComponent, const FName AttachPoint, const FVector& LocationOffset, const FRotator& RotationOffset, float AudioVolume, float AudioPitch)
+{
+	UWorld* World = GetWorld();
+	if ((Sound == nullptr) || (AttachToComponent == nullptr) || (World == nullptr) || (World->GetNetMode() == NM_DedicatedServer))
+	{
+		return nullptr;
+	}
+
+	FLyraContextEffectAudioPool& Pool = AudioPools.FindOrAdd(Sound);
+
+	// Replay the sound on a component that has finished with it
+	for (int32 Index = Pool.Components.Num() - 1; Index >= 0; --Index)
+	{
+		UAudioComponent* AudioComponent = Pool.Components[Index];
+		if (!IsValid(AudioComponent))
+		{
+			Pool.Components.RemoveAtSwap(Index);
+			continue;
+		}
+
+		if (!AudioComponent->IsPlaying())
+		{
+			AudioComponent->DetachFromComponent(FDetachmentTransformRules::KeepWorldTransform);
+			AudioComponent->AttachToComponent(AttachToComponent, FAttachmentTransformRules::KeepRelativeTransform, AttachPoint);
+			AudioComponent->SetRelativeLocationAndRotation(LocationOffset, RotationOffset);
+			AudioComponent->SetVolumeMultiplier(AudioVolume);
+			AudioComponent->SetPitchMultiplier(AudioPitch);
+			AudioComponent->Play();
+
+			INC_DWORD_STAT(STAT_LyraContextEffectsAudioReused);
+			return AudioComponent;
+		}
+	}
+
+	if (Pool.Components.Num() >= LyraConsoleVariables::MaxPooledAudioComponentsPerSound)
+	{
+		return UGameplayStatics::SpawnSoundAttached(Sound, AttachToComponent, AttachPoint, LocationOffset, RotationOffset, EAttachLocation::KeepRelativeOffset,
+			false, AudioVolume, AudioPitch, 0.0f, nullptr, nullptr, true);
+	}
+
+	// Pooled components are owned by the world settings rather than whoever played them first, so they outlive that actor
+	FAudioDevice::FCreateComponentParams Params(World, World->GetWorldSettings());
+	UAudioComponent* AudioComponent = FAudioDevice::CreateComponent(Sound, Params);
+	if (AudioComponent == nullptr)
+	{
+		return nullptr;
+	}
+
+	AudioComponent->bAutoDestroy = false;
+	AudioComponent->bStopWhenOwnerDestroyed = false;
+	AudioComponent->OnAudioFinishedNative.AddUObject(this, &ThisClass::HandlePooledAudioFinished);
+	AudioComponent->AttachToComponent(AttachToComponent, FAttachmentTransformRules::KeepRelativeTransform, AttachPoint);
+	AudioComponent->SetRelativeLocationAndRotation(LocationOffset, RotationOffset);
+	AudioComponent->SetVolumeMultiplier(AudioVolume);
+	AudioComponent->SetPitchMultiplier(AudioPitch);
+	AudioComponent->Play();
 
-				NiagaraOut.Add(NiagaraComponent);
+	Pool.Components.Add(AudioComponent);
+	return AudioComponent;
+}
+
+void ULyraContextEffectsSubsystem::HandlePooledAudioFinished(UAudioComponent* AudioComponent)
+{
+	if (IsValid(AudioComponent))
+	{
+		AudioComponent->DetachFromComponent(FDetachmentTransformRules::KeepWorldTransform);
+	}
+}
+
+void ULyraContextEffectsSubsystem::Deinitialize()
+{
+	for (TPair<TObjectPtr<USoundBase>, FLyraContextEffectAudioPool>& Pair : AudioPools)
+	{
+		for (UAudioComponent* AudioComponent : Pair.Value.Components)
+		{
+			if (IsValid(AudioComponent))
+			{
+				AudioComponent->DestroyComponent();
 			}
 		}
 	}
+	AudioPools.Reset();
+
+	Super::Deinitialize();
 }
 
 bool ULyraContextEffectsSubsystem::GetContextFromSurfaceType(
@@ -114,8 +347,60 @@ void ULyraContextEffectsSubsystem::LoadAndAddContextEffectsLibraries(AActor* Own
 		return;
 	}
 
+	// Find or create the shared set before releasing the old one, so swapping to the same libraries doesn't reload them
+	ULyraContextEffectsSet* EffectsLibrariesSet = AcquireEffectsSet(ContextEffectsLibraries);
+
+	if (TObjectPtr<ULyraContextEffectsSet>* ExistingSetPtr = ActiveActorEffectsMap.Find(OwningActor))
+	{
+		ReleaseEffectsSet(*ExistingSetPtr);
+	}
+
+	// Update Active Actor Effects Map
+	ActiveActorEffectsMap.Emplace(OwningActor, EffectsLibrariesSet);
+}
+
+void ULyraContextEffectsSubsystem::UnloadAndRemoveContextEffectsLibraries(AActor* OwningActor)
+{
+	// Early out if Owning Actor is invalid
+	if (OwningActor == nullptr)
+	{
+		return;
+	}
+
+	// Remove ref from Active Actor/Effects Set Map
+	TObjectPtr<ULyraContextEffectsSet> RemovedSet;
+	if (ActiveActorEffectsMap.RemoveAndCopyValue(OwningActor, RemovedSet))
+	{
+		ReleaseEffectsSet(RemovedSet);
+	}
+}
+
+ULyraContextEffectsSet* ULyraContextEffectsSubsystem::AcquireEffectsSet(const TSet<TSoftObjectPtr<ULyraContextEffectsLibrary>>& ContextEffectsLibraries)
+{
+	TSet<FSoftObjectPath> LibraryPaths;
+	LibraryPaths.Reserve(ContextEffectsLibraries.Num());
+	for (const TSoftObjectPtr<ULyraContextEffectsLibrary>& ContextEffectSoftObj : ContextEffectsLibraries)
+	{
+		LibraryPaths.Add(ContextEffectSoftObj.ToSoftObjectPath());
+	}
+
+	const uint32 ContentHash = GetLibrariesHash(ContextEffectsLibraries);
+	TObjectPtr<ULyraContextEffectsSet>* SharedSetPtr = SharedEffectsSets.Find(ContentHash);
+	if (SharedSetPtr && *SharedSetPtr)
+	{
+		ULyraContextEffectsSet* SharedSet = *SharedSetPtr;
+		if ((SharedSet->SourceLibraryPaths.Num() == LibraryPaths.Num()) && SharedSet->SourceLibraryPaths.Includes(LibraryPaths))
+		{
+			++SharedSet->RefCount;
+			return SharedSet;
+		}
+	}
+
 	// Create new Context Effect Set
 	ULyraContextEffectsSet* EffectsLibrariesSet = NewObject<ULyraContextEffectsSet>(this);
+	EffectsLibrariesSet->SourceLibraryPaths = MoveTemp(LibraryPaths);
+	EffectsLibrariesSet->ContentHash = ContentHash;
+	EffectsLibrariesSet->RefCount = 1;
 
 	// Cycle through Libraries getting Soft Obj Refs
 	for (const TSoftObjectPtr<ULyraContextEffectsLibrary>& ContextEffectSoftObj : ContextEffectsLibraries)
@@ -124,27 +409,197 @@ void ULyraContextEffectsSubsystem::LoadAndAddContextEffectsLibraries(AActor* Own
 		// TODO Support Async Loading of Asset Data
 		if (ULyraContextEffectsLibrary* EffectsLibrary = ContextEffectSoftObj.LoadSynchronous())
 		{
-			// Call load on valid Libraries
-			EffectsLibrary->LoadEffects();
+			// Call load on valid Libraries, unless another actor already has
+			if (EffectsLibrary->GetContextEffectsLibraryLoadState() == EContextEffectsLibraryLoadState::Unloaded)
+			{
+				EffectsLibrary->LoadEffects();
+			}
 
 			// Add new library to Set
 			EffectsLibrariesSet->LyraContextEffectsLibraries.Add(EffectsLibrary);
 		}
 	}
 
-	// Update Active Actor Effects Map
-	ActiveActorEffectsMap.Emplace(OwningActor, EffectsLibrariesSet);
+	// A different combination that hashes the same keeps its slot, this one just isn't shared
+	if (SharedSetPtr == nullptr)
+	{
+		SharedEffectsSets.Add(ContentHash, EffectsLibrariesSet);
+	}
+
+	return EffectsLibrariesSet;
 }
 
-void ULyraContextEffectsSubsystem::UnloadAndRemoveContextEffectsLibraries(AActor* OwningActor)
+void ULyraContextEffectsSubsystem::ReleaseEffectsSet(ULyraContextEffectsSet* EffectsSet)
 {
-	// Early out if Owning Actor is invalid
-	if (OwningActor == nullptr)
+	if ((EffectsSet == nullptr) || (--EffectsSet->RefCount > 0))
 	{
 		return;
 	}
 
-	// Remove ref from Active Actor/Effects Set Map
-	ActiveActorEffectsMap.Remove(OwningActor);
+	TObjectPtr<ULyraContextEffectsSet>* SharedSetPtr = SharedEffectsSets.Find(EffectsSet->ContentHash);
+	if (SharedSetPtr && (*SharedSetPtr == EffectsSet))
+	{
+		SharedEffectsSets.Remove(EffectsSet->ContentHash);
+	}
 }
 
+uint32 ULyraContextEffectsSubsystem::GetLibrariesHash(const TSet<TSoftObjectPtr<ULyraContextEffectsLibrary>>& ContextEffectsLibraries)
+{
+	// Set iteration order isn't stable between actors, so combine in an order independent way
+	uint32 Hash = ContextEffectsLibraries.Num();
+	for (const TSoftObjectPtr<ULyraContextEffectsLibrary>& ContextEffectSoftObj : ContextEffectsLibraries)
+	{
+		Hash ^= GetTypeHash(ContextEffectSoftObj.ToSoftObjectPath());
+	}
+	return Hash;
+}
+
+#if !UE_BUILD_SHIPPING
+void ULyraContextEffectsSubsystem::ReportEffectsSets() const
+{
+	TSet<const ULyraContextEffectsSet*> UniqueSets;
+	SIZE_T UniqueSetBytes = 0;
+	for (const TPair<TObjectPtr<AActor>, TObjectPtr<ULyraContextEffectsSet>>& Pair : ActiveActorEffectsMap)
+	{
+		const ULyraContextEffectsSet* EffectsSet = Pair.Value;
+		bool bAlreadyCounted = false;
+		UniqueSets.Add(EffectsSet, &bAlreadyCounted);
+		if (EffectsSet && !bAlreadyCounted)
+		{
+			UniqueSetBytes += EffectsSet->GetClass()->GetStructureSize() + EffectsSet->LyraContextEffectsLibraries.GetAllocatedSize() + EffectsSet->SourceLibraryPaths.GetAllocatedSize();
+		}
+	}
+
+	const int32 NumActors = ActiveActorEffectsMap.Num();
+	const int32 NumUniqueSets = UniqueSets.Num();
+	const double AverageSetBytes = (NumUniqueSets > 0) ? (double)UniqueSetBytes / NumUniqueSets : 0.0;
+
+	UE_LOG(LogLyra, Display, TEXT("Context effects sets: %d actors share %d unique sets (%.2f actors per set)"),
+		NumActors, NumUniqueSets, (NumUniqueSets > 0) ? (double)NumActors / NumUniqueSets : 0.0);
+	UE_LOG(LogLyra, Display, TEXT("  %llu bytes in unique sets, ~%.0f bytes saved versus a set per actor"),
+		(uint64)UniqueSetBytes, AverageSetBytes * (NumActors - NumUniqueSets));
+
+	for (const ULyraContextEffectsSet* EffectsSet : UniqueSets)
+	{
+		if (EffectsSet)
+		{
+			UE_LOG(LogLyra, Display, TEXT("  %08x: %d actors, %d libraries"), EffectsSet->ContentHash, EffectsSet->RefCount, EffectsSet->LyraContextEffectsLibraries.Num());
+		}
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs LyraContextEffectsReportSetsCmd(
+	TEXT("Lyra.ContextEffects.ReportSets"),
+	TEXT("Reports the unique context effects library sets in use, how many actors share them and the memory saved by sharing"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (const ULyraContextEffectsSubsystem* Subsystem = World ? World->GetSubsystem<ULyraContextEffectsSubsystem>() : nullptr)
+		{
+			Subsystem->ReportEffectsSets();
+		}
+	}));
+
+void ULyraContextEffectsSubsystem::RunFootstepBenchmark(FGameplayTag Effect, int32 NumFootsteps, bool bSpawnEffects)
+{
+	// Build the context for each surface once, as the component would after converting the hit's physical material
+	TArray<FGameplayTagContainer> SurfaceContexts;
+	SurfaceContexts.AddDefaulted();
+	for (const TPair<TEnumAsByte<EPhysicalSurface>, FGameplayTag>& Pair : GetDefault<ULyraContextEffectsSettings>()->SurfaceTypeToContextMap)
+	{
+		SurfaceContexts.Add(FGameplayTagContainer(Pair.Value));
+	}
+
+	int32 NumActors = 0;
+	int32 NumLookups = 0;
+	int32 NumMatches = 0;
+	int32 NumSpawned = 0;
+
+	const double StartTime = FPlatformTime::Seconds();
+	for (const TPair<TObjectPtr<AActor>, TObjectPtr<ULyraContextEffectsSet>>& Pair : ActiveActorEffectsMap)
+	{
+		const AActor* Actor = Pair.Key;
+		if ((Actor == nullptr) || (Pair.Value == nullptr))
+		{
+			continue;
+		}
+		++NumActors;
+
+		for (int32 StepIndex = 0; StepIndex < NumFootsteps; ++StepIndex)
+		{
+			const FGameplayTagContainer& Contexts = SurfaceContexts[StepIndex % SurfaceContexts.Num()];
+
+			if (bSpawnEffects)
+			{
+				FLyraContextEffectAudioComponents AudioComponents;
+				FLyraContextEffectNiagaraComponents NiagaraComponents;
+				SpawnContextEffects(Actor, Actor->GetRootComponent(), NAME_None, FVector::ZeroVector, FRotator::ZeroRotator, Effect, Contexts, AudioComponents, NiagaraComponents);
+				NumSpawned += AudioComponents.Num() + NiagaraComponents.Num();
+			}
+			else
+			{
+				for (ULyraContextEffectsLibrary* EffectLibrary : Pair.Value->LyraContextEffectsLibraries)
+				{
+					if (EffectLibrary)
+					{
+						++NumLookups;
+						const FLyraCompiledContextEffects* CompiledEffects = EffectLibrary->FindCompiledEffects(Effect, Contexts);
+						FLyraCompiledContextEffects GatheredEffects;
+						if (CompiledEffects && CompiledEffects->IsEmpty())
+						{
+							EffectLibrary->GatherEffects(Effect, Contexts, GatheredEffects);
+							CompiledEffects = &GatheredEffects;
+						}
+						NumMatches += (CompiledEffects && !CompiledEffects->IsEmpty()) ? 1 : 0;
+					}
+				}
+			}
+		}
+	}
+	const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+	const int32 NumFootstepsTotal = NumActors * NumFootsteps;
+	UE_LOG(LogLyra, Display, TEXT("Context effect footstep benchmark: %d actors x %d footsteps over %d surface contexts, %.3f ms total, %.3f us per footstep"),
+		NumActors, NumFootsteps, SurfaceContexts.Num(), ElapsedMs, (NumFootstepsTotal > 0) ? (ElapsedMs * 1000.0 / NumFootstepsTotal) : 0.0);
+	if (bSpawnEffects)
+	{
+		UE_LOG(LogLyra, Display, TEXT("  spawned %d components"), NumSpawned);
+	}
+	else
+	{
+		UE_LOG(LogLyra, Display, TEXT("  %d library lookups, %d with effects"), NumLookups, NumMatches);
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs LyraContextEffectsFootstepBenchmarkCmd(
+	TEXT("Lyra.ContextEffects.FootstepBenchmark"),
+	TEXT("Usage: Lyra.ContextEffects.FootstepBenchmark <EffectTag> [FootstepsPerActor=1000] [Spawn=0]\n")
+	TEXT("Times context effect lookups (or spawns) for every actor with registered context effect libraries, cycling through the surface contexts from the project settings"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		ULyraContextEffectsSubsystem* Subsystem = World ? World->GetSubsystem<ULyraContextEffectsSubsystem>() : nullptr;
+		if ((Subsystem == nullptr) || (Args.Num() < 1))
+		{
+			return;
+		}
+
+		const FGameplayTag Effect = FGameplayTag::RequestGameplayTag(FName(*Args[0]), /*ErrorIfNotFound=*/ false);
+		if (!Effect.IsValid())
+		{
+			UE_LOG(LogLyra, Warning, TEXT("Lyra.ContextEffects.FootstepBenchmark: unknown effect tag %s"), *Args[0]);
+			return;
+		}
+
+		int32 NumFootsteps = 1000;
+		bool bSpawnEffects = false;
+		if (Args.IsValidIndex(1))
+		{
+			LexTryParseString(NumFootsteps, *Args[1]);
+		}
+		if (Args.IsValidIndex(2))
+		{
+			LexTryParseString(bSpawnEffects, *Args[2]);
+		}
+
+		Subsystem->RunFootstepBenchmark(Effect, FMath::Max(NumFootsteps, 1), bSpawnEffects);
+	}));
+#endif // !UE_BUILD_SHIPPING
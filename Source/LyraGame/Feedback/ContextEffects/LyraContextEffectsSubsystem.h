@@ -4,10 +4,16 @@
 
 #include "Engine/DeveloperSettings.h"
 #include "GameplayTagContainer.h"
+#include "Stats/Stats.h"
 #include "Subsystems/WorldSubsystem.h"
 
 #include "LyraContextEffectsSubsystem.generated.h"
 
+DECLARE_STATS_GROUP(TEXT("Lyra Context Effects"), STATGROUP_LyraContextEffects, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Context Effects Spawned"), STAT_LyraContextEffectsSpawned, STATGROUP_LyraContextEffects, LYRAGAME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Context Effects Dropped Over Budget"), STAT_LyraContextEffectsDropped, STATGROUP_LyraContextEffects, LYRAGAME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Pooled Audio Components Reused"), STAT_LyraContextEffectsAudioReused, STATGROUP_LyraContextEffects, LYRAGAME_API);
+
 #define UE_API LYRAGAME_API
 
 enum EPhysicalSurface : int;
@@ -17,10 +23,15 @@ class UAudioComponent;
 class ULyraContextEffectsLibrary;
 class UNiagaraComponent;
 class USceneComponent;
+class USoundBase;
 struct FFrame;
 struct FGameplayTag;
 struct FGameplayTagContainer;
 
+/** Buffers for the native spawn path, sized so a typical effect doesn't allocate */
+typedef TArray<UAudioComponent*, TInlineAllocator<4>> FLyraContextEffectAudioComponents;
+typedef TArray<UNiagaraComponent*, TInlineAllocator<4>> FLyraContextEffectNiagaraComponents;
+
 /**
  *
  */
@@ -36,7 +47,7 @@ public:
 };
 
 /**
- *
+ * A loaded combination of context effects libraries, shared by every actor that asked for the same libraries
  */
 UCLASS(MinimalAPI)
 class ULyraContextEffectsSet : public UObject
@@ -46,8 +57,25 @@ class ULyraContextEffectsSet : public UObject
 public:
 	UPROPERTY(Transient)
 	TSet<TObjectPtr<ULyraContextEffectsLibrary>> LyraContextEffectsLibraries;
+
+	// The libraries this set was requested with, used to find it again for other actors
+	TSet<FSoftObjectPath> SourceLibraryPaths;
+
+	uint32 ContentHash = 0;
+
+	// Number of actors in ActiveActorEffectsMap using this set
+	int32 RefCount = 0;
 };
 
+/** Audio components kept to replay one sound */
+USTRUCT()
+struct FLyraContextEffectAudioPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UAudioComponent>> Components;
+};
 
 /**
  * 
@@ -58,6 +86,10 @@ class ULyraContextEffectsSubsystem : public UWorldSubsystem
 	GENERATED_BODY()
 	
 public:
+	//~USubsystem interface
+	UE_API virtual void Deinitialize() override;
+	//~End of USubsystem interface
+
 	/** */
 	UFUNCTION(BlueprintCallable, Category = "ContextEffects")
 	UE_API void SpawnContextEffects(
@@ -74,6 +106,21 @@ public:
 		, float AudioVolume = 1
 		, float AudioPitch = 1);
 
+	/** Native version of SpawnContextEffects, writes the spawned components into caller provided inline buffers */
+	UE_API void SpawnContextEffects(
+		const AActor* SpawningActor
+		, USceneComponent* AttachToComponent
+		, const FName AttachPoint
+		, const FVector LocationOffset
+		, const FRotator RotationOffset
+		, FGameplayTag Effect
+		, const FGameplayTagContainer& Contexts
+		, FLyraContextEffectAudioComponents& AudioOut
+		, FLyraContextEffectNiagaraComponents& NiagaraOut
+		, FVector VFXScale = FVector(1)
+		, float AudioVolume = 1
+		, float AudioPitch = 1);
+
 	/** */
 	UFUNCTION(BlueprintCallable, Category = "ContextEffects")
 	UE_API bool GetContextFromSurfaceType(TEnumAsByte<EPhysicalSurface> PhysicalSurface, FGameplayTag& Context);
@@ -86,11 +133,53 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "ContextEffects")
 	UE_API void UnloadAndRemoveContextEffectsLibraries(AActor* OwningActor);
 
+#if !UE_BUILD_SHIPPING
+	/** Logs how many actors share each library set and the memory that saves */
+	UE_API void ReportEffectsSets() const;
+
+	/** Runs NumFootsteps lookups (and optionally spawns) per registered actor, across every surface context in the project settings */
+	UE_API void RunFootstepBenchmark(FGameplayTag Effect, int32 NumFootsteps, bool bSpawnEffects);
+#endif
+
 private:
 
+	template <typename AudioArrayType, typename NiagaraArrayType>
+	void SpawnContextEffectsInternal(const AActor* SpawningActor, USceneComponent* AttachToComponent, const FName AttachPoint, const FVector& LocationOffset, const FRotator& RotationOffset,
+		FGameplayTag Effect, const FGameplayTagContainer& Contexts, AudioArrayType& AudioOut, NiagaraArrayType& NiagaraOut, const FVector& VFXScale, float AudioVolume, float AudioPitch);
+
+	/** Counts an effect against this frame's spawn budget, returns false if it should be dropped instead */
+	bool ConsumeSpawnBudget(const AActor* SpawningActor, const USceneComponent* AttachToComponent);
+
+	/** Effects that still spawn once the budget is spent, on a locally controlled pawn or near a local player's view */
+	bool IsSignificantEffect(const AActor* SpawningActor, const USceneComponent* AttachToComponent) const;
+
+	/** Plays Sound on a recycled audio component, creating one if every pooled component for the sound is busy */
+	UAudioComponent* SpawnPooledSound(USoundBase* Sound, USceneComponent* AttachToComponent, const FName AttachPoint, const FVector& LocationOffset, const FRotator& RotationOffset, float AudioVolume, float AudioPitch);
+
+	/** Detaches a pooled audio component once its sound is done, so it doesn't hang on to whatever it last played on */
+	void HandlePooledAudioFinished(UAudioComponent* AudioComponent);
+
+	/** Returns the shared set for these libraries, loading a new one if no other actor uses the same combination */
+	ULyraContextEffectsSet* AcquireEffectsSet(const TSet<TSoftObjectPtr<ULyraContextEffectsLibrary>>& ContextEffectsLibraries);
+
+	/** Drops one reference to EffectsSet, forgetting it once no actor uses it */
+	void ReleaseEffectsSet(ULyraContextEffectsSet* EffectsSet);
+
+	static uint32 GetLibrariesHash(const TSet<TSoftObjectPtr<ULyraContextEffectsLibrary>>& ContextEffectsLibraries);
+
 	UPROPERTY(Transient)
 	TMap<TObjectPtr<AActor>, TObjectPtr<ULyraContextEffectsSet>> ActiveActorEffectsMap;
 
+	// Every set in use, keyed by the hash of its source libraries
+	UPROPERTY(Transient)
+	TMap<uint32, TObjectPtr<ULyraContextEffectsSet>> SharedEffectsSets;
+
+	UPROPERTY(Transient)
+	TMap<TObjectPtr<USoundBase>, FLyraContextEffectAudioPool> AudioPools;
+
+	uint64 SpawnBudgetFrame = 0;
+	int32 NumSpawnsThisFrame = 0;
+
 };
 
 #undef UE_API
@@ -2,6 +2,7 @@
 
 #include "LyraNumberPopComponent_MeshText.h"
 
+#include "Components/InstancedStaticMeshComponent.h"
 #include "Components/StaticMeshComponent.h"
 #include "Engine/CollisionProfile.h"
 #include "Engine/Engine.h"
@@ -16,6 +17,82 @@
 
 class UStaticMesh;
 
+//////////////////////////////////////////////////////////////////////
+// FLyraNumberPopDigits
+
+void FLyraNumberPopDigits::Encode(int32 Number, int32 MaxDigits)
+{
+	MaxDigits = FMath::Clamp(MaxDigits, 1, Capacity);
+
+	// Least significant first, an int32 has at most 10 digits
+	uint8 ReversedDigits[10];
+	int32 NumNumberDigits = 0;
+	int64 Remaining = FMath::Abs((int64)Number);
+	do
+	{
+		ReversedDigits[NumNumberDigits++] = (uint8)(Remaining % 10);
+		Remaining /= 10;
+	}
+	while (Remaining > 0);
+
+	// Reserve space for + or -, used by the material
+	Digits[0] = 0;
+
+	// IF the damage number has more digits than we support
+	// THEN show the highest number we can support
+	if ((NumNumberDigits + 1) > MaxDigits)
+	{
+		NumDigits = MaxDigits;
+		for (int32 DigitIndex = 1; DigitIndex < NumDigits; ++DigitIndex)
+		{
+			Digits[DigitIndex] = 9;
+		}
+		return;
+	}
+
+	NumDigits = NumNumberDigits + 1;
+	for (int32 DigitIndex = 0; DigitIndex < NumNumberDigits; ++DigitIndex)
+	{
+		Digits[DigitIndex + 1] = ReversedDigits[NumNumberDigits - 1 - DigitIndex];
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+// FLyraNumberPopParameters
+
+void FLyraNumberPopParameters::PackCustomData(float (&OutCustomData)[NumCustomData]) const
+{
+	int32 Offset = 0;
+	auto PackColor = [&OutCustomData, &Offset](const FLinearColor& Value, int32 NumComponents)
+	{
+		const float Components[4] = { Value.R, Value.G, Value.B, Value.A };
+		for (int32 Index = 0; Index < NumComponents; ++Index)
+		{
+			OutCustomData[Offset++] = Components[Index];
+		}
+	};
+
+	OutCustomData[Offset++] = Sign;
+	PackColor(Color, 4);
+	OutCustomData[Offset++] = AnimationLifespan;
+	OutCustomData[Offset++] = IsCriticalHit;
+	OutCustomData[Offset++] = MoveToCamera;
+
+	for (int32 DigitIndex = 0; DigitIndex < FLyraNumberPopDigits::Capacity; ++DigitIndex)
+	{
+		// Unused slots get a zero scale so they don't draw
+		const bool bUsedSlot = (DigitIndex < NumDigitSlots);
+		PackColor(bUsedSlot ? Position[DigitIndex] : FLinearColor::Transparent, 4);
+		PackColor(bUsedSlot ? ScaleRotationAngle[DigitIndex] : FLinearColor::Transparent, 4);
+		PackColor(bUsedSlot ? Duration[DigitIndex] : FLinearColor::Transparent, 2);
+	}
+
+	check(Offset == NumCustomData);
+}
+
+//////////////////////////////////////////////////////////////////////
+// ULyraNumberPopComponent_MeshText
+
 ULyraNumberPopComponent_MeshText::ULyraNumberPopComponent_MeshText(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
@@ -56,38 +133,41 @@ void ULyraNumberPopComponent_MeshText::AddNumberPop(const FLyraNumberPopRequest&
 
 	FTempNumberPopInfo PreparedNumberInfo;
 
-	// Prepare the DamageNumberArray with the digits from the damage.
+	// Prepare the digits from the damage
+	PreparedNumberInfo.Digits.Encode(NewRequest.NumberToDisplay, GetMaxSupportedDigits());
+
+	UStaticMesh* MeshToUse = DetermineStaticMesh(NewRequest);
+	if (MeshToUse == nullptr)
 	{
-		int32 LocalDamage = NewRequest.NumberToDisplay;
-		PreparedNumberInfo.DamageNumberArray.Empty();
+		return;
+	}
 
-		if (LocalDamage == 0)
-		{
-			// We want to just show a zero
-			PreparedNumberInfo.DamageNumberArray.Insert(0, 0);
-		}
-		else
+	// Determine the position
+	FTransform CameraTransform;
+	FVector NumberLocation(NewRequest.WorldLocation);
+	if (APlayerController* PC = GetController<APlayerController>())
+	{
+		if (APlayerCameraManager* PlayerCameraManager = PC->PlayerCameraManager)
 		{
-			// Parse the base10 number into an array
-			while (LocalDamage > 0)
-			{
-				PreparedNumberInfo.DamageNumberArray.Insert(LocalDamage % 10, 0);
-				LocalDamage /= 10;
-			}
+			CameraTransform = FTransform(PlayerCameraManager->GetCameraRotation(), PlayerCameraManager->GetCameraLocation());
+
+			FVector LocationOffset(ForceInitToZero);
+
+			const float RandomMagnitude = 5.0f; //@TODO: Make this style driven
+			LocationOffset += FMath::RandPointInBox(FBox(FVector(-RandomMagnitude), FVector(RandomMagnitude)));
+
+			NumberLocation += LocationOffset;
 		}
+	}
 
-		// Insert a zero to reserve space for + or -. Used by the blueprint
-		PreparedNumberInfo.DamageNumberArray.Insert(0, 0);
+	if (bUseInstancedRendering)
+	{
+		AddInstancedNumberPop(NewRequest, MeshToUse, PreparedNumberInfo.Digits, CameraTransform, NumberLocation);
+		return;
 	}
 
 	// Grab a component from the pool for this number or create one
 	{
-		UStaticMesh* MeshToUse = DetermineStaticMesh(NewRequest);
-		if (MeshToUse == nullptr)
-		{
-			return;
-		}
-
 		FPooledNumberPopComponentList& ComponentPool = PooledComponentMap.FindOrAdd(MeshToUse);
 
 		UStaticMeshComponent* ComponentToUse = nullptr;
@@ -126,13 +206,7 @@ void ULyraNumberPopComponent_MeshText::AddNumberPop(const FLyraNumberPopRequest&
 		check(LocalWorld);
 		LiveComponents.Emplace(ComponentToUse, &ComponentPool, LocalWorld->GetTimeSeconds() + ComponentLifespan);
 
-		// Assign struct pointers
 		PreparedNumberInfo.StaticMeshComponent = ComponentToUse;
-		for (int32 MatIdx = 0; MatIdx < ComponentToUse->GetNumMaterials(); ++MatIdx)
-		{
-			UMaterialInstanceDynamic* NewMID = Cast<UMaterialInstanceDynamic>(ComponentToUse->GetMaterial(MatIdx));
-			PreparedNumberInfo.MeshMIDs.Add(NewMID);
-		}
 
 		// Start the timer if it wasn't already running
 		if (!LocalWorld->GetTimerManager().IsTimerActive(ReleaseTimerHandle))
@@ -141,27 +215,125 @@ void ULyraNumberPopComponent_MeshText::AddNumberPop(const FLyraNumberPopRequest&
 		}
 	}
 
-	// Determine the position
-	FTransform CameraTransform;
-	FVector NumberLocation(NewRequest.WorldLocation);
-	if (APlayerController* PC = GetController<APlayerController>())
+	PreparedNumberInfo.StaticMeshComponent->SetWorldTransform(FTransform(CameraTransform.GetRotation(), NumberLocation));
+
+	// Now apply the material parameters to make the digits, etc...
+	SetMaterialParameters(NewRequest, PreparedNumberInfo, CameraTransform, NumberLocation);
+}
+
+void ULyraNumberPopComponent_MeshText::AddInstancedNumberPop(const FLyraNumberPopRequest& Request, UStaticMesh* Mesh, const FLyraNumberPopDigits& Digits, const FTransform& CameraTransform, const FVector& NumberLocation)
+{
+	UWorld* LocalWorld = GetWorld();
+	check(LocalWorld);
+
+	FInstancedNumberPopMesh& InstancedMesh = FindOrCreateInstancedMesh(Mesh);
+	UInstancedStaticMeshComponent* Component = InstancedMesh.Component;
+
+	// Reuse a finished instance if there is one, the component only grows to the most pops live at once
+	const FTransform InstanceTransform(CameraTransform.GetRotation(), NumberLocation);
+	int32 InstanceIndex = INDEX_NONE;
+	if (InstancedMesh.FreeInstances.Num() > 0)
 	{
-		if (APlayerCameraManager* PlayerCameraManager = PC->PlayerCameraManager)
+		InstanceIndex = InstancedMesh.FreeInstances.Pop(EAllowShrinking::No);
+		Component->UpdateInstanceTransform(InstanceIndex, InstanceTransform, /*bWorldSpace=*/ true);
+	}
+	else
+	{
+		InstanceIndex = Component->AddInstance(InstanceTransform, /*bWorldSpace=*/ true);
+	}
+
+	FLyraNumberPopParameters Parameters;
+	ComputeMaterialParameters(Request, Digits, CameraTransform, NumberLocation, Parameters);
+
+	float CustomData[FLyraNumberPopParameters::NumCustomData];
+	Parameters.PackCustomData(CustomData);
+	Component->SetCustomData(InstanceIndex, MakeArrayView(CustomData), /*bMarkRenderStateDirty=*/ true);
+
+	FLiveInstancedNumberPop& LivePop = LiveInstances.AddDefaulted_GetRef();
+	LivePop.Mesh = Mesh;
+	LivePop.InstanceIndex = InstanceIndex;
+	LivePop.ReleaseTime = LocalWorld->GetTimeSeconds() + ComponentLifespan;
+
+	if (!LocalWorld->GetTimerManager().IsTimerActive(ReleaseInstancesTimerHandle))
+	{
+		LocalWorld->GetTimerManager().SetTimer(ReleaseInstancesTimerHandle, this, &ThisClass::ReleaseNextInstances, ComponentLifespan);
+	}
+}
+
+FInstancedNumberPopMesh& ULyraNumberPopComponent_MeshText::FindOrCreateInstancedMesh(UStaticMesh* Mesh)
+{
+	FInstancedNumberPopMesh& InstancedMesh = InstancedMeshMap.FindOrAdd(Mesh);
+	if (InstancedMesh.Component == nullptr)
+	{
+		UInstancedStaticMeshComponent* Component = NewObject<UInstancedStaticMeshComponent>(GetOwner());
+		Component->SetupAttachment(nullptr);
+		Component->SetUsingAbsoluteLocation(true);
+		Component->SetUsingAbsoluteRotation(true);
+		Component->SetUsingAbsoluteScale(true);
+		Component->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+		Component->SetStaticMesh(Mesh);
+		Component->SetNumCustomDataFloats(FLyraNumberPopParameters::NumCustomData);
+
+		// Same as the pooled components, see AddNumberPop
+		Component->SetRenderCustomDepth(true);
+		Component->SetCustomDepthStencilValue(123);
+		Component->SetBoundsScale(2000.0f);
+
+		if (InstancedMaterial)
 		{
-			CameraTransform = FTransform(PlayerCameraManager->GetCameraRotation(), PlayerCameraManager->GetCameraLocation());
+			for (int32 MatIdx = 0; MatIdx < Component->GetNumMaterials(); ++MatIdx)
+			{
+				Component->SetMaterial(MatIdx, InstancedMaterial);
+			}
+		}
 
-			FVector LocationOffset(ForceInitToZero);
+		// Registered once, pops only add or update instances from here on
+		Component->RegisterComponent();
+		InstancedMesh.Component = Component;
+	}
 
-			const float RandomMagnitude = 5.0f; //@TODO: Make this style driven
-			LocationOffset += FMath::RandPointInBox(FBox(FVector(-RandomMagnitude), FVector(RandomMagnitude)));
+	return InstancedMesh;
+}
 
-			NumberLocation += LocationOffset;
+void ULyraNumberPopComponent_MeshText::ReleaseNextInstances()
+{
+	UWorld* LocalWorld = GetWorld();
+	check(LocalWorld);
+
+	const float CurrentTime = LocalWorld->GetTimeSeconds();
+
+	// Finished instances are scaled to nothing rather than removed, removing would renumber the instances after them
+	const FTransform HiddenTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+
+	int32 NumReleased = 0;
+	for (const FLiveInstancedNumberPop& LivePop : LiveInstances)
+	{
+		if (CurrentTime < LivePop.ReleaseTime)
+		{
+			// These are in chronological order so none of the other elements will be released
+			break;
+		}
+
+		NumReleased++;
+		if (FInstancedNumberPopMesh* InstancedMesh = InstancedMeshMap.Find(LivePop.Mesh))
+		{
+			InstancedMesh->Component->UpdateInstanceTransform(LivePop.InstanceIndex, HiddenTransform, /*bWorldSpace=*/ true);
+			InstancedMesh->FreeInstances.Push(LivePop.InstanceIndex);
 		}
 	}
-	PreparedNumberInfo.StaticMeshComponent->SetWorldTransform(FTransform(CameraTransform.GetRotation(), NumberLocation));
 
-	// Now apply the material parameters to make the digits, etc...
-	SetMaterialParameters(NewRequest, PreparedNumberInfo, CameraTransform, NumberLocation);
+	LiveInstances.RemoveAt(0, NumReleased, EAllowShrinking::No);
+
+	for (TPair<TObjectPtr<UStaticMesh>, FInstancedNumberPopMesh>& Pair : InstancedMeshMap)
+	{
+		Pair.Value.Component->MarkRenderStateDirty();
+	}
+
+	if (LiveInstances.Num() > 0)
+	{
+		const float TimeUntilNextRelease = LiveInstances[0].ReleaseTime - CurrentTime;
+		LocalWorld->GetTimerManager().SetTimer(ReleaseInstancesTimerHandle, this, &ThisClass::ReleaseNextInstances, TimeUntilNextRelease);
+	}
 }
 
 void ULyraNumberPopComponent_MeshText::ReleaseNextComponents()
@@ -244,93 +416,104 @@ UStaticMesh* ULyraNumberPopComponent_MeshText::DetermineStaticMesh(const FLyraNu
 	return nullptr;
 }
 
-void ULyraNumberPopComponent_MeshText::SetMaterialParameters(const FLyraNumberPopRequest& Request, FTempNumberPopInfo& NewDamageNumberInfo, const FTransform& CameraTransform, const FVector& NumberLocation)
+int32 ULyraNumberPopComponent_MeshText::GetMaxSupportedDigits() const
 {
-	UWorld* World = GetWorld();
-	if (World && GEngine)
-	{
-		const float RealGameTime = World->GetRealTimeSeconds();
-
-		// Whether we should show a sign as the first digit, and if so which one
-		// (if bIsSignNegative is true, we show minus, false is plus)
-		const bool bShouldShowSign = false;
-		const bool bIsSignNegative = true;
-
-		for (UMaterialInstanceDynamic* MeshMID : NewDamageNumberInfo.MeshMIDs)
-		{
-			MeshMID->SetScalarParameterValue(SignDigitParameterName, bIsSignNegative ? 0.5f : 0.0f);
-			MeshMID->SetVectorParameterValue(ColorParameterName, DetermineColor(Request));
-
-			// IF the damage number has more digits than we support
-			// THEN force the damage number to the highest number we can support
-			const int32 MaxSupportedDigits = FMath::Min(FMath::Min(PositionParameterNames.Num(), ScaleRotationAngleParameterNames.Num()), DurationParameterNames.Num());
-			if (!ensure(NewDamageNumberInfo.DamageNumberArray.Num() <= MaxSupportedDigits))
-			{
-				NewDamageNumberInfo.DamageNumberArray.SetNum(MaxSupportedDigits);
-
-				// Set all number digits to 9 so we show the largest number we can
-				// Skip digit 0 because that digit is for the +/- sign
-				for (int32 DigitIndex = 1; DigitIndex < NewDamageNumberInfo.DamageNumberArray.Num(); ++DigitIndex)
-				{
-					NewDamageNumberInfo.DamageNumberArray[DigitIndex] = 9;
-				}
-			}
-
-			MeshMID->SetScalarParameterValue(AnimationLifespanParameterName, ComponentLifespan);
-			MeshMID->SetScalarParameterValue(IsCriticalHitParameterName, Request.bIsCriticalDamage ? 1.f : 0.f);
-
-			const int32 DamageNumberArrayLength = NewDamageNumberInfo.DamageNumberArray.Num();
-			float OffsetAccumulatedValue = (DamageNumberArrayLength * -1.f) + (bShouldShowSign ? 0.f : -1.f);
+	const int32 NumParameterSlots = FMath::Min3(PositionParameterNames.Num(), ScaleRotationAngleParameterNames.Num(), DurationParameterNames.Num());
+	return FMath::Min(NumParameterSlots, FLyraNumberPopDigits::Capacity);
+}
 
-			const int32 LastIndex = (DamageNumberArrayLength >= 4) ? DamageNumberArrayLength : 4;
+void ULyraNumberPopComponent_MeshText::ComputeMaterialParameters(const FLyraNumberPopRequest& Request, const FLyraNumberPopDigits& Digits, const FTransform& CameraTransform, const FVector& NumberLocation, FLyraNumberPopParameters& OutParameters) const
+{
+	const float RealGameTime = GetWorld()->GetRealTimeSeconds();
 
-			for (int32 NumberIndex = 0; NumberIndex < LastIndex; ++NumberIndex)
-			{
-				const float NumberYOffset = ((NumberIndex / FMath::Max(1, DamageNumberArrayLength - 1)) - 0.5f) * 2.f;
-				const FVector NumberOffset = FVector(0.f, NumberYOffset, 0.f);
-				const FVector CameraSpaceDirection = CameraTransform.TransformVectorNoScale(NumberOffset);
+	// Whether we should show a sign as the first digit, and if so which one
+	// (if bIsSignNegative is true, we show minus, false is plus)
+	const bool bShouldShowSign = false;
+	const bool bIsSignNegative = true;
 
-				const float SpacingForNumber = ((NumberIndex < DamageNumberArrayLength) && ((NewDamageNumberInfo.DamageNumberArray[NumberIndex] == 1) || ((NumberIndex > 0) && (NewDamageNumberInfo.DamageNumberArray[NumberIndex - 1] == 1)))) ? SpacingPercentageForOnes : 1.f;
-				OffsetAccumulatedValue += SpacingForNumber;
+	OutParameters.Sign = bIsSignNegative ? 0.5f : 0.0f;
+	OutParameters.Color = DetermineColor(Request);
+	OutParameters.AnimationLifespan = ComponentLifespan;
+	OutParameters.IsCriticalHit = Request.bIsCriticalDamage ? 1.f : 0.f;
 
-				FLinearColor RGBAPositionParameter(CameraSpaceDirection);
-				RGBAPositionParameter.A = OffsetAccumulatedValue;
+	const int32 DamageNumberArrayLength = Digits.Num();
+	float OffsetAccumulatedValue = (DamageNumberArrayLength * -1.f) + (bShouldShowSign ? 0.f : -1.f);
 
-				const FName PositionParameterName = PositionParameterNames[NumberIndex];
-				MeshMID->SetVectorParameterValue(PositionParameterName, RGBAPositionParameter);
+	const int32 LastIndex = FMath::Min((DamageNumberArrayLength >= 4) ? DamageNumberArrayLength : 4, GetMaxSupportedDigits());
+	OutParameters.NumDigitSlots = LastIndex;
 
-				const float DistanceFromCameraToNumber = (CameraTransform.GetLocation() - NumberLocation).Size();
-				const float DistanceSpriteScale = DistanceFromCameraBeforeDoublingSize == 0.f ? 1.f : FMath::Clamp(DistanceFromCameraToNumber / DistanceFromCameraBeforeDoublingSize, 1.f, 1000000000.f);
+	// The same for every digit
+	const float DistanceFromCameraToNumber = (CameraTransform.GetLocation() - NumberLocation).Size();
+	const float DistanceSpriteScale = DistanceFromCameraBeforeDoublingSize == 0.f ? 1.f : FMath::Clamp(DistanceFromCameraToNumber / DistanceFromCameraBeforeDoublingSize, 1.f, 1000000000.f);
+	const float HitSizeMultiplier = Request.bIsCriticalDamage ? CriticalHitSizeMultiplier : 1.f;
 
-				const float ScaleToZeroMultiplier = (NumberIndex < DamageNumberArrayLength) && (((NumberIndex == 0) && bShouldShowSign) || (NumberIndex != 0)) ? 1.f : 0.f;
+	for (int32 NumberIndex = 0; NumberIndex < LastIndex; ++NumberIndex)
+	{
+		const float NumberYOffset = ((NumberIndex / FMath::Max(1, DamageNumberArrayLength - 1)) - 0.5f) * 2.f;
+		const FVector NumberOffset = FVector(0.f, NumberYOffset, 0.f);
+		const FVector CameraSpaceDirection = CameraTransform.TransformVectorNoScale(NumberOffset);
+
+		const float SpacingForNumber = ((NumberIndex < DamageNumberArrayLength) && ((Digits[NumberIndex] == 1) || ((NumberIndex > 0) && (Digits[NumberIndex - 1] == 1)))) ? SpacingPercentageForOnes : 1.f;
+		OffsetAccumulatedValue += SpacingForNumber;
+
+		FLinearColor& RGBAPositionParameter = OutParameters.Position[NumberIndex];
+		RGBAPositionParameter = FLinearColor(CameraSpaceDirection);
+		RGBAPositionParameter.A = OffsetAccumulatedValue;
+
+		const float ScaleToZeroMultiplier = (NumberIndex < DamageNumberArrayLength) && (((NumberIndex == 0) && bShouldShowSign) || (NumberIndex != 0)) ? 1.f : 0.f;
+		const float FontSizeMultiplier = HitSizeMultiplier * DistanceSpriteScale * ScaleToZeroMultiplier;
+
+		FLinearColor& RGBAScaleRotationParameter = OutParameters.ScaleRotationAngle[NumberIndex];
+		RGBAScaleRotationParameter.R = FontXSize * FontSizeMultiplier;
+		RGBAScaleRotationParameter.G = FontYSize * FontSizeMultiplier;
+		RGBAScaleRotationParameter.B = Digits[FMath::Min(DamageNumberArrayLength - 1, NumberIndex)];
+		RGBAScaleRotationParameter.A = FMath::Sign(CameraSpaceDirection.X) * NumberOfNumberRotations;
+
+		FLinearColor& RGBADurationParameter = OutParameters.Duration[NumberIndex];
+		RGBADurationParameter = FLinearColor::Transparent;
+		RGBADurationParameter.R = RealGameTime + ComponentLifespan;
+		RGBADurationParameter.G = FMath::FRand();
+	}
 
-				const float HitSizeMultiplier = Request.bIsCriticalDamage ? CriticalHitSizeMultiplier : 1.f;
-				const float FontSizeMultiplier = HitSizeMultiplier * DistanceSpriteScale * ScaleToZeroMultiplier;
+	// Non-gameplay cameras while spectating have more cinematic values of aperture as default.
+	// This makes damage numbers very blurry as they are brought close to the camera, and away from the point of focus.
+	// Disable the shifting of numbers towards the camera here, if in a cinematic spectator camera.
+	//@TODO: Determine whether or not we are spectating
+	const bool bIsSpectating = false;
+	OutParameters.MoveToCamera = bIsSpectating ? 0.0f : 1.0f;
+}
 
-				FLinearColor RGBAScaleRotationParameter;
-				RGBAScaleRotationParameter.R = FontXSize * FontSizeMultiplier;
-				RGBAScaleRotationParameter.G = FontYSize * FontSizeMultiplier;
-				RGBAScaleRotationParameter.B = NewDamageNumberInfo.DamageNumberArray[FMath::Min(DamageNumberArrayLength - 1, NumberIndex)];
-				RGBAScaleRotationParameter.A = FMath::Sign(CameraSpaceDirection.X) * NumberOfNumberRotations;
+void ULyraNumberPopComponent_MeshText::SetMaterialParameters(const FLyraNumberPopRequest& Request, FTempNumberPopInfo& NewDamageNumberInfo, const FTransform& CameraTransform, const FVector& NumberLocation)
+{
+	UWorld* World = GetWorld();
+	if (World && GEngine)
+	{
+		FLyraNumberPopParameters Parameters;
+		ComputeMaterialParameters(Request, NewDamageNumberInfo.Digits, CameraTransform, NumberLocation, Parameters);
 
-				const FName ScaleRotationAngleParameterName = ScaleRotationAngleParameterNames[NumberIndex];
-				MeshMID->SetVectorParameterValue(ScaleRotationAngleParameterName, RGBAScaleRotationParameter);
+		// The MIDs were created along with the pooled component
+		UStaticMeshComponent* Component = NewDamageNumberInfo.StaticMeshComponent;
+		for (int32 MatIdx = 0; MatIdx < Component->GetNumMaterials(); ++MatIdx)
+		{
+			UMaterialInstanceDynamic* MeshMID = Cast<UMaterialInstanceDynamic>(Component->GetMaterial(MatIdx));
+			if (MeshMID == nullptr)
+			{
+				continue;
+			}
 
-				FLinearColor RGBADurationParameter;
-				RGBADurationParameter.R = RealGameTime + ComponentLifespan;
-				RGBADurationParameter.G = FMath::FRand();
+			MeshMID->SetScalarParameterValue(SignDigitParameterName, Parameters.Sign);
+			MeshMID->SetVectorParameterValue(ColorParameterName, Parameters.Color);
+			MeshMID->SetScalarParameterValue(AnimationLifespanParameterName, Parameters.AnimationLifespan);
+			MeshMID->SetScalarParameterValue(IsCriticalHitParameterName, Parameters.IsCriticalHit);
 
-				const FName DurationParameterName = DurationParameterNames[NumberIndex];
-				MeshMID->SetVectorParameterValue(DurationParameterName, RGBADurationParameter);
+			for (int32 NumberIndex = 0; NumberIndex < Parameters.NumDigitSlots; ++NumberIndex)
+			{
+				MeshMID->SetVectorParameterValue(PositionParameterNames[NumberIndex], Parameters.Position[NumberIndex]);
+				MeshMID->SetVectorParameterValue(ScaleRotationAngleParameterNames[NumberIndex], Parameters.ScaleRotationAngle[NumberIndex]);
+				MeshMID->SetVectorParameterValue(DurationParameterNames[NumberIndex], Parameters.Duration[NumberIndex]);
 			}
 
-			// Non-gameplay cameras while spectating have more cinematic values of aperture as default.
-			// This makes damage numbers very blurry as they are brought close to the camera, and away from the point of focus.
-			// Disable the shifting of numbers towards the camera here, if in a cinematic spectator camera.
-			//@TODO: Determine whether or not we are spectating
-			const bool bIsSpectating = false;
-			MeshMID->SetScalarParameterValue(MoveToCameraParameterName, bIsSpectating ? 0.0f : 1.0f);
+			MeshMID->SetScalarParameterValue(MoveToCameraParameterName, Parameters.MoveToCamera);
 		}
 	}
 }
-
@@ -7,7 +7,8 @@
 #include "LyraNumberPopComponent_MeshText.generated.h"
 
 class ULyraDamagePopStyle;
-class UMaterialInstanceDynamic;
+class UInstancedStaticMeshComponent;
+class UMaterialInterface;
 class UObject;
 class UStaticMesh;
 class UStaticMeshComponent;
@@ -44,14 +45,74 @@ struct FLiveNumberPopEntry
 	{}
 };
 
+USTRUCT()
+struct FInstancedNumberPopMesh
+{
+	GENERATED_BODY()
+
+	/** The one component drawing every pop of this mesh */
+	UPROPERTY(transient)
+	TObjectPtr<UInstancedStaticMeshComponent> Component = nullptr;
+
+	/** Instances whose pop has finished, hidden until they are reused */
+	TArray<int32> FreeInstances;
+};
+
+struct FLiveInstancedNumberPop
+{
+	UStaticMesh* Mesh = nullptr;
+	int32 InstanceIndex = INDEX_NONE;
+	float ReleaseTime = 0.0f;
+};
+
+/** The digits of a number pop, most significant first after a leading slot reserved for the sign. Fixed capacity, never allocates */
+struct FLyraNumberPopDigits
+{
+	static constexpr int32 Capacity = 9;
+
+	/** Encodes Number using at most MaxDigits slots (sign included), showing all 9s if it doesn't fit */
+	void Encode(int32 Number, int32 MaxDigits);
+
+	int32 Num() const { return NumDigits; }
+	int32 operator[](int32 Index) const { return Digits[Index]; }
+
+private:
+	uint8 Digits[Capacity] = {};
+	int32 NumDigits = 0;
+};
+
+/** Everything the number pop material is given for one pop, the same values whether they go to MIDs or per instance custom data */
+struct FLyraNumberPopParameters
+{
+	float Sign = 0.0f;
+	FLinearColor Color = FLinearColor::White;
+	float AnimationLifespan = 0.0f;
+	float IsCriticalHit = 0.0f;
+	float MoveToCamera = 1.0f;
+
+	int32 NumDigitSlots = 0;
+	FLinearColor Position[FLyraNumberPopDigits::Capacity];
+	FLinearColor ScaleRotationAngle[FLyraNumberPopDigits::Capacity];
+	FLinearColor Duration[FLyraNumberPopDigits::Capacity];
+
+	/**
+	 * Per instance custom data layout used with instanced rendering:
+	 *   [0] Sign, [1-4] Color, [5] AnimationLifespan, [6] IsCriticalHit, [7] MoveToCamera,
+	 *   then for each of the Capacity digit slots: Position RGBA, ScaleRotationAngle RGBA, Duration RG
+	 */
+	static constexpr int32 NumHeaderCustomData = 8;
+	static constexpr int32 NumCustomDataPerDigit = 10;
+	static constexpr int32 NumCustomData = NumHeaderCustomData + (NumCustomDataPerDigit * FLyraNumberPopDigits::Capacity);
+
+	void PackCustomData(float (&OutCustomData)[NumCustomData]) const;
+};
+
 /** Struct that holds the info for a new damage number */
 struct FTempNumberPopInfo
 {
 	UStaticMeshComponent* StaticMeshComponent = nullptr;
 
-	TArray<UMaterialInstanceDynamic*> MeshMIDs;
-
-	TArray<int32> DamageNumberArray;
+	FLyraNumberPopDigits Digits;
 };
 
 
@@ -72,6 +133,13 @@ public:
 
 protected:
 	void SetMaterialParameters(const FLyraNumberPopRequest& Request, FTempNumberPopInfo& NewDamageNumberInfo, const FTransform& CameraTransform, const FVector& NumberLocation);
+	void ComputeMaterialParameters(const FLyraNumberPopRequest& Request, const FLyraNumberPopDigits& Digits, const FTransform& CameraTransform, const FVector& NumberLocation, FLyraNumberPopParameters& OutParameters) const;
+
+	/** Most digit slots (sign included) the material parameters support */
+	int32 GetMaxSupportedDigits() const;
+
+	void AddInstancedNumberPop(const FLyraNumberPopRequest& Request, UStaticMesh* Mesh, const FLyraNumberPopDigits& Digits, const FTransform& CameraTransform, const FVector& NumberLocation);
+	FInstancedNumberPopMesh& FindOrCreateInstancedMesh(UStaticMesh* Mesh);
 
 	FLinearColor DetermineColor(const FLyraNumberPopRequest& Request) const;
 	UStaticMesh* DetermineStaticMesh(const FLyraNumberPopRequest& Request) const;
@@ -80,6 +148,9 @@ protected:
 	/** Releases components back to the pool that have exceeded their lifespan */
 	void ReleaseNextComponents();
 
+	/** Hides the instances that have exceeded their lifespan so they can be reused */
+	void ReleaseNextInstances();
+
 	/** Style patterns to attempt to apply to the incoming number pops */
 	UPROPERTY(EditDefaultsOnly, Category="Number Pop|Style")
 	TArray<TObjectPtr<ULyraDamagePopStyle>> Styles;
@@ -137,4 +208,24 @@ protected:
 	TArray<FLiveNumberPopEntry> LiveComponents;
 
 	FTimerHandle ReleaseTimerHandle;
+
+	/**
+	 * Draws all the live pops of a mesh with one instanced static mesh component and per instance custom data, instead of a
+	 * registered component with its own MIDs per pop. The material must read its parameters from PerInstanceCustomData, laid
+	 * out as described by FLyraNumberPopParameters.
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Number Pop|Instancing")
+	bool bUseInstancedRendering = false;
+
+	/** The per instance custom data version of the text mesh's material, the mesh's own materials are used if unset */
+	UPROPERTY(EditDefaultsOnly, Category = "Number Pop|Instancing", meta = (EditCondition = "bUseInstancedRendering"))
+	TObjectPtr<UMaterialInterface> InstancedMaterial;
+
+	UPROPERTY(Transient)
+	TMap<TObjectPtr<UStaticMesh>, FInstancedNumberPopMesh> InstancedMeshMap;
+
+	/** In chronological order, like LiveComponents */
+	TArray<FLiveInstancedNumberPop> LiveInstances;
+
+	FTimerHandle ReleaseInstancesTimerHandle;
 };
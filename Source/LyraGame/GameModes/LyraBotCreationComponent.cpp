@@ -3,6 +3,7 @@
 #include "LyraBotCreationComponent.h"
 #include "LyraGameMode.h"
 #include "Engine/World.h"
+#include "TimerManager.h"
 #include "GameFramework/PlayerState.h"
 #include "GameModes/LyraExperienceManagerComponent.h"
 #include "Development/LyraDeveloperSettings.h"
@@ -10,9 +11,25 @@
 #include "AIController.h"
 #include "Kismet/GameplayStatics.h"
 #include "Character/LyraHealthComponent.h"
+#include "Character/LyraPawnPoolSubsystem.h"
+#include "HAL/IConsoleManager.h"
+#include "LyraLogChannels.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(LyraBotCreationComponent)
 
+DECLARE_CYCLE_STAT(TEXT("Bot Spawn Queue"), STAT_LyraBotSpawnQueue, STATGROUP_Game);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bots Spawned From Queue"), STAT_LyraBotsSpawnedFromQueue, STATGROUP_Game);
+
+namespace LyraConsoleVariables
+{
+	static float BotSpawnBudgetMs = 4.0f;
+	static FAutoConsoleVariableRef CVarBotSpawnBudgetMs(
+		TEXT("lyra.Bots.SpawnBudgetMs"),
+		BotSpawnBudgetMs,
+		TEXT("Milliseconds per frame the bot spawn queue may spend creating bots and prewarming pawns (at least one is always done per frame, 0 does the whole queue at once)"),
+		ECVF_Default);
+}
+
 ULyraBotCreationComponent::ULyraBotCreationComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
@@ -29,11 +46,22 @@ void ULyraBotCreationComponent::BeginPlay()
 	ExperienceComponent->CallOrRegister_OnExperienceLoaded_LowPriority(FOnLyraExperienceLoaded::FDelegate::CreateUObject(this, &ThisClass::OnExperienceLoaded));
 }
 
+void ULyraBotCreationComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(SpawnQueueTimerHandle);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void ULyraBotCreationComponent::OnExperienceLoaded(const ULyraExperienceDefinition* Experience)
 {
 #if WITH_SERVER_CODE
 	if (HasAuthority())
 	{
+		PrewarmBotPawns(NumPawnsToPrewarm);
 		ServerCreateBots();
 	}
 #endif
@@ -70,11 +98,107 @@ void ULyraBotCreationComponent::ServerCreateBots_Implementation()
 		EffectiveBotCount = UGameplayStatics::GetIntOption(GameModeBase->OptionsString, TEXT("NumBots"), EffectiveBotCount);
 	}
 
-	// Create them
-	for (int32 Count = 0; Count < EffectiveBotCount; ++Count)
+	// Create them over the next few frames
+	QueueBots(EffectiveBotCount);
+}
+
+void ULyraBotCreationComponent::QueueBots(int32 NumBots)
+{
+	if ((NumBots <= 0) || (BotControllerClass == nullptr))
 	{
-		SpawnOneBot();
+		return;
 	}
+
+	NumBotsQueued += NumBots;
+	StartSpawnQueue();
+}
+
+void ULyraBotCreationComponent::PrewarmBotPawns(int32 NumPawns)
+{
+	if (NumPawns <= 0)
+	{
+		return;
+	}
+
+	NumPawnsQueuedToPrewarm += NumPawns;
+	StartSpawnQueue();
+}
+
+void ULyraBotCreationComponent::StartSpawnQueue()
+{
+	if (!SpawnQueueTimerHandle.IsValid())
+	{
+		SpawnQueueStats = FSpawnQueueStats();
+		SpawnQueueStats.StartTime = FPlatformTime::Seconds();
+
+		SpawnQueueTimerHandle = GetWorld()->GetTimerManager().SetTimerForNextTick(this, &ThisClass::ProcessSpawnQueue);
+	}
+}
+
+void ULyraBotCreationComponent::ProcessSpawnQueue()
+{
+	SCOPE_CYCLE_COUNTER(STAT_LyraBotSpawnQueue);
+
+	const double BudgetSeconds = LyraConsoleVariables::BotSpawnBudgetMs * 0.001;
+	const double FrameStartTime = FPlatformTime::Seconds();
+
+	// Pawns needed for the experience's default pawn data, which is what bots get unless something overrides it
+	ALyraGameMode* GameMode = GetGameMode<ALyraGameMode>();
+	const ULyraPawnData* PawnDataToPrewarm = GameMode ? GameMode->GetPawnDataForController(nullptr) : nullptr;
+	ULyraPawnPoolSubsystem* PawnPool = GetWorld()->GetSubsystem<ULyraPawnPoolSubsystem>();
+
+	// Always make some progress, even when a single spawn is over budget
+	do
+	{
+		if (NumPawnsQueuedToPrewarm > 0)
+		{
+			--NumPawnsQueuedToPrewarm;
+			if (PawnPool && PawnPool->PrewarmPawn(PawnDataToPrewarm))
+			{
+				++SpawnQueueStats.NumPawnsPrewarmed;
+			}
+		}
+		else if (NumBotsQueued > 0)
+		{
+			--NumBotsQueued;
+			SpawnOneBot();
+			++SpawnQueueStats.NumBotsSpawned;
+			INC_DWORD_STAT(STAT_LyraBotsSpawnedFromQueue);
+		}
+	}
+	while (((NumPawnsQueuedToPrewarm > 0) || (NumBotsQueued > 0)) && ((BudgetSeconds <= 0.0) || ((FPlatformTime::Seconds() - FrameStartTime) < BudgetSeconds)));
+
+	const double FrameMs = (FPlatformTime::Seconds() - FrameStartTime) * 1000.0;
+	SpawnQueueStats.TotalSpawnMs += FrameMs;
+	SpawnQueueStats.WorstFrameMs = FMath::Max(SpawnQueueStats.WorstFrameMs, FrameMs);
+	++SpawnQueueStats.NumFrames;
+
+	if ((NumPawnsQueuedToPrewarm > 0) || (NumBotsQueued > 0))
+	{
+		SpawnQueueTimerHandle = GetWorld()->GetTimerManager().SetTimerForNextTick(this, &ThisClass::ProcessSpawnQueue);
+		return;
+	}
+
+	FinishSpawnQueue();
+}
+
+void ULyraBotCreationComponent::FinishSpawnQueue()
+{
+	SpawnQueueTimerHandle.Invalidate();
+
+	const FSpawnQueueStats& Stats = SpawnQueueStats;
+	const double ElapsedSeconds = FPlatformTime::Seconds() - Stats.StartTime;
+	const int32 NumSpawned = Stats.NumBotsSpawned + Stats.NumPawnsPrewarmed;
+
+	UE_LOG(LogLyra, Log, TEXT("Bot spawn queue done: %d bots and %d prewarmed pawns over %d frames (%.2fs). %.2fms spawning in total, %.2fms per spawn, worst frame %.2fms, %.1f spawns/s"),
+		Stats.NumBotsSpawned,
+		Stats.NumPawnsPrewarmed,
+		Stats.NumFrames,
+		ElapsedSeconds,
+		Stats.TotalSpawnMs,
+		(NumSpawned > 0) ? (Stats.TotalSpawnMs / NumSpawned) : 0.0,
+		Stats.WorstFrameMs,
+		(ElapsedSeconds > 0.0) ? (NumSpawned / ElapsedSeconds) : 0.0);
 }
 
 FString ULyraBotCreationComponent::CreateBotName(int32 PlayerIndex)
@@ -179,4 +303,14 @@ void ULyraBotCreationComponent::RemoveOneBot()
 	ensureMsgf(0, TEXT("Bot functions do not exist in LyraClient!"));
 }
 
+void ULyraBotCreationComponent::QueueBots(int32 NumBots)
+{
+	ensureMsgf(0, TEXT("Bot functions do not exist in LyraClient!"));
+}
+
+void ULyraBotCreationComponent::PrewarmBotPawns(int32 NumPawns)
+{
+	ensureMsgf(0, TEXT("Bot functions do not exist in LyraClient!"));
+}
+
 #endif
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "Components/GameStateComponent.h"
+#include "Engine/TimerHandle.h"
 
 #include "LyraBotCreationComponent.generated.h"
 
@@ -20,6 +21,7 @@ public:
 
 	//~UActorComponent interface
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	//~End of UActorComponent interface
 
 private:
@@ -37,6 +39,10 @@ protected:
 
 	TArray<FString> RemainingBotNames;
 
+	/** Number of bot pawns to spawn ahead of time into the pawn pool when the experience loads, before any bots are created */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category=Gameplay)
+	int32 NumPawnsToPrewarm = 0;
+
 protected:
 	UPROPERTY(Transient)
 	TArray<TObjectPtr<AAIController>> SpawnedBotList;
@@ -53,6 +59,37 @@ protected:
 	UFUNCTION(BlueprintNativeEvent, BlueprintAuthorityOnly, Category=Gameplay)
 	void ServerCreateBots();
 
+	/** Adds bots to the spawn queue, which creates them over the next few frames within lyra.Bots.SpawnBudgetMs */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category=Gameplay)
+	void QueueBots(int32 NumBots);
+
+	/** Queues bot pawns to be spawned into the pawn pool ahead of time, so queued bots don't pay for spawning them */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category=Gameplay)
+	void PrewarmBotPawns(int32 NumPawns);
+
+private:
+	void ProcessSpawnQueue();
+	void StartSpawnQueue();
+	void FinishSpawnQueue();
+
+	int32 NumBotsQueued = 0;
+	int32 NumPawnsQueuedToPrewarm = 0;
+
+	// Set while the queue is running, it is processed once per world tick
+	FTimerHandle SpawnQueueTimerHandle;
+
+	// Throughput of the current run of the queue, logged when it empties
+	struct FSpawnQueueStats
+	{
+		double StartTime = 0.0;
+		double TotalSpawnMs = 0.0;
+		double WorstFrameMs = 0.0;
+		int32 NumFrames = 0;
+		int32 NumBotsSpawned = 0;
+		int32 NumPawnsPrewarmed = 0;
+	};
+	FSpawnQueueStats SpawnQueueStats;
+
 #if WITH_SERVER_CODE
 public:
 	void Cheat_AddBot() { SpawnOneBot(); }
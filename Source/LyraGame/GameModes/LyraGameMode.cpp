@@ -16,6 +16,7 @@
 #include "UI/LyraHUD.h"
 #include "Character/LyraPawnExtensionComponent.h"
 #include "Character/LyraPawnData.h"
+#include "Character/LyraPawnPoolSubsystem.h"
 #include "GameModes/LyraWorldSettings.h"
 #include "GameModes/LyraExperienceDefinition.h"
 #include "GameModes/LyraExperienceManagerComponent.h"
@@ -351,6 +352,15 @@ APawn* ALyraGameMode::SpawnDefaultPawnAtTransform_Implementation(AController* Ne
 
 	if (UClass* PawnClass = GetDefaultPawnClassForController(NewPlayer))
 	{
+		// Prefer a pawn that was spawned ahead of time, it already has its pawn data
+		if (ULyraPawnPoolSubsystem* PawnPool = GetWorld()->GetSubsystem<ULyraPawnPoolSubsystem>())
+		{
+			if (APawn* PooledPawn = PawnPool->TakePawn(PawnClass, GetPawnDataForController(NewPlayer), SpawnTransform))
+			{
+				return PooledPawn;
+			}
+		}
+
 		if (APawn* SpawnedPawn = GetWorld()->SpawnActor<APawn>(PawnClass, SpawnTransform, SpawnInfo))
 		{
 			if (ULyraPawnExtensionComponent* PawnExtComp = ULyraPawnExtensionComponent::FindPawnExtensionComponent(SpawnedPawn))
@@ -2,6 +2,8 @@
 
 #include "LyraInventoryManagerComponent.h"
 
+#include "Algo/BinarySearch.h"
+#include "Algo/Sort.h"
 #include "Engine/ActorChannel.h"
 #include "Engine/World.h"
 #include "GameFramework/GameplayMessageSubsystem.h"
@@ -42,10 +44,16 @@ void FLyraInventoryList::PreReplicatedRemove(const TArrayView<int32> RemovedIndi
 		BroadcastChangeMessage(Stack, /*OldCount=*/ Stack.StackCount, /*NewCount=*/ 0);
 		Stack.LastObservedCount = 0;
 	}
+
+	// The serializer removes the entries after this returns and may move others around, so the index is rebuilt lazily
+	bItemDefIndexDirty = true;
 }
 
 void FLyraInventoryList::PostReplicatedAdd(const TArrayView<int32> AddedIndices, int32 FinalSize)
 {
+	// Dirty before broadcasting, listeners may query the inventory
+	bItemDefIndexDirty = true;
+
 	for (int32 Index : AddedIndices)
 	{
 		FLyraInventoryEntry& Stack = Entries[Index];
@@ -56,6 +64,9 @@ void FLyraInventoryList::PostReplicatedAdd(const TArrayView<int32> AddedIndices,
 
 void FLyraInventoryList::PostReplicatedChange(const TArrayView<int32> ChangedIndices, int32 FinalSize)
 {
+	// The instance may have only just been mapped, dirty before broadcasting as listeners may query the inventory
+	bItemDefIndexDirty = true;
+
 	for (int32 Index : ChangedIndices)
 	{
 		FLyraInventoryEntry& Stack = Entries[Index];
@@ -88,30 +99,58 @@ ULyraInventoryItemInstance* FLyraInventoryList::AddEntry(TSubclassOf<ULyraInvent
 	check(OwningActor->HasAuthority());
 
 
-	FLyraInventoryEntry& NewEntry = Entries.AddDefaulted_GetRef();
-	NewEntry.Instance = NewObject<ULyraInventoryItemInstance>(OwnerComponent->GetOwner());  //@TODO: Using the actor instead of component as the outer due to UE-127172
-	NewEntry.Instance->SetItemDef(ItemDef);
+	ULyraInventoryItemInstance* NewInstance = NewObject<ULyraInventoryItemInstance>(OwnerComponent->GetOwner());  //@TODO: Using the actor instead of component as the outer due to UE-127172
+	NewInstance->SetItemDef(ItemDef);
 	for (ULyraInventoryItemFragment* Fragment : GetDefault<ULyraInventoryItemDefinition>(ItemDef)->Fragments)
 	{
 		if (Fragment != nullptr)
 		{
-			Fragment->OnInstanceCreated(NewEntry.Instance);
+			Fragment->OnInstanceCreated(NewInstance);
 		}
 	}
-	NewEntry.StackCount = StackCount;
-	Result = NewEntry.Instance;
+	Result = AddEntryInternal(NewInstance, StackCount).Instance;
 
 	//const ULyraInventoryItemDefinition* ItemCDO = GetDefault<ULyraInventoryItemDefinition>(ItemDef);
-	MarkItemDirty(NewEntry);
 
 	return Result;
 }
 
+ULyraInventoryItemInstance* FLyraInventoryList::AddEntryCopy(const ULyraInventoryItemInstance* Source, int32 StackCount)
+{
+	check(Source);
+
+	ULyraInventoryItemInstance* NewInstance = AddEntry(Source->GetItemDef(), StackCount);
+
+	// Replaces whatever the fragments initialized, the stats belong to the item being copied
+	NewInstance->StatTags.CopyStacksFrom(Source->StatTags);
+
+	return NewInstance;
+}
+
 void FLyraInventoryList::AddEntry(ULyraInventoryItemInstance* Instance)
 {
 	unimplemented();
 }
 
+FLyraInventoryEntry& FLyraInventoryList::AddEntryInternal(ULyraInventoryItemInstance* Instance, int32 StackCount)
+{
+	check(Instance);
+
+	const int32 NewEntryIndex = Entries.AddDefaulted();
+	FLyraInventoryEntry& NewEntry = Entries[NewEntryIndex];
+	NewEntry.Instance = Instance;
+	NewEntry.StackCount = StackCount;
+	MarkItemDirty(NewEntry);
+
+	// Appending keeps every other index valid
+	if (!bItemDefIndexDirty)
+	{
+		ItemDefToEntryIndices.FindOrAdd(Instance->GetItemDef()).Add(NewEntryIndex);
+	}
+
+	return NewEntry;
+}
+
 void FLyraInventoryList::RemoveEntry(ULyraInventoryItemInstance* Instance)
 {
 	for (auto EntryIt = Entries.CreateIterator(); EntryIt; ++EntryIt)
@@ -121,8 +160,63 @@ void FLyraInventoryList::RemoveEntry(ULyraInventoryItemInstance* Instance)
 		{
 			EntryIt.RemoveCurrent();
 			MarkArrayDirty();
+			bItemDefIndexDirty = true;
+		}
+	}
+}
+
+void FLyraInventoryList::RemoveEntries(TConstArrayView<ULyraInventoryItemInstance*> SortedInstances)
+{
+	if (SortedInstances.IsEmpty())
+	{
+		return;
+	}
+
+	const int32 NumRemoved = Entries.RemoveAll([SortedInstances](const FLyraInventoryEntry& Entry)
+	{
+		return Algo::BinarySearch(SortedInstances, Entry.Instance.Get()) != INDEX_NONE;
+	});
+
+	if (NumRemoved > 0)
+	{
+		MarkArrayDirty();
+		bItemDefIndexDirty = true;
+	}
+}
+
+TConstArrayView<int32> FLyraInventoryList::GetEntryIndicesForDefinition(TSubclassOf<ULyraInventoryItemDefinition> ItemDef) const
+{
+	if (bItemDefIndexDirty)
+	{
+		RebuildItemDefIndex();
+	}
+
+	const TArray<int32, TInlineAllocator<4>>* EntryIndices = ItemDefToEntryIndices.Find(ItemDef);
+	return EntryIndices ? TConstArrayView<int32>(*EntryIndices) : TConstArrayView<int32>();
+}
+
+void FLyraInventoryList::RebuildItemDefIndex() const
+{
+	// Keep the per definition arrays around, inventories tend to hold the same kinds of items over and over
+	for (TPair<TSubclassOf<ULyraInventoryItemDefinition>, TArray<int32, TInlineAllocator<4>>>& Pair : ItemDefToEntryIndices)
+	{
+		Pair.Value.Reset();
+	}
+
+	for (int32 EntryIndex = 0; EntryIndex < Entries.Num(); ++EntryIndex)
+	{
+		const ULyraInventoryItemInstance* Instance = Entries[EntryIndex].Instance;
+		const TSubclassOf<ULyraInventoryItemDefinition> ItemDef = (Instance != nullptr) ? Instance->GetItemDef() : nullptr;
+		if (ItemDef == nullptr)
+		{
+			// On clients the instance can be mapped after the entry arrives, PostReplicatedChange dirties the index again when it is
+			continue;
 		}
+
+		ItemDefToEntryIndices.FindOrAdd(ItemDef).Add(EntryIndex);
 	}
+
+	bItemDefIndexDirty = false;
 }
 
 TArray<ULyraInventoryItemInstance*> FLyraInventoryList::GetAllItems() const
@@ -139,6 +233,41 @@ TArray<ULyraInventoryItemInstance*> FLyraInventoryList::GetAllItems() const
 	return Results;
 }
 
+//////////////////////////////////////////////////////////////////////
+// FLyraInventoryTransaction
+
+void FLyraInventoryTransaction::AddItemDefinition(TSubclassOf<ULyraInventoryItemDefinition> ItemDef, int32 StackCount)
+{
+	if ((ItemDef != nullptr) && (StackCount > 0))
+	{
+		FOperation& Operation = Operations.AddDefaulted_GetRef();
+		Operation.Type = EOperation::Add;
+		Operation.ItemDef = ItemDef;
+		Operation.Count = StackCount;
+	}
+}
+
+void FLyraInventoryTransaction::ConsumeItemsByDefinition(TSubclassOf<ULyraInventoryItemDefinition> ItemDef, int32 NumToConsume)
+{
+	if (NumToConsume > 0)
+	{
+		FOperation& Operation = Operations.AddDefaulted_GetRef();
+		Operation.Type = EOperation::Consume;
+		Operation.ItemDef = ItemDef;
+		Operation.Count = NumToConsume;
+	}
+}
+
+void FLyraInventoryTransaction::RemoveItemInstance(ULyraInventoryItemInstance* ItemInstance)
+{
+	if (ItemInstance != nullptr)
+	{
+		FOperation& Operation = Operations.AddDefaulted_GetRef();
+		Operation.Type = EOperation::Remove;
+		Operation.Instance = ItemInstance;
+	}
+}
+
 //////////////////////////////////////////////////////////////////////
 // ULyraInventoryManagerComponent
 
@@ -203,16 +332,13 @@ TArray<ULyraInventoryItemInstance*> ULyraInventoryManagerComponent::GetAllItems(
 
 ULyraInventoryItemInstance* ULyraInventoryManagerComponent::FindFirstItemStackByDefinition(TSubclassOf<ULyraInventoryItemDefinition> ItemDef) const
 {
-	for (const FLyraInventoryEntry& Entry : InventoryList.Entries)
+	for (const int32 EntryIndex : InventoryList.GetEntryIndicesForDefinition(ItemDef))
 	{
-		ULyraInventoryItemInstance* Instance = Entry.Instance;
+		ULyraInventoryItemInstance* Instance = InventoryList.Entries[EntryIndex].Instance;
 
 		if (IsValid(Instance))
 		{
-			if (Instance->GetItemDef() == ItemDef)
-			{
-				return Instance;
-			}
+			return Instance;
 		}
 	}
 
@@ -222,16 +348,11 @@ ULyraInventoryItemInstance* ULyraInventoryManagerComponent::FindFirstItemStackBy
 int32 ULyraInventoryManagerComponent::GetTotalItemCountByDefinition(TSubclassOf<ULyraInventoryItemDefinition> ItemDef) const
 {
 	int32 TotalCount = 0;
-	for (const FLyraInventoryEntry& Entry : InventoryList.Entries)
+	for (const int32 EntryIndex : InventoryList.GetEntryIndicesForDefinition(ItemDef))
 	{
-		ULyraInventoryItemInstance* Instance = Entry.Instance;
-
-		if (IsValid(Instance))
+		if (IsValid(InventoryList.Entries[EntryIndex].Instance))
 		{
-			if (Instance->GetItemDef() == ItemDef)
-			{
-				++TotalCount;
-			}
+			++TotalCount;
 		}
 	}
 
@@ -239,6 +360,44 @@ int32 ULyraInventoryManagerComponent::GetTotalItemCountByDefinition(TSubclassOf<
 }
 
 bool ULyraInventoryManagerComponent::ConsumeItemsByDefinition(TSubclassOf<ULyraInventoryItemDefinition> ItemDef, int32 NumToConsume)
+{
+	FLyraInventoryTransaction Transaction;
+	Transaction.ConsumeItemsByDefinition(ItemDef, NumToConsume);
+	return ApplyTransaction(Transaction);
+}
+
+void ULyraInventoryManagerComponent::ForEachItem(TFunctionRef<void(ULyraInventoryItemInstance* Instance, int32 StackCount)> Func) const
+{
+	InventoryList.ForEachItem(Func);
+}
+
+void ULyraInventoryManagerComponent::ForEachItemOfDefinition(TSubclassOf<ULyraInventoryItemDefinition> ItemDef, TFunctionRef<void(ULyraInventoryItemInstance* Instance, int32 StackCount)> Func) const
+{
+	InventoryList.ForEachItemOfDefinition(ItemDef, Func);
+}
+
+bool ULyraInventoryManagerComponent::GatherItemsToConsume(TSubclassOf<ULyraInventoryItemDefinition> ItemDef, int32 NumToConsume, TArray<ULyraInventoryItemInstance*, TInlineAllocator<16>>& OutInstances) const
+{
+	int32 NumGathered = 0;
+	for (const int32 EntryIndex : InventoryList.GetEntryIndicesForDefinition(ItemDef))
+	{
+		if (NumGathered >= NumToConsume)
+		{
+			break;
+		}
+
+		ULyraInventoryItemInstance* Instance = InventoryList.Entries[EntryIndex].Instance;
+		if (IsValid(Instance) && !OutInstances.Contains(Instance))
+		{
+			OutInstances.Add(Instance);
+			++NumGathered;
+		}
+	}
+
+	return NumGathered >= NumToConsume;
+}
+
+bool ULyraInventoryManagerComponent::ApplyTransaction(const FLyraInventoryTransaction& Transaction, TArray<ULyraInventoryItemInstance*>* OutAddedItems)
 {
 	AActor* OwningActor = GetOwner();
 	if (!OwningActor || !OwningActor->HasAuthority())
@@ -246,22 +405,99 @@ bool ULyraInventoryManagerComponent::ConsumeItemsByDefinition(TSubclassOf<ULyraI
 		return false;
 	}
 
-	//@TODO: N squared right now as there's no acceleration structure
-	int32 TotalConsumed = 0;
-	while (TotalConsumed < NumToConsume)
+	// Work out everything that's removed first, so nothing changes if there aren't enough items to consume
+	TArray<ULyraInventoryItemInstance*, TInlineAllocator<16>> InstancesToRemove;
+	for (const FLyraInventoryTransaction::FOperation& Operation : Transaction.Operations)
+	{
+		if (Operation.Type == FLyraInventoryTransaction::EOperation::Consume)
+		{
+			if (!GatherItemsToConsume(Operation.ItemDef, Operation.Count, InstancesToRemove))
+			{
+				return false;
+			}
+		}
+		else if (Operation.Type == FLyraInventoryTransaction::EOperation::Remove)
+		{
+			// Instances this inventory doesn't hold are skipped, their replicated subobject registration belongs to someone else
+			const ULyraInventoryItemInstance* Instance = Operation.Instance;
+			if ((Instance != nullptr) && InventoryList.Entries.ContainsByPredicate([Instance](const FLyraInventoryEntry& Entry) { return Entry.Instance == Instance; }))
+			{
+				InstancesToRemove.AddUnique(Operation.Instance);
+			}
+		}
+	}
+
+	Algo::Sort(InstancesToRemove);
+	InventoryList.RemoveEntries(InstancesToRemove);
+
+	if (IsUsingRegisteredSubObjectList())
+	{
+		for (ULyraInventoryItemInstance* Instance : InstancesToRemove)
+		{
+			RemoveReplicatedSubObject(Instance);
+		}
+	}
+
+	for (const FLyraInventoryTransaction::FOperation& Operation : Transaction.Operations)
+	{
+		if (Operation.Type == FLyraInventoryTransaction::EOperation::Add)
+		{
+			ULyraInventoryItemInstance* Result = AddItemDefinition(Operation.ItemDef, Operation.Count);
+			if (OutAddedItems && Result)
+			{
+				OutAddedItems->Add(Result);
+			}
+		}
+	}
+
+	return true;
+}
+
+bool ULyraInventoryManagerComponent::TransferItemsByDefinition(ULyraInventoryManagerComponent* Destination, TSubclassOf<ULyraInventoryItemDefinition> ItemDef, int32 NumToTransfer)
+{
+	AActor* OwningActor = GetOwner();
+	if (!OwningActor || !OwningActor->HasAuthority() || !Destination || (Destination == this) || !Destination->GetOwner() || !Destination->GetOwner()->HasAuthority())
+	{
+		return false;
+	}
+
+	TArray<ULyraInventoryItemInstance*, TInlineAllocator<16>> InstancesToTransfer;
+	if (!GatherItemsToConsume(ItemDef, NumToTransfer, InstancesToTransfer))
+	{
+		return false;
+	}
+
+	// Captured in inventory order before the entries go away
+	TArray<TPair<ULyraInventoryItemInstance*, int32>, TInlineAllocator<16>> TransferredStacks;
+	for (const int32 EntryIndex : InventoryList.GetEntryIndicesForDefinition(ItemDef))
 	{
-		if (ULyraInventoryItemInstance* Instance = ULyraInventoryManagerComponent::FindFirstItemStackByDefinition(ItemDef))
+		const FLyraInventoryEntry& Entry = InventoryList.Entries[EntryIndex];
+		if (InstancesToTransfer.Contains(Entry.Instance))
 		{
-			InventoryList.RemoveEntry(Instance);
-			++TotalConsumed;
+			TransferredStacks.Emplace(Entry.Instance, Entry.StackCount);
 		}
-		else
+	}
+
+	Algo::Sort(InstancesToTransfer);
+	InventoryList.RemoveEntries(InstancesToTransfer);
+
+	for (const TPair<ULyraInventoryItemInstance*, int32>& Stack : TransferredStacks)
+	{
+		ULyraInventoryItemInstance* Instance = Stack.Key;
+		if (IsUsingRegisteredSubObjectList())
 		{
-			return false;
+			RemoveReplicatedSubObject(Instance);
+		}
+
+		// A replicated subobject can't change owning actor, so the destination gets a new instance outered to its own actor
+		ULyraInventoryItemInstance* NewInstance = Destination->InventoryList.AddEntryCopy(Instance, Stack.Value);
+		if (Destination->IsUsingRegisteredSubObjectList() && Destination->IsReadyForReplication())
+		{
+			Destination->AddReplicatedSubObject(NewInstance);
 		}
 	}
 
-	return TotalConsumed == NumToConsume;
+	return true;
 }
 
 void ULyraInventoryManagerComponent::ReadyForReplication()
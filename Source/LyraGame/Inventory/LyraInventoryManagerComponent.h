@@ -81,6 +81,36 @@ struct FLyraInventoryList : public FFastArraySerializer
 
 	TArray<ULyraInventoryItemInstance*> GetAllItems() const;
 
+	/** Calls Func(Instance, StackCount) for each item without copying them into an array like GetAllItems. Func must not change the inventory */
+	template <typename FuncType>
+	void ForEachItem(FuncType&& Func) const
+	{
+		for (const FLyraInventoryEntry& Entry : Entries)
+		{
+			if (Entry.Instance != nullptr)
+			{
+				Func(Entry.Instance.Get(), Entry.StackCount);
+			}
+		}
+	}
+
+	/** Calls Func(Instance, StackCount) for each item of ItemDef, in inventory order. Func must not change the inventory */
+	template <typename FuncType>
+	void ForEachItemOfDefinition(TSubclassOf<ULyraInventoryItemDefinition> ItemDef, FuncType&& Func) const
+	{
+		for (const int32 EntryIndex : GetEntryIndicesForDefinition(ItemDef))
+		{
+			const FLyraInventoryEntry& Entry = Entries[EntryIndex];
+			Func(Entry.Instance.Get(), Entry.StackCount);
+		}
+	}
+
+	/** Number of items (not stacks) of ItemDef */
+	int32 GetNumItemsOfDefinition(TSubclassOf<ULyraInventoryItemDefinition> ItemDef) const
+	{
+		return GetEntryIndicesForDefinition(ItemDef).Num();
+	}
+
 public:
 	//~FFastArraySerializer contract
 	void PreReplicatedRemove(const TArrayView<int32> RemovedIndices, int32 FinalSize);
@@ -101,6 +131,17 @@ public:
 private:
 	void BroadcastChangeMessage(FLyraInventoryEntry& Entry, int32 OldCount, int32 NewCount);
 
+	FLyraInventoryEntry& AddEntryInternal(ULyraInventoryItemInstance* Instance, int32 StackCount);
+
+	// Adds a new instance of Source's item definition with a copy of its stat tags
+	ULyraInventoryItemInstance* AddEntryCopy(const ULyraInventoryItemInstance* Source, int32 StackCount);
+
+	// Removes the entries of several instances (sorted with Algo::Sort), marking the array dirty once for the whole batch
+	void RemoveEntries(TConstArrayView<ULyraInventoryItemInstance*> SortedInstances);
+
+	TConstArrayView<int32> GetEntryIndicesForDefinition(TSubclassOf<ULyraInventoryItemDefinition> ItemDef) const;
+	void RebuildItemDefIndex() const;
+
 private:
 	friend ULyraInventoryManagerComponent;
 
@@ -111,6 +152,45 @@ private:
 
 	UPROPERTY(NotReplicated)
 	TObjectPtr<UActorComponent> OwnerComponent;
+
+	// Indices into Entries of each item definition's entries, in the same order
+	mutable TMap<TSubclassOf<ULyraInventoryItemDefinition>, TArray<int32, TInlineAllocator<4>>> ItemDefToEntryIndices;
+
+	// Set when entries are removed or replication changes the list, the index is rebuilt on the next query
+	mutable bool bItemDefIndexDirty = false;
+};
+
+/**
+ * A batch of changes applied to an inventory together with ULyraInventoryManagerComponent::ApplyTransaction.
+ * Consumes and removals only apply to items that were in the inventory before the transaction.
+ */
+struct FLyraInventoryTransaction
+{
+	void AddItemDefinition(TSubclassOf<ULyraInventoryItemDefinition> ItemDef, int32 StackCount = 1);
+	void ConsumeItemsByDefinition(TSubclassOf<ULyraInventoryItemDefinition> ItemDef, int32 NumToConsume);
+	void RemoveItemInstance(ULyraInventoryItemInstance* ItemInstance);
+
+	bool IsEmpty() const { return Operations.IsEmpty(); }
+
+private:
+	friend ULyraInventoryManagerComponent;
+
+	enum class EOperation : uint8
+	{
+		Add,
+		Consume,
+		Remove
+	};
+
+	struct FOperation
+	{
+		EOperation Type = EOperation::Add;
+		TSubclassOf<ULyraInventoryItemDefinition> ItemDef;
+		ULyraInventoryItemInstance* Instance = nullptr;
+		int32 Count = 0;
+	};
+
+	TArray<FOperation, TInlineAllocator<8>> Operations;
 };
 
 template<>
@@ -160,12 +240,34 @@ public:
 	UE_API int32 GetTotalItemCountByDefinition(TSubclassOf<ULyraInventoryItemDefinition> ItemDef) const;
 	UE_API bool ConsumeItemsByDefinition(TSubclassOf<ULyraInventoryItemDefinition> ItemDef, int32 NumToConsume);
 
+	/** Calls Func(Instance, StackCount) for each item, without allocating. Func must not change the inventory */
+	UE_API void ForEachItem(TFunctionRef<void(ULyraInventoryItemInstance* Instance, int32 StackCount)> Func) const;
+
+	/** Calls Func(Instance, StackCount) for each item of ItemDef, without allocating. Func must not change the inventory */
+	UE_API void ForEachItemOfDefinition(TSubclassOf<ULyraInventoryItemDefinition> ItemDef, TFunctionRef<void(ULyraInventoryItemInstance* Instance, int32 StackCount)> Func) const;
+
+	/**
+	 * Applies every operation of Transaction, or none of them if it consumes more items than there are.
+	 * Removed entries mark the replicated list dirty once for the whole transaction.
+	 */
+	UE_API bool ApplyTransaction(const FLyraInventoryTransaction& Transaction, TArray<ULyraInventoryItemInstance*>* OutAddedItems = nullptr);
+
+	/**
+	 * Moves NumToTransfer items of ItemDef into another inventory. All or nothing.
+	 * The destination gets new instances with the same stack counts and stat tags, the instances removed from this inventory aren't reused.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category=Inventory)
+	UE_API bool TransferItemsByDefinition(ULyraInventoryManagerComponent* Destination, TSubclassOf<ULyraInventoryItemDefinition> ItemDef, int32 NumToTransfer);
+
 	//~UObject interface
 	UE_API virtual bool ReplicateSubobjects(class UActorChannel* Channel, class FOutBunch* Bunch, FReplicationFlags* RepFlags) override;
 	UE_API virtual void ReadyForReplication() override;
 	//~End of UObject interface
 
 private:
+	// Gathers the first NumToConsume items of ItemDef not already in OutInstances, returns false if there aren't enough
+	bool GatherItemsToConsume(TSubclassOf<ULyraInventoryItemDefinition> ItemDef, int32 NumToConsume, TArray<ULyraInventoryItemInstance*, TInlineAllocator<16>>& OutInstances) const;
+
 	UPROPERTY(Replicated)
 	FLyraInventoryList InventoryList;
 };
@@ -2,11 +2,54 @@
 
 #include "LyraVerbMessageReplication.h"
 
+#include "Engine/DemoNetDriver.h"
+#include "Engine/NetConnection.h"
+#include "Engine/PackageMapClient.h"
+#include "Engine/World.h"
 #include "GameFramework/GameplayMessageSubsystem.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "HAL/IConsoleManager.h"
+#include "LyraLogChannels.h"
 #include "Messages/LyraVerbMessage.h"
+#include "Misc/AutomationTest.h"
+#include "Net/RepLayout.h"
+#include "NativeGameplayTags.h"
+#include "Teams/LyraTeamSubsystem.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(LyraVerbMessageReplication)
 
+namespace LyraConsoleVariables
+{
+	static int32 MaxReplicatedVerbMessages = 32;
+	static FAutoConsoleVariableRef CVarMaxReplicatedVerbMessages(
+		TEXT("lyra.VerbMessages.MaxMessages"),
+		MaxReplicatedVerbMessages,
+		TEXT("Most verb messages a replicated message channel holds, the oldest one is replaced once it is full"),
+		ECVF_Default);
+
+	static float VerbMessageLifetime = 10.0f;
+	static FAutoConsoleVariableRef CVarVerbMessageLifetime(
+		TEXT("lyra.VerbMessages.Lifetime"),
+		VerbMessageLifetime,
+		TEXT("Seconds a replicated verb message stays in its channel, older ones are no longer sent (0 keeps them until they are replaced)"),
+		ECVF_Default);
+
+	static float VerbMessageCoalesceWindow = 3.0f;
+	static FAutoConsoleVariableRef CVarVerbMessageCoalesceWindow(
+		TEXT("lyra.VerbMessages.CoalesceWindow"),
+		VerbMessageCoalesceWindow,
+		TEXT("Coalesced verb messages from the same instigator that come within this many seconds of each other are folded into one entry (0 disables coalescing)"),
+		ECVF_Default);
+
+	static float VerbMessageProximityRadius = 5000.0f;
+	static FAutoConsoleVariableRef CVarVerbMessageProximityRadius(
+		TEXT("lyra.VerbMessages.ProximityRadius"),
+		VerbMessageProximityRadius,
+		TEXT("Distance (in cm) from where it happened that a Nearby verb message is sent to"),
+		ECVF_Default);
+}
+
 //////////////////////////////////////////////////////////////////////
 // FLyraVerbMessageReplicationEntry
 
@@ -18,36 +61,305 @@ FString FLyraVerbMessageReplicationEntry::GetDebugString() const
 //////////////////////////////////////////////////////////////////////
 // FLyraVerbMessageReplication
 
-void FLyraVerbMessageReplication::AddMessage(const FLyraVerbMessage& Message)
+void FLyraVerbMessageReplication::AddMessage(const FLyraVerbMessage& Message, ELyraVerbMessageRelevancy Relevancy)
 {
-	FLyraVerbMessageReplicationEntry& NewStack = CurrentMessages.Emplace_GetRef(Message);
-	MarkItemDirty(NewStack);
+	AddMessageAtTime(Message, ResolveRelevancy(Message, Relevancy), GetServerTime());
+}
+
+void FLyraVerbMessageReplication::AddMessageAtTime(const FLyraVerbMessage& Message, const FLyraVerbMessageRelevancyInfo& RelevancyInfo, double Now)
+{
+	if (bUnboundedForSimulation)
+	{
+		FLyraVerbMessageReplicationEntry& Entry = CurrentMessages.Emplace_GetRef(Message);
+		Entry.ServerTime = Now;
+		Entry.RelevancyInfo = RelevancyInfo;
+		MarkItemDirty(Entry);
+		return;
+	}
+
+	PruneExpiredMessages(Now);
+
+	if (TryCoalesceMessage(Message, RelevancyInfo, Now))
+	{
+		return;
+	}
+
+	auto FindOldestIndex = [this]()
+	{
+		int32 OldestIndex = 0;
+		for (int32 Index = 1; Index < CurrentMessages.Num(); ++Index)
+		{
+			if (CurrentMessages[Index].ServerTime < CurrentMessages[OldestIndex].ServerTime)
+			{
+				OldestIndex = Index;
+			}
+		}
+		return OldestIndex;
+	};
+
+	// Once full the oldest entry is dropped rather than reused, clients only treat changes as coalesced updates
+	const int32 MaxMessages = FMath::Max(LyraConsoleVariables::MaxReplicatedVerbMessages, 1);
+	while (CurrentMessages.Num() >= MaxMessages)
+	{
+		CurrentMessages.RemoveAtSwap(FindOldestIndex());
+		MarkArrayDirty();
+	}
+
+	FLyraVerbMessageReplicationEntry& Entry = CurrentMessages.Emplace_GetRef(Message);
+	Entry.ServerTime = Now;
+	Entry.RelevancyInfo = RelevancyInfo;
+	MarkItemDirty(Entry);
+}
+
+bool FLyraVerbMessageReplication::TryCoalesceMessage(const FLyraVerbMessage& Message, const FLyraVerbMessageRelevancyInfo& RelevancyInfo, double Now)
+{
+	const double CoalesceWindow = LyraConsoleVariables::VerbMessageCoalesceWindow;
+	if ((CoalesceWindow <= 0.0) || (Message.Instigator == nullptr) || !Message.Verb.MatchesAny(CoalescedVerbs))
+	{
+		return false;
+	}
+
+	for (FLyraVerbMessageReplicationEntry& Entry : CurrentMessages)
+	{
+		if ((Entry.Message.Verb == Message.Verb) &&
+			(Entry.Message.Instigator == Message.Instigator) &&
+			(Entry.RelevancyInfo.Relevancy == RelevancyInfo.Relevancy) &&
+			((Now - Entry.ServerTime) <= CoalesceWindow))
+		{
+			// Magnitude counts the messages folded together, the latest target is the one shown
+			Entry.Message.Magnitude += Message.Magnitude;
+			Entry.Message.Target = Message.Target;
+			Entry.Message.TargetTags = Message.TargetTags;
+			Entry.Message.ContextTags.AppendTags(Message.ContextTags);
+			Entry.ServerTime = Now;
+			Entry.RelevancyInfo = RelevancyInfo;
+			MarkItemDirty(Entry);
+
+			// This is news to connections it wasn't relevant to (it may have happened somewhere else), they decide again
+			for (auto It = Entry.RelevancyByConnection.CreateIterator(); It; ++It)
+			{
+				if (!It.Value())
+				{
+					It.RemoveCurrent();
+				}
+			}
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void FLyraVerbMessageReplication::PruneExpiredMessages(double Now)
+{
+	const double Lifetime = LyraConsoleVariables::VerbMessageLifetime;
+	if (Lifetime <= 0.0)
+	{
+		return;
+	}
+
+	const int32 NumRemoved = CurrentMessages.RemoveAllSwap([Now, Lifetime](const FLyraVerbMessageReplicationEntry& Entry)
+	{
+		return (Now - Entry.ServerTime) > Lifetime;
+	});
+
+	if (NumRemoved > 0)
+	{
+		MarkArrayDirty();
+	}
+}
+
+double FLyraVerbMessageReplication::GetServerTime() const
+{
+	const UWorld* World = Owner ? Owner->GetWorld() : nullptr;
+	return World ? World->GetTimeSeconds() : 0.0;
+}
+
+FLyraVerbMessageRelevancyInfo FLyraVerbMessageReplication::ResolveRelevancy(const FLyraVerbMessage& Message, ELyraVerbMessageRelevancy Relevancy) const
+{
+	FLyraVerbMessageRelevancyInfo Info;
+
+	const UWorld* World = Owner ? Owner->GetWorld() : nullptr;
+	if (World == nullptr)
+	{
+		return Info;
+	}
+
+	if (Relevancy == ELyraVerbMessageRelevancy::InvolvedTeams)
+	{
+		if (const ULyraTeamSubsystem* TeamSubsystem = World->GetSubsystem<ULyraTeamSubsystem>())
+		{
+			Info.InstigatorTeamId = TeamSubsystem->FindTeamFromObject(Message.Instigator);
+			Info.TargetTeamId = TeamSubsystem->FindTeamFromObject(Message.Target);
+		}
+
+		// Nobody to limit it to, so it goes to everyone
+		if ((Info.InstigatorTeamId != INDEX_NONE) || (Info.TargetTeamId != INDEX_NONE))
+		{
+			Info.Relevancy = Relevancy;
+		}
+	}
+	else if (Relevancy == ELyraVerbMessageRelevancy::Nearby)
+	{
+		auto GetLocationActor = [](UObject* Object) -> const AActor*
+		{
+			if (const APlayerState* PlayerState = Cast<APlayerState>(Object))
+			{
+				return PlayerState->GetPawn();
+			}
+			return Cast<AActor>(Object);
+		};
+
+		// Where the target was is where it happened (e.g. the elimination), otherwise where the instigator is
+		const AActor* LocationActor = GetLocationActor(Message.Target);
+		if (LocationActor == nullptr)
+		{
+			LocationActor = GetLocationActor(Message.Instigator);
+		}
+
+		if (LocationActor != nullptr)
+		{
+			Info.Relevancy = Relevancy;
+			Info.Location = LocationActor->GetActorLocation();
+		}
+	}
+
+	return Info;
+}
+
+FLyraVerbMessageReplication::FViewer FLyraVerbMessageReplication::ResolveViewer(const FNetDeltaSerializeInfo& DeltaParms) const
+{
+	if (SimulatedViewer.IsSet())
+	{
+		FViewer Viewer = SimulatedViewer.GetValue();
+		Viewer.ConnectionKey = DeltaParms.Map;
+		return Viewer;
+	}
+
+	FViewer Viewer;
+	Viewer.Now = GetServerTime();
+	Viewer.ConnectionKey = DeltaParms.Map;
+
+	const UWorld* World = Owner ? Owner->GetWorld() : nullptr;
+	UPackageMapClient* PackageMap = Cast<UPackageMapClient>(DeltaParms.Map);
+	const UNetConnection* Connection = PackageMap ? PackageMap->GetConnection() : nullptr;
+	if ((World == nullptr) || (Connection == nullptr))
+	{
+		return Viewer;
+	}
+
+	// Replay and spectator connections without a team or view target get everything
+	if (Connection->PlayerController != nullptr)
+	{
+		if (const ULyraTeamSubsystem* TeamSubsystem = World->GetSubsystem<ULyraTeamSubsystem>())
+		{
+			Viewer.TeamId = TeamSubsystem->FindTeamFromObject(Connection->PlayerController);
+			Viewer.bHasTeam = (Viewer.TeamId != INDEX_NONE);
+		}
+	}
+
+	if (Connection->ViewTarget != nullptr)
+	{
+		Viewer.Location = Connection->ViewTarget->GetActorLocation();
+		Viewer.bHasLocation = true;
+	}
+
+	return Viewer;
+}
+
+bool FLyraVerbMessageReplication::IsExpired(const FLyraVerbMessageReplicationEntry& Entry, const FViewer& Viewer)
+{
+	const double Lifetime = LyraConsoleVariables::VerbMessageLifetime;
+	return (Viewer.Now > 0.0) && (Lifetime > 0.0) && ((Viewer.Now - Entry.ServerTime) > Lifetime);
+}
+
+bool FLyraVerbMessageReplication::IsRelevantToCurrentViewer(const FLyraVerbMessageReplicationEntry& Entry) const
+{
+	// Expired messages that haven't been pruned by a newer one yet still don't go out
+	if (IsExpired(Entry, CurrentViewer))
+	{
+		return false;
+	}
+
+	// Without a connection to remember it for there's nothing to keep consistent
+	if (CurrentViewer.ConnectionKey == TObjectKey<UObject>())
+	{
+		return IsRelevantToViewer(Entry, CurrentViewer);
+	}
+
+	// Once decided it sticks, otherwise a Nearby message would be deleted when the viewer moves away and re-added
+	// (and broadcast again as if it just happened) when they come back
+	if (const bool* bRelevant = Entry.RelevancyByConnection.Find(CurrentViewer.ConnectionKey))
+	{
+		return *bRelevant;
+	}
+
+	const bool bRelevant = IsRelevantToViewer(Entry, CurrentViewer);
+	Entry.RelevancyByConnection.Add(CurrentViewer.ConnectionKey, bRelevant);
+	return bRelevant;
+}
+
+bool FLyraVerbMessageReplication::IsRelevantToViewer(const FLyraVerbMessageReplicationEntry& Entry, const FViewer& Viewer)
+{
+	const FLyraVerbMessageRelevancyInfo& Info = Entry.RelevancyInfo;
+	switch (Info.Relevancy)
+	{
+	case ELyraVerbMessageRelevancy::InvolvedTeams:
+		return !Viewer.bHasTeam || (Viewer.TeamId == Info.InstigatorTeamId) || (Viewer.TeamId == Info.TargetTeamId);
+	case ELyraVerbMessageRelevancy::Nearby:
+		return !Viewer.bHasLocation || (FVector::DistSquared(Viewer.Location, Info.Location) <= FMath::Square((double)LyraConsoleVariables::VerbMessageProximityRadius));
+	default:
+		return true;
+	}
+}
+
+bool FLyraVerbMessageReplication::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+	const bool bWritingOnServer = (DeltaParms.Writer != nullptr) && !DeltaParms.bIsWritingOnClient;
+	if (bWritingOnServer)
+	{
+		CurrentViewer = ResolveViewer(DeltaParms);
+	}
+
+	const bool bResult = FFastArraySerializer::FastArrayDeltaSerialize<FLyraVerbMessageReplicationEntry, FLyraVerbMessageReplication>(CurrentMessages, DeltaParms, *this);
+
+	if (bWritingOnServer)
+	{
+		CurrentViewer = FViewer();
+	}
+
+	return bResult;
 }
 
 void FLyraVerbMessageReplication::PreReplicatedRemove(const TArrayView<int32> RemovedIndices, int32 FinalSize)
 {
-// 	for (int32 Index : RemovedIndices)
-// 	{
-// 		const FGameplayTag Tag = CurrentMessages[Index].Tag;
-// 		TagToCountMap.Remove(Tag);
-// 	}
+	// Messages were broadcast when they arrived, there is nothing to undo when they expire
 }
 
 void FLyraVerbMessageReplication::PostReplicatedAdd(const TArrayView<int32> AddedIndices, int32 FinalSize)
 {
 	for (int32 Index : AddedIndices)
 	{
-		const FLyraVerbMessageReplicationEntry& Entry = CurrentMessages[Index];
+		FLyraVerbMessageReplicationEntry& Entry = CurrentMessages[Index];
 		RebroadcastMessage(Entry.Message);
+		Entry.LastObservedMagnitude = Entry.Message.Magnitude;
 	}
 }
 
 void FLyraVerbMessageReplication::PostReplicatedChange(const TArrayView<int32> ChangedIndices, int32 FinalSize)
 {
+	// Entries only change when another message was coalesced into them, the earlier part was already broadcast
 	for (int32 Index : ChangedIndices)
 	{
-		const FLyraVerbMessageReplicationEntry& Entry = CurrentMessages[Index];
-		RebroadcastMessage(Entry.Message);
+		FLyraVerbMessageReplicationEntry& Entry = CurrentMessages[Index];
+		const double AddedMagnitude = Entry.Message.Magnitude - Entry.LastObservedMagnitude;
+		if (AddedMagnitude > 0.0)
+		{
+			FLyraVerbMessage AddedMessage = Entry.Message;
+			AddedMessage.Magnitude = AddedMagnitude;
+			RebroadcastMessage(AddedMessage);
+		}
+		Entry.LastObservedMagnitude = Entry.Message.Magnitude;
 	}
 }
 
@@ -58,3 +370,318 @@ void FLyraVerbMessageReplication::RebroadcastMessage(const FLyraVerbMessage& Mes
 	MessageSystem.BroadcastMessage(Message.Verb, Message);
 }
 
+
+//////////////////////////////////////////////////////////////////////
+
+namespace LyraVerbMessageSimulation
+{
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Lyra_Elimination_Message, "Lyra.Elimination.Message");
+	UE_DEFINE_GAMEPLAY_TAG_STATIC(TAG_Lyra_Assist_Message, "Lyra.Assist.Message");
+
+	/** A client of the simulation, which acknowledges everything it is sent right away */
+	struct FConnection
+	{
+		ULyraVerbMessageSimulationPackageMap* PackageMap = nullptr;
+		TSharedPtr<INetDeltaBaseState> AckedState;
+		int64 BitsSent = 0;
+	};
+}
+
+bool ULyraVerbMessageSimulationPackageMap::SerializeObject(FArchive& Ar, UClass* InClass, UObject*& Obj, FNetworkGUID* OutNetGUID)
+{
+	check(Ar.IsSaving());
+
+	// Zero is the null reference, like an invalid NetGUID
+	uint32 ObjectIndex = 0;
+	if (Obj != nullptr)
+	{
+		ObjectIndex = ObjectIndices.FindOrAdd(Obj, ObjectIndices.Num() + 1);
+	}
+	Ar.SerializeIntPacked(ObjectIndex);
+
+	return true;
+}
+
+FLyraVerbMessageReplication::FSimulationResults FLyraVerbMessageReplication::RunLongMatchSimulation(float MatchMinutes, float EliminationsPerMinute, bool bLogProgress)
+{
+	using namespace LyraVerbMessageSimulation;
+
+	FSimulationResults Results;
+
+	// Stand-ins for the players, only their identity is used (for coalescing and object references)
+	const int32 NumPlayers = 16;
+	FRandomStream Random(1337);
+	TArray<UObject*> Players;
+	TArray<FVector> PlayerLocations;
+	for (int32 PlayerIndex = 0; PlayerIndex < NumPlayers; ++PlayerIndex)
+	{
+		Players.Add(NewObject<UPackage>(nullptr, NAME_None, RF_Transient));
+		PlayerLocations.Add(FVector(Random.FRandRange(-10000.0f, 10000.0f), Random.FRandRange(-10000.0f, 10000.0f), 0.0f));
+	}
+
+	auto GetTeam = [](int32 PlayerIndex) { return PlayerIndex % 2; };
+
+	// The unbounded channel never drops anything, like a plain replicated array of every message
+	FLyraVerbMessageReplication UnboundedChannel;
+	UnboundedChannel.bUnboundedForSimulation = true;
+	FLyraVerbMessageReplication BoundedChannel;
+	FLyraVerbMessageReplication CoalescedChannel;
+	CoalescedChannel.CoalescedVerbs = FGameplayTagContainer(TAG_Lyra_Elimination_Message);
+
+	// Every message is seen from player 0's connection, the unbounded channel sends everything to everyone
+	FViewer Viewer;
+	Viewer.TeamId = GetTeam(0);
+	Viewer.bHasTeam = true;
+	Viewer.Location = PlayerLocations[0];
+	Viewer.bHasLocation = true;
+	const FViewer UnboundedViewer;
+
+	// NetDeltaSerialize writes the entries through the net driver's rep layouts
+	UNetDriver* NetDriver = NewObject<UDemoNetDriver>(GetTransientPackage());
+	FNetSerializeCB NetSerializeCB(NetDriver);
+
+	auto MakeConnection = []()
+	{
+		FConnection Connection;
+		Connection.PackageMap = NewObject<ULyraVerbMessageSimulationPackageMap>(GetTransientPackage());
+		return Connection;
+	};
+
+	// A net update of the channel for one connection, returns the bits written
+	auto SerializeForConnection = [&NetSerializeCB](FLyraVerbMessageReplication& Channel, const FViewer& ChannelViewer, FConnection& Connection) -> int64
+	{
+		FNetBitWriter Writer(Connection.PackageMap, 1024);
+		TSharedPtr<INetDeltaBaseState> NewState;
+
+		FNetDeltaSerializeInfo DeltaParms;
+		DeltaParms.Writer = &Writer;
+		DeltaParms.Map = Connection.PackageMap;
+		DeltaParms.OldState = Connection.AckedState.Get();
+		DeltaParms.NewState = &NewState;
+		DeltaParms.NetSerializeCB = &NetSerializeCB;
+		DeltaParms.Object = Connection.PackageMap;
+
+		Channel.SimulatedViewer = ChannelViewer;
+		Channel.NetDeltaSerialize(DeltaParms);
+		Channel.SimulatedViewer.Reset();
+
+		if (NewState.IsValid())
+		{
+			Connection.AckedState = NewState;
+		}
+
+		const int64 NumBits = Writer.GetNumBits();
+		Connection.BitsSent += NumBits;
+		return NumBits;
+	};
+
+	// What a client joining right now would be sent
+	auto GetLateJoinerBits = [&](FLyraVerbMessageReplication& Channel, const FViewer& ChannelViewer)
+	{
+		FConnection LateJoiner = MakeConnection();
+		return SerializeForConnection(Channel, ChannelViewer, LateJoiner);
+	};
+
+	FConnection UnboundedConnection = MakeConnection();
+	FConnection BoundedConnection = MakeConnection();
+	FConnection CoalescedConnection = MakeConnection();
+
+	auto AddToChannels = [&](const FLyraVerbMessage& Message, const FLyraVerbMessageRelevancyInfo& RelevancyInfo, double Now)
+	{
+		UnboundedChannel.AddMessageAtTime(Message, RelevancyInfo, Now);
+		BoundedChannel.AddMessageAtTime(Message, RelevancyInfo, Now);
+		CoalescedChannel.AddMessageAtTime(Message, RelevancyInfo, Now);
+		++Results.NumMessages;
+	};
+
+	// Eliminations go to everyone, assists to the teams involved, and a quarter of eliminations start a multi-kill streak
+	struct FPendingElimination
+	{
+		double Time;
+		int32 Instigator;
+	};
+	TArray<FPendingElimination> PendingEliminations;
+
+	const double StepSeconds = 0.1;
+	const double MatchSeconds = FMath::Max(MatchMinutes, 0.1f) * 60.0;
+	const double EliminationChancePerStep = (EliminationsPerMinute / 60.0) * StepSeconds;
+	const double ReportInterval = (MatchSeconds > 600.0) ? 300.0 : 60.0;
+	double NextReportTime = ReportInterval;
+
+	UE_CLOG(bLogProgress, LogLyra, Display, TEXT("Simulating %.1f minutes with %d players and %.1f eliminations per minute (MaxMessages %d, Lifetime %.1fs, CoalesceWindow %.1fs)"),
+		MatchSeconds / 60.0, NumPlayers, EliminationsPerMinute, LyraConsoleVariables::MaxReplicatedVerbMessages, LyraConsoleVariables::VerbMessageLifetime, LyraConsoleVariables::VerbMessageCoalesceWindow);
+
+	for (double Now = StepSeconds; Now <= MatchSeconds; Now += StepSeconds)
+	{
+		if (Random.FRand() < EliminationChancePerStep)
+		{
+			const int32 Instigator = Random.RandHelper(NumPlayers);
+			PendingEliminations.Add({ Now, Instigator });
+
+			if (Random.FRand() < 0.25f)
+			{
+				double StreakTime = Now;
+				const int32 StreakLength = Random.RandRange(1, 3);
+				for (int32 StreakIndex = 0; StreakIndex < StreakLength; ++StreakIndex)
+				{
+					StreakTime += Random.FRandRange(0.5f, 2.5f);
+					PendingEliminations.Add({ StreakTime, Instigator });
+				}
+			}
+		}
+
+		for (int32 Index = PendingEliminations.Num() - 1; Index >= 0; --Index)
+		{
+			if (PendingEliminations[Index].Time > Now)
+			{
+				continue;
+			}
+
+			const int32 Instigator = PendingEliminations[Index].Instigator;
+			PendingEliminations.RemoveAtSwap(Index);
+
+			// Someone on the other team
+			const int32 Target = (Instigator + 1 + 2 * Random.RandHelper(NumPlayers / 2)) % NumPlayers;
+
+			FLyraVerbMessage Elimination;
+			Elimination.Verb = TAG_Lyra_Elimination_Message;
+			Elimination.Instigator = Players[Instigator];
+			Elimination.Target = Players[Target];
+			AddToChannels(Elimination, FLyraVerbMessageRelevancyInfo(), Now);
+
+			if (Random.FRand() < 0.5f)
+			{
+				const int32 Assister = (Instigator + 2) % NumPlayers;
+
+				FLyraVerbMessage Assist;
+				Assist.Verb = TAG_Lyra_Assist_Message;
+				Assist.Instigator = Players[Assister];
+				Assist.Target = Players[Target];
+
+				FLyraVerbMessageRelevancyInfo AssistRelevancy;
+				AssistRelevancy.Relevancy = ELyraVerbMessageRelevancy::InvolvedTeams;
+				AssistRelevancy.InstigatorTeamId = GetTeam(Assister);
+				AssistRelevancy.TargetTeamId = GetTeam(Target);
+				AddToChannels(Assist, AssistRelevancy, Now);
+			}
+		}
+
+		Results.MaxBoundedEntries = FMath::Max(Results.MaxBoundedEntries, BoundedChannel.GetNumMessages());
+		Results.MaxCoalescedEntries = FMath::Max(Results.MaxCoalescedEntries, CoalescedChannel.GetNumMessages());
+
+		// Like a real channel, expired entries are only removed by the next message but are no longer sent
+		Viewer.Now = Now;
+		SerializeForConnection(UnboundedChannel, UnboundedViewer, UnboundedConnection);
+		SerializeForConnection(BoundedChannel, Viewer, BoundedConnection);
+		SerializeForConnection(CoalescedChannel, Viewer, CoalescedConnection);
+
+		if (bLogProgress && (Now >= NextReportTime))
+		{
+			NextReportTime += ReportInterval;
+
+			UE_LOG(LogLyra, Display, TEXT("  %5.1f min: unbounded %5d entries, %8.2f KB to a late joiner | bounded %3d entries, %6.2f KB | coalesced %3d entries, %6.2f KB"),
+				Now / 60.0,
+				UnboundedChannel.GetNumMessages(), GetLateJoinerBits(UnboundedChannel, UnboundedViewer) / 8192.0,
+				BoundedChannel.GetNumMessages(), GetLateJoinerBits(BoundedChannel, Viewer) / 8192.0,
+				CoalescedChannel.GetNumMessages(), GetLateJoinerBits(CoalescedChannel, Viewer) / 8192.0);
+		}
+	}
+
+	Results.UnboundedBitsSent = UnboundedConnection.BitsSent;
+	Results.BoundedBitsSent = BoundedConnection.BitsSent;
+	Results.CoalescedBitsSent = CoalescedConnection.BitsSent;
+	Results.UnboundedLateJoinerBits = GetLateJoinerBits(UnboundedChannel, UnboundedViewer);
+	Results.BoundedLateJoinerBits = GetLateJoinerBits(BoundedChannel, Viewer);
+	Results.CoalescedLateJoinerBits = GetLateJoinerBits(CoalescedChannel, Viewer);
+
+	UE_CLOG(bLogProgress, LogLyra, Display, TEXT("Serialized for one client over the match: unbounded %.2f KB, bounded %.2f KB, coalesced %.2f KB"),
+		Results.UnboundedBitsSent / 8192.0, Results.BoundedBitsSent / 8192.0, Results.CoalescedBitsSent / 8192.0);
+
+	return Results;
+}
+
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommand LyraVerbMessagesSimulateCmd(
+	TEXT("Lyra.VerbMessages.Simulate"),
+	TEXT("Runs a simulated match through the replicated verb message channel and logs its size and bandwidth. Usage: Lyra.VerbMessages.Simulate [Minutes=30] [EliminationsPerMinute=40]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		float MatchMinutes = 30.0f;
+		float EliminationsPerMinute = 40.0f;
+
+		if (Args.Num() > 0)
+		{
+			LexTryParseString(MatchMinutes, *Args[0]);
+		}
+		if (Args.Num() > 1)
+		{
+			LexTryParseString(EliminationsPerMinute, *Args[1]);
+		}
+
+		FLyraVerbMessageReplication::RunLongMatchSimulation(MatchMinutes, EliminationsPerMinute, /*bLogProgress=*/ true);
+	}));
+#endif // !UE_BUILD_SHIPPING
+
+//////////////////////////////////////////////////////////////////////
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLyraVerbMessageReplicationLongMatchTest, "Lyra.VerbMessages.LongMatch", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FLyraVerbMessageReplicationLongMatchTest::RunTest(const FString& Parameters)
+{
+	const FLyraVerbMessageReplication::FSimulationResults Results = FLyraVerbMessageReplication::RunLongMatchSimulation(/*MatchMinutes=*/ 30.0f, /*EliminationsPerMinute=*/ 40.0f, /*bLogProgress=*/ false);
+	const int32 MaxMessages = FMath::Max(LyraConsoleVariables::MaxReplicatedVerbMessages, 1);
+
+	TestTrue(TEXT("The match produced more messages than the channel holds"), Results.NumMessages > MaxMessages);
+	TestTrue(TEXT("The bounded channel never holds more than lyra.VerbMessages.MaxMessages"), Results.MaxBoundedEntries <= MaxMessages);
+	TestTrue(TEXT("The coalesced channel never holds more than lyra.VerbMessages.MaxMessages"), Results.MaxCoalescedEntries <= MaxMessages);
+	TestTrue(TEXT("Coalescing never needs more entries than the bounded channel"), Results.MaxCoalescedEntries <= Results.MaxBoundedEntries);
+
+	TestTrue(TEXT("Every channel sent something"), (Results.UnboundedBitsSent > 0) && (Results.BoundedBitsSent > 0) && (Results.CoalescedBitsSent > 0));
+	TestTrue(TEXT("A late joiner is sent less by the bounded channel than by the unbounded one"), Results.BoundedLateJoinerBits < Results.UnboundedLateJoinerBits);
+	TestTrue(TEXT("A late joiner is sent no more by the coalesced channel than by the bounded one"), Results.CoalescedLateJoinerBits <= Results.BoundedLateJoinerBits);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLyraVerbMessageReplicationRelevancyTest, "Lyra.VerbMessages.Relevancy", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FLyraVerbMessageReplicationRelevancyTest::RunTest(const FString& Parameters)
+{
+	UObject* NearConnection = NewObject<ULyraVerbMessageSimulationPackageMap>(GetTransientPackage());
+	UObject* FarConnection = NewObject<ULyraVerbMessageSimulationPackageMap>(GetTransientPackage());
+
+	FLyraVerbMessageReplication Channel;
+
+	FLyraVerbMessageRelevancyInfo RelevancyInfo;
+	RelevancyInfo.Relevancy = ELyraVerbMessageRelevancy::Nearby;
+	RelevancyInfo.Location = FVector::ZeroVector;
+	Channel.AddMessageAtTime(FLyraVerbMessage(), RelevancyInfo, /*Now=*/ 1.0);
+	const FLyraVerbMessageReplicationEntry& Entry = Channel.CurrentMessages[0];
+
+	const double OutOfRange = 2.0 * LyraConsoleVariables::VerbMessageProximityRadius;
+
+	auto IsWrittenFor = [&Channel, &Entry](UObject* Connection, const FVector& ViewLocation)
+	{
+		FLyraVerbMessageReplication::FViewer Viewer;
+		Viewer.Now = 1.0;
+		Viewer.Location = ViewLocation;
+		Viewer.bHasLocation = true;
+		Viewer.ConnectionKey = Connection;
+
+		Channel.CurrentViewer = Viewer;
+		const bool bWritten = Channel.ShouldWriteFastArrayItem<FLyraVerbMessageReplicationEntry, FLyraVerbMessageReplication>(Entry, /*bIsWritingOnClient=*/ false);
+		Channel.CurrentViewer = FLyraVerbMessageReplication::FViewer();
+		return bWritten;
+	};
+
+	TestTrue(TEXT("A Nearby message is written for a connection in range"), IsWrittenFor(NearConnection, FVector::ZeroVector));
+	TestTrue(TEXT("It stays written after that viewer moves out of range, so it isn't deleted and re-added"), IsWrittenFor(NearConnection, FVector(OutOfRange, 0.0, 0.0)));
+	TestFalse(TEXT("It isn't written for a connection out of range"), IsWrittenFor(FarConnection, FVector(OutOfRange, 0.0, 0.0)));
+	TestFalse(TEXT("That connection doesn't get it later by moving into range"), IsWrittenFor(FarConnection, FVector::ZeroVector));
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -5,6 +5,8 @@
 #include "GameplayTagContainer.h"
 #include "LyraVerbMessage.h"
 #include "Net/Serialization/FastArraySerializer.h"
+#include "UObject/CoreNet.h"
+#include "UObject/ObjectKey.h"
 
 #include "LyraVerbMessageReplication.generated.h"
 
@@ -12,6 +14,29 @@ class UObject;
 struct FLyraVerbMessageReplication;
 struct FNetDeltaSerializeInfo;
 
+/** Which connections a replicated verb message is sent to */
+UENUM()
+enum class ELyraVerbMessageRelevancy : uint8
+{
+	// Every connection
+	Everyone,
+
+	// Connections whose player is on the instigator's or the target's team
+	InvolvedTeams,
+
+	// Connections viewing from within lyra.VerbMessages.ProximityRadius of where the message happened
+	Nearby
+};
+
+/** Server side relevancy of one verb message, resolved when it is added */
+struct FLyraVerbMessageRelevancyInfo
+{
+	ELyraVerbMessageRelevancy Relevancy = ELyraVerbMessageRelevancy::Everyone;
+	int32 InstigatorTeamId = INDEX_NONE;
+	int32 TargetTeamId = INDEX_NONE;
+	FVector Location = FVector::ZeroVector;
+};
+
 /**
  * Represents one verb message
  */
@@ -35,9 +60,32 @@ private:
 
 	UPROPERTY()
 	FLyraVerbMessage Message;
+
+	// Server only, when the message was added (or last had another coalesced into it)
+	double ServerTime = 0.0;
+
+	// Server only, who the message is sent to
+	FLyraVerbMessageRelevancyInfo RelevancyInfo;
+
+	// Server only, whether the message is relevant to each connection (by package map). Decided the first time the entry is
+	// written for a connection and kept, so a viewer moving in and out of range doesn't get it deleted and re-added
+	mutable TMap<TObjectKey<UObject>, bool> RelevancyByConnection;
+
+	// Client only, the magnitude already broadcast for this entry. Coalesced updates only broadcast what was added since
+	double LastObservedMagnitude = 0.0;
 };
 
-/** Container of verb messages to replicate */
+/**
+ * Container of verb messages to replicate
+ *
+ * A bounded channel: at most lyra.VerbMessages.MaxMessages entries are kept, the oldest one being dropped once it is full,
+ * and entries older than lyra.VerbMessages.Lifetime stop being sent (they are removed when the next message is added), so
+ * late joiners only receive what is still recent. Each entry is only written to connections it is relevant to, and
+ * messages whose verb is in CoalescedVerbs are folded into the instigator's previous one while they keep coming within
+ * lyra.VerbMessages.CoalesceWindow, with Magnitude counting them (e.g. a multi-kill is one entry with Magnitude 3).
+ * Clients broadcast a coalesced update with only the added Magnitude, so listeners see each message once.
+ * Relevancy is decided once per connection, the first time an entry could be written for it.
+ */
 USTRUCT(BlueprintType)
 struct FLyraVerbMessageReplication : public FFastArraySerializer
 {
@@ -51,7 +99,32 @@ public:
 	void SetOwner(UObject* InOwner) { Owner = InOwner; }
 
 	// Broadcasts a message from server to clients
-	void AddMessage(const FLyraVerbMessage& Message);
+	void AddMessage(const FLyraVerbMessage& Message, ELyraVerbMessageRelevancy Relevancy = ELyraVerbMessageRelevancy::Everyone);
+
+	// Same as AddMessage, with the relevancy already resolved and an explicit server time
+	void AddMessageAtTime(const FLyraVerbMessage& Message, const FLyraVerbMessageRelevancyInfo& RelevancyInfo, double Now);
+
+	int32 GetNumMessages() const { return CurrentMessages.Num(); }
+
+	/** What RunLongMatchSimulation measured, bits are what NetDeltaSerialize actually wrote for one connection */
+	struct FSimulationResults
+	{
+		int32 NumMessages = 0;
+		int32 MaxBoundedEntries = 0;
+		int32 MaxCoalescedEntries = 0;
+
+		int64 UnboundedBitsSent = 0;
+		int64 BoundedBitsSent = 0;
+		int64 CoalescedBitsSent = 0;
+
+		// A full serialize for a connection that joins at the end of the match
+		int64 UnboundedLateJoinerBits = 0;
+		int64 BoundedLateJoinerBits = 0;
+		int64 CoalescedLateJoinerBits = 0;
+	};
+
+	// Simulates a long match's worth of messages through NetDeltaSerialize, comparing the array size and bits sent to an unbounded array
+	static FSimulationResults RunLongMatchSimulation(float MatchMinutes, float EliminationsPerMinute, bool bLogProgress);
 
 	//~FFastArraySerializer contract
 	void PreReplicatedRemove(const TArrayView<int32> RemovedIndices, int32 FinalSize);
@@ -59,12 +132,46 @@ public:
 	void PostReplicatedChange(const TArrayView<int32> ChangedIndices, int32 FinalSize);
 	//~End of FFastArraySerializer contract
 
-	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	template<typename Type, typename SerializerType>
+	bool ShouldWriteFastArrayItem(const Type& Item, const bool bIsWritingOnClient)
 	{
-		return FFastArraySerializer::FastArrayDeltaSerialize<FLyraVerbMessageReplicationEntry, FLyraVerbMessageReplication>(CurrentMessages, DeltaParms, *this);
+		if (bIsWritingOnClient)
+		{
+			return Item.ReplicationID != INDEX_NONE;
+		}
+
+		return IsRelevantToCurrentViewer(Item);
 	}
 
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
+
 private:
+	/** The connection the array is being written for */
+	struct FViewer
+	{
+		double Now = 0.0;
+		int32 TeamId = INDEX_NONE;
+		FVector Location = FVector::ZeroVector;
+		bool bHasTeam = false;
+		bool bHasLocation = false;
+
+		// The connection's package map, relevancy is remembered per connection when set
+		TObjectKey<UObject> ConnectionKey;
+	};
+
+	static bool IsExpired(const FLyraVerbMessageReplicationEntry& Entry, const FViewer& Viewer);
+	static bool IsRelevantToViewer(const FLyraVerbMessageReplicationEntry& Entry, const FViewer& Viewer);
+	bool IsRelevantToCurrentViewer(const FLyraVerbMessageReplicationEntry& Entry) const;
+
+	FLyraVerbMessageRelevancyInfo ResolveRelevancy(const FLyraVerbMessage& Message, ELyraVerbMessageRelevancy Relevancy) const;
+	FViewer ResolveViewer(const FNetDeltaSerializeInfo& DeltaParms) const;
+	bool TryCoalesceMessage(const FLyraVerbMessage& Message, const FLyraVerbMessageRelevancyInfo& RelevancyInfo, double Now);
+
+	// Removes the messages that have outlived lyra.VerbMessages.Lifetime
+	void PruneExpiredMessages(double Now);
+
+	double GetServerTime() const;
+
 	void RebroadcastMessage(const FLyraVerbMessage& Message);
 
 private:
@@ -75,6 +182,39 @@ private:
 	// Owner (for a route to a world)
 	UPROPERTY()
 	TObjectPtr<UObject> Owner = nullptr;
+
+	// Messages with these verbs (or child tags of them) get coalesced per instigator, set in the owner's defaults
+	UPROPERTY(EditDefaultsOnly, NotReplicated)
+	FGameplayTagContainer CoalescedVerbs;
+
+	// Only valid while NetDeltaSerialize is writing
+	FViewer CurrentViewer;
+
+	// RunLongMatchSimulation only: the viewer to write for instead of resolving it from the connection
+	TOptional<FViewer> SimulatedViewer;
+
+	// RunLongMatchSimulation only: never drop or expire messages, to compare against
+	bool bUnboundedForSimulation = false;
+
+	friend class FLyraVerbMessageReplicationRelevancyTest;
+};
+
+/**
+ * Stands in for a client's package map in FLyraVerbMessageReplication::RunLongMatchSimulation. Object references are
+ * written the way an already acknowledged NetGUID is, as a packed index, which is what they cost once a match is underway
+ */
+UCLASS(Transient)
+class ULyraVerbMessageSimulationPackageMap : public UPackageMap
+{
+	GENERATED_BODY()
+
+public:
+	//~UPackageMap interface
+	virtual bool SerializeObject(FArchive& Ar, UClass* InClass, UObject*& Obj, FNetworkGUID* OutNetGUID = nullptr) override;
+	//~End of UPackageMap interface
+
+private:
+	TMap<TObjectKey<UObject>, uint32> ObjectIndices;
 };
 
 template<>
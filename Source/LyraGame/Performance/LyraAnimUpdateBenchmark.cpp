@@ -0,0 +1,220 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Animation/LyraAnimInstance.h"
+#include "Character/LyraCharacter.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Containers/Ticker.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "LyraLogChannels.h"
+#include "Misc/App.h"
+
+//////////////////////////////////////////////////////////////////////
+// FLyraAnimUpdateBenchmark
+
+#if !UE_BUILD_SHIPPING
+
+/**
+ * Spawns N copies of a character in front of the player and measures frame and game thread times with the anim graphs
+ * updating on worker threads (NativeThreadSafeUpdateAnimation) and then all on the game thread (a.ParallelAnimUpdate 0).
+ */
+class FLyraAnimUpdateBenchmark
+{
+public:
+	static void Start(UWorld* World, int32 NumCharacters, int32 FramesPerPass);
+
+private:
+	struct FPassResult
+	{
+		double FrameMs = 0.0;
+		double GameThreadMs = 0.0;
+		int32 NumFrames = 0;
+	};
+
+	bool Tick(float DeltaTime);
+	void SetParallelAnimUpdate(bool bParallel);
+	void Finish();
+
+	TWeakObjectPtr<UWorld> World;
+	TArray<TWeakObjectPtr<AActor>> SpawnedCharacters;
+	FTSTicker::FDelegateHandle TickHandle;
+
+	int32 FramesPerPass = 0;
+	int32 WarmupFrames = 10;
+	int32 PassIndex = 0;
+	int32 FrameInPass = 0;
+	FPassResult Passes[2];
+
+	int32 OriginalParallelAnimUpdate = 1;
+
+	static TUniquePtr<FLyraAnimUpdateBenchmark> ActiveBenchmark;
+};
+
+TUniquePtr<FLyraAnimUpdateBenchmark> FLyraAnimUpdateBenchmark::ActiveBenchmark;
+
+void FLyraAnimUpdateBenchmark::Start(UWorld* InWorld, int32 NumCharacters, int32 InFramesPerPass)
+{
+	if (ActiveBenchmark.IsValid())
+	{
+		UE_LOG(LogLyra, Display, TEXT("Lyra.Anim.Benchmark: already running"));
+		return;
+	}
+
+	IConsoleVariable* ParallelAnimUpdateCVar = IConsoleManager::Get().FindConsoleVariable(TEXT("a.ParallelAnimUpdate"));
+	if ((InWorld == nullptr) || (ParallelAnimUpdateCVar == nullptr))
+	{
+		return;
+	}
+
+	// Copy the local player's character if there is one, otherwise any Lyra character with a Lyra anim instance
+	const ALyraCharacter* Template = nullptr;
+	if (const APlayerController* PC = InWorld->GetFirstPlayerController())
+	{
+		Template = Cast<ALyraCharacter>(PC->GetPawn());
+	}
+	for (TActorIterator<ALyraCharacter> It(InWorld); It && (Template == nullptr); ++It)
+	{
+		if (Cast<ULyraAnimInstance>(It->GetMesh()->GetAnimInstance()))
+		{
+			Template = *It;
+		}
+	}
+
+	if (Template == nullptr)
+	{
+		UE_LOG(LogLyra, Display, TEXT("Lyra.Anim.Benchmark: no Lyra character in the world to copy"));
+		return;
+	}
+
+	ActiveBenchmark = MakeUnique<FLyraAnimUpdateBenchmark>();
+	FLyraAnimUpdateBenchmark& Benchmark = *ActiveBenchmark;
+	Benchmark.World = InWorld;
+	Benchmark.FramesPerPass = InFramesPerPass;
+	Benchmark.OriginalParallelAnimUpdate = ParallelAnimUpdateCVar->GetInt();
+
+	// A grid in front of the template, far enough apart that they don't push each other around
+	const int32 GridSize = FMath::CeilToInt(FMath::Sqrt((float)NumCharacters));
+	const FVector Origin = Template->GetActorLocation() + Template->GetActorForwardVector() * 300.0;
+	for (int32 Index = 0; Index < NumCharacters; ++Index)
+	{
+		const FVector Location = Origin + FVector((Index / GridSize) * 150.0, ((Index % GridSize) - GridSize / 2) * 150.0, 0.0);
+
+		FActorSpawnParameters SpawnInfo;
+		SpawnInfo.ObjectFlags |= RF_Transient;
+		SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		if (ALyraCharacter* Character = InWorld->SpawnActor<ALyraCharacter>(Template->GetClass(), Location, Template->GetActorRotation(), SpawnInfo))
+		{
+			// Off screen ones would otherwise skip their update and flatter whichever pass they are hidden in
+			TInlineComponentArray<USkeletalMeshComponent*> Meshes(Character);
+			for (USkeletalMeshComponent* Mesh : Meshes)
+			{
+				Mesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+			}
+
+			Benchmark.SpawnedCharacters.Add(Character);
+		}
+	}
+
+	Benchmark.SetParallelAnimUpdate(true);
+	Benchmark.TickHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(&Benchmark, &FLyraAnimUpdateBenchmark::Tick), 0.0f);
+
+	UE_LOG(LogLyra, Display, TEXT("Lyra.Anim.Benchmark: spawned %d copies of %s, measuring %d frames with and without parallel anim update"),
+		Benchmark.SpawnedCharacters.Num(), *GetNameSafe(Template->GetClass()), InFramesPerPass);
+}
+
+void FLyraAnimUpdateBenchmark::SetParallelAnimUpdate(bool bParallel)
+{
+	if (IConsoleVariable* ParallelAnimUpdateCVar = IConsoleManager::Get().FindConsoleVariable(TEXT("a.ParallelAnimUpdate")))
+	{
+		ParallelAnimUpdateCVar->Set(bParallel ? 1 : 0, ECVF_SetByConsole);
+	}
+}
+
+bool FLyraAnimUpdateBenchmark::Tick(float DeltaTime)
+{
+	if (!World.IsValid())
+	{
+		Finish();
+		return false;
+	}
+
+	// Let the characters settle (and the cvar take effect) before measuring
+	++FrameInPass;
+	if (FrameInPass > WarmupFrames)
+	{
+		FPassResult& Pass = Passes[PassIndex];
+		Pass.FrameMs += FApp::GetDeltaTime() * 1000.0;
+		Pass.GameThreadMs += FPlatformTime::ToMilliseconds(GGameThreadTime);
+		++Pass.NumFrames;
+	}
+
+	if (FrameInPass >= (WarmupFrames + FramesPerPass))
+	{
+		if (PassIndex == 0)
+		{
+			PassIndex = 1;
+			FrameInPass = 0;
+			SetParallelAnimUpdate(false);
+		}
+		else
+		{
+			Finish();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void FLyraAnimUpdateBenchmark::Finish()
+{
+	if (IConsoleVariable* ParallelAnimUpdateCVar = IConsoleManager::Get().FindConsoleVariable(TEXT("a.ParallelAnimUpdate")))
+	{
+		ParallelAnimUpdateCVar->Set(OriginalParallelAnimUpdate, ECVF_SetByConsole);
+	}
+
+	for (const TWeakObjectPtr<AActor>& Character : SpawnedCharacters)
+	{
+		if (Character.IsValid())
+		{
+			Character->Destroy();
+		}
+	}
+
+	static const TCHAR* PassNames[] = { TEXT("worker threads"), TEXT("game thread") };
+	for (int32 Index = 0; Index < UE_ARRAY_COUNT(Passes); ++Index)
+	{
+		const FPassResult& Pass = Passes[Index];
+		const int32 NumFrames = FMath::Max(Pass.NumFrames, 1);
+		UE_LOG(LogLyra, Display, TEXT("  %d characters, anim update on %-14s: frame %.2f ms, game thread %.2f ms (%d frames)"),
+			SpawnedCharacters.Num(), PassNames[Index], Pass.FrameMs / NumFrames, Pass.GameThreadMs / NumFrames, Pass.NumFrames);
+	}
+
+	// Deleting ourselves, nothing can be touched after this
+	ActiveBenchmark.Reset();
+}
+
+static FAutoConsoleCommandWithWorldAndArgs LyraAnimBenchmarkCmd(
+	TEXT("Lyra.Anim.Benchmark"),
+	TEXT("Spawns copies of the player's character and compares frame times with anim graphs updating on worker threads vs the game thread. Usage: Lyra.Anim.Benchmark [NumCharacters=100] [Frames=300]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		int32 NumCharacters = 100;
+		int32 Frames = 300;
+
+		if (Args.Num() > 0)
+		{
+			LexTryParseString(NumCharacters, *Args[0]);
+		}
+		if (Args.Num() > 1)
+		{
+			LexTryParseString(Frames, *Args[1]);
+		}
+
+		FLyraAnimUpdateBenchmark::Start(World, FMath::Clamp(NumCharacters, 1, 1000), FMath::Max(Frames, 1));
+	}));
+
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,263 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "LyraHitchDetector.h"
+
+#include "AbilitySystem/LyraAbilitySystemComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "LyraLogChannels.h"
+#include "Misc/App.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Tasks/Task.h"
+#include "UObject/UObjectIterator.h"
+
+namespace LyraConsoleVariables
+{
+	static bool bEnableHitchDetector = false;
+	static FAutoConsoleVariableRef CVarEnableHitchDetector(
+		TEXT("lyra.Hitch.Enable"),
+		bEnableHitchDetector,
+		TEXT("Should frames that go over lyra.Hitch.BudgetMs write the recent frame timings, gameplay tags and actor counts to the profiling directory?"),
+		FConsoleVariableDelegate::CreateLambda([](IConsoleVariable* Variable)
+		{
+			FLyraHitchDetector::Get().SetEnabled(Variable->GetBool());
+		}),
+		ECVF_Default);
+
+	static float HitchBudgetMs = 50.0f;
+	static FAutoConsoleVariableRef CVarHitchBudgetMs(
+		TEXT("lyra.Hitch.BudgetMs"),
+		HitchBudgetMs,
+		TEXT("Frames longer than this (in milliseconds) count as hitches"),
+		ECVF_Default);
+
+	static int32 HitchFramesToKeep = 120;
+	static FAutoConsoleVariableRef CVarHitchFramesToKeep(
+		TEXT("lyra.Hitch.FramesToKeep"),
+		HitchFramesToKeep,
+		TEXT("Number of frames of timings written out with each hitch, the hitch frame included (applies when the detector is next enabled)"),
+		ECVF_Default);
+
+	static float HitchMinSecondsBetweenDumps = 10.0f;
+	static FAutoConsoleVariableRef CVarHitchMinSecondsBetweenDumps(
+		TEXT("lyra.Hitch.MinSecondsBetweenDumps"),
+		HitchMinSecondsBetweenDumps,
+		TEXT("Hitches closer together than this only write out the first one, so a bad patch doesn't flood the disk"),
+		ECVF_Default);
+}
+
+//////////////////////////////////////////////////////////////////////
+// FLyraHitchDetector
+
+FLyraHitchDetector& FLyraHitchDetector::Get()
+{
+	static FLyraHitchDetector Instance;
+	return Instance;
+}
+
+bool FLyraHitchDetector::IsEnabled()
+{
+	return LyraConsoleVariables::bEnableHitchDetector;
+}
+
+const TCHAR* FLyraHitchDetector::GetScopeName(ELyraHitchScope Scope)
+{
+	static_assert((int32)ELyraHitchScope::Count == 4, "Need to name new hitch scopes");
+
+	switch (Scope)
+	{
+	case ELyraHitchScope::AbilityActivation: return TEXT("AbilityActivation");
+	case ELyraHitchScope::DamageExecution: return TEXT("DamageExecution");
+	case ELyraHitchScope::ContextEffects: return TEXT("ContextEffects");
+	case ELyraHitchScope::IndicatorCanvas: return TEXT("IndicatorCanvas");
+	default: return TEXT("Unknown");
+	}
+}
+
+void FLyraHitchDetector::SetEnabled(bool bEnabled)
+{
+	if (bEnabled == EndFrameHandle.IsValid())
+	{
+		return;
+	}
+
+	if (bEnabled)
+	{
+		RecentFrames.Reset();
+		RecentFrames.SetNum(FMath::Max(LyraConsoleVariables::HitchFramesToKeep, 1));
+		NextFrameIndex = 0;
+		NumRecentFrames = 0;
+		CurrentFrame = FFrameTimings();
+		LastEndFrameTime = 0.0;
+
+		EndFrameHandle = FCoreDelegates::OnEndFrame.AddRaw(this, &FLyraHitchDetector::HandleEndFrame);
+	}
+	else
+	{
+		FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+		EndFrameHandle.Reset();
+		RecentFrames.Empty();
+	}
+}
+
+void FLyraHitchDetector::HandleEndFrame()
+{
+	const double Now = FPlatformTime::Seconds();
+
+	// The first frame after enabling has no start time to measure from
+	if (LastEndFrameTime > 0.0)
+	{
+		CurrentFrame.FrameNumber = GFrameCounter;
+		CurrentFrame.FrameTimeMs = (float)((Now - LastEndFrameTime) * 1000.0);
+		CurrentFrame.GameThreadTimeMs = (float)FPlatformTime::ToMilliseconds(GGameThreadTime);
+
+		RecentFrames[NextFrameIndex] = CurrentFrame;
+		NextFrameIndex = (NextFrameIndex + 1) % RecentFrames.Num();
+		NumRecentFrames = FMath::Min(NumRecentFrames + 1, RecentFrames.Num());
+
+		if ((CurrentFrame.FrameTimeMs > LyraConsoleVariables::HitchBudgetMs) && ((Now - LastDumpTime) >= LyraConsoleVariables::HitchMinSecondsBetweenDumps))
+		{
+			CSV_EVENT_GLOBAL(TEXT("Lyra Hitch %.1fms"), CurrentFrame.FrameTimeMs);
+			DumpRecentFrames(*FString::Printf(TEXT("Frame took %.2fms, budget is %.2fms"), CurrentFrame.FrameTimeMs, LyraConsoleVariables::HitchBudgetMs));
+		}
+	}
+
+	CurrentFrame = FFrameTimings();
+
+	// Don't count the time spent writing a dump against the next frame
+	LastEndFrameTime = FPlatformTime::Seconds();
+}
+
+FString FLyraHitchDetector::DumpRecentFrames(const TCHAR* Reason)
+{
+	LastDumpTime = FPlatformTime::Seconds();
+
+	FString Output;
+	Output.Reserve(256 + NumRecentFrames * 128);
+	Output += FString::Printf(TEXT("Lyra hitch report, frame %llu, %s\n"), (uint64)GFrameCounter, *FDateTime::Now().ToString());
+	Output += FString::Printf(TEXT("Reason: %s\n"), Reason);
+	Output += FString::Printf(TEXT("Build: %s\n\n"), FApp::GetBuildVersion());
+
+	// Frame timings, oldest first, as CSV so they can be pasted straight into a spreadsheet
+	Output += TEXT("Frame,FrameTimeMs,GameThreadTimeMs");
+	for (int32 ScopeIndex = 0; ScopeIndex < (int32)ELyraHitchScope::Count; ++ScopeIndex)
+	{
+		const TCHAR* ScopeName = GetScopeName((ELyraHitchScope)ScopeIndex);
+		Output += FString::Printf(TEXT(",%sMs,%sCalls"), ScopeName, ScopeName);
+	}
+	Output += TEXT("\n");
+
+	const int32 RingSize = RecentFrames.Num();
+	for (int32 Offset = NumRecentFrames; Offset > 0; --Offset)
+	{
+		const FFrameTimings& Frame = RecentFrames[(NextFrameIndex - Offset + RingSize) % RingSize];
+		Output += FString::Printf(TEXT("%llu,%.3f,%.3f"), Frame.FrameNumber, Frame.FrameTimeMs, Frame.GameThreadTimeMs);
+		for (int32 ScopeIndex = 0; ScopeIndex < (int32)ELyraHitchScope::Count; ++ScopeIndex)
+		{
+			Output += FString::Printf(TEXT(",%.3f,%u"), FPlatformTime::ToMilliseconds64(Frame.ScopeCycles[ScopeIndex]), Frame.ScopeCalls[ScopeIndex]);
+		}
+		Output += TEXT("\n");
+	}
+
+	if (GEngine)
+	{
+		for (const FWorldContext& Context : GEngine->GetWorldContexts())
+		{
+			const UWorld* World = Context.World();
+			if (World && World->IsGameWorld())
+			{
+				AppendWorldState(World, Output);
+			}
+		}
+	}
+
+	const FString OutputDir = FPaths::ProfilingDir() / TEXT("Hitches");
+	const FString Filename = OutputDir / FString::Printf(TEXT("Hitch_%s_%llu.txt"), *FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S")), (uint64)GFrameCounter);
+
+	// Gathering has to happen here, but the disk doesn't need to hold up the game thread
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [OutputDir, Filename, Output = MoveTemp(Output)]()
+	{
+		IFileManager::Get().MakeDirectory(*OutputDir, true);
+		FFileHelper::SaveStringToFile(Output, *Filename);
+	});
+
+	UE_LOG(LogLyra, Warning, TEXT("Hitch detected (%s), writing the last %d frames to %s"), Reason, NumRecentFrames, *Filename);
+
+	return Filename;
+}
+
+void FLyraHitchDetector::AppendWorldState(const UWorld* World, FString& Output) const
+{
+	Output += FString::Printf(TEXT("\nWorld %s (%s)\n"), *World->GetMapName(), (World->GetNetMode() == NM_Client) ? TEXT("client") : TEXT("server/standalone"));
+
+	// How many ability system components own each gameplay tag
+	TMap<FGameplayTag, int32> TagCounts;
+	int32 NumAbilitySystems = 0;
+	for (TObjectIterator<ULyraAbilitySystemComponent> It; It; ++It)
+	{
+		if (It->GetWorld() == World)
+		{
+			++NumAbilitySystems;
+
+			FGameplayTagContainer OwnedTags;
+			It->GetOwnedGameplayTags(OwnedTags);
+			for (const FGameplayTag& Tag : OwnedTags)
+			{
+				TagCounts.FindOrAdd(Tag)++;
+			}
+		}
+	}
+
+	TagCounts.ValueSort(TGreater<int32>());
+	Output += FString::Printf(TEXT("Gameplay tags owned across %d ability system components:\n"), NumAbilitySystems);
+	for (const TPair<FGameplayTag, int32>& Pair : TagCounts)
+	{
+		Output += FString::Printf(TEXT("  %5d  %s\n"), Pair.Value, *Pair.Key.ToString());
+	}
+
+	// Actor counts by class, the most common first
+	TMap<const UClass*, int32> ActorCounts;
+	int32 NumActors = 0;
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		++NumActors;
+		ActorCounts.FindOrAdd(It->GetClass())++;
+	}
+
+	ActorCounts.ValueSort(TGreater<int32>());
+	Output += FString::Printf(TEXT("%d actors:\n"), NumActors);
+	int32 NumClassesListed = 0;
+	for (const TPair<const UClass*, int32>& Pair : ActorCounts)
+	{
+		if (++NumClassesListed > 40)
+		{
+			Output += FString::Printf(TEXT("  ... and %d more classes\n"), ActorCounts.Num() - 40);
+			break;
+		}
+		Output += FString::Printf(TEXT("  %5d  %s\n"), Pair.Value, *Pair.Key->GetName());
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommand LyraHitchDumpCmd(
+	TEXT("Lyra.Hitch.Dump"),
+	TEXT("Writes the frames currently held by the hitch detector out as if a hitch had just happened (needs lyra.Hitch.Enable 1)"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		if (!FLyraHitchDetector::IsEnabled())
+		{
+			UE_LOG(LogLyra, Display, TEXT("Lyra.Hitch.Dump: the hitch detector is off, set lyra.Hitch.Enable 1 first"));
+			return;
+		}
+
+		FLyraHitchDetector::Get().DumpRecentFrames(TEXT("Requested from the console"));
+	}));
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,99 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "HAL/PlatformTime.h"
+
+class UWorld;
+
+/** Game code hot paths timed by the hitch detector, see LYRA_HITCH_SCOPE */
+enum class ELyraHitchScope : uint8
+{
+	AbilityActivation,
+	DamageExecution,
+	ContextEffects,
+	IndicatorCanvas,
+
+	Count
+};
+
+/**
+ * FLyraHitchDetector
+ *
+ * Keeps the last few frames of timings for the scopes in ELyraHitchScope. When a frame goes over lyra.Hitch.BudgetMs the
+ * recent frames are written to the profiling directory along with the gameplay tags and actor counts of the game worlds,
+ * so spikes seen in the field can be looked into without an Insights capture.
+ *
+ * Off by default, enable with lyra.Hitch.Enable. Timings are only gathered on the game thread.
+ */
+class FLyraHitchDetector
+{
+public:
+	static FLyraHitchDetector& Get();
+
+	static bool IsEnabled();
+
+	/** Starts or stops watching frames, driven by lyra.Hitch.Enable */
+	void SetEnabled(bool bEnabled);
+
+	/** Adds time spent in a scope to the current frame */
+	void AddScopeTime(ELyraHitchScope Scope, uint64 Cycles)
+	{
+		CurrentFrame.ScopeCycles[(int32)Scope] += Cycles;
+		CurrentFrame.ScopeCalls[(int32)Scope]++;
+	}
+
+	/** Writes the recent frames out now, returns the file written to */
+	FString DumpRecentFrames(const TCHAR* Reason);
+
+	static const TCHAR* GetScopeName(ELyraHitchScope Scope);
+
+private:
+	struct FFrameTimings
+	{
+		uint64 FrameNumber = 0;
+		float FrameTimeMs = 0.0f;
+		float GameThreadTimeMs = 0.0f;
+		uint64 ScopeCycles[(int32)ELyraHitchScope::Count] = {};
+		uint32 ScopeCalls[(int32)ELyraHitchScope::Count] = {};
+	};
+
+	void HandleEndFrame();
+
+	void AppendWorldState(const UWorld* World, FString& Output) const;
+
+	FFrameTimings CurrentFrame;
+
+	TArray<FFrameTimings> RecentFrames;
+	int32 NextFrameIndex = 0;
+	int32 NumRecentFrames = 0;
+
+	double LastEndFrameTime = 0.0;
+	double LastDumpTime = 0.0;
+
+	FDelegateHandle EndFrameHandle;
+};
+
+/** Times the enclosing scope for the hitch detector, when it is enabled and on the game thread */
+struct FLyraHitchScope
+{
+	explicit FLyraHitchScope(ELyraHitchScope InScope)
+		: Scope(InScope)
+		, StartCycles((FLyraHitchDetector::IsEnabled() && IsInGameThread()) ? FPlatformTime::Cycles64() : 0)
+	{
+	}
+
+	~FLyraHitchScope()
+	{
+		if (StartCycles != 0)
+		{
+			FLyraHitchDetector::Get().AddScopeTime(Scope, FPlatformTime::Cycles64() - StartCycles);
+		}
+	}
+
+private:
+	ELyraHitchScope Scope;
+	uint64 StartCycles;
+};
+
+#define LYRA_HITCH_SCOPE(ScopeName) FLyraHitchScope PREPROCESSOR_JOIN(LyraHitchScope_, __LINE__)(ELyraHitchScope::ScopeName)
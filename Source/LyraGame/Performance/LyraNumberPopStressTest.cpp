@@ -0,0 +1,178 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Camera/PlayerCameraManager.h"
+#include "Containers/Ticker.h"
+#include "Engine/World.h"
+#include "Feedback/NumberPops/LyraNumberPopComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "GameplayTagsManager.h"
+#include "HAL/IConsoleManager.h"
+#include "LyraLogChannels.h"
+
+//////////////////////////////////////////////////////////////////////
+// FLyraNumberPopStressTest
+
+#if !UE_BUILD_SHIPPING
+
+/**
+ * Bursts number pops in front of the local player's camera at a fixed rate and measures what AddNumberPop costs on the
+ * game thread, along with how many components the number pops leave on their controller.
+ */
+class FLyraNumberPopStressTest
+{
+public:
+	static void Start(UWorld* World, int32 PopsPerSecond, float Seconds, const FGameplayTag& TargetTag);
+
+private:
+	bool Tick(float DeltaTime);
+	void AddPop();
+	void Finish();
+
+	TWeakObjectPtr<ULyraNumberPopComponent> NumberPopComponent;
+	FTSTicker::FDelegateHandle TickHandle;
+	FGameplayTagContainer TargetTags;
+
+	double PopsPerSecond = 0.0;
+	double PopsOwed = 0.0;
+	double TimeRemaining = 0.0;
+
+	int32 NumPops = 0;
+	uint64 TotalCycles = 0;
+	uint64 MaxPopCycles = 0;
+	uint64 MaxFrameCycles = 0;
+	int32 NumComponentsBefore = 0;
+
+	static TUniquePtr<FLyraNumberPopStressTest> ActiveTest;
+};
+
+TUniquePtr<FLyraNumberPopStressTest> FLyraNumberPopStressTest::ActiveTest;
+
+void FLyraNumberPopStressTest::Start(UWorld* World, int32 InPopsPerSecond, float Seconds, const FGameplayTag& TargetTag)
+{
+	if (ActiveTest.IsValid())
+	{
+		UE_LOG(LogLyra, Display, TEXT("Lyra.NumberPops.Stress: already running"));
+		return;
+	}
+
+	APlayerController* PC = (World != nullptr) ? World->GetFirstPlayerController() : nullptr;
+	ULyraNumberPopComponent* Component = (PC != nullptr) ? PC->FindComponentByClass<ULyraNumberPopComponent>() : nullptr;
+	if (Component == nullptr)
+	{
+		UE_LOG(LogLyra, Display, TEXT("Lyra.NumberPops.Stress: the local player controller has no number pop component"));
+		return;
+	}
+
+	ActiveTest = MakeUnique<FLyraNumberPopStressTest>();
+	FLyraNumberPopStressTest& Test = *ActiveTest;
+	Test.NumberPopComponent = Component;
+	Test.PopsPerSecond = InPopsPerSecond;
+	Test.TimeRemaining = Seconds;
+	Test.NumComponentsBefore = PC->GetComponents().Num();
+	if (TargetTag.IsValid())
+	{
+		Test.TargetTags.AddTag(TargetTag);
+	}
+
+	Test.TickHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(&Test, &FLyraNumberPopStressTest::Tick), 0.0f);
+
+	UE_LOG(LogLyra, Display, TEXT("Lyra.NumberPops.Stress: adding %d pops per second for %.1f seconds with %s"),
+		InPopsPerSecond, Seconds, *GetNameSafe(Component->GetClass()));
+}
+
+bool FLyraNumberPopStressTest::Tick(float DeltaTime)
+{
+	if (!NumberPopComponent.IsValid() || (TimeRemaining <= 0.0))
+	{
+		Finish();
+		return false;
+	}
+
+	TimeRemaining -= DeltaTime;
+	PopsOwed += PopsPerSecond * DeltaTime;
+
+	// Everything owed this frame goes in at once, which is what a burst of hits looks like
+	const uint64 FrameStartCycles = FPlatformTime::Cycles64();
+	while (PopsOwed >= 1.0)
+	{
+		AddPop();
+		PopsOwed -= 1.0;
+	}
+	MaxFrameCycles = FMath::Max(MaxFrameCycles, FPlatformTime::Cycles64() - FrameStartCycles);
+
+	return true;
+}
+
+void FLyraNumberPopStressTest::AddPop()
+{
+	ULyraNumberPopComponent* Component = NumberPopComponent.Get();
+
+	FLyraNumberPopRequest Request;
+	Request.TargetTags = TargetTags;
+	Request.NumberToDisplay = FMath::RandRange(1, 9999);
+	Request.bIsCriticalDamage = FMath::FRand() < 0.1f;
+
+	// Somewhere in a box in front of the camera, so the pops are actually drawn
+	if (APlayerController* PC = Component->GetController<APlayerController>())
+	{
+		if (APlayerCameraManager* PlayerCameraManager = PC->PlayerCameraManager)
+		{
+			const FVector BoxCenter = PlayerCameraManager->GetCameraLocation() + PlayerCameraManager->GetCameraRotation().Vector() * 800.0;
+			Request.WorldLocation = FMath::RandPointInBox(FBox(BoxCenter - FVector(300.0), BoxCenter + FVector(300.0)));
+		}
+	}
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	Component->AddNumberPop(Request);
+	const uint64 PopCycles = FPlatformTime::Cycles64() - StartCycles;
+
+	TotalCycles += PopCycles;
+	MaxPopCycles = FMath::Max(MaxPopCycles, PopCycles);
+	++NumPops;
+}
+
+void FLyraNumberPopStressTest::Finish()
+{
+	if (const ULyraNumberPopComponent* Component = NumberPopComponent.Get())
+	{
+		const int32 NumComponentsAfter = (Component->GetOwner() != nullptr) ? Component->GetOwner()->GetComponents().Num() : 0;
+
+		UE_LOG(LogLyra, Display, TEXT("Lyra.NumberPops.Stress: %d pops, AddNumberPop avg %.2f us, max %.2f us, worst frame %.3f ms, controller components %d -> %d"),
+			NumPops,
+			FPlatformTime::ToMilliseconds64(TotalCycles) * 1000.0 / FMath::Max(NumPops, 1),
+			FPlatformTime::ToMilliseconds64(MaxPopCycles) * 1000.0,
+			FPlatformTime::ToMilliseconds64(MaxFrameCycles),
+			NumComponentsBefore, NumComponentsAfter);
+	}
+
+	// Deleting ourselves, nothing can be touched after this
+	ActiveTest.Reset();
+}
+
+static FAutoConsoleCommandWithWorldAndArgs LyraNumberPopStressCmd(
+	TEXT("Lyra.NumberPops.Stress"),
+	TEXT("Adds number pops in front of the local player's camera at a fixed rate and logs the cost of AddNumberPop. Usage: Lyra.NumberPops.Stress [PopsPerSecond=1000] [Seconds=5] [TargetTag]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		int32 PopsPerSecond = 1000;
+		float Seconds = 5.0f;
+		FGameplayTag TargetTag;
+
+		if (Args.Num() > 0)
+		{
+			LexTryParseString(PopsPerSecond, *Args[0]);
+		}
+		if (Args.Num() > 1)
+		{
+			LexTryParseString(Seconds, *Args[1]);
+		}
+		if (Args.Num() > 2)
+		{
+			// The styles pick a mesh from the target tags, and no pop is shown without one
+			TargetTag = UGameplayTagsManager::Get().RequestGameplayTag(FName(*Args[2]), /*ErrorIfNotFound=*/ false);
+		}
+
+		FLyraNumberPopStressTest::Start(World, FMath::Max(PopsPerSecond, 1), FMath::Max(Seconds, 0.1f), TargetTag);
+	}));
+
+#endif // !UE_BUILD_SHIPPING
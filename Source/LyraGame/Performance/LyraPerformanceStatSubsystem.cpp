@@ -7,9 +7,11 @@
 #include "Engine/NetConnection.h"
 #include "Engine/World.h"
 #include "GameFramework/PlayerState.h"
+#include "HAL/IConsoleManager.h"
 #include "GameModes/LyraGameState.h"
 #include "Performance/LyraPerformanceStatTypes.h"
 #include "Performance/LatencyMarkerModule.h"
+#include "LyraLogChannels.h"
 #include "ProfilingDebugging/CsvProfiler.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(LyraPerformanceStatSubsystem)
@@ -18,15 +20,223 @@ CSV_DEFINE_CATEGORY(LyraPerformance, /*bIsEnabledByDefault=*/false);
 
 class FSubsystemCollectionBase;
 
+namespace LyraConsoleVariables
+{
+	static int32 PerformanceStatSampleSize = 125;
+	static FAutoConsoleVariableRef CVarPerformanceStatSampleSize(
+		TEXT("lyra.PerfStats.SampleSize"),
+		PerformanceStatSampleSize,
+		TEXT("How many frames of each performance stat are kept for the averages, percentiles and graphs. Changing it clears the recorded samples."),
+		ECVF_Default);
+}
+
+//////////////////////////////////////////////////////////////////////
+// FSampledStatCache
+
+FSampledStatCache::FSampledStatCache(const int32 InSampleSize, const FHistogramRange& InHistogramRange)
+	: HistogramRange(InHistogramRange)
+{
+	check(HistogramRange.Min > 0.0 && HistogramRange.Max > HistogramRange.Min && HistogramRange.NumBuckets > 0);
+
+	HistogramLogMin = FMath::Loge(HistogramRange.Min);
+	HistogramBucketsPerLog = HistogramRange.NumBuckets / (FMath::Loge(HistogramRange.Max) - HistogramLogMin);
+
+	Reset(InSampleSize);
+}
+
+void FSampledStatCache::FSampleNumberQueue::Reset(const int32 Capacity)
+{
+	Numbers.SetNumUninitialized(Capacity);
+	Head = 0;
+	Num = 0;
+}
+
+void FSampledStatCache::Reset(const int32 InSampleSize)
+{
+	check(InSampleSize > 0);
+
+	SampleSize = InSampleSize;
+	CurrentSampleIndex = 0;
+	NumSamplesRecorded = 0;
+	RunningSum = 0.0;
+
+	Samples.Reset();
+	Samples.AddZeroed(SampleSize);
+
+	MinQueue.Reset(SampleSize);
+	MaxQueue.Reset(SampleSize);
+
+	HistogramCounts.Reset();
+	HistogramCounts.AddZeroed(HistogramRange.NumBuckets);
+}
+
+void FSampledStatCache::RecordSample(const double Sample)
+{
+	const uint64 SampleNumber = NumSamplesRecorded;
+
+	// Forget the sample falling out of the window
+	if (NumSamplesRecorded >= (uint64)SampleSize)
+	{
+		const double OldSample = Samples[CurrentSampleIndex];
+		RunningSum -= OldSample;
+		HistogramCounts[GetBucketIndex(OldSample)]--;
+	}
+
+	// A simple little ring buffer for storing the samples over time
+	Samples[CurrentSampleIndex] = Sample;
+	RunningSum += Sample;
+	HistogramCounts[GetBucketIndex(Sample)]++;
+	++NumSamplesRecorded;
+
+	CurrentSampleIndex++;
+	if (CurrentSampleIndex >= Samples.Num())
+	{
+		CurrentSampleIndex = 0u;
+
+		// Re-sum once per lap so rounding errors from the running sum can't build up
+		RunningSum = 0.0;
+		for (const double WindowSample : Samples)
+		{
+			RunningSum += WindowSample;
+		}
+	}
+
+	// The queues only keep samples that could still become the min or max once older ones leave the window
+	const uint64 OldestSampleNumber = (NumSamplesRecorded > (uint64)SampleSize) ? (NumSamplesRecorded - SampleSize) : 0;
+
+	while ((MinQueue.Num > 0) && (GetSampleByNumber(MinQueue.Back()) >= Sample))
+	{
+		MinQueue.PopBack();
+	}
+	while ((MinQueue.Num > 0) && (MinQueue.Front() < OldestSampleNumber))
+	{
+		MinQueue.PopFront();
+	}
+	MinQueue.PushBack(SampleNumber);
+
+	while ((MaxQueue.Num > 0) && (GetSampleByNumber(MaxQueue.Back()) <= Sample))
+	{
+		MaxQueue.PopBack();
+	}
+	while ((MaxQueue.Num > 0) && (MaxQueue.Front() < OldestSampleNumber))
+	{
+		MaxQueue.PopFront();
+	}
+	MaxQueue.PushBack(SampleNumber);
+}
+
+double FSampledStatCache::GetPercentile(const double Percentile) const
+{
+	const int32 NumRecorded = GetNumRecordedSamples();
+	if (NumRecorded == 0)
+	{
+		return 0.0;
+	}
+
+	// Walk the buckets until we reach the sample at the requested rank, then interpolate within that bucket
+	const double TargetRank = FMath::Clamp(Percentile, 0.0, 100.0) * 0.01 * NumRecorded;
+	int32 CountBelow = 0;
+	for (int32 BucketIndex = 0; BucketIndex < HistogramCounts.Num(); ++BucketIndex)
+	{
+		const int32 BucketCount = HistogramCounts[BucketIndex];
+		if ((BucketCount > 0) && ((CountBelow + BucketCount) >= TargetRank))
+		{
+			const double Alpha = FMath::Clamp((TargetRank - CountBelow) / BucketCount, 0.0, 1.0);
+			const double Value = FMath::Lerp(GetBucketLowerBound(BucketIndex), GetBucketLowerBound(BucketIndex + 1), Alpha);
+
+			// The end buckets are open ended, and the exact min and max are known anyway
+			return FMath::Clamp(Value, GetMin(), GetMax());
+		}
+		CountBelow += BucketCount;
+	}
+
+	return GetMax();
+}
+
+int32 FSampledStatCache::GetBucketIndex(const double Sample) const
+{
+	if (Sample <= HistogramRange.Min)
+	{
+		return 0;
+	}
+
+	const int32 BucketIndex = FMath::FloorToInt32((FMath::Loge(Sample) - HistogramLogMin) * HistogramBucketsPerLog);
+	return FMath::Clamp(BucketIndex, 0, HistogramRange.NumBuckets - 1);
+}
+
+double FSampledStatCache::GetBucketLowerBound(const int32 BucketIndex) const
+{
+	return FMath::Exp(HistogramLogMin + (BucketIndex / HistogramBucketsPerLog));
+}
+
 //////////////////////////////////////////////////////////////////////
 // FLyraPerformanceStatCache
 
+static FSampledStatCache::FHistogramRange GetHistogramRangeForStat(const ELyraDisplayablePerformanceStat Stat)
+{
+	static_assert((int32)ELyraDisplayablePerformanceStat::Count == 18, "Need to update this function to deal with new performance stats");
+
+	switch (Stat)
+	{
+	case ELyraDisplayablePerformanceStat::ClientFPS:
+	case ELyraDisplayablePerformanceStat::ServerFPS:
+		return { 1.0, 1000.0, 128 };
+	case ELyraDisplayablePerformanceStat::IdleTime:
+	case ELyraDisplayablePerformanceStat::FrameTime:
+	case ELyraDisplayablePerformanceStat::FrameTime_GameThread:
+	case ELyraDisplayablePerformanceStat::FrameTime_RenderThread:
+	case ELyraDisplayablePerformanceStat::FrameTime_RHIThread:
+	case ELyraDisplayablePerformanceStat::FrameTime_GPU:
+		// Seconds, 0.1ms to 2s
+		return { 0.0001, 2.0, 128 };
+	case ELyraDisplayablePerformanceStat::Ping:
+	case ELyraDisplayablePerformanceStat::Latency_Total:
+	case ELyraDisplayablePerformanceStat::Latency_Game:
+	case ELyraDisplayablePerformanceStat::Latency_Render:
+		// Milliseconds
+		return { 0.1, 5000.0, 128 };
+	case ELyraDisplayablePerformanceStat::PacketLoss_Incoming:
+	case ELyraDisplayablePerformanceStat::PacketLoss_Outgoing:
+		return { 0.01, 100.0, 64 };
+	case ELyraDisplayablePerformanceStat::PacketRate_Incoming:
+	case ELyraDisplayablePerformanceStat::PacketRate_Outgoing:
+		return { 1.0, 10000.0, 64 };
+	case ELyraDisplayablePerformanceStat::PacketSize_Incoming:
+	case ELyraDisplayablePerformanceStat::PacketSize_Outgoing:
+		return { 1.0, 65536.0, 64 };
+	default:
+		return FSampledStatCache::FHistogramRange();
+	}
+}
+
+FLyraPerformanceStatCache::FLyraPerformanceStatCache(ULyraPerformanceStatSubsystem* InSubsystem)
+	: MySubsystem(InSubsystem)
+{
+	const int32 SampleSize = FMath::Max(LyraConsoleVariables::PerformanceStatSampleSize, 1);
+
+	PerfStateCache.Reserve((int32)ELyraDisplayablePerformanceStat::Count);
+	for (ELyraDisplayablePerformanceStat Stat : TEnumRange<ELyraDisplayablePerformanceStat>())
+	{
+		PerfStateCache.Emplace(SampleSize, GetHistogramRangeForStat(Stat));
+	}
+}
+
 void FLyraPerformanceStatCache::StartCharting()
 {
 }
 
 void FLyraPerformanceStatCache::ProcessFrame(const FFrameData& FrameData)
 {
+	// Pick up changes to the sample size
+	const int32 SampleSize = FMath::Max(LyraConsoleVariables::PerformanceStatSampleSize, 1);
+	if (PerfStateCache[0].GetSampleSize() != SampleSize)
+	{
+		for (FSampledStatCache& Cache : PerfStateCache)
+		{
+			Cache.Reset(SampleSize);
+		}
+	}
+
 	// Record stats about the frame data
 	{
 		RecordStat(
@@ -130,7 +340,7 @@ void FLyraPerformanceStatCache::StopCharting()
 
 void FLyraPerformanceStatCache::RecordStat(const ELyraDisplayablePerformanceStat Stat, const double Value)
 {
-	PerfStateCache.FindOrAdd(Stat).RecordSample(Value);
+	PerfStateCache[(int32)Stat].RecordSample(Value);
 }
 
 double FLyraPerformanceStatCache::GetCachedStat(ELyraDisplayablePerformanceStat Stat) const
@@ -149,7 +359,9 @@ const FSampledStatCache* FLyraPerformanceStatCache::GetCachedStatData(const ELyr
 {
 	static_assert((int32)ELyraDisplayablePerformanceStat::Count == 18, "Need to update this function to deal with new performance stats");
 	
-	return PerfStateCache.Find(Stat);
+	// Stats that have never been recorded (e.g. latency without a latency marker module) have no data
+	const FSampledStatCache& Cache = PerfStateCache[(int32)Stat];
+	return (Cache.GetNumRecordedSamples() > 0) ? &Cache : nullptr;
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -172,8 +384,45 @@ double ULyraPerformanceStatSubsystem::GetCachedStat(ELyraDisplayablePerformanceS
 	return Tracker->GetCachedStat(Stat);
 }
 
+double ULyraPerformanceStatSubsystem::GetCachedStatPercentile(ELyraDisplayablePerformanceStat Stat, double Percentile) const
+{
+	if (const FSampledStatCache* Cache = GetCachedStatData(Stat))
+	{
+		return Cache->GetPercentile(Percentile);
+	}
+
+	return 0.0;
+}
+
 const FSampledStatCache* ULyraPerformanceStatSubsystem::GetCachedStatData(const ELyraDisplayablePerformanceStat Stat) const
 {
 	return Tracker->GetCachedStatData(Stat);
 }
 
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommandWithWorld LyraDumpPerfStatsCmd(
+	TEXT("Lyra.PerfStats.Dump"),
+	TEXT("Logs the average, min, max and P50/P95/P99 of every recorded performance stat over the current sample window (see lyra.PerfStats.SampleSize)"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		const UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+		const ULyraPerformanceStatSubsystem* Subsystem = GameInstance ? GameInstance->GetSubsystem<ULyraPerformanceStatSubsystem>() : nullptr;
+		if (Subsystem == nullptr)
+		{
+			return;
+		}
+
+		for (ELyraDisplayablePerformanceStat Stat : TEnumRange<ELyraDisplayablePerformanceStat>())
+		{
+			if (const FSampledStatCache* Cache = Subsystem->GetCachedStatData(Stat))
+			{
+				UE_LOG(LogLyra, Display, TEXT("%-24s avg %10.4f  min %10.4f  max %10.4f  p50 %10.4f  p95 %10.4f  p99 %10.4f  (%d samples)"),
+					*StaticEnum<ELyraDisplayablePerformanceStat>()->GetNameStringByValue((int64)Stat),
+					Cache->GetAverage(), Cache->GetMin(), Cache->GetMax(),
+					Cache->GetPercentile(50.0), Cache->GetPercentile(95.0), Cache->GetPercentile(99.0),
+					Cache->GetNumRecordedSamples());
+			}
+		}
+	}));
+#endif // !UE_BUILD_SHIPPING
+
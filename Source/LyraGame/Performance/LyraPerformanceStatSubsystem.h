@@ -4,8 +4,6 @@
 
 #include "ChartCreation.h"
 #include "LyraPerformanceStatTypes.h"
-#include "Algo/MaxElement.h"
-#include "Algo/MinElement.h"
 #include "Stats/StatsData.h"
 #include "Subsystems/GameInstanceSubsystem.h"
 
@@ -20,32 +18,29 @@ struct FFrame;
 
 /**
  * Stores a buffer of the given sample size and provides an interface to get data
- * like the min, max, and average of that group.
+ * like the min, max, average and percentiles of that group.
+ *
+ * The sum, min and max are maintained as samples come and go, so reading them is O(1). Percentiles come from a
+ * fixed size histogram of the samples in the buffer, so they are approximate but cost the same for any sample size.
  */
 class FSampledStatCache
 {
 public:
 
-	FSampledStatCache(const int32 InSampleSize = 125)
-		: SampleSize(InSampleSize)
+	/** Histogram buckets are spaced logarithmically between Min and Max, samples outside the range land in the end buckets */
+	struct FHistogramRange
 	{
-		check(InSampleSize > 0);
-		
-		Samples.Empty();
-		Samples.AddZeroed(SampleSize);
-	}
+		double Min = 0.001;
+		double Max = 10000.0;
+		int32 NumBuckets = 128;
+	};
+
+	FSampledStatCache(const int32 InSampleSize = 125, const FHistogramRange& InHistogramRange = FHistogramRange());
 		
-	void RecordSample(const double Sample)
-	{
-		// A simple little ring buffer for storing the samples over time
-		Samples[CurrentSampleIndex] = Sample;
-	
-		CurrentSampleIndex++;
-		if (CurrentSampleIndex >= Samples.Num())
-		{
-			CurrentSampleIndex = 0u;
-		}
-	}
+	void RecordSample(const double Sample);
+
+	/** Throws away every sample and changes the number kept */
+	void Reset(const int32 InSampleSize);
 
 	double GetCurrentCachedStat() const
 	{
@@ -87,34 +82,73 @@ public:
 		return SampleSize;
 	}
 
-	inline double GetAverage() const
+	/** How many of the samples have actually been recorded, the rest of the buffer is still zero */
+	inline int32 GetNumRecordedSamples() const
 	{
-		double Sum = 0.0;
-		ForEachCurrentSample([&Sum](const double Stat)
-		{
-			Sum += Stat;
-		});
+		return (int32)FMath::Min<uint64>(NumSamplesRecorded, (uint64)SampleSize);
+	}
 
-		// Return the average stat value
-		return Sum / static_cast<double>(SampleSize);
+	inline double GetAverage() const
+	{
+		const int32 NumRecorded = GetNumRecordedSamples();
+		return (NumRecorded > 0) ? (RunningSum / static_cast<double>(NumRecorded)) : 0.0;
 	}
 
 	inline double GetMin() const
 	{
-		return *Algo::MinElement(Samples);
+		return (MinQueue.Num > 0) ? GetSampleByNumber(MinQueue.Front()) : 0.0;
 	}
 
 	inline double GetMax() const
 	{
-		return *Algo::MaxElement(Samples);
+		return (MaxQueue.Num > 0) ? GetSampleByNumber(MaxQueue.Front()) : 0.0;
 	}
+
+	/** Returns the given percentile (0 to 100) of the recorded samples, accurate to within a histogram bucket */
+	double GetPercentile(const double Percentile) const;
 		
 private:
-	const int32 SampleSize = 125;
+	/** Sample numbers in a fixed size ring, used as a monotonic queue for the running min and max */
+	struct FSampleNumberQueue
+	{
+		TArray<uint64> Numbers;
+		int32 Head = 0;
+		int32 Num = 0;
+
+		void Reset(const int32 Capacity);
+		uint64 Front() const { return Numbers[Head]; }
+		uint64 Back() const { return Numbers[(Head + Num - 1) % Numbers.Num()]; }
+		void PopFront() { Head = (Head + 1) % Numbers.Num(); --Num; }
+		void PopBack() { --Num; }
+		void PushBack(const uint64 SampleNumber) { Numbers[(Head + Num) % Numbers.Num()] = SampleNumber; ++Num; }
+	};
+
+	double GetSampleByNumber(const uint64 SampleNumber) const
+	{
+		return Samples[(int32)(SampleNumber % (uint64)SampleSize)];
+	}
+
+	int32 GetBucketIndex(const double Sample) const;
+	double GetBucketLowerBound(const int32 BucketIndex) const;
+
+	int32 SampleSize = 125;
 
 	int32 CurrentSampleIndex = 0;
 	
 	TArray<double> Samples;
+
+	uint64 NumSamplesRecorded = 0;
+
+	double RunningSum = 0.0;
+
+	// Candidates for the min (increasing values) and max (decreasing values) of the window, oldest first
+	FSampleNumberQueue MinQueue;
+	FSampleNumberQueue MaxQueue;
+
+	FHistogramRange HistogramRange;
+	double HistogramLogMin = 0.0;
+	double HistogramBucketsPerLog = 1.0;
+	TArray<int32> HistogramCounts;
 };
 
 //////////////////////////////////////////////////////////////////////
@@ -123,10 +157,7 @@ private:
 struct FLyraPerformanceStatCache : public IPerformanceDataConsumer
 {
 public:
-	FLyraPerformanceStatCache(ULyraPerformanceStatSubsystem* InSubsystem)
-		: MySubsystem(InSubsystem)
-	{
-	}
+	FLyraPerformanceStatCache(ULyraPerformanceStatSubsystem* InSubsystem);
 
 	//~IPerformanceDataConsumer interface
 	virtual void StartCharting() override;
@@ -153,9 +184,10 @@ protected:
 	ULyraPerformanceStatSubsystem* MySubsystem;
 
 	/**
-	 * Caches the sampled data for each of the performance stats currently available
+	 * Caches the sampled data for each of the performance stats currently available, indexed by ELyraDisplayablePerformanceStat.
+	 * Sized once so pointers handed out by GetCachedStatData stay valid.
 	 */
-	TMap<ELyraDisplayablePerformanceStat, FSampledStatCache> PerfStateCache;
+	TArray<FSampledStatCache> PerfStateCache;
 };
 
 //////////////////////////////////////////////////////////////////////
@@ -170,6 +202,10 @@ public:
 	UFUNCTION(BlueprintCallable)
 	double GetCachedStat(ELyraDisplayablePerformanceStat Stat) const;
 
+	// Returns the given percentile (0 to 100) of the recent samples of a stat, e.g. 99 for the 1% worst frame times
+	UFUNCTION(BlueprintCallable)
+	double GetCachedStatPercentile(ELyraDisplayablePerformanceStat Stat, double Percentile) const;
+
 	const FSampledStatCache* GetCachedStatData(const ELyraDisplayablePerformanceStat Stat) const;
 
 	//~USubsystem interface
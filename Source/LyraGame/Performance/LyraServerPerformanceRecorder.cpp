@@ -0,0 +1,497 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "LyraServerPerformanceRecorder.h"
+
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "LyraLogChannels.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/MemoryReader.h"
+#include "UObject/UObjectGlobals.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(LyraServerPerformanceRecorder)
+
+DECLARE_CYCLE_STAT(TEXT("Server Performance Record"), STAT_LyraServerPerformanceRecord, STATGROUP_Game);
+
+namespace LyraConsoleVariables
+{
+	static bool bRecordServerPerformance = false;
+	static FAutoConsoleVariableRef CVarRecordServerPerformance(
+		TEXT("lyra.ServerPerf.Record"),
+		bRecordServerPerformance,
+		TEXT("Should servers record per frame performance telemetry to the profiling directory? (also enabled by -LyraServerPerf)"),
+		ECVF_Default);
+
+	static int32 ServerPerformanceRingSize = 4096;
+	static FAutoConsoleVariableRef CVarServerPerformanceRingSize(
+		TEXT("lyra.ServerPerf.RingSize"),
+		ServerPerformanceRingSize,
+		TEXT("Number of frames of telemetry kept in memory, a flush is forced before unflushed samples would be overwritten (applies to recordings started after changing it)"),
+		ECVF_Default);
+
+	static float ServerPerformanceFlushInterval = 10.0f;
+	static FAutoConsoleVariableRef CVarServerPerformanceFlushInterval(
+		TEXT("lyra.ServerPerf.FlushInterval"),
+		ServerPerformanceFlushInterval,
+		TEXT("Seconds between appending recorded telemetry to the recording file"),
+		ECVF_Default);
+}
+
+namespace LyraServerPerformance
+{
+	static const uint32 FileMagic = 0x4650524C; // 'LRPF'
+	static const int32 FileVersion = 1;
+}
+
+//////////////////////////////////////////////////////////////////////
+// FLyraServerPerformanceSample
+
+FArchive& operator<<(FArchive& Ar, FLyraServerPerformanceSample& Sample)
+{
+	Ar << Sample.Time;
+	Ar << Sample.FrameTimeMs;
+	Ar << Sample.GameThreadTimeMs;
+	Ar << Sample.ReplicationTimeMs;
+	Ar << Sample.GarbageCollectionTimeMs;
+	Ar << Sample.NumConnections;
+	Ar << Sample.NumActorsReplicated;
+	Ar << Sample.OutBytesPerSecondPerConnection;
+	return Ar;
+}
+
+//////////////////////////////////////////////////////////////////////
+// FLyraServerPerformanceRecording
+
+// File layout: magic, version, build version, map name, start time, then any number of chunks of (sample count, samples)
+
+bool FLyraServerPerformanceRecording::LoadFromFile(const FString& Filename, FLyraServerPerformanceRecording& OutRecording)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Filename))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Bytes);
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+	Reader << Magic;
+	Reader << Version;
+	if ((Magic != LyraServerPerformance::FileMagic) || (Version != LyraServerPerformance::FileVersion))
+	{
+		UE_LOG(LogLyra, Warning, TEXT("%s is not a server performance recording (or is from an unsupported version)"), *Filename);
+		return false;
+	}
+
+	Reader << OutRecording.BuildVersion;
+	Reader << OutRecording.MapName;
+	Reader << OutRecording.StartTime;
+
+	OutRecording.Samples.Reset();
+	while (!Reader.AtEnd() && !Reader.IsError())
+	{
+		int32 NumSamples = 0;
+		Reader << NumSamples;
+		if ((NumSamples < 0) || Reader.IsError())
+		{
+			break;
+		}
+
+		// A truncated final chunk (e.g. the server was killed mid write) still leaves the earlier samples usable
+		OutRecording.Samples.Reserve(OutRecording.Samples.Num() + NumSamples);
+		for (int32 Index = 0; Index < NumSamples; ++Index)
+		{
+			FLyraServerPerformanceSample Sample;
+			Reader << Sample;
+			if (Reader.IsError())
+			{
+				break;
+			}
+			OutRecording.Samples.Add(Sample);
+		}
+	}
+
+	return true;
+}
+
+bool FLyraServerPerformanceRecording::ExportToCSV(const FString& Filename) const
+{
+	FString Output;
+	Output.Reserve((Samples.Num() + 1) * 80);
+	Output += TEXT("Time,FrameTimeMs,GameThreadTimeMs,ReplicationTimeMs,GarbageCollectionTimeMs,NumConnections,NumActorsReplicated,OutBytesPerSecondPerConnection\n");
+
+	for (const FLyraServerPerformanceSample& Sample : Samples)
+	{
+		Output += FString::Printf(TEXT("%.4f,%.3f,%.3f,%.3f,%.3f,%u,%u,%u\n"),
+			Sample.Time, Sample.FrameTimeMs, Sample.GameThreadTimeMs, Sample.ReplicationTimeMs, Sample.GarbageCollectionTimeMs,
+			Sample.NumConnections, Sample.NumActorsReplicated, Sample.OutBytesPerSecondPerConnection);
+	}
+
+	return FFileHelper::SaveStringToFile(Output, *Filename);
+}
+
+bool FLyraServerPerformanceRecording::ExportToJSON(const FString& Filename) const
+{
+	FString Output;
+	TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Output);
+
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("buildVersion"), BuildVersion);
+	Writer->WriteValue(TEXT("mapName"), MapName);
+	Writer->WriteValue(TEXT("startTime"), StartTime.ToIso8601());
+
+	// Columns rather than one object per sample, this is several times smaller for long recordings
+	auto WriteColumn = [this, &Writer](const TCHAR* Name, TFunctionRef<double(const FLyraServerPerformanceSample&)> GetValue)
+	{
+		Writer->WriteArrayStart(Name);
+		for (const FLyraServerPerformanceSample& Sample : Samples)
+		{
+			Writer->WriteValue(GetValue(Sample));
+		}
+		Writer->WriteArrayEnd();
+	};
+
+	Writer->WriteObjectStart(TEXT("samples"));
+	WriteColumn(TEXT("time"), [](const FLyraServerPerformanceSample& Sample) { return Sample.Time; });
+	WriteColumn(TEXT("frameTimeMs"), [](const FLyraServerPerformanceSample& Sample) { return (double)Sample.FrameTimeMs; });
+	WriteColumn(TEXT("gameThreadTimeMs"), [](const FLyraServerPerformanceSample& Sample) { return (double)Sample.GameThreadTimeMs; });
+	WriteColumn(TEXT("replicationTimeMs"), [](const FLyraServerPerformanceSample& Sample) { return (double)Sample.ReplicationTimeMs; });
+	WriteColumn(TEXT("garbageCollectionTimeMs"), [](const FLyraServerPerformanceSample& Sample) { return (double)Sample.GarbageCollectionTimeMs; });
+	WriteColumn(TEXT("numConnections"), [](const FLyraServerPerformanceSample& Sample) { return (double)Sample.NumConnections; });
+	WriteColumn(TEXT("numActorsReplicated"), [](const FLyraServerPerformanceSample& Sample) { return (double)Sample.NumActorsReplicated; });
+	WriteColumn(TEXT("outBytesPerSecondPerConnection"), [](const FLyraServerPerformanceSample& Sample) { return (double)Sample.OutBytesPerSecondPerConnection; });
+	Writer->WriteObjectEnd();
+
+	Writer->WriteObjectEnd();
+	Writer->Close();
+
+	return FFileHelper::SaveStringToFile(Output, *Filename);
+}
+
+//////////////////////////////////////////////////////////////////////
+// ULyraServerPerformanceRecorder
+
+bool ULyraServerPerformanceRecorder::IsRecordingEnabled()
+{
+	return LyraConsoleVariables::bRecordServerPerformance;
+}
+
+bool ULyraServerPerformanceRecorder::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void ULyraServerPerformanceRecorder::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	if (FParse::Param(FCommandLine::Get(), TEXT("LyraServerPerf")))
+	{
+		LyraConsoleVariables::bRecordServerPerformance = true;
+	}
+}
+
+void ULyraServerPerformanceRecorder::Deinitialize()
+{
+	StopRecording();
+
+	Super::Deinitialize();
+}
+
+TStatId ULyraServerPerformanceRecorder::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(ULyraServerPerformanceRecorder, STATGROUP_Tickables);
+}
+
+void ULyraServerPerformanceRecorder::StartRecording()
+{
+	const UWorld* World = GetWorld();
+
+	const int32 RingSize = FMath::Max(LyraConsoleVariables::ServerPerformanceRingSize, 64);
+	SampleRing.SetNum(RingSize);
+	NextSampleIndex = 0;
+	NumSamplesInRing = 0;
+	NumSamplesToFlush = 0;
+
+	PendingReplicationTimeMs = 0.0f;
+	PendingNumActorsReplicated = 0;
+	PendingGarbageCollectionTimeMs = 0.0;
+
+	RecordingStartTime = FPlatformTime::Seconds();
+	LastFlushTime = RecordingStartTime;
+
+	const FDateTime StartTime = FDateTime::Now();
+	const FString MapName = World->GetMapName();
+	const FString OutputDir = FPaths::ProfilingDir() / TEXT("ServerPerf");
+	IFileManager::Get().MakeDirectory(*OutputDir, true);
+	RecordingFilename = OutputDir / FString::Printf(TEXT("%s_%s.lyraperf"), *MapName, *StartTime.ToString(TEXT("%Y%m%d-%H%M%S")));
+
+	// Write the header up front so a crashed server still leaves a readable file behind
+	FString BuildVersion = FApp::GetBuildVersion();
+	PendingWrite = UE::Tasks::Launch(UE_SOURCE_LOCATION,
+		[Filename = RecordingFilename, BuildVersion = MoveTemp(BuildVersion), MapName, StartTime]() mutable
+		{
+			if (TUniquePtr<FArchive> File = TUniquePtr<FArchive>(IFileManager::Get().CreateFileWriter(*Filename)))
+			{
+				uint32 Magic = LyraServerPerformance::FileMagic;
+				int32 Version = LyraServerPerformance::FileVersion;
+				FDateTime Time = StartTime;
+				*File << Magic;
+				*File << Version;
+				*File << BuildVersion;
+				*File << MapName;
+				*File << Time;
+			}
+		}, UE::Tasks::Prerequisites(PendingWrite));
+
+	FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddUObject(this, &ThisClass::HandlePreGarbageCollect);
+	FCoreUObjectDelegates::GetPostGarbageCollect().AddUObject(this, &ThisClass::HandlePostGarbageCollect);
+
+	bRecording = true;
+
+	UE_LOG(LogLyra, Log, TEXT("Recording server performance to %s"), *RecordingFilename);
+}
+
+void ULyraServerPerformanceRecorder::StopRecording()
+{
+	if (!bRecording)
+	{
+		return;
+	}
+
+	Flush(/*bWaitForWrite=*/ true);
+
+	FCoreUObjectDelegates::GetPreGarbageCollectDelegate().RemoveAll(this);
+	FCoreUObjectDelegates::GetPostGarbageCollect().RemoveAll(this);
+
+	bRecording = false;
+	SampleRing.Empty();
+
+	UE_LOG(LogLyra, Log, TEXT("Finished recording server performance to %s"), *RecordingFilename);
+}
+
+void ULyraServerPerformanceRecorder::HandlePreGarbageCollect()
+{
+	GarbageCollectStartTime = FPlatformTime::Seconds();
+}
+
+void ULyraServerPerformanceRecorder::HandlePostGarbageCollect()
+{
+	if (GarbageCollectStartTime > 0.0)
+	{
+		PendingGarbageCollectionTimeMs += (FPlatformTime::Seconds() - GarbageCollectStartTime) * 1000.0;
+		GarbageCollectStartTime = 0.0;
+	}
+}
+
+void ULyraServerPerformanceRecorder::RecordReplicationFrame(double TimeMs, int32 NumActorsReplicated)
+{
+	PendingReplicationTimeMs = (float)TimeMs;
+	PendingNumActorsReplicated = (uint32)FMath::Max(NumActorsReplicated, 0);
+}
+
+void ULyraServerPerformanceRecorder::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	UWorld* World = GetWorld();
+	const ENetMode NetMode = World->GetNetMode();
+	const bool bShouldRecord = IsRecordingEnabled() && ((NetMode == NM_DedicatedServer) || (NetMode == NM_ListenServer));
+	if (bShouldRecord != bRecording)
+	{
+		if (bShouldRecord)
+		{
+			StartRecording();
+		}
+		else
+		{
+			StopRecording();
+		}
+	}
+
+	if (!bRecording)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_LyraServerPerformanceRecord);
+
+	const double Now = FPlatformTime::Seconds();
+
+	FLyraServerPerformanceSample& Sample = SampleRing[NextSampleIndex];
+	Sample.Time = Now - RecordingStartTime;
+	Sample.FrameTimeMs = (float)(FApp::GetDeltaTime() * 1000.0);
+	Sample.GameThreadTimeMs = (float)FPlatformTime::ToMilliseconds(GGameThreadTime);
+	Sample.ReplicationTimeMs = PendingReplicationTimeMs;
+	Sample.NumActorsReplicated = PendingNumActorsReplicated;
+	Sample.GarbageCollectionTimeMs = (float)PendingGarbageCollectionTimeMs;
+
+	uint64 TotalOutBytesPerSecond = 0;
+	uint32 NumConnections = 0;
+	if (const UNetDriver* NetDriver = World->GetNetDriver())
+	{
+		for (const UNetConnection* Connection : NetDriver->ClientConnections)
+		{
+			if (Connection)
+			{
+				TotalOutBytesPerSecond += FMath::Max(Connection->OutBytesPerSecond, 0);
+				++NumConnections;
+			}
+		}
+	}
+	Sample.NumConnections = NumConnections;
+	Sample.OutBytesPerSecondPerConnection = (NumConnections > 0) ? (uint32)(TotalOutBytesPerSecond / NumConnections) : 0;
+
+	PendingReplicationTimeMs = 0.0f;
+	PendingNumActorsReplicated = 0;
+	PendingGarbageCollectionTimeMs = 0.0;
+
+	NextSampleIndex = (NextSampleIndex + 1) % SampleRing.Num();
+	NumSamplesInRing = FMath::Min(NumSamplesInRing + 1, SampleRing.Num());
+	++NumSamplesToFlush;
+
+	if ((NumSamplesToFlush >= SampleRing.Num()) || ((Now - LastFlushTime) >= LyraConsoleVariables::ServerPerformanceFlushInterval))
+	{
+		Flush();
+	}
+}
+
+void ULyraServerPerformanceRecorder::Flush(bool bWaitForWrite)
+{
+	if (bRecording && (NumSamplesToFlush > 0))
+	{
+		// Copy the unflushed part of the ring out, oldest first, and hand it to a background task
+		TArray<FLyraServerPerformanceSample> SamplesToWrite;
+		SamplesToWrite.Reserve(NumSamplesToFlush);
+
+		const int32 RingSize = SampleRing.Num();
+		for (int32 SampleIndex = NextSampleIndex - NumSamplesToFlush + RingSize; SampleIndex < NextSampleIndex + RingSize; ++SampleIndex)
+		{
+			SamplesToWrite.Add(SampleRing[SampleIndex % RingSize]);
+		}
+
+		NumSamplesToFlush = 0;
+
+		PendingWrite = UE::Tasks::Launch(UE_SOURCE_LOCATION,
+			[Filename = RecordingFilename, Samples = MoveTemp(SamplesToWrite)]() mutable
+			{
+				if (TUniquePtr<FArchive> File = TUniquePtr<FArchive>(IFileManager::Get().CreateFileWriter(*Filename, FILEWRITE_Append | FILEWRITE_AllowRead)))
+				{
+					int32 NumSamples = Samples.Num();
+					*File << NumSamples;
+					for (FLyraServerPerformanceSample& Sample : Samples)
+					{
+						*File << Sample;
+					}
+				}
+			}, UE::Tasks::Prerequisites(PendingWrite));
+	}
+
+	LastFlushTime = FPlatformTime::Seconds();
+
+	if (bWaitForWrite && PendingWrite.IsValid())
+	{
+		PendingWrite.Wait();
+	}
+}
+
+void ULyraServerPerformanceRecorder::LogSummary() const
+{
+	if (NumSamplesInRing == 0)
+	{
+		UE_LOG(LogLyra, Display, TEXT("No server performance samples recorded (see lyra.ServerPerf.Record)"));
+		return;
+	}
+
+	double TotalFrameTime = 0.0, TotalGameThreadTime = 0.0, TotalReplicationTime = 0.0, TotalGarbageCollectionTime = 0.0;
+	double TotalActorsReplicated = 0.0, TotalOutBytes = 0.0;
+	float WorstFrameTime = 0.0f, WorstReplicationTime = 0.0f;
+	uint32 MaxConnections = 0;
+
+	const int32 RingSize = SampleRing.Num();
+	for (int32 Offset = 0; Offset < NumSamplesInRing; ++Offset)
+	{
+		const FLyraServerPerformanceSample& Sample = SampleRing[(NextSampleIndex - 1 - Offset + RingSize) % RingSize];
+		TotalFrameTime += Sample.FrameTimeMs;
+		TotalGameThreadTime += Sample.GameThreadTimeMs;
+		TotalReplicationTime += Sample.ReplicationTimeMs;
+		TotalGarbageCollectionTime += Sample.GarbageCollectionTimeMs;
+		TotalActorsReplicated += Sample.NumActorsReplicated;
+		TotalOutBytes += Sample.OutBytesPerSecondPerConnection;
+		WorstFrameTime = FMath::Max(WorstFrameTime, Sample.FrameTimeMs);
+		WorstReplicationTime = FMath::Max(WorstReplicationTime, Sample.ReplicationTimeMs);
+		MaxConnections = FMath::Max(MaxConnections, Sample.NumConnections);
+	}
+
+	const double Count = NumSamplesInRing;
+	UE_LOG(LogLyra, Display, TEXT("Server performance over the last %d frames (recording to %s):"), NumSamplesInRing, *RecordingFilename);
+	UE_LOG(LogLyra, Display, TEXT("  Frame %.2fms avg, %.2fms worst. Game thread %.2fms avg"), TotalFrameTime / Count, WorstFrameTime, TotalGameThreadTime / Count);
+	UE_LOG(LogLyra, Display, TEXT("  Replication %.3fms avg, %.3fms worst, %.1f actors per frame"), TotalReplicationTime / Count, WorstReplicationTime, TotalActorsReplicated / Count);
+	UE_LOG(LogLyra, Display, TEXT("  GC %.3fms per frame. Up to %u connections at %.0f bytes/s each"), TotalGarbageCollectionTime / Count, MaxConnections, TotalOutBytes / Count);
+}
+
+//////////////////////////////////////////////////////////////////////
+
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommandWithWorld LyraServerPerfSummaryCmd(
+	TEXT("Lyra.ServerPerf.Summary"),
+	TEXT("Logs averages and worst frames of the server performance samples currently held in memory"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const ULyraServerPerformanceRecorder* Recorder = World ? World->GetSubsystem<ULyraServerPerformanceRecorder>() : nullptr)
+		{
+			Recorder->LogSummary();
+		}
+	}));
+#endif // !UE_BUILD_SHIPPING
+
+static FAutoConsoleCommandWithWorldAndArgs LyraServerPerfExportCmd(
+	TEXT("Lyra.ServerPerf.Export"),
+	TEXT("Converts a server performance recording to CSV or JSON next to the original file.\n")
+	TEXT("Usage: Lyra.ServerPerf.Export [Filename] [csv|json]. Without a filename the current recording is flushed and exported."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		FString Filename;
+		FString Format = TEXT("csv");
+		for (const FString& Arg : Args)
+		{
+			if ((Arg == TEXT("csv")) || (Arg == TEXT("json")))
+			{
+				Format = Arg;
+			}
+			else
+			{
+				Filename = Arg;
+			}
+		}
+
+		if (Filename.IsEmpty())
+		{
+			if (ULyraServerPerformanceRecorder* Recorder = World ? World->GetSubsystem<ULyraServerPerformanceRecorder>() : nullptr)
+			{
+				Recorder->Flush(/*bWaitForWrite=*/ true);
+				Filename = Recorder->GetRecordingFilename();
+			}
+		}
+
+		FLyraServerPerformanceRecording Recording;
+		if (Filename.IsEmpty() || !FLyraServerPerformanceRecording::LoadFromFile(Filename, Recording))
+		{
+			UE_LOG(LogLyra, Warning, TEXT("Lyra.ServerPerf.Export: could not read a recording from '%s'"), *Filename);
+			return;
+		}
+
+		const FString OutputFilename = FPaths::ChangeExtension(Filename, Format);
+		const bool bSuccess = (Format == TEXT("json")) ? Recording.ExportToJSON(OutputFilename) : Recording.ExportToCSV(OutputFilename);
+		UE_LOG(LogLyra, Display, TEXT("Lyra.ServerPerf.Export: %s %d samples (build %s, map %s) to %s"),
+			bSuccess ? TEXT("exported") : TEXT("failed to export"), Recording.Samples.Num(), *Recording.BuildVersion, *Recording.MapName, *OutputFilename);
+	}));
@@ -0,0 +1,118 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "Tasks/Task.h"
+
+#include "LyraServerPerformanceRecorder.generated.h"
+
+/** One server frame of telemetry. Written to the recording file field by field, see FLyraServerPerformanceRecording. */
+struct FLyraServerPerformanceSample
+{
+	// Seconds since the recording started
+	double Time = 0.0;
+
+	float FrameTimeMs = 0.0f;
+	float GameThreadTimeMs = 0.0f;
+
+	// Time spent in the replication graph gathering and replicating actors, from the last net flush
+	float ReplicationTimeMs = 0.0f;
+
+	// Time spent collecting garbage since the previous sample
+	float GarbageCollectionTimeMs = 0.0f;
+
+	uint32 NumConnections = 0;
+	uint32 NumActorsReplicated = 0;
+
+	// Average outgoing bandwidth of the client connections
+	uint32 OutBytesPerSecondPerConnection = 0;
+
+	friend FArchive& operator<<(FArchive& Ar, FLyraServerPerformanceSample& Sample);
+};
+
+/** Contents of a recording file, see ULyraServerPerformanceRecorder */
+struct FLyraServerPerformanceRecording
+{
+	FString BuildVersion;
+	FString MapName;
+	FDateTime StartTime;
+	TArray<FLyraServerPerformanceSample> Samples;
+
+	static bool LoadFromFile(const FString& Filename, FLyraServerPerformanceRecording& OutRecording);
+
+	bool ExportToCSV(const FString& Filename) const;
+	bool ExportToJSON(const FString& Filename) const;
+};
+
+/**
+ * ULyraServerPerformanceRecorder
+ *
+ * Records per frame telemetry on servers (tick time, replication time and volume, bandwidth, GC) into a fixed size ring,
+ * and periodically appends it to a compact binary file in the profiling directory from a background task, so runs of
+ * different builds under the same bot load can be compared. Use Lyra.ServerPerf.Export to turn a recording into CSV or JSON.
+ *
+ * Off by default, enable with lyra.ServerPerf.Record or the -LyraServerPerf command line switch.
+ */
+UCLASS()
+class ULyraServerPerformanceRecorder : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~USubsystem interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	//~End of USubsystem interface
+
+	//~UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	//~End of UTickableWorldSubsystem interface
+
+	static bool IsRecordingEnabled();
+
+	bool IsRecording() const { return bRecording; }
+
+	/** Called by the replication graph after each ServerReplicateActors */
+	void RecordReplicationFrame(double TimeMs, int32 NumActorsReplicated);
+
+	/** Appends the samples recorded since the last flush to the recording file, optionally waiting until they are on disk */
+	void Flush(bool bWaitForWrite = false);
+
+	/** Logs averages and worst frames of the samples currently in the ring */
+	void LogSummary() const;
+
+	const FString& GetRecordingFilename() const { return RecordingFilename; }
+
+protected:
+	//~UWorldSubsystem interface
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	//~End of UWorldSubsystem interface
+
+private:
+	void StartRecording();
+	void StopRecording();
+
+	void HandlePreGarbageCollect();
+	void HandlePostGarbageCollect();
+
+	TArray<FLyraServerPerformanceSample> SampleRing;
+	int32 NextSampleIndex = 0;
+	int32 NumSamplesInRing = 0;
+	int32 NumSamplesToFlush = 0;
+
+	FString RecordingFilename;
+	double RecordingStartTime = 0.0;
+	double LastFlushTime = 0.0;
+	bool bRecording = false;
+
+	// Written out by the next sample
+	float PendingReplicationTimeMs = 0.0f;
+	uint32 PendingNumActorsReplicated = 0;
+	double PendingGarbageCollectionTimeMs = 0.0;
+	double GarbageCollectStartTime = 0.0;
+
+	// Writes are chained so they reach the file in order
+	UE::Tasks::FTask PendingWrite;
+};
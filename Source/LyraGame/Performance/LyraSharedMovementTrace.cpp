@@ -0,0 +1,363 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "LyraSharedMovementTrace.h"
+
+#include "Character/LyraCharacter.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "LyraLogChannels.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/CoreNet.h"
+
+namespace LyraSharedMovementTrace
+{
+	static const uint32 FileMagic = 0x4D53524C; // 'LRSM'
+	static const int32 FileVersion = 1;
+
+	// Only one recording at a time
+	static TUniquePtr<FLyraSharedMovementTrace> ActiveRecording;
+
+	static FSharedRepMovement MakeMovement(const FLyraSharedMovementTraceSample& Sample)
+	{
+		FSharedRepMovement Movement;
+		Movement.RepMovement.Location = Sample.Location;
+		Movement.RepMovement.Rotation = Sample.Rotation;
+		Movement.RepMovement.LinearVelocity = Sample.Velocity;
+		Movement.RepTimeStamp = Sample.RepTimeStamp;
+		Movement.RepMovementMode = Sample.MovementMode;
+		Movement.bProxyIsJumpForceApplied = Sample.bProxyIsJumpForceApplied;
+		Movement.bIsCrouched = Sample.bIsCrouched;
+		return Movement;
+	}
+
+	static int64 SerializeAndMeasure(FSharedRepMovement& Movement, FSharedRepMovement* OutReceived)
+	{
+		FNetBitWriter Writer(nullptr, 1024);
+		bool bSuccess = true;
+		Movement.NetSerialize(Writer, nullptr, bSuccess);
+
+		if (OutReceived)
+		{
+			FNetBitReader Reader(nullptr, Writer.GetData(), Writer.GetNumBits());
+			OutReceived->NetSerialize(Reader, nullptr, bSuccess);
+		}
+
+		return Writer.GetNumBits();
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+// FLyraSharedMovementTraceSample
+
+FArchive& operator<<(FArchive& Ar, FLyraSharedMovementTraceSample& Sample)
+{
+	Ar << Sample.Time;
+	Ar << Sample.CharacterId;
+	Ar << Sample.Location;
+	Ar << Sample.Rotation;
+	Ar << Sample.Velocity;
+	Ar << Sample.RepTimeStamp;
+	Ar << Sample.MovementMode;
+	Ar << Sample.bProxyIsJumpForceApplied;
+	Ar << Sample.bIsCrouched;
+	return Ar;
+}
+
+//////////////////////////////////////////////////////////////////////
+// FLyraSharedMovementTrace
+
+FString FLyraSharedMovementTrace::GetDefaultTraceDirectory()
+{
+	return FPaths::ProfilingDir() / TEXT("SharedMovement");
+}
+
+bool FLyraSharedMovementTrace::SaveToFile(const FString& Filename) const
+{
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+
+	uint32 Magic = LyraSharedMovementTrace::FileMagic;
+	int32 Version = LyraSharedMovementTrace::FileVersion;
+	double SavedDuration = Duration;
+	Writer << Magic;
+	Writer << Version;
+	Writer << SavedDuration;
+	Writer << const_cast<TArray<FLyraSharedMovementTraceSample>&>(Samples);
+
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(Filename), true);
+	return FFileHelper::SaveArrayToFile(Bytes, *Filename);
+}
+
+bool FLyraSharedMovementTrace::LoadFromFile(const FString& Filename)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Filename))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Bytes);
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+	Reader << Magic;
+	Reader << Version;
+	if ((Magic != LyraSharedMovementTrace::FileMagic) || (Version != LyraSharedMovementTrace::FileVersion))
+	{
+		UE_LOG(LogLyra, Warning, TEXT("%s is not a shared movement trace (or is from an unsupported version)"), *Filename);
+		return false;
+	}
+
+	Reader << Duration;
+	Reader << Samples;
+
+	return !Reader.IsError();
+}
+
+void FLyraSharedMovementTrace::StartRecording(UWorld* World, float Seconds, const FString& Filename)
+{
+	using namespace LyraSharedMovementTrace;
+
+	if (ActiveRecording.IsValid())
+	{
+		UE_LOG(LogLyra, Display, TEXT("Lyra.SharedMovement.RecordTrace: already recording to %s"), *ActiveRecording->RecordingFilename);
+		return;
+	}
+
+	ActiveRecording = MakeUnique<FLyraSharedMovementTrace>();
+	ActiveRecording->RecordingWorld = World;
+	ActiveRecording->RecordingStartTime = FPlatformTime::Seconds();
+	ActiveRecording->RecordingEndTime = ActiveRecording->RecordingStartTime + Seconds;
+	ActiveRecording->RecordingFilename = Filename;
+	ActiveRecording->RecordTickHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(ActiveRecording.Get(), &FLyraSharedMovementTrace::RecordFrame), 0.0f);
+
+	UE_LOG(LogLyra, Display, TEXT("Lyra.SharedMovement.RecordTrace: recording %.1fs of character movement to %s"), Seconds, *Filename);
+}
+
+bool FLyraSharedMovementTrace::RecordFrame(float DeltaTime)
+{
+	const double Now = FPlatformTime::Seconds();
+	UWorld* World = RecordingWorld.Get();
+
+	if ((World != nullptr) && (Now < RecordingEndTime))
+	{
+		for (TActorIterator<ALyraCharacter> It(World); It; ++It)
+		{
+			ALyraCharacter* Character = *It;
+			if (!Character->HasAuthority())
+			{
+				continue;
+			}
+
+			FSharedRepMovement Movement;
+			if (!Movement.FillForCharacter(Character))
+			{
+				continue;
+			}
+
+			FLyraSharedMovementTraceSample& Sample = Samples.AddDefaulted_GetRef();
+			Sample.Time = Now - RecordingStartTime;
+			Sample.CharacterId = CharacterIds.FindOrAdd(Character, CharacterIds.Num());
+			Sample.Location = Movement.RepMovement.Location;
+			Sample.Rotation = Movement.RepMovement.Rotation;
+			Sample.Velocity = Movement.RepMovement.LinearVelocity;
+			Sample.RepTimeStamp = Movement.RepTimeStamp;
+			Sample.MovementMode = Movement.RepMovementMode;
+			Sample.bProxyIsJumpForceApplied = Movement.bProxyIsJumpForceApplied;
+			Sample.bIsCrouched = Movement.bIsCrouched;
+		}
+
+		return true;
+	}
+
+	Duration = FMath::Min(Now, RecordingEndTime) - RecordingStartTime;
+	const bool bSaved = SaveToFile(RecordingFilename);
+	UE_LOG(LogLyra, Display, TEXT("Lyra.SharedMovement.RecordTrace: %s %d samples of %d characters over %.1fs to %s"),
+		bSaved ? TEXT("wrote") : TEXT("failed to write"), Samples.Num(), CharacterIds.Num(), Duration, *RecordingFilename);
+
+	// Destroys this, so nothing past here
+	LyraSharedMovementTrace::ActiveRecording.Reset();
+	return false;
+}
+
+void FLyraSharedMovementTrace::RunBandwidthBenchmark() const
+{
+	using namespace LyraSharedMovementTrace;
+
+	if ((Samples.Num() == 0) || (Duration <= 0.0))
+	{
+		UE_LOG(LogLyra, Display, TEXT("Lyra.SharedMovement.Benchmark: the trace is empty"));
+		return;
+	}
+
+	// Receivers on FastShared rate tier N get every 2^N updates
+	static constexpr int32 NumTiers = 4;
+
+	struct FCharacterState
+	{
+		FSharedRepMovement LastSent;
+		bool bHasSent = false;
+		FSharedRepMovementBaseline Baseline;
+		int32 NumSent = 0;
+
+		uint8 ReceivedBaselineId[NumTiers] = {};
+		FVector ReceivedBaselineLocation[NumTiers];
+	};
+
+	TMap<int32, FCharacterState> Characters;
+
+	int64 NumUpdates = 0;
+	int64 FullBits = 0;
+	int64 CompactBits = 0;
+	int64 NumReceived[NumTiers] = {};
+	int64 NumDropped[NumTiers] = {};
+	double MaxLocationError = 0.0;
+	double MaxRotationError = 0.0;
+
+	for (const FLyraSharedMovementTraceSample& Sample : Samples)
+	{
+		FCharacterState& State = Characters.FindOrAdd(Sample.CharacterId);
+
+		// Same filtering as ALyraCharacter::UpdateSharedReplication, unchanged movement isn't sent again
+		FSharedRepMovement Full = MakeMovement(Sample);
+		if (State.bHasSent && Full.Equals(State.LastSent, nullptr))
+		{
+			continue;
+		}
+		State.LastSent = Full;
+		State.bHasSent = true;
+		++NumUpdates;
+
+		FSharedRepMovement FullReceived;
+		FullBits += SerializeAndMeasure(Full, &FullReceived);
+
+		FSharedRepMovement Compact = MakeMovement(Sample);
+		State.Baseline.Apply(Compact, /*bUseCompactFormat=*/ true);
+
+		FSharedRepMovement CompactReceived;
+		CompactBits += SerializeAndMeasure(Compact, &CompactReceived);
+
+		for (int32 Tier = 0; Tier < NumTiers; ++Tier)
+		{
+			// Spread characters over the phases a throttled connection could be on
+			const int32 Period = 1 << Tier;
+			if (((State.NumSent + Sample.CharacterId) % Period) != 0)
+			{
+				continue;
+			}
+
+			FSharedRepMovement Received = CompactReceived;
+			if (Received.ResolveLocation(State.ReceivedBaselineId[Tier], State.ReceivedBaselineLocation[Tier]))
+			{
+				++NumReceived[Tier];
+
+				if (Tier == 0)
+				{
+					// Error against what the full format delivers, so only the extra loss of the compact format shows up
+					MaxLocationError = FMath::Max(MaxLocationError, FVector::Dist(Received.RepMovement.Location, FullReceived.RepMovement.Location));
+					MaxRotationError = FMath::Max(MaxRotationError, FMath::RadiansToDegrees(Received.RepMovement.Rotation.Quaternion().AngularDistance(Sample.Rotation.Quaternion())));
+				}
+			}
+			else
+			{
+				++NumDropped[Tier];
+			}
+		}
+
+		++State.NumSent;
+	}
+
+	const double UpdatesPerSecond = NumUpdates / Duration;
+	const double FullBytesPerSecond = FullBits / 8.0 / Duration;
+	const double CompactBytesPerSecond = CompactBits / 8.0 / Duration;
+
+	UE_LOG(LogLyra, Display, TEXT("Lyra.SharedMovement.Benchmark: %d samples of %d characters over %.1fs, %lld updates sent (%.1f/s across all characters)"),
+		Samples.Num(), Characters.Num(), Duration, NumUpdates, UpdatesPerSecond);
+	UE_LOG(LogLyra, Display, TEXT("  Full:    %6.1f bits/update, %8.1f bytes/s per viewer (payload only)"),
+		(double)FullBits / FMath::Max<int64>(NumUpdates, 1), FullBytesPerSecond);
+	UE_LOG(LogLyra, Display, TEXT("  Compact: %6.1f bits/update, %8.1f bytes/s per viewer (payload only), %.1f%% of full"),
+		(double)CompactBits / FMath::Max<int64>(NumUpdates, 1), CompactBytesPerSecond, (FullBits > 0) ? (100.0 * CompactBits / FullBits) : 0.0);
+	UE_LOG(LogLyra, Display, TEXT("  Compact max error vs full: %.2fcm location, %.2f degrees rotation"), MaxLocationError, MaxRotationError);
+
+	for (int32 Tier = 0; Tier < NumTiers; ++Tier)
+	{
+		const int64 NumDelivered = NumReceived[Tier] + NumDropped[Tier];
+		UE_LOG(LogLyra, Display, TEXT("  Rate tier %d (every %d updates): %8.1f bytes/s, %lld of %lld received updates unusable (%.1f%%)"),
+			Tier, 1 << Tier, CompactBytesPerSecond / (1 << Tier), NumDropped[Tier], NumDelivered, (NumDelivered > 0) ? (100.0 * NumDropped[Tier] / NumDelivered) : 0.0);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommandWithWorldAndArgs LyraSharedMovementRecordTraceCmd(
+	TEXT("Lyra.SharedMovement.RecordTrace"),
+	TEXT("Records the movement of every character on the server for a while, for Lyra.SharedMovement.Benchmark. Usage: Lyra.SharedMovement.RecordTrace [Seconds=30] [Filename]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if ((World == nullptr) || (World->GetNetMode() == NM_Client))
+		{
+			UE_LOG(LogLyra, Display, TEXT("Lyra.SharedMovement.RecordTrace: needs to run on the server"));
+			return;
+		}
+
+		float Seconds = 30.0f;
+		if (Args.Num() > 0)
+		{
+			LexTryParseString(Seconds, *Args[0]);
+		}
+
+		FString Filename = FLyraSharedMovementTrace::GetDefaultTraceDirectory() / FString::Printf(TEXT("%s_%s.lyramove"), *World->GetMapName(), *FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S")));
+		if (Args.Num() > 1)
+		{
+			Filename = Args[1];
+		}
+
+		FLyraSharedMovementTrace::StartRecording(World, FMath::Max(Seconds, 1.0f), Filename);
+	}));
+
+static FAutoConsoleCommand LyraSharedMovementBenchmarkCmd(
+	TEXT("Lyra.SharedMovement.Benchmark"),
+	TEXT("Replays a recorded movement trace through the full and compact FastShared movement formats and compares their bandwidth. Usage: Lyra.SharedMovement.Benchmark [Filename, defaults to the newest trace]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FString Filename;
+		if (Args.Num() > 0)
+		{
+			Filename = Args[0];
+		}
+		else
+		{
+			// Newest trace in the default directory
+			const FString Directory = FLyraSharedMovementTrace::GetDefaultTraceDirectory();
+			TArray<FString> Found;
+			IFileManager::Get().FindFiles(Found, *(Directory / TEXT("*.lyramove")), true, false);
+
+			FDateTime Newest = FDateTime::MinValue();
+			for (const FString& Candidate : Found)
+			{
+				const FDateTime Stamp = IFileManager::Get().GetTimeStamp(*(Directory / Candidate));
+				if (Stamp > Newest)
+				{
+					Newest = Stamp;
+					Filename = Directory / Candidate;
+				}
+			}
+		}
+
+		FLyraSharedMovementTrace Trace;
+		if (Filename.IsEmpty() || !Trace.LoadFromFile(Filename))
+		{
+			UE_LOG(LogLyra, Display, TEXT("Lyra.SharedMovement.Benchmark: could not read a trace from '%s', record one with Lyra.SharedMovement.RecordTrace"), *Filename);
+			return;
+		}
+
+		UE_LOG(LogLyra, Display, TEXT("Lyra.SharedMovement.Benchmark: replaying %s"), *Filename);
+		Trace.RunBandwidthBenchmark();
+	}));
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,60 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Containers/Ticker.h"
+#include "UObject/ObjectKey.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+class UWorld;
+
+/** One character's movement on one server frame, the same data FSharedRepMovement::FillForCharacter gathers */
+struct FLyraSharedMovementTraceSample
+{
+	double Time = 0.0;
+	int32 CharacterId = 0;
+
+	FVector Location = FVector::ZeroVector;
+	FRotator Rotation = FRotator::ZeroRotator;
+	FVector Velocity = FVector::ZeroVector;
+	float RepTimeStamp = 0.0f;
+	uint8 MovementMode = 0;
+	bool bProxyIsJumpForceApplied = false;
+	bool bIsCrouched = false;
+
+	friend FArchive& operator<<(FArchive& Ar, FLyraSharedMovementTraceSample& Sample);
+};
+
+/**
+ * FLyraSharedMovementTrace
+ *
+ * Character movement recorded on the server (Lyra.SharedMovement.RecordTrace), which Lyra.SharedMovement.Benchmark replays
+ * through the full and compact FSharedRepMovement formats to compare the bandwidth of the FastShared path.
+ */
+class FLyraSharedMovementTrace
+{
+public:
+	TArray<FLyraSharedMovementTraceSample> Samples;
+	double Duration = 0.0;
+
+	bool SaveToFile(const FString& Filename) const;
+	bool LoadFromFile(const FString& Filename);
+
+	/** Serializes every update the trace would send in both formats and logs bytes per second, plus how receivers on each FastShared rate tier fare with the compact one */
+	void RunBandwidthBenchmark() const;
+
+	/** Records the movement of every character in World for Seconds, then writes it to Filename */
+	static void StartRecording(UWorld* World, float Seconds, const FString& Filename);
+
+	static FString GetDefaultTraceDirectory();
+
+private:
+	bool RecordFrame(float DeltaTime);
+
+	TWeakObjectPtr<UWorld> RecordingWorld;
+	TMap<TObjectKey<AActor>, int32> CharacterIds;
+	double RecordingStartTime = 0.0;
+	double RecordingEndTime = 0.0;
+	FString RecordingFilename;
+	FTSTicker::FDelegateHandle RecordTickHandle;
+};
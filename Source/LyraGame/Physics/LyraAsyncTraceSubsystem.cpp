@@ -0,0 +1,211 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "LyraAsyncTraceSubsystem.h"
+
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(LyraAsyncTraceSubsystem)
+
+DEFINE_STAT(STAT_LyraSyncTraces);
+DEFINE_STAT(STAT_LyraAsyncTracesIssued);
+DEFINE_STAT(STAT_LyraAsyncTracesDeferred);
+
+CSV_DEFINE_CATEGORY(LyraAsyncTrace, /*bIsEnabledByDefault=*/false);
+
+namespace LyraConsoleVariables
+{
+	static bool bAsyncGroundInfoTraces = true;
+	static FAutoConsoleVariableRef CVarAsyncGroundInfoTraces(
+		TEXT("lyra.AsyncTrace.GroundInfo"),
+		bAsyncGroundInfoTraces,
+		TEXT("Should airborne characters get their ground info from last frame's async trace rather than tracing synchronously?"),
+		ECVF_Default);
+
+	static bool bAsyncCameraFeelerTraces = true;
+	static FAutoConsoleVariableRef CVarAsyncCameraFeelerTraces(
+		TEXT("lyra.AsyncTrace.CameraFeelers"),
+		bAsyncCameraFeelerTraces,
+		TEXT("Should the predictive camera penetration feelers be swept asynchronously? The main feeler is always swept synchronously"),
+		ECVF_Default);
+
+	static int32 MaxAsyncQueriesPerFrame = 128;
+	static FAutoConsoleVariableRef CVarMaxAsyncQueriesPerFrame(
+		TEXT("lyra.AsyncTrace.MaxQueriesPerFrame"),
+		MaxAsyncQueriesPerFrame,
+		TEXT("Most low priority async traces issued in one frame, the least overdue ones wait for the next frame (0 for no limit)"),
+		ECVF_Default);
+
+	static int32 AsyncQueryTimeoutFrames = 60;
+	static FAutoConsoleVariableRef CVarAsyncQueryTimeoutFrames(
+		TEXT("lyra.AsyncTrace.QueryTimeoutFrames"),
+		AsyncQueryTimeoutFrames,
+		TEXT("Async trace queries that haven't been requested for this many frames are dropped"),
+		ECVF_Default);
+}
+
+bool ULyraAsyncTraceSubsystem::ShouldTraceGroundInfoAsync()
+{
+	return LyraConsoleVariables::bAsyncGroundInfoTraces;
+}
+
+bool ULyraAsyncTraceSubsystem::ShouldTraceCameraFeelersAsync()
+{
+	return LyraConsoleVariables::bAsyncCameraFeelerTraces;
+}
+
+bool ULyraAsyncTraceSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void ULyraAsyncTraceSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	TraceDoneDelegate.BindUObject(this, &ThisClass::HandleTraceDone);
+
+	// After the cameras have updated, so this frame's feelers make it into this frame's batch
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &ThisClass::HandleWorldPostActorTick);
+}
+
+void ULyraAsyncTraceSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	TraceDoneDelegate.Unbind();
+	Slots.Reset();
+
+	Super::Deinitialize();
+}
+
+void ULyraAsyncTraceSubsystem::RequestTrace(int32& InOutHandle, const FLyraAsyncTraceRequest& Request, int32 IntervalFrames)
+{
+	IntervalFrames = FMath::Max(IntervalFrames, 0);
+
+	FQuerySlot* Slot = (InOutHandle != INDEX_NONE) ? Slots.Find(InOutHandle) : nullptr;
+	if (Slot == nullptr)
+	{
+		InOutHandle = NextHandle++;
+		Slot = &Slots.Add(InOutHandle);
+
+		// Stagger new queries over their interval so ones added together don't all trace on the same frames
+		Slot->NextIssueFrame = GFrameCounter + (InOutHandle % (IntervalFrames + 1));
+	}
+	else if (IntervalFrames < Slot->IntervalFrames)
+	{
+		// Asked to trace more often, e.g. a feeler that just hit something
+		Slot->NextIssueFrame = FMath::Min(Slot->NextIssueFrame, Slot->LastIssuedFrame + IntervalFrames + 1);
+	}
+
+	Slot->Request = Request;
+	Slot->IntervalFrames = IntervalFrames;
+	Slot->LastRequestedFrame = GFrameCounter;
+	Slot->bHasRequest = true;
+}
+
+bool ULyraAsyncTraceSubsystem::GetResult(int32 Handle, FLyraAsyncTraceResult& OutResult) const
+{
+	const FQuerySlot* Slot = Slots.Find(Handle);
+	if ((Slot == nullptr) || !Slot->bHasResult)
+	{
+		return false;
+	}
+
+	OutResult = Slot->Result;
+	OutResult.bStale = (OutResult.FrameIssued + 1) < GFrameCounter;
+	return true;
+}
+
+void ULyraAsyncTraceSubsystem::RecordSyncTrace()
+{
+	++NumSyncTracesThisFrame;
+	INC_DWORD_STAT(STAT_LyraSyncTraces);
+}
+
+void ULyraAsyncTraceSubsystem::HandleWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World != GetWorld())
+	{
+		return;
+	}
+
+	IssueQueries();
+
+	CSV_CUSTOM_STAT(LyraAsyncTrace, SyncTraces, NumSyncTracesThisFrame, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(LyraAsyncTrace, AsyncTraces, NumAsyncTracesLastFrame, ECsvCustomStatOp::Set);
+
+	NumSyncTracesLastFrame = NumSyncTracesThisFrame;
+	NumSyncTracesThisFrame = 0;
+}
+
+void ULyraAsyncTraceSubsystem::IssueQueries()
+{
+	UWorld* World = GetWorld();
+	const uint64 Frame = GFrameCounter;
+
+	// Drop the queries nobody is asking for anymore, and gather the ones due this frame
+	TArray<int32, TInlineAllocator<64>> DueHandles;
+	for (auto It = Slots.CreateIterator(); It; ++It)
+	{
+		FQuerySlot& Slot = It.Value();
+		if ((Frame - Slot.LastRequestedFrame) > (uint64)FMath::Max(LyraConsoleVariables::AsyncQueryTimeoutFrames, 1))
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		if (Slot.bHasRequest && (Frame >= Slot.NextIssueFrame))
+		{
+			DueHandles.Add(It.Key());
+		}
+	}
+
+	// Most overdue first
+	const int32 MaxQueries = LyraConsoleVariables::MaxAsyncQueriesPerFrame;
+	if ((MaxQueries > 0) && (DueHandles.Num() > MaxQueries))
+	{
+		DueHandles.Sort([this](int32 A, int32 B) { return Slots[A].NextIssueFrame < Slots[B].NextIssueFrame; });
+
+		INC_DWORD_STAT_BY(STAT_LyraAsyncTracesDeferred, DueHandles.Num() - MaxQueries);
+		DueHandles.SetNum(MaxQueries, EAllowShrinking::No);
+	}
+
+	for (int32 Handle : DueHandles)
+	{
+		FQuerySlot& Slot = Slots[Handle];
+		const FLyraAsyncTraceRequest& Request = Slot.Request;
+
+		if (Request.Shape.IsLine())
+		{
+			World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Request.Start, Request.End, Request.Channel, Request.QueryParams, Request.ResponseParams, &TraceDoneDelegate, (uint32)Handle);
+		}
+		else
+		{
+			World->AsyncSweepByChannel(EAsyncTraceType::Single, Request.Start, Request.End, Request.Rotation, Request.Channel, Request.Shape, Request.QueryParams, Request.ResponseParams, &TraceDoneDelegate, (uint32)Handle);
+		}
+
+		Slot.InFlightFrame = Frame;
+		Slot.LastIssuedFrame = Frame;
+		Slot.NextIssueFrame = Frame + Slot.IntervalFrames + 1;
+		Slot.bHasRequest = false;
+	}
+
+	NumAsyncTracesLastFrame = DueHandles.Num();
+	INC_DWORD_STAT_BY(STAT_LyraAsyncTracesIssued, DueHandles.Num());
+}
+
+void ULyraAsyncTraceSubsystem::HandleTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceData)
+{
+	FQuerySlot* Slot = Slots.Find((int32)TraceData.UserData);
+	if (Slot == nullptr)
+	{
+		return;
+	}
+
+	Slot->Result.Hit = (TraceData.OutHits.Num() > 0) ? TraceData.OutHits[0] : FHitResult(TraceData.Start, TraceData.End);
+	Slot->Result.Start = TraceData.Start;
+	Slot->Result.End = TraceData.End;
+	Slot->Result.FrameIssued = Slot->InFlightFrame;
+	Slot->bHasResult = true;
+}
@@ -0,0 +1,123 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CollisionQueryParams.h"
+#include "CollisionShape.h"
+#include "Engine/EngineTypes.h"
+#include "Engine/HitResult.h"
+#include "Stats/Stats.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+
+#include "LyraAsyncTraceSubsystem.generated.h"
+
+DECLARE_STATS_GROUP(TEXT("Lyra Async Traces"), STATGROUP_LyraAsyncTrace, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Sync Traces"), STAT_LyraSyncTraces, STATGROUP_LyraAsyncTrace, LYRAGAME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Async Traces Issued"), STAT_LyraAsyncTracesIssued, STATGROUP_LyraAsyncTrace, LYRAGAME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Async Traces Deferred Over Budget"), STAT_LyraAsyncTracesDeferred, STATGROUP_LyraAsyncTrace, LYRAGAME_API);
+
+class UWorld;
+
+/** A low priority line trace or sweep, a line trace unless Shape is set to something other than a line */
+struct FLyraAsyncTraceRequest
+{
+	FVector Start = FVector::ZeroVector;
+	FVector End = FVector::ZeroVector;
+	FQuat Rotation = FQuat::Identity;
+	FCollisionShape Shape;
+	ECollisionChannel Channel = ECC_Visibility;
+	FCollisionQueryParams QueryParams;
+	FCollisionResponseParams ResponseParams;
+};
+
+/** The latest result of an async query */
+struct FLyraAsyncTraceResult
+{
+	FHitResult Hit;
+
+	// What the query was traced with, which may be a frame or more behind where its owner is now
+	FVector Start = FVector::ZeroVector;
+	FVector End = FVector::ZeroVector;
+
+	// GFrameCounter when the query was issued
+	uint64 FrameIssued = 0;
+
+	// Set when the result didn't come from last frame's batch, e.g. the query is throttled or was over budget
+	bool bStale = false;
+};
+
+/**
+ * ULyraAsyncTraceSubsystem
+ *
+ * Collects recurring low priority traces (airborne ground info, predictive camera feelers) and runs them as one async batch
+ * after the actors of a frame have ticked, serving each query's result on the following frame.
+ *
+ * Each query is identified by a handle its owner keeps and passes to RequestTrace every frame it wants the trace, along with
+ * how many frames may be skipped between traces. The subsystem staggers queries sharing an interval, issues the most overdue
+ * ones first and holds the rest back once lyra.AsyncTrace.MaxQueriesPerFrame is reached. Queries that stop being requested
+ * are dropped after a while, so owners don't need to unregister them.
+ */
+UCLASS()
+class ULyraAsyncTraceSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~USubsystem interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	//~End of USubsystem interface
+
+	static bool ShouldTraceGroundInfoAsync();
+	static bool ShouldTraceCameraFeelersAsync();
+
+	/**
+	 * Queues Request to be traced in this frame's batch, unless it was traced within the last IntervalFrames frames.
+	 * InOutHandle is assigned the first time (and again if the query was dropped for not being requested), pass INDEX_NONE to start.
+	 */
+	void RequestTrace(int32& InOutHandle, const FLyraAsyncTraceRequest& Request, int32 IntervalFrames = 0);
+
+	/** Gets the latest result of a query, returns false if it hasn't got one yet */
+	bool GetResult(int32 Handle, FLyraAsyncTraceResult& OutResult) const;
+
+	/** Counts a trace the caller had to do synchronously (e.g. no async result yet) */
+	void RecordSyncTrace();
+
+	int32 GetNumSyncTracesLastFrame() const { return NumSyncTracesLastFrame; }
+	int32 GetNumAsyncTracesLastFrame() const { return NumAsyncTracesLastFrame; }
+
+protected:
+	//~UWorldSubsystem interface
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	//~End of UWorldSubsystem interface
+
+private:
+	struct FQuerySlot
+	{
+		FLyraAsyncTraceRequest Request;
+		FLyraAsyncTraceResult Result;
+		int32 IntervalFrames = 0;
+		uint64 NextIssueFrame = 0;
+		uint64 LastIssuedFrame = 0;
+		uint64 LastRequestedFrame = 0;
+		uint64 InFlightFrame = 0;
+		bool bHasRequest = false;
+		bool bHasResult = false;
+	};
+
+	void HandleWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+	void HandleTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceData);
+
+	void IssueQueries();
+
+	TMap<int32, FQuerySlot> Slots;
+	int32 NextHandle = 0;
+
+	FTraceDelegate TraceDoneDelegate;
+	FDelegateHandle PostActorTickHandle;
+
+	int32 NumSyncTracesThisFrame = 0;
+	int32 NumSyncTracesLastFrame = 0;
+	int32 NumAsyncTracesLastFrame = 0;
+};
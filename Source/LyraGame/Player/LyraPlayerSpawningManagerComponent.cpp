@@ -1,15 +1,64 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "LyraPlayerSpawningManagerComponent.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/Pawn.h"
 #include "GameFramework/PlayerState.h"
 #include "EngineUtils.h"
 #include "Engine/PlayerStartPIE.h"
+#include "HAL/IConsoleManager.h"
 #include "LyraPlayerStart.h"
+#include "Teams/LyraTeamSubsystem.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(LyraPlayerSpawningManagerComponent)
 
 DEFINE_LOG_CATEGORY_STATIC(LogPlayerSpawning, Log, All);
 
+namespace LyraConsoleVariables
+{
+	static bool bUseSpreadOutPlayerStarts = true;
+	static FAutoConsoleVariableRef CVarUseSpreadOutPlayerStarts(
+		TEXT("lyra.Spawning.SpreadOut"),
+		bUseSpreadOutPlayerStarts,
+		TEXT("Should players restart at the free start furthest from enemies and other restarting players, instead of a random free start?"),
+		ECVF_Default);
+
+	static float SpawnOccupancyCellSize = 400.0f;
+	static FAutoConsoleVariableRef CVarSpawnOccupancyCellSize(
+		TEXT("lyra.Spawning.OccupancyCellSize"),
+		SpawnOccupancyCellSize,
+		TEXT("Size (in cm) of the grid cells used to tell which player starts have pawns near them, must be larger than a pawn"),
+		ECVF_Default);
+
+	static float SpawnOccupancyCacheMaxAge = 10.0f;
+	static FAutoConsoleVariableRef CVarSpawnOccupancyCacheMaxAge(
+		TEXT("lyra.Spawning.OccupancyCacheMaxAge"),
+		SpawnOccupancyCacheMaxAge,
+		TEXT("Seconds a player start's occupancy is reused for when no pawns are near it, to pick up other things that moved onto it"),
+		ECVF_Default);
+
+	static float SpawnSafeEnemyDistance = 3000.0f;
+	static FAutoConsoleVariableRef CVarSpawnSafeEnemyDistance(
+		TEXT("lyra.Spawning.SafeEnemyDistance"),
+		SpawnSafeEnemyDistance,
+		TEXT("Enemies further than this (in cm) from a player start don't make it any less desirable"),
+		ECVF_Default);
+
+	static float SpawnSpreadDistance = 1500.0f;
+	static FAutoConsoleVariableRef CVarSpawnSpreadDistance(
+		TEXT("lyra.Spawning.SpreadDistance"),
+		SpawnSpreadDistance,
+		TEXT("Players restarting in the same frame try to be at least this far (in cm) apart"),
+		ECVF_Default);
+
+	static float SpawnRandomness = 500.0f;
+	static FAutoConsoleVariableRef CVarSpawnRandomness(
+		TEXT("lyra.Spawning.Randomness"),
+		SpawnRandomness,
+		TEXT("Random distance (in cm) added to the score of each player start, so equally good starts are picked evenly"),
+		ECVF_Default);
+}
+
 ULyraPlayerSpawningManagerComponent::ULyraPlayerSpawningManagerComponent(const FObjectInitializer& ObjectInitializer)
 : Super(ObjectInitializer)
 {
@@ -39,6 +88,13 @@ void ULyraPlayerSpawningManagerComponent::InitializeComponent()
 			CachedPlayerStarts.Add(PlayerStart);
 		}
 	}
+	MarkStartPointIndexDirty();
+
+	// Only the server picks player starts, so only it needs to track where the pawns are
+	if (World->GetNetMode() != NM_Client)
+	{
+		SetComponentTickEnabled(true);
+	}
 }
 
 void ULyraPlayerSpawningManagerComponent::OnLevelAdded(ULevel* InLevel, UWorld* InWorld)
@@ -51,6 +107,7 @@ void ULyraPlayerSpawningManagerComponent::OnLevelAdded(ULevel* InLevel, UWorld*
 			{
 				ensure(!CachedPlayerStarts.Contains(PlayerStart));
 				CachedPlayerStarts.Add(PlayerStart);
+				MarkStartPointIndexDirty();
 			}
 		}
 	}
@@ -61,6 +118,15 @@ void ULyraPlayerSpawningManagerComponent::HandleOnActorSpawned(AActor* SpawnedAc
 	if (ALyraPlayerStart* PlayerStart = Cast<ALyraPlayerStart>(SpawnedActor))
 	{
 		CachedPlayerStarts.Add(PlayerStart);
+		MarkStartPointIndexDirty();
+	}
+	else if (APawn* Pawn = Cast<APawn>(SpawnedActor))
+	{
+		// Track new pawns straight away, so a start a player was just restarted at isn't trusted as empty until the next tick
+		if (IsComponentTickEnabled() && !bStartPointIndexDirty)
+		{
+			TrackPawn(Pawn, TrackingPass);
+		}
 	}
 }
 
@@ -89,6 +155,7 @@ AActor* ULyraPlayerSpawningManagerComponent::ChoosePlayerStart(AController* Play
 			else
 			{
 				StartIt.RemoveCurrent();
+				MarkStartPointIndexDirty();
 			}
 		}
 
@@ -108,6 +175,11 @@ AActor* ULyraPlayerSpawningManagerComponent::ChoosePlayerStart(AController* Play
 
 		AActor* PlayerStart = OnChoosePlayerStart(Player, StarterPoints);
 
+		if (!PlayerStart && LyraConsoleVariables::bUseSpreadOutPlayerStarts)
+		{
+			PlayerStart = ChooseSpreadOutPlayerStart(Player);
+		}
+
 		if (!PlayerStart)
 		{
 			PlayerStart = GetFirstRandomUnoccupiedPlayerStart(Player, StarterPoints);
@@ -170,41 +242,351 @@ void ULyraPlayerSpawningManagerComponent::FinishRestartPlayer(AController* NewPl
 void ULyraPlayerSpawningManagerComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	UpdateTrackedPawns();
+}
+
+void ULyraPlayerSpawningManagerComponent::ChoosePlayerStarts(TArrayView<AController* const> Players, TArray<AActor*>& OutStarts)
+{
+	OutStarts.Reset(Players.Num());
+
+	// Every ChoosePlayerStart this frame shares the picked starts and enemy distances, so the players spread out between them
+	for (AController* Player : Players)
+	{
+		OutStarts.Add(ChoosePlayerStart(Player));
+	}
+}
+
+//================================================================
+// Spatial index and occupancy cache
+
+FIntVector ULyraPlayerSpawningManagerComponent::GetGridCell(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt32(Location.X / GridCellSize),
+		FMath::FloorToInt32(Location.Y / GridCellSize),
+		FMath::FloorToInt32(Location.Z / GridCellSize));
+}
+
+void ULyraPlayerSpawningManagerComponent::RebuildStartPointIndex()
+{
+	bStartPointIndexDirty = false;
+	GridCellSize = FMath::Max(LyraConsoleVariables::SpawnOccupancyCellSize, 100.0f);
+
+	// Keep what we already know about starts that are still around
+	TMap<TObjectKey<ALyraPlayerStart>, FStartPointInfo> PreviousInfo;
+	for (FStartPointInfo& Info : StartPoints)
+	{
+		PreviousInfo.Add(Info.StartPoint.Get(), MoveTemp(Info));
+	}
+
+	StartPoints.Reset();
+	StartPointIndices.Reset();
+	StartPointGrid.Reset();
+
+	for (const TWeakObjectPtr<ALyraPlayerStart>& WeakStart : CachedPlayerStarts)
+	{
+		ALyraPlayerStart* StartPoint = WeakStart.Get();
+		if ((StartPoint == nullptr) || StartPointIndices.Contains(StartPoint))
+		{
+			continue;
+		}
+
+		FStartPointInfo Info;
+		if (FStartPointInfo* Previous = PreviousInfo.Find(StartPoint))
+		{
+			Info = MoveTemp(*Previous);
+		}
+		Info.StartPoint = StartPoint;
+		Info.Location = StartPoint->GetActorLocation();
+		Info.NumNearbyPawns = 0;
+
+		const int32 Index = StartPoints.Add(MoveTemp(Info));
+		StartPointIndices.Add(StartPoint, Index);
+		StartPointGrid.FindOrAdd(GetGridCell(StartPoints[Index].Location)).Add(Index);
+	}
+
+	// Cells may have changed size, so re-add every pawn
+	TrackedPawns.Reset();
+	++TrackingPass;
+	if (IsComponentTickEnabled())
+	{
+		for (TActorIterator<APawn> It(GetWorld()); It; ++It)
+		{
+			TrackPawn(*It, TrackingPass);
+		}
+	}
+
+	SelectionBatchFrame = 0;
+}
+
+void ULyraPlayerSpawningManagerComponent::AdjustNearbyPawnCounts(const FIntVector& Cell, int32 Delta)
+{
+	for (int32 Z = -1; Z <= 1; ++Z)
+	{
+		for (int32 Y = -1; Y <= 1; ++Y)
+		{
+			for (int32 X = -1; X <= 1; ++X)
+			{
+				if (const TArray<int32>* StartIndices = StartPointGrid.Find(Cell + FIntVector(X, Y, Z)))
+				{
+					for (const int32 StartIndex : *StartIndices)
+					{
+						StartPoints[StartIndex].NumNearbyPawns += Delta;
+					}
+				}
+			}
+		}
+	}
+}
+
+void ULyraPlayerSpawningManagerComponent::TrackPawn(APawn* Pawn, uint32 Pass)
+{
+	const FIntVector Cell = GetGridCell(Pawn->GetActorLocation());
+
+	FTrackedPawn* Tracked = TrackedPawns.Find(Pawn);
+	if (Tracked == nullptr)
+	{
+		Tracked = &TrackedPawns.Add(Pawn);
+		Tracked->Pawn = Pawn;
+		Tracked->Cell = Cell;
+		AdjustNearbyPawnCounts(Cell, 1);
+	}
+	else if (Tracked->Cell != Cell)
+	{
+		AdjustNearbyPawnCounts(Tracked->Cell, -1);
+		AdjustNearbyPawnCounts(Cell, 1);
+		Tracked->Cell = Cell;
+	}
+
+	Tracked->LastSeenPass = Pass;
+}
+
+void ULyraPlayerSpawningManagerComponent::UpdateTrackedPawns()
+{
+	if (bStartPointIndexDirty || (GridCellSize != FMath::Max(LyraConsoleVariables::SpawnOccupancyCellSize, 100.0f)))
+	{
+		RebuildStartPointIndex();
+	}
+
+	// Only pawns that changed cell touch the start points
+	const uint32 Pass = ++TrackingPass;
+	for (TActorIterator<APawn> It(GetWorld()); It; ++It)
+	{
+		TrackPawn(*It, Pass);
+	}
+
+	for (auto It = TrackedPawns.CreateIterator(); It; ++It)
+	{
+		if ((It->Value.LastSeenPass != Pass) || !It->Value.Pawn.IsValid())
+		{
+			AdjustNearbyPawnCounts(It->Value.Cell, -1);
+			It.RemoveCurrent();
+		}
+	}
+}
+
+ELyraPlayerStartLocationOccupancy ULyraPlayerSpawningManagerComponent::GetCachedLocationOccupancy(ALyraPlayerStart* StartPoint, AController* Controller) const
+{
+	const int32* StartIndex = StartPointIndices.Find(StartPoint);
+	if ((StartIndex == nullptr) || bStartPointIndexDirty || !IsComponentTickEnabled())
+	{
+		return StartPoint->GetLocationOccupancy(Controller);
+	}
+
+	AGameModeBase* GameMode = GetWorld()->GetAuthGameMode();
+	const UClass* PawnClass = GameMode ? GameMode->GetDefaultPawnClassForController(Controller) : nullptr;
+	return GetCachedLocationOccupancy(*StartIndex, Controller, PawnClass);
+}
+
+ELyraPlayerStartLocationOccupancy ULyraPlayerSpawningManagerComponent::GetCachedLocationOccupancy(int32 StartIndex, AController* Controller, const UClass* PawnClass) const
+{
+	FStartPointInfo& Info = StartPoints[StartIndex];
+	ALyraPlayerStart* StartPoint = Info.StartPoint.Get();
+	if (StartPoint == nullptr)
+	{
+		return ELyraPlayerStartLocationOccupancy::Full;
+	}
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	if ((Info.NumNearbyPawns == 0) && Info.bHasCachedOccupancy && (Info.CachedPawnClass == PawnClass) && ((Now - Info.CachedOccupancyTime) < LyraConsoleVariables::SpawnOccupancyCacheMaxAge))
+	{
+		return (ELyraPlayerStartLocationOccupancy)Info.CachedOccupancy;
+	}
+
+	const ELyraPlayerStartLocationOccupancy Occupancy = StartPoint->GetLocationOccupancy(Controller);
+
+	// With no pawns around only the level decides the result, so it stays valid until a pawn comes near
+	Info.bHasCachedOccupancy = (Info.NumNearbyPawns == 0);
+	Info.CachedOccupancy = (uint8)Occupancy;
+	Info.CachedPawnClass = PawnClass;
+	Info.CachedOccupancyTime = Now;
+
+	return Occupancy;
+}
+
+const TArray<double>& ULyraPlayerSpawningManagerComponent::GetNearestEnemyDistancesSquared(int32 TeamId)
+{
+	if (TArray<double>* Existing = SelectionBatchEnemyDistances.Find(TeamId))
+	{
+		return *Existing;
+	}
+
+	TArray<double>& Distances = SelectionBatchEnemyDistances.Add(TeamId);
+	Distances.Init(UE_DOUBLE_BIG_NUMBER, StartPoints.Num());
+
+	const ULyraTeamSubsystem* TeamSubsystem = GetWorld()->GetSubsystem<ULyraTeamSubsystem>();
+	for (const TPair<TObjectKey<APawn>, FTrackedPawn>& Pair : TrackedPawns)
+	{
+		const APawn* Pawn = Pair.Value.Pawn.Get();
+		if ((Pawn == nullptr) || (Pawn->GetController() == nullptr))
+		{
+			continue;
+		}
+
+		// Without a team to compare against, everyone else counts as an enemy
+		const int32 PawnTeamId = TeamSubsystem ? TeamSubsystem->FindTeamFromObject(Pawn) : INDEX_NONE;
+		if ((TeamId != INDEX_NONE) && (PawnTeamId == TeamId))
+		{
+			continue;
+		}
+
+		const FVector PawnLocation = Pawn->GetActorLocation();
+		for (int32 StartIndex = 0; StartIndex < StartPoints.Num(); ++StartIndex)
+		{
+			Distances[StartIndex] = FMath::Min(Distances[StartIndex], FVector::DistSquared(PawnLocation, StartPoints[StartIndex].Location));
+		}
+	}
+
+	return Distances;
+}
+
+ALyraPlayerStart* ULyraPlayerSpawningManagerComponent::ChooseSpreadOutPlayerStart(AController* Controller)
+{
+	if ((Controller == nullptr) || !IsComponentTickEnabled())
+	{
+		return nullptr;
+	}
+
+	if (bStartPointIndexDirty)
+	{
+		RebuildStartPointIndex();
+	}
+
+	if (SelectionBatchFrame != GFrameCounter)
+	{
+		SelectionBatchFrame = GFrameCounter;
+		SelectionBatchPickedLocations.Reset();
+		SelectionBatchEnemyDistances.Reset();
+	}
+
+	const ULyraTeamSubsystem* TeamSubsystem = GetWorld()->GetSubsystem<ULyraTeamSubsystem>();
+	const int32 TeamId = TeamSubsystem ? TeamSubsystem->FindTeamFromObject(Controller) : INDEX_NONE;
+	const TArray<double>& NearestEnemyDistancesSquared = GetNearestEnemyDistancesSquared(TeamId);
+
+	AGameModeBase* GameMode = GetWorld()->GetAuthGameMode();
+	const UClass* PawnClass = GameMode ? GameMode->GetDefaultPawnClassForController(Controller) : nullptr;
+
+	const double SafeEnemyDistance = LyraConsoleVariables::SpawnSafeEnemyDistance;
+	const double SpreadDistance = LyraConsoleVariables::SpawnSpreadDistance;
+
+	// Empty starts beat partially occupied ones, which beat starts somebody has claimed or was given this frame
+	int32 BestIndex = INDEX_NONE;
+	int32 BestTier = MAX_int32;
+	double BestScore = -UE_DOUBLE_BIG_NUMBER;
+
+	for (int32 StartIndex = 0; StartIndex < StartPoints.Num(); ++StartIndex)
+	{
+		const FStartPointInfo& Info = StartPoints[StartIndex];
+		const ALyraPlayerStart* StartPoint = Info.StartPoint.Get();
+		if (StartPoint == nullptr)
+		{
+			continue;
+		}
+
+		double NearestPickedDistanceSquared = UE_DOUBLE_BIG_NUMBER;
+		for (const FVector& PickedLocation : SelectionBatchPickedLocations)
+		{
+			NearestPickedDistanceSquared = FMath::Min(NearestPickedDistanceSquared, FVector::DistSquared(PickedLocation, Info.Location));
+		}
+
+		const bool bTaken = StartPoint->IsClaimed() || (NearestPickedDistanceSquared < UE_KINDA_SMALL_NUMBER);
+		const int32 MinTier = bTaken ? 2 : 0;
+		if (MinTier > BestTier)
+		{
+			continue;
+		}
+
+		const ELyraPlayerStartLocationOccupancy Occupancy = GetCachedLocationOccupancy(StartIndex, Controller, PawnClass);
+		if (Occupancy == ELyraPlayerStartLocationOccupancy::Full)
+		{
+			continue;
+		}
+
+		const int32 Tier = bTaken ? 2 : ((Occupancy == ELyraPlayerStartLocationOccupancy::Empty) ? 0 : 1);
+		const double Score =
+			FMath::Min(FMath::Sqrt(NearestEnemyDistancesSquared[StartIndex]), SafeEnemyDistance) +
+			FMath::Min(FMath::Sqrt(NearestPickedDistanceSquared), SpreadDistance) +
+			(FMath::FRand() * LyraConsoleVariables::SpawnRandomness);
+
+		if ((Tier < BestTier) || ((Tier == BestTier) && (Score > BestScore)))
+		{
+			BestIndex = StartIndex;
+			BestTier = Tier;
+			BestScore = Score;
+		}
+	}
+
+	if (BestIndex == INDEX_NONE)
+	{
+		return nullptr;
+	}
+
+	SelectionBatchPickedLocations.Add(StartPoints[BestIndex].Location);
+	return StartPoints[BestIndex].StartPoint.Get();
 }
 
 APlayerStart* ULyraPlayerSpawningManagerComponent::GetFirstRandomUnoccupiedPlayerStart(AController* Controller, const TArray<ALyraPlayerStart*>& StartPoints) const
 {
 	if (Controller)
 	{
-		TArray<ALyraPlayerStart*> UnOccupiedStartPoints;
-		TArray<ALyraPlayerStart*> OccupiedStartPoints;
+		// Pick uniformly from the empty starts (or the partially occupied ones if none are empty) in a single pass
+		ALyraPlayerStart* ChosenUnOccupied = nullptr;
+		ALyraPlayerStart* ChosenOccupied = nullptr;
+		int32 NumUnOccupied = 0;
+		int32 NumOccupied = 0;
 
 		for (ALyraPlayerStart* StartPoint : StartPoints)
 		{
-			ELyraPlayerStartLocationOccupancy State = StartPoint->GetLocationOccupancy(Controller);
+			ELyraPlayerStartLocationOccupancy State = GetCachedLocationOccupancy(StartPoint, Controller);
 
 			switch (State)
 			{
 				case ELyraPlayerStartLocationOccupancy::Empty:
-					UnOccupiedStartPoints.Add(StartPoint);
+					if (FMath::RandRange(0, NumUnOccupied++) == 0)
+					{
+						ChosenUnOccupied = StartPoint;
+					}
 					break;
 				case ELyraPlayerStartLocationOccupancy::Partial:
-					OccupiedStartPoints.Add(StartPoint);
+					if ((NumUnOccupied == 0) && (FMath::RandRange(0, NumOccupied++) == 0))
+					{
+						ChosenOccupied = StartPoint;
+					}
 					break;
 
 			}
 		}
 
-		if (UnOccupiedStartPoints.Num() > 0)
+		if (ChosenUnOccupied)
 		{
-			return UnOccupiedStartPoints[FMath::RandRange(0, UnOccupiedStartPoints.Num() - 1)];
+			return ChosenUnOccupied;
 		}
-		else if (OccupiedStartPoints.Num() > 0)
+		else if (ChosenOccupied)
 		{
-			return OccupiedStartPoints[FMath::RandRange(0, OccupiedStartPoints.Num() - 1)];
+			return ChosenOccupied;
 		}
 	}
 
 	return nullptr;
 }
-
@@ -3,6 +3,8 @@
 #pragma once
 
 #include "Components/GameStateComponent.h"
+#include "Player/LyraPlayerStart.h"
+#include "UObject/ObjectKey.h"
 
 #include "LyraPlayerSpawningManagerComponent.generated.h"
 
@@ -14,9 +16,14 @@ class APlayerState;
 class APlayerStart;
 class ALyraPlayerStart;
 class AActor;
+class APawn;
 
 /**
  * @class ULyraPlayerSpawningManagerComponent
+ *
+ * On the server, player starts are kept in a coarse grid and the cells that pawns are in are tracked each tick. The
+ * occupancy of a start is only checked against the world while a pawn is in or next to its cell, otherwise the last
+ * result is reused. Players restarting in the same frame are picked as one batch, spread out and away from enemies.
  */
 UCLASS(MinimalAPI)
 class ULyraPlayerSpawningManagerComponent : public UGameStateComponent
@@ -31,9 +38,21 @@ public:
 	UE_API virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 	/** ~UActorComponent */
 
+	/**
+	 * Picks and claims a start for each of Players in one pass (e.g. a wave respawn), spreading them out and keeping them away from enemies.
+	 * OutStarts has one entry per player, null if there was nowhere to put them.
+	 */
+	UE_API void ChoosePlayerStarts(TArrayView<AController* const> Players, TArray<AActor*>& OutStarts);
+
 protected:
 	// Utility
 	UE_API APlayerStart* GetFirstRandomUnoccupiedPlayerStart(AController* Controller, const TArray<ALyraPlayerStart*>& FoundStartPoints) const;
+
+	/** Picks the free start furthest from Controller's enemies and from the other starts picked this frame */
+	UE_API ALyraPlayerStart* ChooseSpreadOutPlayerStart(AController* Controller);
+
+	/** Occupancy of a start for Controller's pawn, reusing the last result when no pawn has been near it since */
+	UE_API ELyraPlayerStartLocationOccupancy GetCachedLocationOccupancy(ALyraPlayerStart* StartPoint, AController* Controller) const;
 	
 	virtual AActor* OnChoosePlayerStart(AController* Player, TArray<ALyraPlayerStart*>& PlayerStarts) { return nullptr; }
 	virtual void OnFinishRestartPlayer(AController* Player, const FRotator& StartRotation) { }
@@ -57,6 +76,54 @@ private:
 	UE_API void OnLevelAdded(ULevel* InLevel, UWorld* InWorld);
 	UE_API void HandleOnActorSpawned(AActor* SpawnedActor);
 
+	struct FStartPointInfo
+	{
+		TWeakObjectPtr<ALyraPlayerStart> StartPoint;
+		FVector Location = FVector::ZeroVector;
+
+		// Pawns in this start's cell or the ones around it, while above zero the cached occupancy can't be trusted
+		int32 NumNearbyPawns = 0;
+
+		// Occupancy when no pawns were nearby, for the pawn class it was checked with
+		TObjectKey<UClass> CachedPawnClass;
+		double CachedOccupancyTime = 0.0;
+		uint8 CachedOccupancy = 0;
+		bool bHasCachedOccupancy = false;
+	};
+
+	struct FTrackedPawn
+	{
+		TWeakObjectPtr<APawn> Pawn;
+		FIntVector Cell = FIntVector::ZeroValue;
+		uint32 LastSeenPass = 0;
+	};
+
+	FIntVector GetGridCell(const FVector& Location) const;
+	void MarkStartPointIndexDirty() { bStartPointIndexDirty = true; }
+	void RebuildStartPointIndex();
+	void UpdateTrackedPawns();
+	void TrackPawn(APawn* Pawn, uint32 Pass);
+	void AdjustNearbyPawnCounts(const FIntVector& Cell, int32 Delta);
+	ELyraPlayerStartLocationOccupancy GetCachedLocationOccupancy(int32 StartIndex, AController* Controller, const UClass* PawnClass) const;
+
+	/** Nearest enemy pawn distance (squared) of every start, for players on TeamId, built once per frame per team */
+	const TArray<double>& GetNearestEnemyDistancesSquared(int32 TeamId);
+
+	// Spatial index of CachedPlayerStarts, rebuilt when starts come and go
+	mutable TArray<FStartPointInfo> StartPoints;
+	TMap<TObjectKey<ALyraPlayerStart>, int32> StartPointIndices;
+	TMap<FIntVector, TArray<int32>> StartPointGrid;
+	float GridCellSize = 1.0f;
+	bool bStartPointIndexDirty = true;
+
+	TMap<TObjectKey<APawn>, FTrackedPawn> TrackedPawns;
+	uint32 TrackingPass = 0;
+
+	// Starts picked this frame and enemy distances, shared by every player restarting this frame
+	uint64 SelectionBatchFrame = 0;
+	TArray<FVector> SelectionBatchPickedLocations;
+	TMap<int32, TArray<double>> SelectionBatchEnemyDistances;
+
 #if WITH_EDITOR
 	UE_API APlayerStart* FindPlayFromHereStart(AController* Player);
 #endif
@@ -2,6 +2,9 @@
 
 #include "GameplayTagStack.h"
 
+#include "GameplayTagsManager.h"
+#include "HAL/IConsoleManager.h"
+#include "LyraLogChannels.h"
 #include "UObject/Stack.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(GameplayTagStack)
@@ -17,6 +20,71 @@ FString FGameplayTagStack::GetDebugString() const
 //////////////////////////////////////////////////////////////////////
 // FGameplayTagStackContainer
 
+int32 FGameplayTagStackContainer::FindStackIndex(FGameplayTag Tag) const
+{
+	if (bStackIndexDirty)
+	{
+		RebuildStackIndex();
+	}
+
+	const int32* StackIndex = TagToStackIndex.Find(Tag);
+	return StackIndex ? *StackIndex : INDEX_NONE;
+}
+
+void FGameplayTagStackContainer::RebuildStackIndex() const
+{
+	TagToStackIndex.Reset();
+	for (int32 StackIndex = 0; StackIndex < Stacks.Num(); ++StackIndex)
+	{
+		TagToStackIndex.Add(Stacks[StackIndex].Tag, StackIndex);
+	}
+
+	bStackIndexDirty = false;
+}
+
+void FGameplayTagStackContainer::AddStackInternal(FGameplayTag Tag, int32 StackCount)
+{
+	const int32 StackIndex = FindStackIndex(Tag);
+	if (StackIndex != INDEX_NONE)
+	{
+		FGameplayTagStack& Stack = Stacks[StackIndex];
+		Stack.StackCount += StackCount;
+		MarkItemDirty(Stack);
+	}
+	else
+	{
+		const int32 NewStackIndex = Stacks.Emplace(Tag, StackCount);
+		TagToStackIndex.Add(Tag, NewStackIndex);
+		MarkItemDirty(Stacks[NewStackIndex]);
+	}
+}
+
+bool FGameplayTagStackContainer::RemoveStackInternal(FGameplayTag Tag, int32 StackCount)
+{
+	const int32 StackIndex = FindStackIndex(Tag);
+	if (StackIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	FGameplayTagStack& Stack = Stacks[StackIndex];
+	if (Stack.StackCount <= StackCount)
+	{
+		// Items are matched by replication ID rather than position, so swapping the last entry in keeps this O(1)
+		TagToStackIndex.Remove(Tag);
+		Stacks.RemoveAtSwap(StackIndex, EAllowShrinking::No);
+		if (Stacks.IsValidIndex(StackIndex))
+		{
+			TagToStackIndex[Stacks[StackIndex].Tag] = StackIndex;
+		}
+		return true;
+	}
+
+	Stack.StackCount -= StackCount;
+	MarkItemDirty(Stack);
+	return false;
+}
+
 void FGameplayTagStackContainer::AddStack(FGameplayTag Tag, int32 StackCount)
 {
 	if (!Tag.IsValid())
@@ -27,21 +95,7 @@ void FGameplayTagStackContainer::AddStack(FGameplayTag Tag, int32 StackCount)
 
 	if (StackCount > 0)
 	{
-		for (FGameplayTagStack& Stack : Stacks)
-		{
-			if (Stack.Tag == Tag)
-			{
-				const int32 NewCount = Stack.StackCount + StackCount;
-				Stack.StackCount = NewCount;
-				TagToCountMap[Tag] = NewCount;
-				MarkItemDirty(Stack);
-				return;
-			}
-		}
-
-		FGameplayTagStack& NewStack = Stacks.Emplace_GetRef(Tag, StackCount);
-		MarkItemDirty(NewStack);
-		TagToCountMap.Add(Tag, StackCount);
+		AddStackInternal(Tag, StackCount);
 	}
 }
 
@@ -56,54 +110,152 @@ void FGameplayTagStackContainer::RemoveStack(FGameplayTag Tag, int32 StackCount)
 	//@TODO: Should we error if you try to remove a stack that doesn't exist or has a smaller count?
 	if (StackCount > 0)
 	{
-		for (auto It = Stacks.CreateIterator(); It; ++It)
+		if (RemoveStackInternal(Tag, StackCount))
 		{
-			FGameplayTagStack& Stack = *It;
-			if (Stack.Tag == Tag)
-			{
-				if (Stack.StackCount <= StackCount)
-				{
-					It.RemoveCurrent();
-					TagToCountMap.Remove(Tag);
-					MarkArrayDirty();
-				}
-				else
-				{
-					const int32 NewCount = Stack.StackCount - StackCount;
-					Stack.StackCount = NewCount;
-					TagToCountMap[Tag] = NewCount;
-					MarkItemDirty(Stack);
-				}
-				return;
-			}
+			MarkArrayDirty();
 		}
 	}
 }
 
-void FGameplayTagStackContainer::PreReplicatedRemove(const TArrayView<int32> RemovedIndices, int32 FinalSize)
+void FGameplayTagStackContainer::AddStacks(TConstArrayView<TPair<FGameplayTag, int32>> TagsAndCounts)
 {
-	for (int32 Index : RemovedIndices)
+	for (const TPair<FGameplayTag, int32>& TagAndCount : TagsAndCounts)
 	{
-		const FGameplayTag Tag = Stacks[Index].Tag;
-		TagToCountMap.Remove(Tag);
+		if (!TagAndCount.Key.IsValid())
+		{
+			FFrame::KismetExecutionMessage(TEXT("An invalid tag was passed to AddStacks"), ELogVerbosity::Warning);
+			continue;
+		}
+
+		if (TagAndCount.Value > 0)
+		{
+			AddStackInternal(TagAndCount.Key, TagAndCount.Value);
+		}
 	}
 }
 
-void FGameplayTagStackContainer::PostReplicatedAdd(const TArrayView<int32> AddedIndices, int32 FinalSize)
+void FGameplayTagStackContainer::RemoveStacks(TConstArrayView<TPair<FGameplayTag, int32>> TagsAndCounts)
 {
-	for (int32 Index : AddedIndices)
+	bool bRemovedAnyStacks = false;
+	for (const TPair<FGameplayTag, int32>& TagAndCount : TagsAndCounts)
 	{
-		const FGameplayTagStack& Stack = Stacks[Index];
-		TagToCountMap.Add(Stack.Tag, Stack.StackCount);
+		if (!TagAndCount.Key.IsValid())
+		{
+			FFrame::KismetExecutionMessage(TEXT("An invalid tag was passed to RemoveStacks"), ELogVerbosity::Warning);
+			continue;
+		}
+
+		if (TagAndCount.Value > 0)
+		{
+			bRemovedAnyStacks |= RemoveStackInternal(TagAndCount.Key, TagAndCount.Value);
+		}
+	}
+
+	if (bRemovedAnyStacks)
+	{
+		MarkArrayDirty();
 	}
 }
 
-void FGameplayTagStackContainer::PostReplicatedChange(const TArrayView<int32> ChangedIndices, int32 FinalSize)
+void FGameplayTagStackContainer::CopyStacksFrom(const FGameplayTagStackContainer& Source)
 {
-	for (int32 Index : ChangedIndices)
+	if (!Stacks.IsEmpty())
 	{
-		const FGameplayTagStack& Stack = Stacks[Index];
-		TagToCountMap[Stack.Tag] = Stack.StackCount;
+		Stacks.Reset();
+		TagToStackIndex.Reset();
+		MarkArrayDirty();
+	}
+
+	for (const FGameplayTagStack& Stack : Source.Stacks)
+	{
+		AddStackInternal(Stack.Tag, Stack.StackCount);
 	}
 }
 
+void FGameplayTagStackContainer::PreReplicatedRemove(const TArrayView<int32> RemovedIndices, int32 FinalSize)
+{
+	// The serializer removes the entries after this returns and may move others around, so the index is rebuilt lazily
+	bStackIndexDirty = true;
+}
+
+void FGameplayTagStackContainer::PostReplicatedAdd(const TArrayView<int32> AddedIndices, int32 FinalSize)
+{
+	bStackIndexDirty = true;
+}
+
+void FGameplayTagStackContainer::PostReplicatedChange(const TArrayView<int32> ChangedIndices, int32 FinalSize)
+{
+	// Only counts changed, which are read straight from Stacks
+}
+
+//////////////////////////////////////////////////////////////////////
+
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommand LyraGameplayTagStackBenchmarkCmd(
+	TEXT("Lyra.GameplayTagStack.Benchmark"),
+	TEXT("Usage: Lyra.GameplayTagStack.Benchmark <Iterations=1000>. Times stack add/query/remove on containers holding 10 to 500 tags."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		int32 Iterations = 1000;
+		if (Args.Num() > 0) { LexTryParseString<int32>(Iterations, *Args[0]); }
+		Iterations = FMath::Max(Iterations, 1);
+
+		FGameplayTagContainer AllTags;
+		UGameplayTagsManager::Get().RequestAllGameplayTags(AllTags, /*OnlyIncludeDictionaryTags=*/ false);
+
+		TArray<FGameplayTag> Tags;
+		AllTags.GetGameplayTagArray(Tags);
+
+		const int32 TagCounts[] = { 10, 50, 100, 250, 500 };
+		for (const int32 RequestedNumTags : TagCounts)
+		{
+			const int32 NumTags = FMath::Min(RequestedNumTags, Tags.Num());
+			TConstArrayView<FGameplayTag> BenchmarkTags = MakeArrayView(Tags).Left(NumTags);
+
+			TArray<TPair<FGameplayTag, int32>> Batch;
+			for (const FGameplayTag& Tag : BenchmarkTags)
+			{
+				Batch.Emplace(Tag, 2);
+			}
+
+			FGameplayTagStackContainer Container;
+			int64 Checksum = 0;
+
+			// Single changes, as gameplay code does for ammo and charges
+			const double SingleStartTime = FPlatformTime::Seconds();
+			for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+			{
+				for (const FGameplayTag& Tag : BenchmarkTags)
+				{
+					Container.AddStack(Tag, 2);
+				}
+				for (const FGameplayTag& Tag : BenchmarkTags)
+				{
+					Checksum += Container.GetStackCount(Tag);
+				}
+				for (const FGameplayTag& Tag : BenchmarkTags)
+				{
+					Container.RemoveStack(Tag, 2);
+				}
+			}
+			const double SingleSeconds = FPlatformTime::Seconds() - SingleStartTime;
+
+			// The same changes through the batched calls
+			const double BatchStartTime = FPlatformTime::Seconds();
+			for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+			{
+				Container.AddStacks(Batch);
+				for (const FGameplayTag& Tag : BenchmarkTags)
+				{
+					Checksum += Container.GetStackCount(Tag);
+				}
+				Container.RemoveStacks(Batch);
+			}
+			const double BatchSeconds = FPlatformTime::Seconds() - BatchStartTime;
+
+			const double NumOps = 3.0 * NumTags * Iterations;
+			UE_LOG(LogLyra, Display, TEXT("GameplayTagStack benchmark: %3d tags, single %.1f ns/op, batched %.1f ns/op (checksum %lld)"),
+				NumTags, (SingleSeconds * 1.0e9) / NumOps, (BatchSeconds * 1.0e9) / NumOps, Checksum);
+		}
+	}));
+#endif // !UE_BUILD_SHIPPING
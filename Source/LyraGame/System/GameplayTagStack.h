@@ -57,16 +57,26 @@ public:
 	// Removes a specified number of stacks from the tag (does nothing if StackCount is below 1)
 	void RemoveStack(FGameplayTag Tag, int32 StackCount);
 
+	// Adds stacks to several tags at once, each added or changed entry is marked dirty the same way AddStack would
+	void AddStacks(TConstArrayView<TPair<FGameplayTag, int32>> TagsAndCounts);
+
+	// Removes stacks from several tags at once, removed entries are only marked dirty once for the whole batch
+	void RemoveStacks(TConstArrayView<TPair<FGameplayTag, int32>> TagsAndCounts);
+
+	// Replaces every stack with the stacks of another container
+	void CopyStacksFrom(const FGameplayTagStackContainer& Source);
+
 	// Returns the stack count of the specified tag (or 0 if the tag is not present)
 	int32 GetStackCount(FGameplayTag Tag) const
 	{
-		return TagToCountMap.FindRef(Tag);
+		const int32 StackIndex = FindStackIndex(Tag);
+		return (StackIndex != INDEX_NONE) ? Stacks[StackIndex].StackCount : 0;
 	}
 
 	// Returns true if there is at least one stack of the specified tag
 	bool ContainsTag(FGameplayTag Tag) const
 	{
-		return TagToCountMap.Contains(Tag);
+		return FindStackIndex(Tag) != INDEX_NONE;
 	}
 
 	//~FFastArraySerializer contract
@@ -81,12 +91,23 @@ public:
 	}
 
 private:
+	int32 FindStackIndex(FGameplayTag Tag) const;
+	void RebuildStackIndex() const;
+
+	void AddStackInternal(FGameplayTag Tag, int32 StackCount);
+
+	// Returns true if the tag's entry was removed from Stacks, the caller is responsible for marking the array dirty
+	bool RemoveStackInternal(FGameplayTag Tag, int32 StackCount);
+
 	// Replicated list of gameplay tag stacks
 	UPROPERTY()
 	TArray<FGameplayTagStack> Stacks;
 	
-	// Accelerated list of tag stacks for queries
-	TMap<FGameplayTag, int32> TagToCountMap;
+	// Index of each tag's entry in Stacks, the counts themselves are only stored in Stacks
+	mutable TMap<FGameplayTag, int32> TagToStackIndex;
+
+	// Set when replication adds or removes entries (which can reorder Stacks), the index is rebuilt on the next query
+	mutable bool bStackIndexDirty = false;
 };
 
 template<>
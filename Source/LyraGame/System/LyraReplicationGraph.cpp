@@ -27,6 +27,11 @@
 *		This is the spatialization node. All "distance based relevant" actors will be routed here. This node divides the map into a 2D grid. Each cell in the grid contains 
 *		children nodes that hold lists of actors based on how they update/go dormant. Actors are put in multiple cells. Connections pull from the single cell they are in.
 *		
+*		ULyraReplicationGraphNode_DenseGrid
+*		Spatialization node for classes mapped to Spatialize_Dense (typically AI minions). Each actor lives in a single cell and connections gather every occupied cell in range,
+*		so hundreds of moving actors do not have to be copied into every cell their cull distance touches each frame. Cells are split into priority tiers, and lower tiers are
+*		gathered less often.
+*		
 *		UReplicationGraphNode_ActorList
 *		This is an actor list node that contains the always relevant actors. These actors are always relevant to every connection.
 *		
@@ -40,6 +45,11 @@
 *		to simulated connections at a low, steady frequency, and to take advantage of serialization sharing. Auto proxy player states are replicated at higher frequency (to the
 *		owning connection only) via ULyraReplicationGraphNode_AlwaysRelevant_ForConnection.
 *		
+*		ULyraReplicationGraphNode_AdaptiveFrequencyLimiter
+*		Used instead of the above when Lyra.RepGraph.AdaptiveFrequency.Enable is set. Each connection measures its own saturation (queued bits, packet loss) and saturated
+*		connections get the rolling buckets spread over more frames, with a longer per actor replication period. Per connection levels are printed by Lyra.RepGraph.PrintRouting
+*		and recorded in the LyraRepGraph CSV category.
+*		
 *		UReplicationGraphNode_TearOff_ForConnection
 *		Connection specific node for handling tear off actors. This is created and managed in the base implementation of Replication Graph.
 *	
@@ -65,6 +75,8 @@
 *		Net.RepGraph.PrintAllActorInfo <ActorMatchString> - will print the class, global, and connection replication info associated with an actor/class. If MatchString is empty will print everything. Call directly from client.
 *		
 *		Lyra.RepGraph.PrintRouting - will print the EClassRepNodeMapping for each class. That is, how a given actor class is routed (or not) in the Replication Graph.
+*		
+*		Lyra.RepGraph.DenseGrid.Benchmark <NumActors> <NumConnections> <Frames> <MovingPct> - times the dense grid node on the server with dummy actors and simulated viewers.
 *	
 */
 
@@ -74,6 +86,7 @@
 #include "Engine/LevelStreaming.h"
 #include "EngineUtils.h"
 #include "CoreGlobals.h"
+#include "ProfilingDebugging/CsvProfiler.h"
 
 #if WITH_GAMEPLAY_DEBUGGER
 #include "GameplayDebuggerCategoryReplicator.h"
@@ -85,14 +98,19 @@
 #include "GameFramework/Pawn.h"
 #include "Engine/LevelScriptActor.h"
 #include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Components/SceneComponent.h"
 #include "UObject/UObjectIterator.h"
 
 #include "LyraReplicationGraphSettings.h"
 #include "Character/LyraCharacter.h"
+#include "Performance/LyraServerPerformanceRecorder.h"
 #include "Player/LyraPlayerController.h"
 
 DEFINE_LOG_CATEGORY( LogLyraRepGraph );
 
+CSV_DEFINE_CATEGORY(LyraRepGraph, /*bIsEnabledByDefault=*/false);
+
 namespace Lyra::RepGraph
 {
 	float DestructionInfoMaxDist = 30000.f;
@@ -132,6 +150,42 @@ namespace Lyra::RepGraph
 	int32 EnableFastSharedPath = 1;
 	static FAutoConsoleVariableRef CVarLyraRepEnableFastSharedPath(TEXT("Lyra.RepGraph.EnableFastSharedPath"), EnableFastSharedPath, TEXT(""), ECVF_Default);
 
+	int32 EnableDenseGrid = 1;
+	static FAutoConsoleVariableRef CVarLyraRepEnableDenseGrid(TEXT("Lyra.RepGraph.DenseGrid.Enable"), EnableDenseGrid, TEXT("Routes Spatialize_Dense classes to the dense grid node. When disabled they are treated as Spatialize_Dynamic."), ECVF_Default);
+
+	float DenseGridCellSize = 5000.f;
+	static FAutoConsoleVariableRef CVarLyraRepDenseGridCellSize(TEXT("Lyra.RepGraph.DenseGrid.CellSize"), DenseGridCellSize, TEXT(""), ECVF_Default);
+
+	int32 EnableAdaptiveFrequency = 0;
+	static FAutoConsoleVariableRef CVarLyraRepEnableAdaptiveFrequency(TEXT("Lyra.RepGraph.AdaptiveFrequency.Enable"), EnableAdaptiveFrequency, TEXT("Use ULyraReplicationGraphNode_AdaptiveFrequencyLimiter for player states (off by default). Takes effect when the graph is created."), ECVF_Default);
+
+	int32 AdaptiveFrequencyMaxLevel = 3;
+	static FAutoConsoleVariableRef CVarLyraRepAdaptiveFrequencyMaxLevel(TEXT("Lyra.RepGraph.AdaptiveFrequency.MaxLevel"), AdaptiveFrequencyMaxLevel, TEXT("Highest degradation level. Each level doubles the bucket count and replication period for the connection."), ECVF_Default);
+
+	float AdaptiveFrequencyQueuedBitsThreshold = 2000.f;
+	static FAutoConsoleVariableRef CVarLyraRepAdaptiveFrequencyQueuedBitsThreshold(TEXT("Lyra.RepGraph.AdaptiveFrequency.QueuedBitsThreshold"), AdaptiveFrequencyQueuedBitsThreshold, TEXT("Smoothed queued bits above which a connection counts as saturated."), ECVF_Default);
+
+	float AdaptiveFrequencyLossThreshold = 0.05f;
+	static FAutoConsoleVariableRef CVarLyraRepAdaptiveFrequencyLossThreshold(TEXT("Lyra.RepGraph.AdaptiveFrequency.LossThreshold"), AdaptiveFrequencyLossThreshold, TEXT("Average outgoing packet loss (0-1) above which a connection counts as saturated."), ECVF_Default);
+
+	int32 AdaptiveFrequencyStepUpFrames = 10;
+	static FAutoConsoleVariableRef CVarLyraRepAdaptiveFrequencyStepUpFrames(TEXT("Lyra.RepGraph.AdaptiveFrequency.StepUpFrames"), AdaptiveFrequencyStepUpFrames, TEXT("Consecutive saturated frames before a connection moves up one level."), ECVF_Default);
+
+	int32 AdaptiveFrequencyStepDownFrames = 90;
+	static FAutoConsoleVariableRef CVarLyraRepAdaptiveFrequencyStepDownFrames(TEXT("Lyra.RepGraph.AdaptiveFrequency.StepDownFrames"), AdaptiveFrequencyStepDownFrames, TEXT("Consecutive clear frames before a connection moves down one level."), ECVF_Default);
+
+	int32 EnableFastSharedRateTiers = 1;
+	static FAutoConsoleVariableRef CVarLyraRepEnableFastSharedRateTiers(TEXT("Lyra.RepGraph.FastSharedRateTiers.Enable"), EnableFastSharedRateTiers, TEXT("Send FastShared movement of far away or out of view characters to each connection less often."), ECVF_Default);
+
+	float FastSharedRateTierNearDistance = 2500.f;
+	static FAutoConsoleVariableRef CVarLyraRepFastSharedRateTierNearDistance(TEXT("Lyra.RepGraph.FastSharedRateTiers.NearDistance"), FastSharedRateTierNearDistance, TEXT("Characters closer than this to a viewer get every FastShared update. Each doubling of the distance halves the rate."), ECVF_Default);
+
+	int32 FastSharedRateTierMax = 3;
+	static FAutoConsoleVariableRef CVarLyraRepFastSharedRateTierMax(TEXT("Lyra.RepGraph.FastSharedRateTiers.MaxTier"), FastSharedRateTierMax, TEXT("Slowest tier, tier N sends every 2^N frames. Keep 2^MaxTier at or below lyra.SharedMovement.BaselineRepeats."), ECVF_Default);
+
+	int32 FastSharedRateTierUpdateFrames = 4;
+	static FAutoConsoleVariableRef CVarLyraRepFastSharedRateTierUpdateFrames(TEXT("Lyra.RepGraph.FastSharedRateTiers.UpdateFrames"), FastSharedRateTierUpdateFrames, TEXT("How many frames apart the tiers are worked out again."), ECVF_Default);
+
 	UReplicationDriver* ConditionalCreateReplicationDriver(UNetDriver* ForNetDriver, UWorld* World)
 	{
 		// Only create for GameNetDriver
@@ -176,6 +230,83 @@ ULyraReplicationGraph::ULyraReplicationGraph()
 	}
 }
 
+int32 ULyraReplicationGraph::ServerReplicateActors(float DeltaSeconds)
+{
+	UpdateFastSharedRateTiers();
+
+	ULyraServerPerformanceRecorder* Recorder = GetWorld() ? GetWorld()->GetSubsystem<ULyraServerPerformanceRecorder>() : nullptr;
+	if ((Recorder == nullptr) || !Recorder->IsRecording())
+	{
+		return Super::ServerReplicateActors(DeltaSeconds);
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	const int32 NumActorsReplicated = Super::ServerReplicateActors(DeltaSeconds);
+	Recorder->RecordReplicationFrame((FPlatformTime::Seconds() - StartTime) * 1000.0, NumActorsReplicated);
+
+	return NumActorsReplicated;
+}
+
+int32 ULyraReplicationGraph::GetFastSharedRateTier(const FVector& ViewLocation, const FVector& ViewDirection, const FVector& ActorLocation)
+{
+	const FVector ToActor = ActorLocation - ViewLocation;
+	const double Distance = ToActor.Size();
+	const double NearDistance = FMath::Max(Lyra::RepGraph::FastSharedRateTierNearDistance, 1.f);
+
+	// One tier per doubling of the distance past NearDistance
+	int32 Tier = (Distance > NearDistance) ? 1 + FMath::FloorToInt32(FMath::Log2(Distance / NearDistance)) : 0;
+
+	// Characters behind the viewer matter less than ones they can see
+	if ((Distance > NearDistance) && (FVector::DotProduct(ToActor, ViewDirection) < 0.0))
+	{
+		++Tier;
+	}
+
+	return FMath::Clamp(Tier, 0, FMath::Clamp(Lyra::RepGraph::FastSharedRateTierMax, 0, 8));
+}
+
+void ULyraReplicationGraph::UpdateFastSharedRateTiers()
+{
+	if (FastSharedRateTierActors.Num() == 0)
+	{
+		return;
+	}
+
+	const uint32 FrameNum = GetReplicationGraphFrame();
+	if ((FrameNum % (uint32)FMath::Max(Lyra::RepGraph::FastSharedRateTierUpdateFrames, 1)) != 0)
+	{
+		return;
+	}
+
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_LyraRepGraph_UpdateFastSharedRateTiers);
+
+	const bool bEnabled = (Lyra::RepGraph::EnableFastSharedRateTiers > 0);
+
+	for (UNetReplicationGraphConnection* ConnectionManager : Connections)
+	{
+		UNetConnection* NetConnection = ConnectionManager ? ConnectionManager->NetConnection : nullptr;
+		const AActor* ViewTarget = NetConnection ? NetConnection->ViewTarget : nullptr;
+		if (ViewTarget == nullptr)
+		{
+			continue;
+		}
+
+		const FVector ViewLocation = ViewTarget->GetActorLocation();
+		const FVector ViewDirection = NetConnection->PlayerController ? NetConnection->PlayerController->GetControlRotation().Vector() : ViewTarget->GetActorForwardVector();
+
+		for (AActor* Actor : FastSharedRateTierActors)
+		{
+			if (Actor == ViewTarget)
+			{
+				continue;
+			}
+
+			const int32 Tier = bEnabled ? GetFastSharedRateTier(ViewLocation, ViewDirection, Actor->GetActorLocation()) : 0;
+			ConnectionManager->ActorInfoMap.FindOrAdd(Actor).FastPath_ReplicationPeriodFrame = (uint16)(1u << Tier);
+		}
+	}
+}
+
 void ULyraReplicationGraph::ResetGameWorldState()
 {
 	Super::ResetGameWorldState();
@@ -270,7 +401,8 @@ void ULyraReplicationGraph::InitClassReplicationInfo(FClassReplicationInfo& Info
 	AActor* CDO = Class->GetDefaultObject<AActor>();
 	if (Spatialize)
 	{
-		Info.SetCullDistanceSquared(CDO->GetNetCullDistanceSquared());
+		const float* CullDistanceOverride = FindClassCullDistanceOverride(Class);
+		Info.SetCullDistanceSquared(CullDistanceOverride ? FMath::Square(*CullDistanceOverride) : CDO->GetNetCullDistanceSquared());
 		UE_LOG(LogLyraRepGraph, Log, TEXT("Setting cull distance for %s to %f (%f)"), *Class->GetName(), Info.GetCullDistanceSquared(), Info.GetCullDistance());
 	}
 
@@ -369,15 +501,29 @@ void ULyraReplicationGraph::InitGlobalActorClassSettings()
 	const ULyraReplicationGraphSettings* LyraRepGraphSettings = GetDefault<ULyraReplicationGraphSettings>();
 	check(LyraRepGraphSettings);
 
+	ClassCullDistanceOverrides.Reset();
+	ClassDenseGridPriorityTiers.Reset();
+
 	// Set Classes Node Mappings
 	for (const FRepGraphActorClassSettings& ActorClassSettings : LyraRepGraphSettings->ClassSettings)
 	{
-		if (ActorClassSettings.bAddClassRepInfoToMap)
+		if (ActorClassSettings.bAddClassRepInfoToMap || ActorClassSettings.bOverrideCullDistance || ActorClassSettings.DenseGridPriorityTier > 0)
 		{
 			if (UClass* StaticActorClass = ActorClassSettings.GetStaticActorClass())
 			{
-				UE_LOG(LogLyraRepGraph, Log, TEXT("ActorClassSettings -- AddClassRepInfo - %s :: %i"), *StaticActorClass->GetName(), int(ActorClassSettings.ClassNodeMapping));
-				AddClassRepInfo(StaticActorClass, ActorClassSettings.ClassNodeMapping);
+				if (ActorClassSettings.bAddClassRepInfoToMap)
+				{
+					UE_LOG(LogLyraRepGraph, Log, TEXT("ActorClassSettings -- AddClassRepInfo - %s :: %i"), *StaticActorClass->GetName(), int(ActorClassSettings.ClassNodeMapping));
+					AddClassRepInfo(StaticActorClass, ActorClassSettings.ClassNodeMapping);
+				}
+
+				if (ActorClassSettings.bOverrideCullDistance)
+				{
+					UE_LOG(LogLyraRepGraph, Log, TEXT("ActorClassSettings -- CullDistance - %s :: %.2f"), *StaticActorClass->GetName(), ActorClassSettings.CullDistance);
+					ClassCullDistanceOverrides.Add(StaticActorClass, ActorClassSettings.CullDistance);
+				}
+
+				ClassDenseGridPriorityTiers.Add(StaticActorClass, FMath::Clamp(ActorClassSettings.DenseGridPriorityTier, 0, ULyraReplicationGraphNode_DenseGrid::NumPriorityTiers - 1));
 			}
 		}
 	}
@@ -423,7 +569,8 @@ void ULyraReplicationGraph::InitGlobalActorClassSettings()
 	CharacterClassRepInfo.DistancePriorityScale = 1.f;
 	CharacterClassRepInfo.StarvationPriorityScale = 1.f;
 	CharacterClassRepInfo.ActorChannelFrameTimeout = 4;
-	CharacterClassRepInfo.SetCullDistanceSquared(ALyraCharacter::StaticClass()->GetDefaultObject<ALyraCharacter>()->GetNetCullDistanceSquared());
+	const float* CharacterCullDistanceOverride = FindClassCullDistanceOverride(ALyraCharacter::StaticClass());
+	CharacterClassRepInfo.SetCullDistanceSquared(CharacterCullDistanceOverride ? FMath::Square(*CharacterCullDistanceOverride) : ALyraCharacter::StaticClass()->GetDefaultObject<ALyraCharacter>()->GetNetCullDistanceSquared());
 
 	SetClassInfo(ACharacter::StaticClass(), CharacterClassRepInfo);
 
@@ -546,6 +693,17 @@ void ULyraReplicationGraph::InitGlobalGraphNodes()
 	
 	AddGlobalGraphNode(GridNode);
 
+	// -----------------------------------------------
+	//	Dense Spatial Actors
+	// -----------------------------------------------
+
+	if (Lyra::RepGraph::EnableDenseGrid)
+	{
+		DenseGridNode = CreateNewNode<ULyraReplicationGraphNode_DenseGrid>();
+		DenseGridNode->CellSize = Lyra::RepGraph::DenseGridCellSize;
+		AddGlobalGraphNode(DenseGridNode);
+	}
+
 	// -----------------------------------------------
 	//	Always Relevant (to everyone) Actors
 	// -----------------------------------------------
@@ -555,7 +713,14 @@ void ULyraReplicationGraph::InitGlobalGraphNodes()
 	// -----------------------------------------------
 	//	Player State specialization. This will return a rolling subset of the player states to replicate
 	// -----------------------------------------------
-	ULyraReplicationGraphNode_PlayerStateFrequencyLimiter* PlayerStateNode = CreateNewNode<ULyraReplicationGraphNode_PlayerStateFrequencyLimiter>();
+	if (Lyra::RepGraph::EnableAdaptiveFrequency)
+	{
+		PlayerStateNode = CreateNewNode<ULyraReplicationGraphNode_AdaptiveFrequencyLimiter>();
+	}
+	else
+	{
+		PlayerStateNode = CreateNewNode<ULyraReplicationGraphNode_PlayerStateFrequencyLimiter>();
+	}
 	AddGlobalGraphNode(PlayerStateNode);
 }
 
@@ -579,8 +744,39 @@ EClassRepNodeMapping ULyraReplicationGraph::GetMappingPolicy(UClass* Class)
 	return Policy;
 }
 
+const float* ULyraReplicationGraph::FindClassCullDistanceOverride(const UClass* Class) const
+{
+	for (const UClass* It = Class; It && !ClassCullDistanceOverrides.IsEmpty(); It = It->GetSuperClass())
+	{
+		if (const float* CullDistance = ClassCullDistanceOverrides.Find(It))
+		{
+			return CullDistance;
+		}
+	}
+
+	return nullptr;
+}
+
+int32 ULyraReplicationGraph::GetDenseGridPriorityTier(const UClass* Class) const
+{
+	for (const UClass* It = Class; It && !ClassDenseGridPriorityTiers.IsEmpty(); It = It->GetSuperClass())
+	{
+		if (const int32* Tier = ClassDenseGridPriorityTiers.Find(It))
+		{
+			return *Tier;
+		}
+	}
+
+	return 0;
+}
+
 void ULyraReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo)
 {
+	if (ActorInfo.Class->IsChildOf(ALyraCharacter::StaticClass()))
+	{
+		FastSharedRateTierActors.AddUnique(ActorInfo.Actor);
+	}
+
 	EClassRepNodeMapping Policy = GetMappingPolicy(ActorInfo.Class);
 	switch(Policy)
 	{
@@ -620,11 +816,26 @@ void ULyraReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActo
 			GridNode->AddActor_Dormancy(ActorInfo, GlobalInfo);
 			break;
 		}
+
+		case EClassRepNodeMapping::Spatialize_Dense:
+		{
+			if (DenseGridNode)
+			{
+				DenseGridNode->NotifyAddNetworkActor(ActorInfo);
+			}
+			else
+			{
+				GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+			}
+			break;
+		}
 	};
 }
 
 void ULyraReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
 {
+	FastSharedRateTierActors.RemoveSwap(ActorInfo.Actor);
+
 	EClassRepNodeMapping Policy = GetMappingPolicy(ActorInfo.Class);
 	switch(Policy)
 	{
@@ -670,6 +881,19 @@ void ULyraReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedA
 			GridNode->RemoveActor_Dormancy(ActorInfo);
 			break;
 		}
+
+		case EClassRepNodeMapping::Spatialize_Dense:
+		{
+			if (DenseGridNode)
+			{
+				DenseGridNode->NotifyRemoveNetworkActor(ActorInfo);
+			}
+			else
+			{
+				GridNode->RemoveActor_Dynamic(ActorInfo);
+			}
+			break;
+		}
 	};
 }
 
@@ -938,6 +1162,443 @@ void ULyraReplicationGraphNode_PlayerStateFrequencyLimiter::LogNode(FReplication
 
 // ------------------------------------------------------------------------------
 
+FLyraAdaptiveFrequencyState& ULyraReplicationGraphNode_AdaptiveFrequencyLimiter::UpdateConnectionState(UNetReplicationGraphConnection& ConnectionManager, uint32 ReplicationFrameNum)
+{
+	FLyraAdaptiveFrequencyState& State = ConnectionStates.FindOrAdd(FObjectKey(&ConnectionManager));
+	if (State.LastUpdateFrame == ReplicationFrameNum && State.ConnectionManager.IsValid())
+	{
+		return State;
+	}
+
+	State.ConnectionManager = &ConnectionManager;
+	State.LastUpdateFrame = ReplicationFrameNum;
+
+	UNetConnection* NetConnection = ConnectionManager.NetConnection;
+	if (NetConnection == nullptr)
+	{
+		return State;
+	}
+
+	// QueuedBits goes positive once the connection has sent more than its rate allows
+	const float QueuedBits = (float)FMath::Max(NetConnection->QueuedBits, 0);
+	State.SmoothedQueuedBits = FMath::Lerp(State.SmoothedQueuedBits, QueuedBits, 0.2f);
+	State.OutLoss = NetConnection->GetOutLossPercentage().GetAvgLossPercentage();
+
+	const bool bSaturated = State.SmoothedQueuedBits > Lyra::RepGraph::AdaptiveFrequencyQueuedBitsThreshold || State.OutLoss > Lyra::RepGraph::AdaptiveFrequencyLossThreshold;
+	const int32 MaxLevel = FMath::Clamp(Lyra::RepGraph::AdaptiveFrequencyMaxLevel, 0, 8);
+
+	if (bSaturated)
+	{
+		State.FramesClear = 0;
+		if (++State.FramesSaturated >= Lyra::RepGraph::AdaptiveFrequencyStepUpFrames && State.Level < MaxLevel)
+		{
+			++State.Level;
+			++State.NumLevelChanges;
+			State.FramesSaturated = 0;
+			UE_LOG(LogLyraRepGraph, Verbose, TEXT("AdaptiveFrequency: %s saturated (QueuedBits %.0f, Loss %.2f), level %d"), *ConnectionManager.GetName(), State.SmoothedQueuedBits, State.OutLoss, State.Level);
+		}
+	}
+	else
+	{
+		State.FramesSaturated = 0;
+		if (++State.FramesClear >= Lyra::RepGraph::AdaptiveFrequencyStepDownFrames && State.Level > 0)
+		{
+			--State.Level;
+			++State.NumLevelChanges;
+			State.FramesClear = 0;
+			UE_LOG(LogLyraRepGraph, Verbose, TEXT("AdaptiveFrequency: %s recovered, level %d"), *ConnectionManager.GetName(), State.Level);
+		}
+	}
+
+	State.Level = FMath::Min(State.Level, MaxLevel);
+
+	return State;
+}
+
+void ULyraReplicationGraphNode_AdaptiveFrequencyLimiter::GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params)
+{
+	FLyraAdaptiveFrequencyState& State = UpdateConnectionState(Params.ConnectionManager, Params.ReplicationFrameNum);
+
+	if (ForceNetUpdateReplicationActorList.Num() > 0)
+	{
+		Params.OutGatheredReplicationLists.AddReplicationActorList(ForceNetUpdateReplicationActorList);
+	}
+
+	// At level N the connection only gathers every 2^N frames, so the effective bucket count is NumLists * 2^N.
+	// Connections on the same level still gather the same list on the same frame, which keeps serialization sharing intact.
+	const uint32 LevelMask = (1u << State.Level) - 1u;
+	if ((Params.ReplicationFrameNum & LevelMask) != 0)
+	{
+		++State.NumSkippedGathers;
+		return;
+	}
+
+	const int32 ListIdx = (Params.ReplicationFrameNum >> State.Level) % ReplicationActorLists.Num();
+	const FActorRepListRefView& List = ReplicationActorLists[ListIdx];
+	Params.OutGatheredReplicationLists.AddReplicationActorList(List);
+
+	// Scale the per actor period for this connection so the driver does not try to catch up on the frames we skipped
+	if (FGlobalActorReplicationInfoMap* GlobalRepMap = GraphGlobals.IsValid() ? GraphGlobals->GlobalActorReplicationInfoMap : nullptr)
+	{
+		for (FActorRepListType Actor : List)
+		{
+			const FGlobalActorReplicationInfo& GlobalInfo = GlobalRepMap->Get(Actor);
+			FConnectionReplicationActorInfo& ConnectionActorInfo = Params.ConnectionManager.ActorInfoMap.FindOrAdd(Actor);
+			ConnectionActorInfo.ReplicationPeriodFrame = (uint16)FMath::Min<int32>(FMath::Max<int32>(GlobalInfo.Settings.ReplicationPeriodFrame, 1) << State.Level, MAX_uint16);
+		}
+	}
+}
+
+void ULyraReplicationGraphNode_AdaptiveFrequencyLimiter::PrepareForReplication()
+{
+	Super::PrepareForReplication();
+
+	int32 NumConnections = 0;
+	int32 NumDegraded = 0;
+	int32 MaxLevel = 0;
+	float TotalLevel = 0.f;
+	float TotalQueuedBits = 0.f;
+	float TotalLoss = 0.f;
+
+	for (auto It = ConnectionStates.CreateIterator(); It; ++It)
+	{
+		const FLyraAdaptiveFrequencyState& State = It.Value();
+		if (!State.ConnectionManager.IsValid())
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		++NumConnections;
+		NumDegraded += (State.Level > 0) ? 1 : 0;
+		MaxLevel = FMath::Max(MaxLevel, State.Level);
+		TotalLevel += State.Level;
+		TotalQueuedBits += State.SmoothedQueuedBits;
+		TotalLoss += State.OutLoss;
+	}
+
+#if CSV_PROFILER
+	const float Divisor = (float)FMath::Max(NumConnections, 1);
+	CSV_CUSTOM_STAT(LyraRepGraph, AdaptiveFreq_Connections, NumConnections, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(LyraRepGraph, AdaptiveFreq_DegradedConnections, NumDegraded, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(LyraRepGraph, AdaptiveFreq_MaxLevel, MaxLevel, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(LyraRepGraph, AdaptiveFreq_AvgLevel, TotalLevel / Divisor, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(LyraRepGraph, AdaptiveFreq_AvgQueuedBits, TotalQueuedBits / Divisor, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(LyraRepGraph, AdaptiveFreq_AvgOutLoss, TotalLoss / Divisor, ECsvCustomStatOp::Set);
+#endif
+}
+
+void ULyraReplicationGraphNode_AdaptiveFrequencyLimiter::LogNode(FReplicationGraphDebugInfo& DebugInfo, const FString& NodeName) const
+{
+	Super::LogNode(DebugInfo, NodeName);
+
+	DebugInfo.PushIndent();
+	for (const TPair<FObjectKey, FLyraAdaptiveFrequencyState>& It : ConnectionStates)
+	{
+		const FLyraAdaptiveFrequencyState& State = It.Value;
+		DebugInfo.Log(FString::Printf(TEXT("%s: Level %d Buckets %d QueuedBits %.0f OutLoss %.2f"), *GetNameSafe(State.ConnectionManager.Get()), State.Level, ReplicationActorLists.Num() << State.Level, State.SmoothedQueuedBits, State.OutLoss));
+	}
+	DebugInfo.PopIndent();
+}
+
+void ULyraReplicationGraphNode_AdaptiveFrequencyLimiter::PrintConnectionStats() const
+{
+	GLog->Logf(TEXT("===================================="));
+	GLog->Logf(TEXT("Lyra Adaptive Frequency Buckets (%d base buckets)"), ReplicationActorLists.Num());
+	GLog->Logf(TEXT("===================================="));
+
+	for (const TPair<FObjectKey, FLyraAdaptiveFrequencyState>& It : ConnectionStates)
+	{
+		const FLyraAdaptiveFrequencyState& State = It.Value;
+		const UNetReplicationGraphConnection* ConnectionManager = State.ConnectionManager.Get();
+		const UNetConnection* NetConnection = ConnectionManager ? ConnectionManager->NetConnection : nullptr;
+
+		GLog->Logf(TEXT("%-40s --> Level %d, Buckets %d, QueuedBits %.0f, OutLoss %.2f, LevelChanges %d, SkippedGathers %d"),
+			NetConnection ? *NetConnection->LowLevelGetRemoteAddress(true) : *GetNameSafe(ConnectionManager),
+			State.Level, ReplicationActorLists.Num() << State.Level, State.SmoothedQueuedBits, State.OutLoss, State.NumLevelChanges, State.NumSkippedGathers);
+	}
+}
+
+// ------------------------------------------------------------------------------
+
+ULyraReplicationGraphNode_DenseGrid::ULyraReplicationGraphNode_DenseGrid()
+{
+	bRequiresPrepareForReplicationCall = true;
+}
+
+void ULyraReplicationGraphNode_DenseGrid::NotifyAddNetworkActor(const FNewReplicatedActorInfo& ActorInfo)
+{
+	AActor* Actor = ActorInfo.GetActor();
+	if (Actor == nullptr || ActorToIndex.Contains(Actor))
+	{
+		return;
+	}
+
+	ULyraReplicationGraph* LyraGraph = CastChecked<ULyraReplicationGraph>(GetOuter());
+
+	FActorEntry& Entry = Actors.AddDefaulted_GetRef();
+	Entry.Actor = Actor;
+	Entry.Cell = GetCellCoord(Actor->GetActorLocation());
+	Entry.PriorityTier = LyraGraph->GetDenseGridPriorityTier(ActorInfo.Class);
+	ActorToIndex.Add(Actor, Actors.Num() - 1);
+
+	if (GraphGlobals.IsValid() && GraphGlobals->GlobalActorReplicationInfoMap)
+	{
+		FGlobalActorReplicationInfo& GlobalInfo = GraphGlobals->GlobalActorReplicationInfoMap->Get(Actor);
+		GlobalInfo.WorldLocation = Actor->GetActorLocation();
+		Entry.CullDistance = GlobalInfo.Settings.GetCullDistance();
+		MaxCullDistance = FMath::Max(MaxCullDistance, Entry.CullDistance);
+	}
+
+	AddActorToCell(Actor, Entry.Cell);
+}
+
+bool ULyraReplicationGraphNode_DenseGrid::NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound)
+{
+	int32 Index = INDEX_NONE;
+	if (!ActorToIndex.RemoveAndCopyValue(ActorInfo.Actor, Index))
+	{
+		UE_CLOG(bWarnIfNotFound, LogLyraRepGraph, Warning, TEXT("ULyraReplicationGraphNode_DenseGrid::NotifyRemoveNetworkActor - %s was not found"), *GetActorRepListTypeDebugString(ActorInfo.Actor));
+		return false;
+	}
+
+	const FActorEntry& Entry = Actors[Index];
+	RemoveActorFromCell(Entry.Actor, Entry.Cell);
+
+	// The cell is not rebuilt until the next PrepareForReplication, make sure a removed actor is never gathered in the meantime
+	if (FCell* Cell = Cells.Find(Entry.Cell))
+	{
+		Cell->TierLists[Entry.PriorityTier].RemoveFast(Entry.Actor);
+	}
+
+	const bool bHadMaxCullDistance = (Entry.CullDistance >= MaxCullDistance);
+
+	Actors.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	if (Actors.IsValidIndex(Index))
+	{
+		ActorToIndex.FindChecked(Actors[Index].Actor) = Index;
+	}
+
+	// Only the actor with the largest cull distance leaving can shrink the gather radius
+	if (bHadMaxCullDistance)
+	{
+		MaxCullDistance = 0.f;
+		for (const FActorEntry& RemainingEntry : Actors)
+		{
+			MaxCullDistance = FMath::Max(MaxCullDistance, RemainingEntry.CullDistance);
+		}
+	}
+
+	return true;
+}
+
+void ULyraReplicationGraphNode_DenseGrid::NotifyResetAllNetworkActors()
+{
+	Actors.Reset();
+	ActorToIndex.Reset();
+	Cells.Reset();
+	DirtyCells.Reset();
+	MaxCullDistance = 0.f;
+}
+
+void ULyraReplicationGraphNode_DenseGrid::AddActorToCell(FActorRepListType Actor, const FIntPoint& CellCoord)
+{
+	FCell& Cell = Cells.FindOrAdd(CellCoord);
+	Cell.Actors.Add(Actor);
+
+	if (!Cell.bDirty)
+	{
+		Cell.bDirty = true;
+		DirtyCells.Add(CellCoord);
+	}
+}
+
+void ULyraReplicationGraphNode_DenseGrid::RemoveActorFromCell(FActorRepListType Actor, const FIntPoint& CellCoord)
+{
+	if (FCell* Cell = Cells.Find(CellCoord))
+	{
+		Cell->Actors.RemoveSingleSwap(Actor, EAllowShrinking::No);
+
+		if (!Cell->bDirty)
+		{
+			Cell->bDirty = true;
+			DirtyCells.Add(CellCoord);
+		}
+	}
+}
+
+void ULyraReplicationGraphNode_DenseGrid::RebuildCell(FCell& Cell)
+{
+	for (FActorRepListRefView& TierList : Cell.TierLists)
+	{
+		TierList.Reset();
+	}
+
+	for (FActorRepListType Actor : Cell.Actors)
+	{
+		const int32* Index = ActorToIndex.Find(Actor);
+		const int32 Tier = Index ? Actors[*Index].PriorityTier : 0;
+		Cell.TierLists[Tier].Add(Actor);
+	}
+
+	Cell.bDirty = false;
+}
+
+void ULyraReplicationGraphNode_DenseGrid::PrepareForReplication()
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_LyraDenseGrid_PrepareForReplication);
+
+	FGlobalActorReplicationInfoMap* GlobalRepMap = GraphGlobals.IsValid() ? GraphGlobals->GlobalActorReplicationInfoMap : nullptr;
+
+	// Poll every actor for a cell change. This is the only per-actor work the node does each frame.
+	for (FActorEntry& Entry : Actors)
+	{
+		AActor* Actor = Entry.Actor;
+		if (!IsActorValidForReplicationGather(Actor))
+		{
+			continue;
+		}
+
+		const FVector Location = Actor->GetActorLocation();
+		if (GlobalRepMap)
+		{
+			GlobalRepMap->Get(Actor).WorldLocation = Location;
+		}
+
+		const FIntPoint NewCell = GetCellCoord(Location);
+		if (NewCell != Entry.Cell)
+		{
+			RemoveActorFromCell(Actor, Entry.Cell);
+			AddActorToCell(Actor, NewCell);
+			Entry.Cell = NewCell;
+		}
+	}
+
+	// Only cells that had an actor enter or leave need their lists rebuilt, everything else is left untouched.
+	NumCellsRebuiltLastFrame = DirtyCells.Num();
+	for (const FIntPoint& CellCoord : DirtyCells)
+	{
+		if (FCell* Cell = Cells.Find(CellCoord))
+		{
+			if (Cell->Actors.Num() == 0)
+			{
+				Cells.Remove(CellCoord);
+			}
+			else
+			{
+				RebuildCell(*Cell);
+			}
+		}
+	}
+	DirtyCells.Reset();
+}
+
+void ULyraReplicationGraphNode_DenseGrid::GatherCellListsForViewers(const FNetViewerArray& Viewers, uint32 ReplicationFrameNum, FGatheredReplicationActorLists& OutGatheredLists) const
+{
+	if (Cells.Num() == 0 || CellSize <= 0.f)
+	{
+		return;
+	}
+
+	const int32 CellRadius = FMath::Max(1, FMath::CeilToInt32(MaxCullDistance / CellSize));
+	const int32 CellsInRange = FMath::Square(2 * CellRadius + 1);
+
+	TArray<FIntPoint, TInlineAllocator<64>> GatheredCells;
+
+	auto GatherCell = [&](const FIntPoint& CellCoord, const FCell& Cell)
+	{
+		if (Viewers.Num() > 1)
+		{
+			if (GatheredCells.Contains(CellCoord))
+			{
+				return;
+			}
+			GatheredCells.Add(CellCoord);
+		}
+
+		// Stagger lower tiers across cells so they do not all land on the same frame
+		const uint32 Stagger = GetTypeHash(CellCoord);
+		for (int32 Tier = 0; Tier < NumPriorityTiers; ++Tier)
+		{
+			const FActorRepListRefView& TierList = Cell.TierLists[Tier];
+			const uint32 TierMask = (1u << Tier) - 1u;
+			if (TierList.Num() > 0 && ((ReplicationFrameNum + Stagger) & TierMask) == 0)
+			{
+				OutGatheredLists.AddReplicationActorList(TierList);
+			}
+		}
+	};
+
+	for (const FNetViewer& Viewer : Viewers)
+	{
+		const FIntPoint ViewerCell = GetCellCoord(Viewer.ViewLocation);
+
+		// Pick whichever is cheaper: probing every coordinate in range, or walking the occupied cells
+		if (CellsInRange <= Cells.Num())
+		{
+			for (int32 Y = ViewerCell.Y - CellRadius; Y <= ViewerCell.Y + CellRadius; ++Y)
+			{
+				for (int32 X = ViewerCell.X - CellRadius; X <= ViewerCell.X + CellRadius; ++X)
+				{
+					const FIntPoint CellCoord(X, Y);
+					if (const FCell* Cell = Cells.Find(CellCoord))
+					{
+						GatherCell(CellCoord, *Cell);
+					}
+				}
+			}
+		}
+		else
+		{
+			for (const TPair<FIntPoint, FCell>& It : Cells)
+			{
+				if (FMath::Abs(It.Key.X - ViewerCell.X) <= CellRadius && FMath::Abs(It.Key.Y - ViewerCell.Y) <= CellRadius)
+				{
+					GatherCell(It.Key, It.Value);
+				}
+			}
+		}
+	}
+}
+
+void ULyraReplicationGraphNode_DenseGrid::GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params)
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_LyraDenseGrid_GatherActorListsForConnection);
+
+	GatherCellListsForViewers(Params.Viewers, Params.ReplicationFrameNum, Params.OutGatheredReplicationLists);
+}
+
+void ULyraReplicationGraphNode_DenseGrid::LogNode(FReplicationGraphDebugInfo& DebugInfo, const FString& NodeName) const
+{
+	DebugInfo.Log(FString::Printf(TEXT("%s - Actors: %d Cells: %d CellSize: %.0f MaxCullDistance: %.0f"), *NodeName, Actors.Num(), Cells.Num(), CellSize, MaxCullDistance));
+	DebugInfo.PushIndent();
+
+	for (const TPair<FIntPoint, FCell>& It : Cells)
+	{
+		for (int32 Tier = 0; Tier < NumPriorityTiers; ++Tier)
+		{
+			if (It.Value.TierLists[Tier].Num() > 0)
+			{
+				LogActorRepList(DebugInfo, FString::Printf(TEXT("Cell[%d,%d] Tier[%d]"), It.Key.X, It.Key.Y, Tier), It.Value.TierLists[Tier]);
+			}
+		}
+	}
+
+	DebugInfo.PopIndent();
+}
+
+// ------------------------------------------------------------------------------
+
+ALyraReplicationGraphBenchmarkActor::ALyraReplicationGraphBenchmarkActor()
+{
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	// Only ever fed to the benchmark's own node, the graph and real connections must not see these
+	bReplicates = false;
+}
+
+// ------------------------------------------------------------------------------
+
 void ULyraReplicationGraph::PrintRepNodePolicies()
 {
 	UEnum* Enum = StaticEnum<EClassRepNodeMapping>();
@@ -958,6 +1619,11 @@ void ULyraReplicationGraph::PrintRepNodePolicies()
 
 		GLog->Logf(TEXT("%-40s --> %s"), *GetNameSafe(ObjKey.ResolveObjectPtr()), *Enum->GetNameStringByValue(static_cast<uint32>(Mapping)));
 	}
+
+	if (const ULyraReplicationGraphNode_AdaptiveFrequencyLimiter* AdaptiveNode = Cast<ULyraReplicationGraphNode_AdaptiveFrequencyLimiter>(PlayerStateNode))
+	{
+		AdaptiveNode->PrintConnectionStats();
+	}
 }
 
 FAutoConsoleCommandWithWorldAndArgs LyraPrintRepNodePoliciesCmd(TEXT("Lyra.RepGraph.PrintRouting"),TEXT("Prints how actor classes are routed to RepGraph nodes"),
@@ -987,3 +1653,139 @@ FAutoConsoleCommandWithWorldAndArgs ChangeFrequencyBucketsCmd(TEXT("Lyra.RepGrap
 		Node->SetNonStreamingCollectionSize(Buckets);
 	}
 }));
+
+// ------------------------------------------------------------------------------
+
+#if !UE_BUILD_SHIPPING
+void ULyraReplicationGraph::RunDenseGridBenchmark(int32 NumActors, int32 NumConnections, int32 NumFrames, float MovingPct)
+{
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	const float WorldExtent = 100000.f;
+	FRandomStream Random(1234);
+
+	// Not created with CreateNewNode, so the node is never registered with the graph and is simply collected once we're done
+	ULyraReplicationGraphNode_DenseGrid* BenchNode = NewObject<ULyraReplicationGraphNode_DenseGrid>(this);
+	BenchNode->Initialize(GraphGlobals);
+	BenchNode->CellSize = Lyra::RepGraph::DenseGridCellSize;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParams.ObjectFlags |= RF_Transient;
+
+	TArray<AActor*> SpawnedActors;
+	SpawnedActors.Reserve(NumActors);
+	for (int32 Idx = 0; Idx < NumActors; ++Idx)
+	{
+		const FVector Location(Random.FRandRange(-WorldExtent, WorldExtent), Random.FRandRange(-WorldExtent, WorldExtent), 0.f);
+		if (AActor* Actor = World->SpawnActor<ALyraReplicationGraphBenchmarkActor>(Location, FRotator::ZeroRotator, SpawnParams))
+		{
+			SpawnedActors.Add(Actor);
+			BenchNode->NotifyAddNetworkActor(FNewReplicatedActorInfo(Actor));
+		}
+	}
+
+	// Each simulated connection is a single viewer wandering around the map
+	TArray<FNetViewerArray> ConnectionViewers;
+	ConnectionViewers.SetNum(NumConnections);
+	for (FNetViewerArray& Viewers : ConnectionViewers)
+	{
+		FNetViewer& Viewer = Viewers.AddDefaulted_GetRef();
+		Viewer.ViewLocation = FVector(Random.FRandRange(-WorldExtent, WorldExtent), Random.FRandRange(-WorldExtent, WorldExtent), 0.f);
+	}
+
+	const int32 NumMovingActors = FMath::Clamp(FMath::RoundToInt32(SpawnedActors.Num() * MovingPct / 100.f), 0, SpawnedActors.Num());
+
+	double PrepareSeconds = 0.0;
+	double GatherSeconds = 0.0;
+	double PrioritizeSeconds = 0.0;
+	int64 NumGatheredActors = 0;
+	int64 NumCellsRebuilt = 0;
+
+	TArray<TPair<float, AActor*>> Prioritized;
+
+	for (uint32 Frame = 0; Frame < (uint32)NumFrames; ++Frame)
+	{
+		for (int32 Idx = 0; Idx < NumMovingActors; ++Idx)
+		{
+			AActor* Actor = SpawnedActors[Random.RandHelper(SpawnedActors.Num())];
+			Actor->SetActorLocation(Actor->GetActorLocation() + FVector(Random.FRandRange(-600.f, 600.f), Random.FRandRange(-600.f, 600.f), 0.f));
+		}
+
+		double StartTime = FPlatformTime::Seconds();
+		BenchNode->PrepareForReplication();
+		PrepareSeconds += FPlatformTime::Seconds() - StartTime;
+		NumCellsRebuilt += BenchNode->GetNumCellsRebuiltLastFrame();
+
+		for (const FNetViewerArray& Viewers : ConnectionViewers)
+		{
+			FGatheredReplicationActorLists GatheredLists;
+
+			StartTime = FPlatformTime::Seconds();
+			BenchNode->GatherCellListsForViewers(Viewers, Frame, GatheredLists);
+			GatherSeconds += FPlatformTime::Seconds() - StartTime;
+
+			// Cull and distance sort the gathered actors the way the driver would before replicating them
+			StartTime = FPlatformTime::Seconds();
+			Prioritized.Reset();
+			const FVector ViewLocation = Viewers[0].ViewLocation;
+			for (const FActorRepListRefView& List : GatheredLists.GetLists(EActorRepListTypeFlags::Default))
+			{
+				for (FActorRepListType Actor : List)
+				{
+					const FGlobalActorReplicationInfo& GlobalInfo = GlobalActorReplicationInfoMap.Get(Actor);
+					const float DistSq = FVector::DistSquared(GlobalInfo.WorldLocation, ViewLocation);
+					if (DistSq <= GlobalInfo.Settings.GetCullDistanceSquared())
+					{
+						Prioritized.Emplace(DistSq, Actor);
+					}
+				}
+			}
+			Prioritized.Sort([](const TPair<float, AActor*>& A, const TPair<float, AActor*>& B) { return A.Key < B.Key; });
+			PrioritizeSeconds += FPlatformTime::Seconds() - StartTime;
+			NumGatheredActors += Prioritized.Num();
+		}
+	}
+
+	const double FrameDivisor = FMath::Max(NumFrames, 1);
+	UE_LOG(LogLyraRepGraph, Display, TEXT("DenseGrid benchmark: %d actors, %d connections, %d frames, %.1f%% moving per frame, %d occupied cells"), SpawnedActors.Num(), NumConnections, NumFrames, MovingPct, BenchNode->GetNumCells());
+	UE_LOG(LogLyraRepGraph, Display, TEXT("  Prepare:    %.4f ms/frame (%.1f cells rebuilt/frame)"), PrepareSeconds * 1000.0 / FrameDivisor, NumCellsRebuilt / FrameDivisor);
+	UE_LOG(LogLyraRepGraph, Display, TEXT("  Gather:     %.4f ms/frame"), GatherSeconds * 1000.0 / FrameDivisor);
+	UE_LOG(LogLyraRepGraph, Display, TEXT("  Prioritize: %.4f ms/frame (%.1f relevant actors/connection)"), PrioritizeSeconds * 1000.0 / FrameDivisor, NumGatheredActors / (FrameDivisor * FMath::Max(NumConnections, 1)));
+
+	for (AActor* Actor : SpawnedActors)
+	{
+		BenchNode->NotifyRemoveNetworkActor(FNewReplicatedActorInfo(Actor), false);
+		GlobalActorReplicationInfoMap.Remove(Actor);
+		Actor->Destroy();
+	}
+}
+
+FAutoConsoleCommandWithWorldAndArgs LyraDenseGridBenchmarkCmd(TEXT("Lyra.RepGraph.DenseGrid.Benchmark"), TEXT("Usage: Lyra.RepGraph.DenseGrid.Benchmark <NumActors=500> <NumConnections=40> <Frames=300> <MovingPct=50>. Must run on the server."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		int32 NumActors = 500;
+		int32 NumConnections = 40;
+		int32 NumFrames = 300;
+		float MovingPct = 50.f;
+		if (Args.Num() > 0) { LexTryParseString<int32>(NumActors, *Args[0]); }
+		if (Args.Num() > 1) { LexTryParseString<int32>(NumConnections, *Args[1]); }
+		if (Args.Num() > 2) { LexTryParseString<int32>(NumFrames, *Args[2]); }
+		if (Args.Num() > 3) { LexTryParseString<float>(MovingPct, *Args[3]); }
+
+		UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+		ULyraReplicationGraph* LyraGraph = NetDriver ? Cast<ULyraReplicationGraph>(NetDriver->GetReplicationDriver()) : nullptr;
+		if (LyraGraph == nullptr)
+		{
+			UE_LOG(LogLyraRepGraph, Warning, TEXT("Lyra.RepGraph.DenseGrid.Benchmark requires a server world running ULyraReplicationGraph."));
+			return;
+		}
+
+		LyraGraph->RunDenseGridBenchmark(FMath::Max(NumActors, 0), FMath::Max(NumConnections, 1), FMath::Max(NumFrames, 1), FMath::Clamp(MovingPct, 0.f, 100.f));
+	})
+);
+#endif // !UE_BUILD_SHIPPING
@@ -7,6 +7,8 @@
 #include "LyraReplicationGraph.generated.h"
 
 class AGameplayDebuggerCategoryReplicator;
+class ULyraReplicationGraphNode_DenseGrid;
+class ULyraReplicationGraphNode_PlayerStateFrequencyLimiter;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogLyraRepGraph, Display, All);
 
@@ -20,6 +22,7 @@ public:
 	ULyraReplicationGraph();
 
 	virtual void ResetGameWorldState() override;
+	virtual int32 ServerReplicateActors(float DeltaSeconds) override;
 
 	virtual void InitGlobalActorClassSettings() override;
 	virtual void InitGlobalGraphNodes() override;
@@ -33,9 +36,15 @@ public:
 	UPROPERTY()
 	TObjectPtr<UReplicationGraphNode_GridSpatialization2D> GridNode;
 
+	UPROPERTY()
+	TObjectPtr<ULyraReplicationGraphNode_DenseGrid> DenseGridNode;
+
 	UPROPERTY()
 	TObjectPtr<UReplicationGraphNode_ActorList> AlwaysRelevantNode;
 
+	UPROPERTY()
+	TObjectPtr<ULyraReplicationGraphNode_PlayerStateFrequencyLimiter> PlayerStateNode;
+
 	TMap<FName, FActorRepListRefView> AlwaysRelevantStreamingLevelActors;
 
 #if WITH_GAMEPLAY_DEBUGGER
@@ -44,6 +53,14 @@ public:
 
 	void PrintRepNodePolicies();
 
+	/** Returns the dense grid priority tier configured for Class (or its closest configured parent) in ULyraReplicationGraphSettings */
+	int32 GetDenseGridPriorityTier(const UClass* Class) const;
+
+#if !UE_BUILD_SHIPPING
+	/** Spawns NumActors non-replicated benchmark actors, routes them only through a standalone dense grid node and times prepare, gather and prioritize for NumConnections simulated viewers */
+	void RunDenseGridBenchmark(int32 NumActors, int32 NumConnections, int32 NumFrames, float MovingPct);
+#endif
+
 private:
 	void AddClassRepInfo(UClass* Class, EClassRepNodeMapping Mapping);
 	void RegisterClassRepNodeMapping(UClass* Class);
@@ -61,6 +78,23 @@ private:
 
 	/** Classes that had their replication settings explictly set by code in ULyraReplicationGraph::InitGlobalActorClassSettings */
 	TArray<UClass*> ExplicitlySetClasses;
+
+	/** Cull distances (not squared) set per class in ULyraReplicationGraphSettings::ClassSettings */
+	TMap<UClass*, float> ClassCullDistanceOverrides;
+
+	/** Dense grid priority tiers set per class in ULyraReplicationGraphSettings::ClassSettings */
+	TMap<UClass*, int32> ClassDenseGridPriorityTiers;
+
+	const float* FindClassCullDistanceOverride(const UClass* Class) const;
+
+	/** Sets each connection's FastShared replication period for every character from its distance and direction to the viewer */
+	void UpdateFastSharedRateTiers();
+
+	/** FastShared rate tier of a character at ActorLocation for a viewer, tier N sends every 2^N frames */
+	static int32 GetFastSharedRateTier(const FVector& ViewLocation, const FVector& ViewDirection, const FVector& ActorLocation);
+
+	/** Characters, which send their movement over the FastShared path */
+	TArray<AActor*> FastSharedRateTierActors;
 };
 
 UCLASS()
@@ -101,6 +135,7 @@ class ULyraReplicationGraphNode_PlayerStateFrequencyLimiter : public UReplicatio
 {
 	GENERATED_BODY()
 
+public:
 	ULyraReplicationGraphNode_PlayerStateFrequencyLimiter();
 
 	virtual void NotifyAddNetworkActor(const FNewReplicatedActorInfo& Actor) override { }
@@ -116,8 +151,157 @@ class ULyraReplicationGraphNode_PlayerStateFrequencyLimiter : public UReplicatio
 	/** How many actors we want to return to the replication driver per frame. Will not suppress ForceNetUpdate. */
 	int32 TargetActorsPerFrame = 2;
 
-private:
+protected:
 	
 	TArray<FActorRepListRefView> ReplicationActorLists;
 	FActorRepListRefView ForceNetUpdateReplicationActorList;
-};
\ No newline at end of file
+};
+
+/**
+	Per connection bandwidth feedback for ULyraReplicationGraphNode_AdaptiveFrequencyLimiter.
+	Level 0 is the normal rate. Each level doubles the number of buckets and the replication period of the returned actors for that connection.
+*/
+struct FLyraAdaptiveFrequencyState
+{
+	TWeakObjectPtr<UNetReplicationGraphConnection> ConnectionManager;
+
+	/** Exponentially smoothed UNetConnection::QueuedBits (only the positive, over budget part) */
+	float SmoothedQueuedBits = 0.f;
+
+	/** Last seen average outgoing packet loss, 0-1 */
+	float OutLoss = 0.f;
+
+	int32 Level = 0;
+
+	/** Consecutive frames over/under the saturation thresholds, used for hysteresis */
+	int32 FramesSaturated = 0;
+	int32 FramesClear = 0;
+
+	/** Stats */
+	int32 NumLevelChanges = 0;
+	int32 NumSkippedGathers = 0;
+	uint32 LastUpdateFrame = 0;
+};
+
+/**
+	Player state frequency limiter that degrades per connection instead of globally. Each connection measures its own saturation (queued bits and outgoing packet loss).
+	Saturated connections are moved to higher levels, where the rolling player state buckets are spread over more frames and the per connection replication
+	period of those actors is scaled up. Low bandwidth clients degrade gracefully instead of starving while everyone else keeps the normal rate.
+*/
+UCLASS()
+class ULyraReplicationGraphNode_AdaptiveFrequencyLimiter : public ULyraReplicationGraphNode_PlayerStateFrequencyLimiter
+{
+	GENERATED_BODY()
+
+public:
+	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
+
+	virtual void PrepareForReplication() override;
+
+	virtual void LogNode(FReplicationGraphDebugInfo& DebugInfo, const FString& NodeName) const override;
+
+	/** Prints the current level and saturation of every connection to the log */
+	void PrintConnectionStats() const;
+
+private:
+	FLyraAdaptiveFrequencyState& UpdateConnectionState(UNetReplicationGraphConnection& ConnectionManager, uint32 ReplicationFrameNum);
+
+	TMap<FObjectKey, FLyraAdaptiveFrequencyState> ConnectionStates;
+};
+
+/**
+	Spatialization node for dense fights with hundreds of moving actors. Unlike UReplicationGraphNode_GridSpatialization2D, which copies each dynamic actor into every cell
+	its cull distance touches, an actor here lives in exactly one cell and connections gather all occupied cells within range. Moving an actor is O(1), and gather cost scales with
+	the number of occupied cells around the viewer instead of the number of actors.
+
+	Each cell keeps one list per priority tier (see FRepGraphActorClassSettings::DenseGridPriorityTier). Tier 0 is gathered every frame, tier N every 2^N frames.
+	Cell lists are only rebuilt for cells that had an actor enter, leave or be added this frame; all other cells are skipped entirely during PrepareForReplication.
+*/
+UCLASS()
+class ULyraReplicationGraphNode_DenseGrid : public UReplicationGraphNode
+{
+	GENERATED_BODY()
+
+public:
+	ULyraReplicationGraphNode_DenseGrid();
+
+	static constexpr int32 NumPriorityTiers = 4;
+
+	virtual void NotifyAddNetworkActor(const FNewReplicatedActorInfo& ActorInfo) override;
+	virtual bool NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound=true) override;
+	virtual void NotifyResetAllNetworkActors() override;
+
+	virtual void PrepareForReplication() override;
+
+	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
+
+	virtual void LogNode(FReplicationGraphDebugInfo& DebugInfo, const FString& NodeName) const override;
+
+	/** Adds the lists of every occupied cell in range of any of the viewers. Each cell is added at most once. */
+	void GatherCellListsForViewers(const FNetViewerArray& Viewers, uint32 ReplicationFrameNum, FGatheredReplicationActorLists& OutGatheredLists) const;
+
+	int32 GetNumActors() const { return Actors.Num(); }
+	int32 GetNumCells() const { return Cells.Num(); }
+	int32 GetNumCellsRebuiltLastFrame() const { return NumCellsRebuiltLastFrame; }
+
+	/** Size of a cell along X and Y */
+	float CellSize = 5000.f;
+
+private:
+
+	struct FCell
+	{
+		/** Actors currently in this cell, in no particular order */
+		TArray<FActorRepListType> Actors;
+
+		/** Gatherable lists, one per priority tier. Only valid after the cell has been rebuilt. */
+		FActorRepListRefView TierLists[NumPriorityTiers];
+
+		/** True if an actor entered or left since the last rebuild */
+		bool bDirty = false;
+	};
+
+	struct FActorEntry
+	{
+		FActorRepListType Actor = nullptr;
+		FIntPoint Cell = FIntPoint::ZeroValue;
+		int32 PriorityTier = 0;
+		float CullDistance = 0.f;
+	};
+
+	FIntPoint GetCellCoord(const FVector& Location) const
+	{
+		return FIntPoint(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize));
+	}
+
+	void AddActorToCell(FActorRepListType Actor, const FIntPoint& CellCoord);
+	void RemoveActorFromCell(FActorRepListType Actor, const FIntPoint& CellCoord);
+	void RebuildCell(FCell& Cell);
+
+	/** Flat list of tracked actors, polled for cell changes every frame */
+	TArray<FActorEntry> Actors;
+
+	/** Actor to index in Actors, so removal is O(1) */
+	TMap<FActorRepListType, int32> ActorToIndex;
+
+	/** Only occupied cells are stored */
+	TMap<FIntPoint, FCell> Cells;
+
+	/** Cells that need to be rebuilt during the next PrepareForReplication */
+	TArray<FIntPoint> DirtyCells;
+
+	/** Largest cull distance of any actor in this node, determines how many cells around a viewer are gathered */
+	float MaxCullDistance = 0.f;
+
+	int32 NumCellsRebuiltLastFrame = 0;
+};
+
+/** Minimal non-replicated actor spawned by Lyra.RepGraph.DenseGrid.Benchmark and routed only through its private dense grid node */
+UCLASS(NotPlaceable, Transient)
+class ALyraReplicationGraphBenchmarkActor : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ALyraReplicationGraphBenchmarkActor();
+};
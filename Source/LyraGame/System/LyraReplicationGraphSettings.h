@@ -59,6 +59,14 @@ public:
 	UPROPERTY(EditAnywhere, Category = DynamicSpatialFrequency, meta = (ConsoleVariable = "Lyra.RepGraph.DynamicActorFrequencyBuckets"))
 	int32 DynamicActorFrequencyBuckets = 3;
 
+	// Routes actors mapped to Spatialize_Dense into the dense grid node instead of the generic spatial grid.
+	UPROPERTY(EditAnywhere, Category = DenseGrid, meta = (ConsoleVariable = "Lyra.RepGraph.DenseGrid.Enable"))
+	bool bEnableDenseGrid = true;
+
+	// Each dense grid actor lives in exactly one cell. Connections gather every occupied cell within the largest cull distance of the node.
+	UPROPERTY(EditAnywhere, Category = DenseGrid, meta = (ForceUnits = cm, ConsoleVariable = "Lyra.RepGraph.DenseGrid.CellSize"))
+	float DenseGridCellSize = 5000.0f;
+
 	// Array of Custom Settings for Specific Classes 
 	UPROPERTY(config, EditAnywhere, Category = ReplicationGraph)
 	TArray<FRepGraphActorClassSettings> ClassSettings;
@@ -17,6 +17,7 @@ enum class EClassRepNodeMapping : uint32
 	Spatialize_Static,				// Routes to GridNode: these actors don't move and don't need to be updated every frame.
 	Spatialize_Dynamic,				// Routes to GridNode: these actors mode frequently and are updated once per frame.
 	Spatialize_Dormancy,			// Routes to GridNode: While dormant we treat as static. When flushed/not dormant dynamic. Note this is for things that "move while not dormant".
+	Spatialize_Dense,				// Routes to DenseGridNode: high count moving actors (AI minions, summons). Falls back to GridNode dynamic if the dense grid is disabled.
 };
 
 // Actor Class Settings that can be assigned directly to a Class.  Can also be mapped to a FRepGraphActorTemplateSettings 
@@ -39,6 +40,18 @@ struct FRepGraphActorClassSettings
 	UPROPERTY(EditAnywhere, meta = (EditCondition = "bAddClassRepInfoToMap"))
 	EClassRepNodeMapping ClassNodeMapping = EClassRepNodeMapping::NotRouted;
 
+	// If we should replace the cull distance that would otherwise come from the class' NetCullDistanceSquared
+	UPROPERTY(EditAnywhere, meta = (InlineEditConditionToggle))
+	bool bOverrideCullDistance = false;
+
+	// Cull distance (not squared) used for this class when it is spatialized
+	UPROPERTY(EditAnywhere, meta = (ForceUnits = cm, ClampMin = 0, EditCondition = "bOverrideCullDistance"))
+	float CullDistance = 15000.f;
+
+	// Priority tier used by the dense grid node. Tier 0 is gathered every frame, each following tier half as often as the previous one.
+	UPROPERTY(EditAnywhere, meta = (ClampMin = 0, ClampMax = 3))
+	int32 DenseGridPriorityTier = 0;
+
 	// Should we add this to the RPC_Multicast_OpenChannelForClass map
 	UPROPERTY(EditAnywhere, meta = (InlineEditConditionToggle))
 	bool bAddToRPC_Multicast_OpenChannelForClassMap = false;
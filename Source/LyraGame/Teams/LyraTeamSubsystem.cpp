@@ -3,8 +3,11 @@
 #include "Teams/LyraTeamSubsystem.h"
 
 #include "AbilitySystemGlobals.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
 #include "GameFramework/Controller.h"
 #include "GameFramework/Pawn.h"
+#include "HAL/IConsoleManager.h"
 #include "LyraLogChannels.h"
 #include "LyraTeamAgentInterface.h"
 #include "LyraTeamCheats.h"
@@ -17,6 +20,16 @@
 
 class FSubsystemCollectionBase;
 
+namespace LyraConsoleVariables
+{
+	static bool bUseTeamLookupCache = true;
+	static FAutoConsoleVariableRef CVarUseTeamLookupCache(
+		TEXT("lyra.Teams.UseLookupCache"),
+		bUseTeamLookupCache,
+		TEXT("Should team lookups use the cached team of team agents instead of resolving them every time?"),
+		ECVF_Default);
+}
+
 //////////////////////////////////////////////////////////////////////
 // FLyraTeamTrackingInfo
 
@@ -79,12 +92,17 @@ void ULyraTeamSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 	};
 
 	CheatManagerRegistrationHandle = UCheatManager::RegisterForOnCheatManagerCreated(FOnCheatManagerCreated::FDelegate::CreateLambda(AddTeamCheats));
+
+	// Keep the team agent cache from growing with every pawn that ever lived (the handler goes away with the world)
+	GetWorld()->AddOnActorDestroyedHandler(FOnActorDestroyed::FDelegate::CreateUObject(this, &ThisClass::HandleActorDestroyed));
 }
 
 void ULyraTeamSubsystem::Deinitialize()
 {
 	UCheatManager::UnregisterFromOnCheatManagerCreated(CheatManagerRegistrationHandle);
 
+	TeamAgentCache.Empty();
+
 	Super::Deinitialize();
 }
 
@@ -150,7 +168,77 @@ bool ULyraTeamSubsystem::ChangeTeamForActor(AActor* ActorToChange, int32 NewTeam
 	}
 }
 
+void ULyraTeamSubsystem::NotifyTeamAgentChanged(const UObject* TeamAgent, int32 NewTeamId)
+{
+	if (TeamAgent != nullptr)
+	{
+		TeamAgentCache.Add(TeamAgent, NewTeamId);
+	}
+}
+
+void ULyraTeamSubsystem::HandleActorDestroyed(AActor* DestroyedActor)
+{
+	TeamAgentCache.Remove(DestroyedActor);
+}
+
+bool ULyraTeamSubsystem::FindTeamFromAgent(const UObject* TestObject, int32& OutTeamId) const
+{
+	if (const int32* CachedTeamId = TeamAgentCache.Find(TestObject))
+	{
+		OutTeamId = *CachedTeamId;
+		return true;
+	}
+
+	// Every team change of an agent goes through ConditionalBroadcastTeamChanged, so its current team can be cached until then
+	if (const ILyraTeamAgentInterface* ObjectWithTeamInterface = Cast<ILyraTeamAgentInterface>(TestObject))
+	{
+		OutTeamId = GenericTeamIdToInteger(ObjectWithTeamInterface->GetGenericTeamId());
+		TeamAgentCache.Add(TestObject, OutTeamId);
+		return true;
+	}
+
+	return false;
+}
+
 int32 ULyraTeamSubsystem::FindTeamFromObject(const UObject* TestObject) const
+{
+	if ((TestObject == nullptr) || !LyraConsoleVariables::bUseTeamLookupCache)
+	{
+		return FindTeamFromObject_Uncached(TestObject);
+	}
+
+	// Same order as the uncached lookup, with the team agents answered from the cache
+	int32 TeamId = INDEX_NONE;
+	if (FindTeamFromAgent(TestObject, /*out*/ TeamId))
+	{
+		return TeamId;
+	}
+
+	if (const AActor* TestActor = Cast<const AActor>(TestObject))
+	{
+		if (const APawn* Instigator = TestActor->GetInstigator())
+		{
+			if (FindTeamFromAgent(Instigator, /*out*/ TeamId))
+			{
+				return TeamId;
+			}
+		}
+
+		if (const ALyraTeamInfoBase* TeamInfo = Cast<ALyraTeamInfoBase>(TestActor))
+		{
+			return TeamInfo->GetTeamId();
+		}
+
+		if (const ALyraPlayerState* LyraPS = FindPlayerStateFromActor(TestActor))
+		{
+			return LyraPS->GetTeamId();
+		}
+	}
+
+	return INDEX_NONE;
+}
+
+int32 ULyraTeamSubsystem::FindTeamFromObject_Uncached(const UObject* TestObject) const
 {
 	// See if it's directly a team agent
 	if (const ILyraTeamAgentInterface* ObjectWithTeamInterface = Cast<ILyraTeamAgentInterface>(TestObject))
@@ -241,6 +329,25 @@ ELyraTeamComparison ULyraTeamSubsystem::CompareTeams(const UObject* A, const UOb
 	return CompareTeams(A, B, /*out*/ TeamIdA, /*out*/ TeamIdB);
 }
 
+void ULyraTeamSubsystem::CompareTeams(const UObject* Instigator, TArrayView<const UObject* const> Targets, TArray<ELyraTeamComparison>& OutComparisons) const
+{
+	OutComparisons.Reset(Targets.Num());
+
+	const int32 InstigatorTeamId = FindTeamFromObject(Cast<const AActor>(Instigator));
+	for (const UObject* Target : Targets)
+	{
+		const int32 TargetTeamId = (InstigatorTeamId != INDEX_NONE) ? FindTeamFromObject(Cast<const AActor>(Target)) : INDEX_NONE;
+		if (TargetTeamId == INDEX_NONE)
+		{
+			OutComparisons.Add(ELyraTeamComparison::InvalidArgument);
+		}
+		else
+		{
+			OutComparisons.Add((InstigatorTeamId == TargetTeamId) ? ELyraTeamComparison::OnSameTeam : ELyraTeamComparison::DifferentTeams);
+		}
+	}
+}
+
 void ULyraTeamSubsystem::FindTeamFromActor(const UObject* TestObject, bool& bIsPartOfTeam, int32& TeamId) const
 {
 	TeamId = FindTeamFromObject(TestObject);
@@ -403,3 +510,139 @@ FOnLyraTeamDisplayAssetChangedDelegate& ULyraTeamSubsystem::GetTeamDisplayAssetC
 	return TeamMap.FindOrAdd(TeamId).OnTeamDisplayAssetChanged;
 }
 
+
+//////////////////////////////////////////////////////////////////////
+
+#if !UE_BUILD_SHIPPING
+void ULyraTeamSubsystem::RunLookupBenchmark(int32 NumActors, int32 LookupsPerFrame, int32 NumFrames)
+{
+	UWorld* World = GetWorld();
+
+	// Everything that can be a team agent in the world, plus non-agent actors instigated by the pawns (like projectiles)
+	TArray<const UObject*> Objects;
+	TArray<APawn*> Pawns;
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		if (APawn* Pawn = Cast<APawn>(*It))
+		{
+			Pawns.Add(Pawn);
+			Objects.Add(Pawn);
+		}
+		else if (It->IsA<AController>() || It->IsA<APlayerState>())
+		{
+			Objects.Add(*It);
+		}
+	}
+
+	FRandomStream Random(1234);
+
+	TArray<AActor*> SpawnedActors;
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.ObjectFlags |= RF_Transient;
+	for (int32 Index = 0; Index < NumActors; ++Index)
+	{
+		SpawnParams.Instigator = (Pawns.Num() > 0) ? Pawns[Random.RandHelper(Pawns.Num())] : nullptr;
+		if (AActor* Actor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams))
+		{
+			SpawnedActors.Add(Actor);
+			Objects.Add(Actor);
+		}
+	}
+
+	if (Objects.Num() == 0)
+	{
+		UE_LOG(LogLyraTeams, Display, TEXT("Team lookup benchmark: nothing to look up"));
+		return;
+	}
+
+	TArray<int32> LookupIndices;
+	LookupIndices.SetNumUninitialized(LookupsPerFrame);
+	for (int32& LookupIndex : LookupIndices)
+	{
+		LookupIndex = Random.RandHelper(Objects.Num());
+	}
+
+	int32 NumMismatches = 0;
+	uint64 UncachedCycles = 0;
+	uint64 CachedCycles = 0;
+	uint64 BatchedCycles = 0;
+	int64 Checksum = 0;
+
+	TArray<const UObject*> Targets;
+	TArray<ELyraTeamComparison> Comparisons;
+	for (const int32 LookupIndex : LookupIndices)
+	{
+		Targets.Add(Objects[LookupIndex]);
+	}
+
+	for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+	{
+		uint64 StartCycles = FPlatformTime::Cycles64();
+		for (const int32 LookupIndex : LookupIndices)
+		{
+			Checksum += FindTeamFromObject_Uncached(Objects[LookupIndex]);
+		}
+		UncachedCycles += FPlatformTime::Cycles64() - StartCycles;
+
+		StartCycles = FPlatformTime::Cycles64();
+		for (const int32 LookupIndex : LookupIndices)
+		{
+			Checksum -= FindTeamFromObject(Objects[LookupIndex]);
+		}
+		CachedCycles += FPlatformTime::Cycles64() - StartCycles;
+
+		StartCycles = FPlatformTime::Cycles64();
+		CompareTeams(Objects[LookupIndices[0]], Targets, Comparisons);
+		BatchedCycles += FPlatformTime::Cycles64() - StartCycles;
+	}
+
+	for (const UObject* Object : Objects)
+	{
+		if (FindTeamFromObject(Object) != FindTeamFromObject_Uncached(Object))
+		{
+			++NumMismatches;
+			UE_LOG(LogLyraTeams, Warning, TEXT("Team lookup benchmark: cached team of %s doesn't match the uncached lookup"), *GetPathNameSafe(Object));
+		}
+	}
+
+	for (AActor* Actor : SpawnedActors)
+	{
+		Actor->Destroy();
+	}
+
+	const double Frames = FMath::Max(NumFrames, 1);
+	UE_LOG(LogLyraTeams, Display, TEXT("Team lookup benchmark: %d lookups per frame over %d objects (%d spawned, %d pawns), %d frames"),
+		LookupsPerFrame, Objects.Num(), SpawnedActors.Num(), Pawns.Num(), NumFrames);
+	UE_LOG(LogLyraTeams, Display, TEXT("  Uncached: %.3f ms per frame"), FPlatformTime::ToMilliseconds64(UncachedCycles) / Frames);
+	UE_LOG(LogLyraTeams, Display, TEXT("  Cached:   %.3f ms per frame"), FPlatformTime::ToMilliseconds64(CachedCycles) / Frames);
+	UE_LOG(LogLyraTeams, Display, TEXT("  Batched CompareTeams: %.3f ms per frame"), FPlatformTime::ToMilliseconds64(BatchedCycles) / Frames);
+	UE_LOG(LogLyraTeams, Display, TEXT("  %s (%d mismatches, checksum %lld)"), ((NumMismatches == 0) && (Checksum == 0)) ? TEXT("PASSED") : TEXT("FAILED"), NumMismatches, Checksum);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs LyraTeamLookupBenchmarkCmd(
+	TEXT("Lyra.Teams.LookupBenchmark"),
+	TEXT("Times cached and uncached team lookups. Usage: Lyra.Teams.LookupBenchmark [NumActors=500] [LookupsPerFrame=10000] [Frames=60]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		int32 NumActors = 500;
+		int32 LookupsPerFrame = 10000;
+		int32 NumFrames = 60;
+		if (Args.Num() > 0)
+		{
+			LexTryParseString(NumActors, *Args[0]);
+		}
+		if (Args.Num() > 1)
+		{
+			LexTryParseString(LookupsPerFrame, *Args[1]);
+		}
+		if (Args.Num() > 2)
+		{
+			LexTryParseString(NumFrames, *Args[2]);
+		}
+
+		if (ULyraTeamSubsystem* TeamSubsystem = World ? World->GetSubsystem<ULyraTeamSubsystem>() : nullptr)
+		{
+			TeamSubsystem->RunLookupBenchmark(FMath::Max(NumActors, 0), FMath::Max(LookupsPerFrame, 1), FMath::Max(NumFrames, 1));
+		}
+	}));
+#endif // !UE_BUILD_SHIPPING
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
 
 #include "LyraTeamSubsystem.generated.h"
 
@@ -82,8 +83,12 @@ public:
 	UE_API bool ChangeTeamForActor(AActor* ActorToChange, int32 NewTeamId);
 
 	// Returns the team this object belongs to, or INDEX_NONE if it is not part of a team
+	// Team agents (and actors instigated by them) are answered from a cache kept up to date by NotifyTeamAgentChanged
 	UE_API int32 FindTeamFromObject(const UObject* TestObject) const;
 
+	// Updates the cached team of a team agent, called by ILyraTeamAgentInterface::ConditionalBroadcastTeamChanged
+	UE_API void NotifyTeamAgentChanged(const UObject* TeamAgent, int32 NewTeamId);
+
 	// Returns the associated player state for this actor, or INDEX_NONE if it is not associated with a player
 	UE_API const ALyraPlayerState* FindPlayerStateFromActor(const AActor* PossibleTeamActor) const;
 
@@ -98,6 +103,9 @@ public:
 	// Compare the teams of two actors and returns a value indicating if they are on same teams, different teams, or one/both are invalid
 	UE_API ELyraTeamComparison CompareTeams(const UObject* A, const UObject* B) const;
 
+	// Compares the team of Instigator with each of Targets (e.g. everything caught in an area of effect), OutComparisons has one entry per target
+	UE_API void CompareTeams(const UObject* Instigator, TArrayView<const UObject* const> Targets, TArray<ELyraTeamComparison>& OutComparisons) const;
+
 	// Returns true if the instigator can damage the target, taking into account the friendly fire settings
 	UE_API bool CanCauseDamage(const UObject* Instigator, const UObject* Target, bool bAllowDamageToSelf = true) const;
 
@@ -141,10 +149,26 @@ public:
 	// Register for a team display asset notification for the specified team ID
 	UE_API FOnLyraTeamDisplayAssetChangedDelegate& GetTeamDisplayAssetChangedDelegate(int32 TeamId);
 
+#if !UE_BUILD_SHIPPING
+	// Times cached and uncached team lookups over the pawns, controllers and player states in the world plus NumActors spawned actors instigated by them
+	UE_API void RunLookupBenchmark(int32 NumActors, int32 LookupsPerFrame, int32 NumFrames);
+#endif
+
 private:
+	// The full lookup, walking from the object to whatever decides its team
+	int32 FindTeamFromObject_Uncached(const UObject* TestObject) const;
+
+	// Returns true and the team if TestObject is a team agent, caching the result
+	bool FindTeamFromAgent(const UObject* TestObject, int32& OutTeamId) const;
+
+	void HandleActorDestroyed(AActor* DestroyedActor);
+
 	UPROPERTY()
 	TMap<int32, FLyraTeamTrackingInfo> TeamMap;
 
+	// Team of every team agent looked up or changing team so far
+	mutable TMap<TObjectKey<UObject>, int32> TeamAgentCache;
+
 	FDelegateHandle CheatManagerRegistrationHandle;
 };
 
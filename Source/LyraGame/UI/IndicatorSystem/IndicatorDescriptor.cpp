@@ -31,19 +31,11 @@ bool FIndicatorProjection::Project(const UIndicatorDescriptor& IndicatorDescript
 			{
 				if (WorldLocation.IsSet())
 				{
-					FVector2D OutScreenSpacePosition;
-					const bool bInFrontOfCamera = ULocalPlayer::GetPixelPoint(InProjectionData, ProjectWorldLocation, OutScreenSpacePosition, &ScreenSize);
+					FIndicatorProjectedPoint ProjectedPoint;
+					ProjectedPoint.bInFrontOfCamera = ULocalPlayer::GetPixelPoint(InProjectionData, ProjectWorldLocation, ProjectedPoint.ScreenPosition, &ScreenSize);
+					ProjectedPoint.Depth = FVector::Dist(InProjectionData.ViewOrigin, ProjectWorldLocation);
 
-					OutScreenSpacePosition.X += IndicatorDescriptor.GetScreenSpaceOffset().X * (bInFrontOfCamera ? 1 : -1);
-					OutScreenSpacePosition.Y += IndicatorDescriptor.GetScreenSpaceOffset().Y;
-
-					if (!bInFrontOfCamera && FBox2f(FVector2f::Zero(), ScreenSize).IsInside((FVector2f)OutScreenSpacePosition))
-					{
-						const FVector2f CenterToPosition = (FVector2f(OutScreenSpacePosition) - (ScreenSize / 2)).GetSafeNormal();
-						OutScreenSpacePosition = FVector2D((ScreenSize / 2) + CenterToPosition * ScreenSize);
-					}
-
-					OutScreenPositionWithDepth = FVector(OutScreenSpacePosition.X, OutScreenSpacePosition.Y, FVector::Dist(InProjectionData.ViewOrigin, ProjectWorldLocation));
+					OutScreenPositionWithDepth = FinishComponentPoint(IndicatorDescriptor, ProjectedPoint, ScreenSize);
 
 					return true;
 				}
@@ -122,6 +114,67 @@ bool FIndicatorProjection::Project(const UIndicatorDescriptor& IndicatorDescript
 	return false;
 }
 
+bool FIndicatorProjection::CanBatchProject(const UIndicatorDescriptor& IndicatorDescriptor)
+{
+	return (IndicatorDescriptor.GetProjectionMode() == EActorCanvasProjectionMode::ComponentPoint) && (IndicatorDescriptor.GetSceneComponent() != nullptr);
+}
+
+FVector FIndicatorProjection::GetComponentPointLocation(const UIndicatorDescriptor& IndicatorDescriptor)
+{
+	const USceneComponent* Component = IndicatorDescriptor.GetSceneComponent();
+	check(Component);
+
+	const FVector WorldLocation = (IndicatorDescriptor.GetComponentSocketName() != NAME_None)
+		? Component->GetSocketTransform(IndicatorDescriptor.GetComponentSocketName()).GetLocation()
+		: Component->GetComponentLocation();
+
+	return WorldLocation + IndicatorDescriptor.GetWorldPositionOffset();
+}
+
+void FIndicatorProjection::ProjectPoints(TConstArrayView<FVector> WorldPoints, const FSceneViewProjectionData& InProjectionData, const FVector2f& ScreenSize, TArrayView<FIndicatorProjectedPoint> OutPoints)
+{
+	check(WorldPoints.Num() == OutPoints.Num());
+
+	// ULocalPlayer::GetPixelPoint computes this for every point
+	const FMatrix ViewProjectionMatrix = InProjectionData.ComputeViewProjectionMatrix();
+	const VectorRegister4Double ViewOrigin = VectorLoadFloat3_W0(&InProjectionData.ViewOrigin.X);
+
+	for (int32 PointIndex = 0; PointIndex < WorldPoints.Num(); ++PointIndex)
+	{
+		const VectorRegister4Double WorldPoint = VectorLoadFloat3_W1(&WorldPoints[PointIndex].X);
+		const VectorRegister4Double ClipPoint = VectorTransformVector(WorldPoint, &ViewProjectionMatrix);
+		const VectorRegister4Double ToPoint = VectorSubtract(VectorSet_W0(WorldPoint), ViewOrigin);
+
+		FVector4 Result;
+		VectorStore(ClipPoint, &Result.X);
+
+		// Same mapping from clip space to pixels as GetPixelPoint
+		FIndicatorProjectedPoint& OutPoint = OutPoints[PointIndex];
+		OutPoint.bInFrontOfCamera = (Result.W >= 0.0);
+		const double RHW = 1.0 / ((Result.W != 0.0) ? Result.W : 1.0);
+		OutPoint.ScreenPosition.X = ((Result.X * RHW * 0.5) + 0.5) * ScreenSize.X;
+		OutPoint.ScreenPosition.Y = (0.5 - (Result.Y * RHW * 0.5)) * ScreenSize.Y;
+		OutPoint.Depth = FMath::Sqrt(VectorGetComponent(VectorDot3(ToPoint, ToPoint), 0));
+	}
+}
+
+FVector FIndicatorProjection::FinishComponentPoint(const UIndicatorDescriptor& IndicatorDescriptor, const FIndicatorProjectedPoint& ProjectedPoint, const FVector2f& ScreenSize)
+{
+	const bool bInFrontOfCamera = ProjectedPoint.bInFrontOfCamera;
+
+	FVector2D OutScreenSpacePosition = ProjectedPoint.ScreenPosition;
+	OutScreenSpacePosition.X += IndicatorDescriptor.GetScreenSpaceOffset().X * (bInFrontOfCamera ? 1 : -1);
+	OutScreenSpacePosition.Y += IndicatorDescriptor.GetScreenSpaceOffset().Y;
+
+	if (!bInFrontOfCamera && FBox2f(FVector2f::Zero(), ScreenSize).IsInside((FVector2f)OutScreenSpacePosition))
+	{
+		const FVector2f CenterToPosition = (FVector2f(OutScreenSpacePosition) - (ScreenSize / 2)).GetSafeNormal();
+		OutScreenSpacePosition = FVector2D((ScreenSize / 2) + CenterToPosition * ScreenSize);
+	}
+
+	return FVector(OutScreenSpacePosition.X, OutScreenSpacePosition.Y, ProjectedPoint.Depth);
+}
+
 void UIndicatorDescriptor::SetIndicatorManagerComponent(ULyraIndicatorManagerComponent* InManager)
 {
 	// Make sure nobody has set this.
@@ -16,9 +16,40 @@ class UUserWidget;
 struct FFrame;
 struct FSceneViewProjectionData;
 
+/** A world point projected to the screen by FIndicatorProjection::ProjectPoints */
+struct FIndicatorProjectedPoint
+{
+	FVector2D ScreenPosition = FVector2D::ZeroVector;
+	double Depth = 0.0;
+	bool bInFrontOfCamera = false;
+};
+
 struct FIndicatorProjection
 {
 	bool Project(const UIndicatorDescriptor& IndicatorDescriptor, const FSceneViewProjectionData& InProjectionData, const FVector2f& ScreenSize, FVector& ScreenPositionWithDepth);
+
+	/** True if the indicator can be projected by ProjectPoints, i.e. it uses ComponentPoint on a valid component */
+	static bool CanBatchProject(const UIndicatorDescriptor& IndicatorDescriptor);
+
+	/** The world point a ComponentPoint indicator is projected from */
+	static FVector GetComponentPointLocation(const UIndicatorDescriptor& IndicatorDescriptor);
+
+	/** Projects a batch of world points against one view projection matrix, instead of rebuilding the matrix for every point */
+	static void ProjectPoints(TConstArrayView<FVector> WorldPoints, const FSceneViewProjectionData& InProjectionData, const FVector2f& ScreenSize, TArrayView<FIndicatorProjectedPoint> OutPoints);
+
+	/** Applies the indicator's screen space offset and behind camera handling to a projected ComponentPoint, giving the same result as Project */
+	static FVector FinishComponentPoint(const UIndicatorDescriptor& IndicatorDescriptor, const FIndicatorProjectedPoint& ProjectedPoint, const FVector2f& ScreenSize);
+};
+
+UENUM(BlueprintType)
+enum class EIndicatorLODTier : uint8
+{
+	// The indicator widget, updated every frame
+	Full,
+	// The simplified widget if there is one, updated less often
+	Simplified,
+	// No widget at all, only re-evaluated occasionally
+	Culled
 };
 
 UENUM(BlueprintType)
@@ -182,6 +213,46 @@ public:
 		Priority = InPriority;
 	}
 
+public:
+	// LOD Properties
+	//=======================
+
+	// Allows the indicator manager to simplify or cull this indicator based on distance, screen size and significance (see lyra.Indicators.LOD.Enable).
+	// Opt in only for indicators on slow moving targets, simplified ones are re-projected less often. Indicators that clamp to the screen are never culled.
+	UFUNCTION(BlueprintCallable)
+	bool GetUseLOD() const { return bUseLOD; }
+	UFUNCTION(BlueprintCallable)
+	void SetUseLOD(bool bValue)
+	{
+		bUseLOD = bValue;
+	}
+
+	// Widget shown instead of the indicator class at the simplified tier. If unset the full widget is kept, just updated less often.
+	UFUNCTION(BlueprintCallable)
+	TSoftClassPtr<UUserWidget> GetSimplifiedIndicatorClass() const { return SimplifiedIndicatorWidgetClass; }
+	UFUNCTION(BlueprintCallable)
+	void SetSimplifiedIndicatorClass(TSoftClassPtr<UUserWidget> InIndicatorWidgetClass)
+	{
+		SimplifiedIndicatorWidgetClass = InIndicatorWidgetClass;
+	}
+
+	UFUNCTION(BlueprintCallable)
+	EIndicatorLODTier GetLODTier() const { return LODTier; }
+
+	// The widget class for the current LOD tier, null when culled
+	TSoftClassPtr<UUserWidget> GetIndicatorClassForLOD() const
+	{
+		switch (LODTier)
+		{
+		case EIndicatorLODTier::Simplified:
+			return SimplifiedIndicatorWidgetClass.IsNull() ? IndicatorWidgetClass : SimplifiedIndicatorWidgetClass;
+		case EIndicatorLODTier::Culled:
+			return nullptr;
+		default:
+			return IndicatorWidgetClass;
+		}
+	}
+
 public:
 	ULyraIndicatorManagerComponent* GetIndicatorManagerComponent() { return ManagerPtr.Get(); }
 	UE_API void SetIndicatorManagerComponent(ULyraIndicatorManagerComponent* InManager);
@@ -200,6 +271,8 @@ private:
 	bool bOverrideScreenPosition = false;
 	UPROPERTY()
 	bool bAutoRemoveWhenIndicatorComponentIsNull = false;
+	UPROPERTY()
+	bool bUseLOD = false;
 
 	UPROPERTY()
 	EActorCanvasProjectionMode ProjectionMode = EActorCanvasProjectionMode::ComponentPoint;
@@ -233,6 +306,12 @@ private:
 	UPROPERTY()
 	TSoftClassPtr<UUserWidget> IndicatorWidgetClass;
 
+	UPROPERTY()
+	TSoftClassPtr<UUserWidget> SimplifiedIndicatorWidgetClass;
+
+	// Chosen by the actor canvas
+	EIndicatorLODTier LODTier = EIndicatorLODTier::Full;
+
 	UPROPERTY()
 	TWeakObjectPtr<ULyraIndicatorManagerComponent> ManagerPtr;
 
@@ -2,10 +2,23 @@
 
 #include "LyraIndicatorManagerComponent.h"
 
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
 #include "IndicatorDescriptor.h"
+#include "System/LyraSignificanceManager.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(LyraIndicatorManagerComponent)
 
+namespace LyraConsoleVariables
+{
+	static bool bEnableIndicatorLOD = false;
+	static FAutoConsoleVariableRef CVarEnableIndicatorLOD(
+		TEXT("lyra.Indicators.LOD.Enable"),
+		bEnableIndicatorLOD,
+		TEXT("Should indicators be simplified or culled based on distance, screen size and significance? Off by default, simplified indicators are re-projected less often and visibly lag behind moving targets"),
+		ECVF_Default);
+}
+
 ULyraIndicatorManagerComponent::ULyraIndicatorManagerComponent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
@@ -40,3 +53,65 @@ void ULyraIndicatorManagerComponent::RemoveIndicator(UIndicatorDescriptor* Indic
 		Indicators.Remove(IndicatorDescriptor);
 	}
 }
+
+EIndicatorLODTier ULyraIndicatorManagerComponent::ChooseLODTier(const UIndicatorDescriptor& IndicatorDescriptor, double Distance, float ScreenRadius) const
+{
+	if (!LyraConsoleVariables::bEnableIndicatorLOD || !IndicatorDescriptor.GetUseLOD())
+	{
+		return EIndicatorLODTier::Full;
+	}
+
+	EIndicatorLODTier Tier = EIndicatorLODTier::Full;
+	if ((Distance > CulledDistance) || (ScreenRadius < CulledScreenRadius))
+	{
+		Tier = EIndicatorLODTier::Culled;
+	}
+	else if ((Distance > SimplifiedDistance) || (ScreenRadius < SimplifiedScreenRadius))
+	{
+		Tier = EIndicatorLODTier::Simplified;
+	}
+
+	// Significance can only push an indicator down a tier, and only counts for actors that registered with the manager
+	if (Tier == EIndicatorLODTier::Full)
+	{
+		const USceneComponent* Component = IndicatorDescriptor.GetSceneComponent();
+		AActor* Owner = Component ? Component->GetOwner() : nullptr;
+		if (const ULyraSignificanceManager* SignificanceManager = Owner ? USignificanceManager::Get<ULyraSignificanceManager>(GetWorld()) : nullptr)
+		{
+			if (const USignificanceManager::FManagedObjectInfo* ObjectInfo = SignificanceManager->GetManagedObject(Owner))
+			{
+				if (ObjectInfo->GetSignificance() < SimplifiedSignificance)
+				{
+					Tier = EIndicatorLODTier::Simplified;
+				}
+			}
+		}
+	}
+
+	// Clamped indicators exist to point at things off screen or far away
+	if ((Tier == EIndicatorLODTier::Culled) && IndicatorDescriptor.GetClampToScreen())
+	{
+		Tier = EIndicatorLODTier::Simplified;
+	}
+
+	return Tier;
+}
+
+bool ULyraIndicatorManagerComponent::IsLODUpdateDue(EIndicatorLODTier Tier, uint32 Frame, int32 StaggerIndex) const
+{
+	int32 Interval = 1;
+	switch (Tier)
+	{
+	case EIndicatorLODTier::Full:
+		Interval = LODEvaluationInterval;
+		break;
+	case EIndicatorLODTier::Simplified:
+		Interval = SimplifiedUpdateInterval;
+		break;
+	case EIndicatorLODTier::Culled:
+		Interval = CulledUpdateInterval;
+		break;
+	}
+
+	return ((Frame + (uint32)StaggerIndex) % (uint32)FMath::Max(Interval, 1)) == 0;
+}
@@ -11,6 +11,7 @@
 class AController;
 class UIndicatorDescriptor;
 class UObject;
+enum class EIndicatorLODTier : uint8;
 struct FFrame;
 
 /**
@@ -38,6 +39,44 @@ public:
 
 	const TArray<UIndicatorDescriptor*>& GetIndicators() const { return Indicators; }
 
+	/** Picks the LOD tier for an indicator Distance away from the view that covers roughly ScreenRadius pixels */
+	UE_API EIndicatorLODTier ChooseLODTier(const UIndicatorDescriptor& IndicatorDescriptor, double Distance, float ScreenRadius) const;
+
+	/** Returns true if an indicator at this tier should be updated this frame, spread across frames by StaggerIndex */
+	UE_API bool IsLODUpdateDue(EIndicatorLODTier Tier, uint32 Frame, int32 StaggerIndex) const;
+
+	/** Indicators further than this (cm) are simplified */
+	UPROPERTY(EditAnywhere, Category = "Indicator|LOD")
+	float SimplifiedDistance = 3000.0f;
+
+	/** Indicators further than this (cm) are culled */
+	UPROPERTY(EditAnywhere, Category = "Indicator|LOD")
+	float CulledDistance = 10000.0f;
+
+	/** Indicators whose component covers fewer pixels (radius) than this are simplified */
+	UPROPERTY(EditAnywhere, Category = "Indicator|LOD")
+	float SimplifiedScreenRadius = 0.0f;
+
+	/** Indicators whose component covers fewer pixels (radius) than this are culled */
+	UPROPERTY(EditAnywhere, Category = "Indicator|LOD")
+	float CulledScreenRadius = 0.0f;
+
+	/** Indicators on actors registered with the significance manager are simplified below this significance */
+	UPROPERTY(EditAnywhere, Category = "Indicator|LOD")
+	float SimplifiedSignificance = 0.5f;
+
+	/** How often (in canvas updates) full and simplified indicators re-evaluate their tier */
+	UPROPERTY(EditAnywhere, Category = "Indicator|LOD", meta = (ClampMin = 1))
+	int32 LODEvaluationInterval = 4;
+
+	/** How often (in canvas updates) simplified indicators are re-projected */
+	UPROPERTY(EditAnywhere, Category = "Indicator|LOD", meta = (ClampMin = 1))
+	int32 SimplifiedUpdateInterval = 3;
+
+	/** How often (in canvas updates) culled indicators check if they should come back */
+	UPROPERTY(EditAnywhere, Category = "Indicator|LOD", meta = (ClampMin = 1))
+	int32 CulledUpdateInterval = 15;
+
 private:
 	UPROPERTY()
 	TArray<TObjectPtr<UIndicatorDescriptor>> Indicators;
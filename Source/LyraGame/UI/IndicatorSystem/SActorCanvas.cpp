@@ -2,10 +2,18 @@
 
 #include "SActorCanvas.h"
 
+#include "Blueprint/UserWidget.h"
+#include "Containers/Ticker.h"
 #include "Engine/GameViewportClient.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
 #include "IActorIndicatorWidget.h"
 #include "Layout/ArrangedChildren.h"
 #include "LyraIndicatorManagerComponent.h"
+#include "LyraLogChannels.h"
+#include "Performance/LyraHitchDetector.h"
 #include "SceneView.h"
 #include "UI/IndicatorSystem/IndicatorDescriptor.h"
 #include "Widgets/Layout/SBox.h"
@@ -13,6 +21,38 @@
 
 class FSlateRect;
 
+namespace LyraConsoleVariables
+{
+	static bool bBatchIndicatorProjection = true;
+	static FAutoConsoleVariableRef CVarBatchIndicatorProjection(
+		TEXT("lyra.Indicators.BatchProjection"),
+		bBatchIndicatorProjection,
+		TEXT("Should actor canvases project all ComponentPoint indicators against one view projection matrix, rather than one at a time?"),
+		ECVF_Default);
+}
+
+#if !UE_BUILD_SHIPPING
+/** Timings gathered by every actor canvas while Lyra.Indicators.StressTest runs */
+struct FActorCanvasStressTest
+{
+	bool bActive = false;
+
+	// Set for one update to compare the batched projection with the per indicator one, that update isn't timed
+	bool bVerifyProjection = false;
+	double MaxProjectionError = 0.0;
+
+	uint64 UpdateCycles = 0;
+	uint64 ArrangeCycles = 0;
+	int32 NumUpdates = 0;
+	int32 NumArranges = 0;
+
+	// Timings of a canvas without widgets mean nothing, so the results are only reported if some were created
+	int32 NumWidgetsCreated = 0;
+};
+
+static FActorCanvasStressTest GActorCanvasStressTest;
+#endif
+
 namespace EArrowDirection
 {
 	enum Type
@@ -158,6 +198,11 @@ void SActorCanvas::Construct(const FArguments& InArgs, const FLocalPlayerContext
 EActiveTimerReturnType SActorCanvas::UpdateCanvas(double InCurrentTime, float InDeltaTime)
 {
 	QUICK_SCOPE_CYCLE_COUNTER(STAT_SActorCanvas_UpdateCanvas);
+	LYRA_HITCH_SCOPE(IndicatorCanvas);
+
+#if !UE_BUILD_SHIPPING
+	const uint64 UpdateStartCycles = FPlatformTime::Cycles64();
+#endif
 
 	if (!OptionalPaintGeometry.IsSet())
 	{
@@ -202,6 +247,11 @@ EActiveTimerReturnType SActorCanvas::UpdateCanvas(double InCurrentTime, float In
 
 			bool IndicatorsChanged = false;
 
+			const bool bBatchProjection = LyraConsoleVariables::bBatchIndicatorProjection;
+			++LODUpdateFrame;
+			BatchWorldPoints.Reset();
+			BatchSlotIndices.Reset();
+
 			for (int32 ChildIndex = 0; ChildIndex < CanvasChildren.Num(); ++ChildIndex)
 			{
 				SActorCanvas::FSlot& CurChild = CanvasChildren[ChildIndex];
@@ -235,35 +285,90 @@ EActiveTimerReturnType SActorCanvas::UpdateCanvas(double InCurrentTime, float In
 					IndicatorsChanged = true;
 				}
 
+				// Re-evaluate the LOD tier every few updates
+				const EIndicatorLODTier PreviousTier = Indicator->LODTier;
+				if (IndicatorComponent->IsLODUpdateDue(EIndicatorLODTier::Full, LODUpdateFrame, ChildIndex))
+				{
+					const EIndicatorLODTier NewTier = EvaluateLODTier(*IndicatorComponent, *Indicator, ProjectionData, PaintGeometry.Size);
+					if ((NewTier != PreviousTier) && ChangeLODTier(Indicator, NewTier))
+					{
+						// The slot was removed, either for good or until the widget for the new tier loads
+						IndicatorsChanged = true;
+						--ChildIndex;
+						continue;
+					}
+				}
+
+				// Simplified indicators keep their last position between updates
+				if ((Indicator->LODTier == EIndicatorLODTier::Simplified) && !IndicatorComponent->IsLODUpdateDue(EIndicatorLODTier::Simplified, LODUpdateFrame, ChildIndex))
+				{
+					IndicatorsChanged |= CurChild.bIsDirty();
+					CurChild.ClearDirtyFlag();
+					continue;
+				}
+
+				// Point indicators are projected together below, everything else needs its bounds so goes one at a time
+				if (bBatchProjection && FIndicatorProjection::CanBatchProject(*Indicator))
+				{
+					BatchWorldPoints.Add(FIndicatorProjection::GetComponentPointLocation(*Indicator));
+					BatchSlotIndices.Add(ChildIndex);
+					continue;
+				}
+
 				FVector ScreenPositionWithDepth;
 
 				FIndicatorProjection Projector;
 				const bool Success = Projector.Project(*Indicator, ProjectionData, PaintGeometry.Size, OUT ScreenPositionWithDepth);
 
-				if (!Success)
-				{
-					CurChild.SetHasValidScreenPosition(false);
-					CurChild.SetInFrontOfCamera(false);
+				IndicatorsChanged |= ApplyProjection(CurChild, Success, ScreenPositionWithDepth);
+			}
 
-					IndicatorsChanged |= CurChild.bIsDirty();
-					CurChild.ClearDirtyFlag();
+			// Bring back culled indicators that are now close or significant enough
+			for (int32 CulledIndex = CulledIndicators.Num() - 1; CulledIndex >= 0; --CulledIndex)
+			{
+				UIndicatorDescriptor* Indicator = CulledIndicators[CulledIndex];
+				if (!IndicatorComponent->IsLODUpdateDue(EIndicatorLODTier::Culled, LODUpdateFrame, CulledIndex))
+				{
 					continue;
 				}
 
-				CurChild.SetInFrontOfCamera(Success);
-				CurChild.SetHasValidScreenPosition(CurChild.GetInFrontOfCamera() || Indicator->GetClampToScreen());
+				if (Indicator->CanAutomaticallyRemove())
+				{
+					CulledIndicators.RemoveAtSwap(CulledIndex);
+					continue;
+				}
 
-				if (CurChild.HasValidScreenPosition())
+				const EIndicatorLODTier NewTier = EvaluateLODTier(*IndicatorComponent, *Indicator, ProjectionData, PaintGeometry.Size);
+				if (NewTier != EIndicatorLODTier::Culled)
 				{
-					// Only dirty the screen position if we can actually show this indicator.
-					CurChild.SetScreenPosition(FVector2D(ScreenPositionWithDepth));
-					CurChild.SetDepth(ScreenPositionWithDepth.X);
+					ChangeLODTier(Indicator, NewTier);
 				}
+			}
 
-				CurChild.SetPriority(Indicator->GetPriority());
+			if (BatchWorldPoints.Num() > 0)
+			{
+				BatchProjectedPoints.SetNumUninitialized(BatchWorldPoints.Num(), EAllowShrinking::No);
+				FIndicatorProjection::ProjectPoints(BatchWorldPoints, ProjectionData, PaintGeometry.Size, BatchProjectedPoints);
+
+				for (int32 BatchIndex = 0; BatchIndex < BatchSlotIndices.Num(); ++BatchIndex)
+				{
+					SActorCanvas::FSlot& CurChild = CanvasChildren[BatchSlotIndices[BatchIndex]];
+					const FVector ScreenPositionWithDepth = FIndicatorProjection::FinishComponentPoint(*CurChild.Indicator, BatchProjectedPoints[BatchIndex], PaintGeometry.Size);
+
+#if !UE_BUILD_SHIPPING
+					if (GActorCanvasStressTest.bVerifyProjection)
+					{
+						FVector ReferenceScreenPositionWithDepth;
+						FIndicatorProjection Projector;
+						if (Projector.Project(*CurChild.Indicator, ProjectionData, PaintGeometry.Size, OUT ReferenceScreenPositionWithDepth))
+						{
+							GActorCanvasStressTest.MaxProjectionError = FMath::Max(GActorCanvasStressTest.MaxProjectionError, FVector::Dist(ReferenceScreenPositionWithDepth, ScreenPositionWithDepth));
+						}
+					}
+#endif
 
-				IndicatorsChanged |= CurChild.bIsDirty();
-				CurChild.ClearDirtyFlag();
+					IndicatorsChanged |= ApplyProjection(CurChild, true, ScreenPositionWithDepth);
+				}
 			}
 
 			if (IndicatorsChanged)
@@ -281,6 +386,18 @@ EActiveTimerReturnType SActorCanvas::UpdateCanvas(double InCurrentTime, float In
 		SetShowAnyIndicators(false);
 	}
 
+#if !UE_BUILD_SHIPPING
+	if (GActorCanvasStressTest.bVerifyProjection)
+	{
+		GActorCanvasStressTest.bVerifyProjection = false;
+	}
+	else if (GActorCanvasStressTest.bActive)
+	{
+		GActorCanvasStressTest.UpdateCycles += FPlatformTime::Cycles64() - UpdateStartCycles;
+		++GActorCanvasStressTest.NumUpdates;
+	}
+#endif
+
 	if (AllIndicators.Num() == 0)
 	{
 		TickHandle.Reset();
@@ -292,6 +409,87 @@ EActiveTimerReturnType SActorCanvas::UpdateCanvas(double InCurrentTime, float In
 	}
 }
 
+EIndicatorLODTier SActorCanvas::EvaluateLODTier(const ULyraIndicatorManagerComponent& IndicatorComponent, const UIndicatorDescriptor& Indicator, const FSceneViewProjectionData& ProjectionData, const FVector2f& ScreenSize) const
+{
+	const USceneComponent* Component = Indicator.GetSceneComponent();
+	if (Component == nullptr)
+	{
+		return EIndicatorLODTier::Full;
+	}
+
+	// Rough pixel radius of the component's bounds, from the horizontal field of view
+	const double Distance = FVector::Dist(ProjectionData.ViewOrigin, Component->GetComponentLocation());
+	const double ScreenRadius = Component->Bounds.SphereRadius * ProjectionData.ProjectionMatrix.M[0][0] * 0.5 * ScreenSize.X / FMath::Max(Distance, 1.0);
+
+	return IndicatorComponent.ChooseLODTier(Indicator, Distance, (float)ScreenRadius);
+}
+
+bool SActorCanvas::ChangeLODTier(UIndicatorDescriptor* Indicator, EIndicatorLODTier NewTier)
+{
+	const EIndicatorLODTier PreviousTier = Indicator->LODTier;
+	const TSoftClassPtr<UUserWidget> PreviousClass = Indicator->GetIndicatorClassForLOD();
+	Indicator->LODTier = NewTier;
+
+	if (PreviousTier == EIndicatorLODTier::Culled)
+	{
+		CulledIndicators.RemoveSwap(Indicator);
+		AddIndicatorForEntry(Indicator);
+		return false;
+	}
+
+	if (NewTier == EIndicatorLODTier::Culled)
+	{
+		// Culled indicators hand back their widget and let go of its Slate resources, so crowded scenes stay bounded
+		RemoveIndicatorForEntry(Indicator, /*bReleaseSlate=*/ true);
+		CulledIndicators.Add(Indicator);
+		return true;
+	}
+
+	if (PreviousClass != Indicator->GetIndicatorClassForLOD())
+	{
+		RemoveIndicatorForEntry(Indicator);
+		AddIndicatorForEntry(Indicator);
+		return true;
+	}
+
+	return false;
+}
+
+bool SActorCanvas::ApplyProjection(FSlot& CurChild, bool bSuccess, const FVector& ScreenPositionWithDepth)
+{
+	if (!bSuccess)
+	{
+		CurChild.SetHasValidScreenPosition(false);
+		CurChild.SetInFrontOfCamera(false);
+	}
+	else
+	{
+		CurChild.SetInFrontOfCamera(bSuccess);
+		CurChild.SetHasValidScreenPosition(CurChild.GetInFrontOfCamera() || CurChild.Indicator->GetClampToScreen());
+
+		const double PreviousDepth = CurChild.GetDepth();
+		const int32 PreviousPriority = CurChild.GetPriority();
+
+		if (CurChild.HasValidScreenPosition())
+		{
+			// Only dirty the screen position if we can actually show this indicator.
+			CurChild.SetScreenPosition(FVector2D(ScreenPositionWithDepth));
+			CurChild.SetDepth(ScreenPositionWithDepth.Z);
+		}
+
+		CurChild.SetPriority(CurChild.Indicator->GetPriority());
+
+		if ((PreviousDepth != CurChild.GetDepth()) || (PreviousPriority != CurChild.GetPriority()))
+		{
+			bSortOrderDirty = true;
+		}
+	}
+
+	const bool bChanged = CurChild.bIsDirty();
+	CurChild.ClearDirtyFlag();
+	return bChanged;
+}
+
 void SActorCanvas::SetShowAnyIndicators(bool bIndicators)
 {
 	if (bShowAnyIndicators != bIndicators)
@@ -312,6 +510,10 @@ void SActorCanvas::OnArrangeChildren(const FGeometry& AllottedGeometry, FArrange
 {
 	QUICK_SCOPE_CYCLE_COUNTER(STAT_SActorCanvas_OnArrangeChildren);
 
+#if !UE_BUILD_SHIPPING
+	const uint64 ArrangeStartCycles = FPlatformTime::Cycles64();
+#endif
+
 	NextArrowIndex = 0;
 
 	//Make sure we have a player. If we don't, we can't project anything
@@ -322,22 +524,13 @@ void SActorCanvas::OnArrangeChildren(const FGeometry& AllottedGeometry, FArrange
 		const FVector Center = FVector(AllottedGeometry.Size * 0.5f, 0.0f);
 
 		// Sort the children
-		TArray<const SActorCanvas::FSlot*> SortedSlots;
-		for (int32 ChildIndex = 0; ChildIndex < CanvasChildren.Num(); ++ChildIndex)
-		{
-			SortedSlots.Add(&CanvasChildren[ChildIndex]);
-		}
-
-		SortedSlots.StableSort([](const SActorCanvas::FSlot& A, const SActorCanvas::FSlot& B)
-		{
-			return A.GetPriority() == B.GetPriority() ? A.GetDepth() > B.GetDepth() : A.GetPriority() < B.GetPriority();
-		});
+		UpdateSortOrder();
 
 		// Go through all the sorted children
-		for (int32 ChildIndex = 0; ChildIndex < SortedSlots.Num(); ++ChildIndex)
+		for (int32 SortedIndex = 0; SortedIndex < SortedSlotIndices.Num(); ++SortedIndex)
 		{
 			//grab a child
-			const SActorCanvas::FSlot& CurChild = *SortedSlots[ChildIndex];
+			const SActorCanvas::FSlot& CurChild = CanvasChildren[SortedSlotIndices[SortedIndex]];
 			const UIndicatorDescriptor* Indicator = CurChild.Indicator;
 
 			// Skip this indicator if it's invalid or has an invalid world position
@@ -499,6 +692,77 @@ void SActorCanvas::OnArrangeChildren(const FGeometry& AllottedGeometry, FArrange
 	}
 
 	ArrowIndexLastUpdate = NextArrowIndex;
+
+#if !UE_BUILD_SHIPPING
+	if (GActorCanvasStressTest.bActive)
+	{
+		GActorCanvasStressTest.ArrangeCycles += FPlatformTime::Cycles64() - ArrangeStartCycles;
+		++GActorCanvasStressTest.NumArranges;
+	}
+#endif
+}
+
+bool SActorCanvas::SlotSortsBefore(int32 SlotIndexA, int32 SlotIndexB) const
+{
+	const SActorCanvas::FSlot& A = CanvasChildren[SlotIndexA];
+	const SActorCanvas::FSlot& B = CanvasChildren[SlotIndexB];
+
+	if (A.GetPriority() != B.GetPriority())
+	{
+		return A.GetPriority() < B.GetPriority();
+	}
+	if (A.GetDepth() != B.GetDepth())
+	{
+		return A.GetDepth() > B.GetDepth();
+	}
+
+	// Ties keep the order the slots were added in, as the stable sort used to
+	return SlotIndexA < SlotIndexB;
+}
+
+void SActorCanvas::UpdateSortOrder() const
+{
+	// Slots are only ever appended, removals fix up the order in RemoveActorSlot
+	const int32 NumSlots = CanvasChildren.Num();
+	if (SortedSlotIndices.Num() > NumSlots)
+	{
+		SortedSlotIndices.Reset();
+	}
+	for (int32 SlotIndex = SortedSlotIndices.Num(); SlotIndex < NumSlots; ++SlotIndex)
+	{
+		SortedSlotIndices.Add(SlotIndex);
+		bSortOrderDirty = true;
+	}
+
+	if (!bSortOrderDirty)
+	{
+		return;
+	}
+	bSortOrderDirty = false;
+
+	// Depth only drifts a little between frames, so insertion sort from last frame's order is usually linear.
+	// If the order changed a lot (e.g. the camera spun around) give up and do a full sort.
+	const int32 MaxShifts = NumSlots * 4;
+	int32 NumShifts = 0;
+	for (int32 SortedIndex = 1; SortedIndex < NumSlots; ++SortedIndex)
+	{
+		const int32 SlotIndex = SortedSlotIndices[SortedIndex];
+		int32 InsertIndex = SortedIndex;
+		while ((InsertIndex > 0) && SlotSortsBefore(SlotIndex, SortedSlotIndices[InsertIndex - 1]))
+		{
+			SortedSlotIndices[InsertIndex] = SortedSlotIndices[InsertIndex - 1];
+			--InsertIndex;
+			++NumShifts;
+		}
+		SortedSlotIndices[InsertIndex] = SlotIndex;
+
+		if (NumShifts > MaxShifts)
+		{
+			// The ordering is total, so an unstable sort gives the same result
+			SortedSlotIndices.Sort([this](int32 A, int32 B) { return SlotSortsBefore(A, B); });
+			break;
+		}
+	}
 }
 
 int32 SActorCanvas::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
@@ -557,12 +821,13 @@ void SActorCanvas::OnIndicatorRemoved(UIndicatorDescriptor* Indicator)
 	
 	AllIndicators.Remove(Indicator);
 	InactiveIndicators.Remove(Indicator);
+	CulledIndicators.RemoveSwap(Indicator);
 }
 
 void SActorCanvas::AddIndicatorForEntry(UIndicatorDescriptor* Indicator)
 {
 	// Async load the indicator, and pool the results so that it's easy to use and reuse the widgets.
-	TSoftClassPtr<UUserWidget> IndicatorClass = Indicator->GetIndicatorClass();
+	TSoftClassPtr<UUserWidget> IndicatorClass = Indicator->GetIndicatorClassForLOD();
 	if (!IndicatorClass.IsNull())
 	{
 		TWeakObjectPtr<UIndicatorDescriptor> IndicatorPtr(Indicator);
@@ -575,6 +840,12 @@ void SActorCanvas::AddIndicatorForEntry(UIndicatorDescriptor* Indicator)
 					return;
 				}
 
+				// Or changed LOD tier, in which case the load for the new tier adds it
+				if ((Indicator->GetIndicatorClassForLOD() != IndicatorClass) || Indicator->CanvasHost.IsValid())
+				{
+					return;
+				}
+
 				// Create the widget from the pool.
 				if (UUserWidget* IndicatorWidget = IndicatorPool.GetOrCreateInstance(TSubclassOf<UUserWidget>(IndicatorClass.Get())))
 				{
@@ -587,6 +858,13 @@ void SActorCanvas::AddIndicatorForEntry(UIndicatorDescriptor* Indicator)
 
 					InactiveIndicators.Remove(Indicator);
 
+#if !UE_BUILD_SHIPPING
+					if (GActorCanvasStressTest.bActive)
+					{
+						++GActorCanvasStressTest.NumWidgetsCreated;
+					}
+#endif
+
 					AddActorSlot(Indicator)
 					[
 						SAssignNew(Indicator->CanvasHost, SBox)
@@ -601,7 +879,7 @@ void SActorCanvas::AddIndicatorForEntry(UIndicatorDescriptor* Indicator)
 	}
 }
 
-void SActorCanvas::RemoveIndicatorForEntry(UIndicatorDescriptor* Indicator)
+void SActorCanvas::RemoveIndicatorForEntry(UIndicatorDescriptor* Indicator, bool bReleaseSlate)
 {
 	if (UUserWidget* IndicatorWidget = Indicator->IndicatorWidget.Get())
 	{
@@ -612,7 +890,7 @@ void SActorCanvas::RemoveIndicatorForEntry(UIndicatorDescriptor* Indicator)
 
 		Indicator->IndicatorWidget = nullptr;
 		
-		IndicatorPool.Release(IndicatorWidget);
+		IndicatorPool.Release(IndicatorWidget, bReleaseSlate);
 	}
 
 	TSharedPtr<SWidget> CanvasHost = Indicator->CanvasHost.Pin();
@@ -644,6 +922,16 @@ int32 SActorCanvas::RemoveActorSlot(const TSharedRef<SWidget>& SlotWidget)
 		{
 			CanvasChildren.RemoveAt(SlotIdx);
 
+			// Keep the sort order, only the indices past the removed slot shift down
+			SortedSlotIndices.Remove(SlotIdx);
+			for (int32& SortedSlotIndex : SortedSlotIndices)
+			{
+				if (SortedSlotIndex > SlotIdx)
+				{
+					--SortedSlotIndex;
+				}
+			}
+
 			UpdateActiveTimer();
 
 			return SlotIdx;
@@ -723,3 +1011,120 @@ void SActorCanvas::UpdateActiveTimer()
 		TickHandle = RegisterActiveTimer(0, FWidgetActiveTimerDelegate::CreateSP(this, &SActorCanvas::UpdateCanvas));
 	}
 }
+
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommandWithWorldAndArgs LyraIndicatorStressTestCmd(
+	TEXT("Lyra.Indicators.StressTest"),
+	TEXT("Usage: Lyra.Indicators.StressTest <WidgetClassPath> [NumIndicators=150] [Seconds=5]\n")
+	TEXT("Adds indicators spread around the actors in the world to the first local player, then reports the average actor canvas update and arrange time"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (GActorCanvasStressTest.bActive)
+		{
+			UE_LOG(LogLyra, Warning, TEXT("Lyra.Indicators.StressTest is already running"));
+			return;
+		}
+
+		APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+		ULyraIndicatorManagerComponent* IndicatorManager = ULyraIndicatorManagerComponent::GetComponent(PlayerController);
+		if (IndicatorManager == nullptr)
+		{
+			UE_LOG(LogLyra, Warning, TEXT("Lyra.Indicators.StressTest needs a local player controller with an indicator manager component"));
+			return;
+		}
+
+		// The canvas has to create real widgets for the timings to mean anything, so a concrete widget class is required
+		if (!Args.IsValidIndex(0))
+		{
+			UE_LOG(LogLyra, Error, TEXT("Lyra.Indicators.StressTest: pass the indicator widget class to use, e.g. /Game/UI/Indicators/W_MyIndicator.W_MyIndicator_C"));
+			return;
+		}
+
+		const TSubclassOf<UUserWidget> WidgetClass = LoadClass<UUserWidget>(nullptr, *Args[0]);
+		if ((WidgetClass == nullptr) || WidgetClass->HasAnyClassFlags(CLASS_Abstract))
+		{
+			UE_LOG(LogLyra, Error, TEXT("Lyra.Indicators.StressTest: %s isn't a concrete widget class"), *Args[0]);
+			return;
+		}
+
+		int32 NumIndicators = 150;
+		float Seconds = 5.0f;
+		if (Args.IsValidIndex(1))
+		{
+			LexTryParseString(NumIndicators, *Args[1]);
+		}
+		if (Args.IsValidIndex(2))
+		{
+			LexTryParseString(Seconds, *Args[2]);
+		}
+
+		TArray<USceneComponent*> Anchors;
+		for (TActorIterator<AActor> It(World); It; ++It)
+		{
+			if (USceneComponent* RootComponent = It->GetRootComponent())
+			{
+				Anchors.Add(RootComponent);
+			}
+		}
+		if (Anchors.Num() == 0)
+		{
+			return;
+		}
+
+		// Mix of priorities, depths and clamping so the sort and arrange do representative work
+		FRandomStream Random(1234);
+		TArray<TWeakObjectPtr<UIndicatorDescriptor>> StressIndicators;
+		for (int32 Index = 0; Index < FMath::Max(NumIndicators, 1); ++Index)
+		{
+			UIndicatorDescriptor* Indicator = NewObject<UIndicatorDescriptor>(IndicatorManager);
+			Indicator->SetSceneComponent(Anchors[Random.RandHelper(Anchors.Num())]);
+			Indicator->SetIndicatorClass(TSoftClassPtr<UUserWidget>(WidgetClass.Get()));
+			Indicator->SetWorldPositionOffset(FVector(Random.FRandRange(-2000.0f, 2000.0f), Random.FRandRange(-2000.0f, 2000.0f), Random.FRandRange(0.0f, 300.0f)));
+			Indicator->SetPriority(Random.RandRange(0, 3));
+			Indicator->SetClampToScreen((Index % 4) == 0);
+			Indicator->SetShowClampToScreenArrow((Index % 4) == 0);
+			Indicator->SetAutoRemoveWhenIndicatorComponentIsNull(true);
+
+			IndicatorManager->AddIndicator(Indicator);
+			StressIndicators.Add(Indicator);
+		}
+
+		GActorCanvasStressTest = FActorCanvasStressTest();
+		GActorCanvasStressTest.bActive = true;
+		GActorCanvasStressTest.bVerifyProjection = true;
+
+		TWeakObjectPtr<ULyraIndicatorManagerComponent> WeakManager = IndicatorManager;
+		FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([WeakManager, StressIndicators](float)
+		{
+			const FActorCanvasStressTest& Results = GActorCanvasStressTest;
+			if (Results.NumWidgetsCreated == 0)
+			{
+				UE_LOG(LogLyra, Error, TEXT("Lyra.Indicators.StressTest: no indicator widgets were created for %d indicators, the canvas was empty and there is nothing to report"), StressIndicators.Num());
+			}
+			else
+			{
+				UE_LOG(LogLyra, Display, TEXT("Indicator stress test with %d indicators, %d widgets created (batch projection %s):"), StressIndicators.Num(), Results.NumWidgetsCreated, LyraConsoleVariables::bBatchIndicatorProjection ? TEXT("on") : TEXT("off"));
+				UE_LOG(LogLyra, Display, TEXT("  UpdateCanvas: %.3f ms average over %d updates"),
+					(Results.NumUpdates > 0) ? FPlatformTime::ToMilliseconds64(Results.UpdateCycles) / Results.NumUpdates : 0.0, Results.NumUpdates);
+				UE_LOG(LogLyra, Display, TEXT("  OnArrangeChildren: %.3f ms average over %d arranges"),
+					(Results.NumArranges > 0) ? FPlatformTime::ToMilliseconds64(Results.ArrangeCycles) / Results.NumArranges : 0.0, Results.NumArranges);
+				UE_LOG(LogLyra, Display, TEXT("  Largest difference between batched and per indicator projection: %.4f"), Results.MaxProjectionError);
+			}
+
+			GActorCanvasStressTest.bActive = false;
+
+			if (ULyraIndicatorManagerComponent* Manager = WeakManager.Get())
+			{
+				for (const TWeakObjectPtr<UIndicatorDescriptor>& Indicator : StressIndicators)
+				{
+					if (Indicator.IsValid())
+					{
+						Manager->RemoveIndicator(Indicator.Get());
+					}
+				}
+			}
+
+			return false;
+		}), FMath::Max(Seconds, 0.1f));
+	}));
+#endif // !UE_BUILD_SHIPPING
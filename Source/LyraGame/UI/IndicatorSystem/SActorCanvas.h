@@ -4,6 +4,7 @@
 
 #include "AsyncMixin.h"
 #include "Blueprint/UserWidgetPool.h"
+#include "UI/IndicatorSystem/IndicatorDescriptor.h"
 #include "Widgets/SPanel.h"
 
 class FActiveTimerHandle;
@@ -206,7 +207,7 @@ private:
 	void OnIndicatorRemoved(UIndicatorDescriptor* Indicator);
 
 	void AddIndicatorForEntry(UIndicatorDescriptor* Indicator);
-	void RemoveIndicatorForEntry(UIndicatorDescriptor* Indicator);
+	void RemoveIndicatorForEntry(UIndicatorDescriptor* Indicator, bool bReleaseSlate = false);
 
 	using FScopedWidgetSlotArguments = TPanelChildren<FSlot>::FScopedWidgetSlotArguments;
 	FScopedWidgetSlotArguments AddActorSlot(UIndicatorDescriptor* Indicator);
@@ -215,6 +216,21 @@ private:
 	void SetShowAnyIndicators(bool bIndicators);
 	EActiveTimerReturnType UpdateCanvas(double InCurrentTime, float InDeltaTime);
 
+	/** Measures the indicator against the view and asks the manager for its LOD tier */
+	EIndicatorLODTier EvaluateLODTier(const ULyraIndicatorManagerComponent& IndicatorComponent, const UIndicatorDescriptor& Indicator, const FSceneViewProjectionData& ProjectionData, const FVector2f& ScreenSize) const;
+
+	/** Moves an indicator to a new LOD tier, swapping or releasing its widget. Returns true if its slot was removed. */
+	bool ChangeLODTier(UIndicatorDescriptor* Indicator, EIndicatorLODTier NewTier);
+
+	/** Updates a slot from its projected position, returns true if anything about the slot changed */
+	bool ApplyProjection(FSlot& CurChild, bool bSuccess, const FVector& ScreenPositionWithDepth);
+
+	/** Paint order, by priority then furthest first */
+	bool SlotSortsBefore(int32 SlotIndexA, int32 SlotIndexB) const;
+
+	/** Brings SortedSlotIndices up to date, starting from the previous order */
+	void UpdateSortOrder() const;
+
 	/** Helper function for calculating the offset */
 	void GetOffsetAndSize(const UIndicatorDescriptor* Indicator,
 		FVector2D& OutSize, 
@@ -227,6 +243,10 @@ private:
 private:
 	TArray<TObjectPtr<UIndicatorDescriptor>> AllIndicators;
 	TArray<UIndicatorDescriptor*> InactiveIndicators;
+
+	/** Indicators culled by LOD, they have no slot or widget until they come back */
+	TArray<UIndicatorDescriptor*> CulledIndicators;
+	uint32 LODUpdateFrame = 0;
 	
 	FLocalPlayerContext LocalPlayerContext;
 	TWeakObjectPtr<ULyraIndicatorManagerComponent> IndicatorComponentPtr;
@@ -250,5 +270,14 @@ private:
 
 	mutable TOptional<FGeometry> OptionalPaintGeometry;
 
+	/** Indices into CanvasChildren in paint order, kept between arranges so re-sorting only has to move what changed */
+	mutable TArray<int32> SortedSlotIndices;
+	mutable bool bSortOrderDirty = true;
+
+	/** Scratch space for projecting ComponentPoint indicators in one batch */
+	TArray<FVector> BatchWorldPoints;
+	TArray<FIndicatorProjectedPoint> BatchProjectedPoints;
+	TArray<int32> BatchSlotIndices;
+
 	TSharedPtr<FActiveTimerHandle> TickHandle;
 };
@@ -0,0 +1,303 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "LyraBulletTraceSubsystem.h"
+
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "LyraLogChannels.h"
+#include "Physics/LyraCollisionChannels.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(LyraBulletTraceSubsystem)
+
+DEFINE_STAT(STAT_LyraSyncBulletTraces);
+DEFINE_STAT(STAT_LyraBatchedBulletTraces);
+DEFINE_STAT(STAT_LyraBatchedCartridgesResolved);
+
+namespace LyraConsoleVariables
+{
+	static int32 BatchedBulletTraceMinBullets = 0;
+	static FAutoConsoleVariableRef CVarBatchedBulletTraceMinBullets(
+		TEXT("lyra.Weapon.BatchedBulletTraceMinBullets"),
+		BatchedBulletTraceMinBullets,
+		TEXT("Cartridges with at least this many bullets are traced asynchronously and resolved next tick (0 = always use the sync path, the default). Batched shots add a tick of latency before hits are confirmed and target data is sent, so only enable it for weapons where the trace cost outweighs that"),
+		ECVF_Default);
+}
+
+//////////////////////////////////////////////////////////////////////
+
+bool ULyraBulletTraceSubsystem::ShouldBatchCartridge(int32 BulletsPerCartridge)
+{
+	return (LyraConsoleVariables::BatchedBulletTraceMinBullets > 0) && (BulletsPerCartridge >= LyraConsoleVariables::BatchedBulletTraceMinBullets);
+}
+
+void ULyraBulletTraceSubsystem::Deinitialize()
+{
+	// Anyone still waiting would be calling into a world that is going away
+	PendingCartridges.Reset();
+
+	Super::Deinitialize();
+}
+
+TStatId ULyraBulletTraceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(ULyraBulletTraceSubsystem, STATGROUP_Tickables);
+}
+
+void ULyraBulletTraceSubsystem::SubmitCartridge(TArrayView<const FLyraBulletTraceRequest> Bullets, ECollisionChannel TraceChannel, const FCollisionQueryParams& QueryParams, FLyraOnCartridgeTraced OnComplete)
+{
+	UWorld* World = GetWorld();
+	check(World);
+
+	FPendingCartridge& Cartridge = PendingCartridges.AddDefaulted_GetRef();
+	Cartridge.QueryParams = QueryParams;
+	Cartridge.TraceChannel = TraceChannel;
+	Cartridge.OnComplete = MoveTemp(OnComplete);
+	Cartridge.SubmitFrame = GFrameCounter;
+	Cartridge.Results.SetNum(Bullets.Num());
+
+	for (int32 BulletIndex = 0; BulletIndex < Bullets.Num(); ++BulletIndex)
+	{
+		const FLyraBulletTraceRequest& Bullet = Bullets[BulletIndex];
+		Cartridge.Results[BulletIndex].Request = Bullet;
+
+		Cartridge.LineHandles.Add(World->AsyncLineTraceByChannel(EAsyncTraceType::Multi, Bullet.StartTrace, Bullet.EndTrace, TraceChannel, QueryParams));
+		INC_DWORD_STAT(STAT_LyraBatchedBulletTraces);
+
+		// The sync path only sweeps if the line trace missed every pawn. We can't know that up front, so the sweep is traced speculatively alongside it.
+		if (Bullet.SweepRadius > 0.0f)
+		{
+			Cartridge.SweepHandles.Add(World->AsyncSweepByChannel(EAsyncTraceType::Multi, Bullet.StartTrace, Bullet.EndTrace, FQuat::Identity, TraceChannel, FCollisionShape::MakeSphere(Bullet.SweepRadius), QueryParams));
+			INC_DWORD_STAT(STAT_LyraBatchedBulletTraces);
+		}
+		else
+		{
+			Cartridge.SweepHandles.Add(FTraceHandle());
+		}
+	}
+}
+
+void ULyraBulletTraceSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (PendingCartridges.Num() == 0)
+	{
+		return;
+	}
+
+	UWorld* World = GetWorld();
+
+	// Async traces requested during a frame are available during the following one. Cartridges are appended in submit order, so the ready ones are a prefix.
+	int32 NumReady = 0;
+	while ((NumReady < PendingCartridges.Num()) && (PendingCartridges[NumReady].SubmitFrame < GFrameCounter))
+	{
+		++NumReady;
+	}
+
+	if (NumReady == 0)
+	{
+		return;
+	}
+
+	// Move them out first, completion callbacks are allowed to submit new cartridges
+	TArray<FPendingCartridge> ReadyCartridges;
+	ReadyCartridges.Reserve(NumReady);
+	for (int32 Index = 0; Index < NumReady; ++Index)
+	{
+		ReadyCartridges.Add(MoveTemp(PendingCartridges[Index]));
+	}
+	PendingCartridges.RemoveAt(0, NumReady, EAllowShrinking::No);
+
+	for (FPendingCartridge& Cartridge : ReadyCartridges)
+	{
+		ResolveCartridge(World, Cartridge, /*bAsyncTracesDone=*/ true);
+	}
+}
+
+void ULyraBulletTraceSubsystem::FlushCartridges(const UObject* Owner)
+{
+	if ((Owner == nullptr) || (PendingCartridges.Num() == 0))
+	{
+		return;
+	}
+
+	// Move them out first, same as Tick
+	TArray<FPendingCartridge> OwnedCartridges;
+	for (int32 Index = 0; Index < PendingCartridges.Num(); )
+	{
+		if (PendingCartridges[Index].OnComplete.IsBoundToObject(Owner))
+		{
+			OwnedCartridges.Add(MoveTemp(PendingCartridges[Index]));
+			PendingCartridges.RemoveAt(Index, 1, EAllowShrinking::No);
+		}
+		else
+		{
+			++Index;
+		}
+	}
+
+	UWorld* World = GetWorld();
+	for (FPendingCartridge& Cartridge : OwnedCartridges)
+	{
+		ResolveCartridge(World, Cartridge, /*bAsyncTracesDone=*/ Cartridge.SubmitFrame < GFrameCounter);
+	}
+}
+
+void ULyraBulletTraceSubsystem::ResolveCartridge(UWorld* World, FPendingCartridge& Cartridge, bool bAsyncTracesDone)
+{
+	FTraceDatum TraceDatum;
+
+	for (int32 BulletIndex = 0; BulletIndex < Cartridge.Results.Num(); ++BulletIndex)
+	{
+		FLyraBulletTraceResult& Result = Cartridge.Results[BulletIndex];
+		const FLyraBulletTraceRequest& Bullet = Result.Request;
+
+		if (bAsyncTracesDone && World->QueryTraceData(Cartridge.LineHandles[BulletIndex], TraceDatum))
+		{
+			Result.LineHits = MoveTemp(TraceDatum.OutHits);
+		}
+		else
+		{
+			// The data is only kept for one frame and isn't there yet when flushed early, fall back to tracing now
+			World->LineTraceMultiByChannel(Result.LineHits, Bullet.StartTrace, Bullet.EndTrace, Cartridge.TraceChannel, Cartridge.QueryParams);
+			INC_DWORD_STAT(STAT_LyraSyncBulletTraces);
+		}
+
+		if (Bullet.SweepRadius > 0.0f)
+		{
+			if (bAsyncTracesDone && World->QueryTraceData(Cartridge.SweepHandles[BulletIndex], TraceDatum))
+			{
+				Result.SweepHits = MoveTemp(TraceDatum.OutHits);
+			}
+			else
+			{
+				World->SweepMultiByChannel(Result.SweepHits, Bullet.StartTrace, Bullet.EndTrace, FQuat::Identity, Cartridge.TraceChannel, FCollisionShape::MakeSphere(Bullet.SweepRadius), Cartridge.QueryParams);
+				INC_DWORD_STAT(STAT_LyraSyncBulletTraces);
+			}
+		}
+	}
+
+	INC_DWORD_STAT(STAT_LyraBatchedCartridgesResolved);
+	Cartridge.OnComplete.ExecuteIfBound(Cartridge.Results);
+}
+
+//////////////////////////////////////////////////////////////////////
+
+#if !UE_BUILD_SHIPPING
+void ULyraBulletTraceSubsystem::RunBenchmark(const FVector& Origin, int32 NumCartridges, int32 BulletsPerCartridge, float Range, float SweepRadius)
+{
+	UWorld* World = GetWorld();
+	check(World);
+
+	FRandomStream Random(1234);
+
+	TArray<FLyraBulletTraceRequest> Bullets;
+	Bullets.Reserve(NumCartridges * BulletsPerCartridge);
+	for (int32 Index = 0; Index < NumCartridges * BulletsPerCartridge; ++Index)
+	{
+		FLyraBulletTraceRequest& Bullet = Bullets.AddDefaulted_GetRef();
+		Bullet.StartTrace = Origin;
+		Bullet.EndTrace = Origin + Random.GetUnitVector() * Range;
+		Bullet.SweepRadius = SweepRadius;
+	}
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(WeaponTrace), /*bTraceComplex=*/ true);
+	QueryParams.bReturnPhysicalMaterial = true;
+
+	// Sync: the worst case of the existing path, a line trace followed by the sweep fallback for every bullet
+	int32 SyncHits = 0;
+	const double SyncStartTime = FPlatformTime::Seconds();
+	for (const FLyraBulletTraceRequest& Bullet : Bullets)
+	{
+		TArray<FHitResult> HitResults;
+		World->LineTraceMultiByChannel(HitResults, Bullet.StartTrace, Bullet.EndTrace, Lyra_TraceChannel_Weapon, QueryParams);
+		SyncHits += HitResults.Num();
+
+		if (Bullet.SweepRadius > 0.0f)
+		{
+			World->SweepMultiByChannel(HitResults, Bullet.StartTrace, Bullet.EndTrace, FQuat::Identity, Lyra_TraceChannel_Weapon, FCollisionShape::MakeSphere(Bullet.SweepRadius), QueryParams);
+			SyncHits += HitResults.Num();
+		}
+	}
+	const double SyncSeconds = FPlatformTime::Seconds() - SyncStartTime;
+
+	// Batched: submit everything now and measure the game thread cost of submitting and of resolving next tick
+	struct FBatchedBenchmarkState
+	{
+		int32 CartridgesRemaining = 0;
+		int32 Hits = 0;
+		double SubmitSeconds = 0.0;
+		double FirstResolveTime = 0.0;
+		double SyncSeconds = 0.0;
+		int32 NumBullets = 0;
+	};
+	TSharedRef<FBatchedBenchmarkState> State = MakeShared<FBatchedBenchmarkState>();
+	State->CartridgesRemaining = NumCartridges;
+	State->SyncSeconds = SyncSeconds;
+	State->NumBullets = Bullets.Num();
+
+	const double SubmitStartTime = FPlatformTime::Seconds();
+	for (int32 CartridgeIndex = 0; CartridgeIndex < NumCartridges; ++CartridgeIndex)
+	{
+		TArrayView<const FLyraBulletTraceRequest> CartridgeBullets = MakeArrayView(Bullets).Slice(CartridgeIndex * BulletsPerCartridge, BulletsPerCartridge);
+
+		SubmitCartridge(CartridgeBullets, Lyra_TraceChannel_Weapon, QueryParams, FLyraOnCartridgeTraced::CreateLambda([State](const TArray<FLyraBulletTraceResult>& Results)
+		{
+			if (State->FirstResolveTime == 0.0)
+			{
+				State->FirstResolveTime = FPlatformTime::Seconds();
+			}
+
+			for (const FLyraBulletTraceResult& Result : Results)
+			{
+				State->Hits += Result.LineHits.Num() + Result.SweepHits.Num();
+			}
+
+			if (--State->CartridgesRemaining == 0)
+			{
+				const double ResolveSeconds = FPlatformTime::Seconds() - State->FirstResolveTime;
+				UE_LOG(LogLyra, Display, TEXT("Bullet trace benchmark: %d bullets"), State->NumBullets);
+				UE_LOG(LogLyra, Display, TEXT("  Sync:    %.3f ms game thread"), State->SyncSeconds * 1000.0);
+				UE_LOG(LogLyra, Display, TEXT("  Batched: %.3f ms game thread (%.3f ms submit + %.3f ms resolve next tick), %d hits"), (State->SubmitSeconds + ResolveSeconds) * 1000.0, State->SubmitSeconds * 1000.0, ResolveSeconds * 1000.0, State->Hits);
+			}
+		}));
+	}
+	State->SubmitSeconds = FPlatformTime::Seconds() - SubmitStartTime;
+
+	UE_LOG(LogLyra, Display, TEXT("Bullet trace benchmark: sync pass done (%d hits), batched results will be logged next tick"), SyncHits);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs LyraBulletTraceBenchmarkCmd(
+	TEXT("lyra.Weapon.BulletTraceBenchmark"),
+	TEXT("Usage: lyra.Weapon.BulletTraceBenchmark <NumCartridges=30> <BulletsPerCartridge=12> <Range=5000> <SweepRadius=10>. Traces from the first player's pawn (or the world origin)."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		int32 NumCartridges = 30;
+		int32 BulletsPerCartridge = 12;
+		float Range = 5000.0f;
+		float SweepRadius = 10.0f;
+		if (Args.Num() > 0) { LexTryParseString<int32>(NumCartridges, *Args[0]); }
+		if (Args.Num() > 1) { LexTryParseString<int32>(BulletsPerCartridge, *Args[1]); }
+		if (Args.Num() > 2) { LexTryParseString<float>(Range, *Args[2]); }
+		if (Args.Num() > 3) { LexTryParseString<float>(SweepRadius, *Args[3]); }
+
+		ULyraBulletTraceSubsystem* Subsystem = World ? World->GetSubsystem<ULyraBulletTraceSubsystem>() : nullptr;
+		if (Subsystem == nullptr)
+		{
+			return;
+		}
+
+		FVector Origin = FVector::ZeroVector;
+		if (APlayerController* PC = World->GetFirstPlayerController())
+		{
+			if (APawn* Pawn = PC->GetPawn())
+			{
+				Origin = Pawn->GetActorLocation();
+			}
+		}
+
+		Subsystem->RunBenchmark(Origin, FMath::Max(NumCartridges, 1), FMath::Max(BulletsPerCartridge, 1), Range, FMath::Max(SweepRadius, 0.0f));
+	}));
+#endif // !UE_BUILD_SHIPPING
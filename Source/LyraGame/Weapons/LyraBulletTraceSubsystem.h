@@ -0,0 +1,92 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CollisionQueryParams.h"
+#include "Engine/EngineTypes.h"
+#include "Stats/Stats.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+
+#include "LyraBulletTraceSubsystem.generated.h"
+
+DECLARE_STATS_GROUP(TEXT("Lyra Weapons"), STATGROUP_LyraWeapons, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Sync Bullet Traces"), STAT_LyraSyncBulletTraces, STATGROUP_LyraWeapons, LYRAGAME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Batched Bullet Traces"), STAT_LyraBatchedBulletTraces, STATGROUP_LyraWeapons, LYRAGAME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Batched Cartridges Resolved"), STAT_LyraBatchedCartridgesResolved, STATGROUP_LyraWeapons, LYRAGAME_API);
+
+/** A single bullet of a cartridge, already spread by the weapon */
+struct FLyraBulletTraceRequest
+{
+	FVector StartTrace = FVector::ZeroVector;
+	FVector EndTrace = FVector::ZeroVector;
+
+	// If above zero a sphere sweep is traced alongside the line trace, mirroring the sweep fallback of the sync path
+	float SweepRadius = 0.0f;
+};
+
+/** Raw results of a batched bullet, unfiltered. The owning ability decides how to combine the line and sweep hits. */
+struct FLyraBulletTraceResult
+{
+	FLyraBulletTraceRequest Request;
+
+	TArray<FHitResult> LineHits;
+	TArray<FHitResult> SweepHits;
+};
+
+DECLARE_DELEGATE_OneParam(FLyraOnCartridgeTraced, const TArray<FLyraBulletTraceResult>& /*Results*/);
+
+/**
+ * ULyraBulletTraceSubsystem
+ *
+ * Collects the bullet traces of every cartridge fired this frame and submits them as async world traces, so the physics
+ * scene can run them in parallel instead of blocking the game thread once per pellet. Results are resolved on the next tick
+ * and handed back to whoever submitted the cartridge.
+ *
+ * See lyra.Weapon.BatchedBulletTraceMinBullets for which cartridges use this path, it is off by default since it delays
+ * every batched shot by a tick.
+ */
+UCLASS()
+class ULyraBulletTraceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~UTickableWorldSubsystem interface
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	//~End of UTickableWorldSubsystem interface
+
+	/** Returns true if a cartridge with this many bullets should be traced through the batched path */
+	static bool ShouldBatchCartridge(int32 BulletsPerCartridge);
+
+	/** Queues async traces for every bullet of a cartridge. OnComplete is called next tick with one result per bullet, in order. */
+	void SubmitCartridge(TArrayView<const FLyraBulletTraceRequest> Bullets, ECollisionChannel TraceChannel, const FCollisionQueryParams& QueryParams, FLyraOnCartridgeTraced OnComplete);
+
+	/** Resolves every cartridge submitted by Owner right away, tracing synchronously whatever the async traces haven't finished yet */
+	void FlushCartridges(const UObject* Owner);
+
+	int32 GetNumPendingCartridges() const { return PendingCartridges.Num(); }
+
+#if !UE_BUILD_SHIPPING
+	/** Compares game thread cost of sync and batched tracing for the same set of bullets. Batched results are logged once they resolve. */
+	void RunBenchmark(const FVector& Origin, int32 NumCartridges, int32 BulletsPerCartridge, float Range, float SweepRadius);
+#endif
+
+private:
+	struct FPendingCartridge
+	{
+		TArray<FLyraBulletTraceResult> Results;
+		TArray<FTraceHandle, TInlineAllocator<16>> LineHandles;
+		TArray<FTraceHandle, TInlineAllocator<16>> SweepHandles;
+		FCollisionQueryParams QueryParams;
+		ECollisionChannel TraceChannel = ECC_Visibility;
+		FLyraOnCartridgeTraced OnComplete;
+		uint64 SubmitFrame = 0;
+	};
+
+	void ResolveCartridge(UWorld* World, FPendingCartridge& Cartridge, bool bAsyncTracesDone);
+
+	TArray<FPendingCartridge> PendingCartridges;
+};
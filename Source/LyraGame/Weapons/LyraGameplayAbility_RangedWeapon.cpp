@@ -2,6 +2,8 @@
 
 #include "LyraGameplayAbility_RangedWeapon.h"
 #include "Weapons/LyraRangedWeaponInstance.h"
+#include "Weapons/LyraBulletTraceSubsystem.h"
+#include "Weapons/LyraLagCompensationSubsystem.h"
 #include "Physics/LyraCollisionChannels.h"
 #include "LyraLogChannels.h"
 #include "AIController.h"
@@ -140,17 +142,26 @@ ECollisionChannel ULyraGameplayAbility_RangedWeapon::DetermineTraceChannel(FColl
 	return Lyra_TraceChannel_Weapon;
 }
 
-FHitResult ULyraGameplayAbility_RangedWeapon::WeaponTrace(const FVector& StartTrace, const FVector& EndTrace, float SweepRadius, bool bIsSimulated, OUT TArray<FHitResult>& OutHitResults) const
+FCollisionQueryParams ULyraGameplayAbility_RangedWeapon::MakeWeaponTraceQueryParams() const
 {
-	TArray<FHitResult> HitResults;
-	
 	FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(WeaponTrace), /*bTraceComplex=*/ true, /*IgnoreActor=*/ GetAvatarActorFromActorInfo());
 	TraceParams.bReturnPhysicalMaterial = true;
 	AddAdditionalTraceIgnoreActors(TraceParams);
 	//TraceParams.bDebugQuery = true;
 
+	return TraceParams;
+}
+
+FHitResult ULyraGameplayAbility_RangedWeapon::WeaponTrace(const FVector& StartTrace, const FVector& EndTrace, float SweepRadius, bool bIsSimulated, OUT TArray<FHitResult>& OutHitResults) const
+{
+	TArray<FHitResult> HitResults;
+	
+	FCollisionQueryParams TraceParams = MakeWeaponTraceQueryParams();
+
 	const ECollisionChannel TraceChannel = DetermineTraceChannel(TraceParams, bIsSimulated);
 
+	INC_DWORD_STAT(STAT_LyraSyncBulletTraces);
+
 	if (SweepRadius > 0.0f)
 	{
 		GetWorld()->SweepMultiByChannel(HitResults, StartTrace, EndTrace, FQuat::Identity, TraceChannel, FCollisionShape::MakeSphere(SweepRadius), TraceParams);
@@ -160,13 +171,18 @@ FHitResult ULyraGameplayAbility_RangedWeapon::WeaponTrace(const FVector& StartTr
 		GetWorld()->LineTraceMultiByChannel(HitResults, StartTrace, EndTrace, TraceChannel, TraceParams);
 	}
 
+	return FilterWeaponTraceHits(HitResults, StartTrace, EndTrace, /*out*/ OutHitResults);
+}
+
+FHitResult ULyraGameplayAbility_RangedWeapon::FilterWeaponTraceHits(const TArray<FHitResult>& HitResults, const FVector& StartTrace, const FVector& EndTrace, OUT TArray<FHitResult>& OutHitResults)
+{
 	FHitResult Hit(ForceInit);
 	if (HitResults.Num() > 0)
 	{
 		// Filter the output list to prevent multiple hits on the same actor;
 		// this is to prevent a single bullet dealing damage multiple times to
 		// a single actor if using an overlap trace
-		for (FHitResult& CurHitResult : HitResults)
+		for (const FHitResult& CurHitResult : HitResults)
 		{
 			auto Pred = [&CurHitResult](const FHitResult& Other)
 			{
@@ -316,47 +332,77 @@ FHitResult ULyraGameplayAbility_RangedWeapon::DoSingleBulletTrace(const FVector&
 			TArray<FHitResult> SweepHits;
 			Impact = WeaponTrace(StartTrace, EndTrace, SweepRadius, bIsSimulated, /*out*/ SweepHits);
 
-			// If the trace with sweep radius enabled hit a pawn, check if we should use its hit results
-			const int32 FirstPawnIdx = FindFirstPawnHitResult(SweepHits);
-			if (SweepHits.IsValidIndex(FirstPawnIdx))
-			{
-				// If we had a blocking hit in our line trace that occurs in SweepHits before our
-				// hit pawn, we should just use our initial hit results since the Pawn hit should be blocked
-				bool bUseSweepHits = true;
-				for (int32 Idx = 0; Idx < FirstPawnIdx; ++Idx)
-				{
-					const FHitResult& CurHitResult = SweepHits[Idx];
+			MergeSweepHits(SweepHits, /*inout*/ OutHits);
+		}
+	}
 
-					auto Pred = [&CurHitResult](const FHitResult& Other)
-					{
-						return Other.HitObjectHandle == CurHitResult.HitObjectHandle;
-					};
-					if (CurHitResult.bBlockingHit && OutHits.ContainsByPredicate(Pred))
-					{
-						bUseSweepHits = false;
-						break;
-					}
-				}
+	return Impact;
+}
 
-				if (bUseSweepHits)
-				{
-					OutHits = SweepHits;
-				}
+void ULyraGameplayAbility_RangedWeapon::MergeSweepHits(const TArray<FHitResult>& SweepHits, OUT TArray<FHitResult>& OutHits)
+{
+	// If the trace with sweep radius enabled hit a pawn, check if we should use its hit results
+	const int32 FirstPawnIdx = FindFirstPawnHitResult(SweepHits);
+	if (SweepHits.IsValidIndex(FirstPawnIdx))
+	{
+		// If we had a blocking hit in our line trace that occurs in SweepHits before our
+		// hit pawn, we should just use our initial hit results since the Pawn hit should be blocked
+		bool bUseSweepHits = true;
+		for (int32 Idx = 0; Idx < FirstPawnIdx; ++Idx)
+		{
+			const FHitResult& CurHitResult = SweepHits[Idx];
+
+			auto Pred = [&CurHitResult](const FHitResult& Other)
+			{
+				return Other.HitObjectHandle == CurHitResult.HitObjectHandle;
+			};
+			if (CurHitResult.bBlockingHit && OutHits.ContainsByPredicate(Pred))
+			{
+				bUseSweepHits = false;
+				break;
 			}
 		}
+
+		if (bUseSweepHits)
+		{
+			OutHits = SweepHits;
+		}
+	}
+}
+
+FHitResult ULyraGameplayAbility_RangedWeapon::ResolveBatchedBulletTrace(const FLyraBulletTraceResult& TraceResult, OUT TArray<FHitResult>& OutHits) const
+{
+	const FLyraBulletTraceRequest& Bullet = TraceResult.Request;
+
+#if ENABLE_DRAW_DEBUG
+	if (LyraConsoleVariables::DrawBulletTracesDuration > 0.0f)
+	{
+		static float DebugThickness = 1.0f;
+		DrawDebugLine(GetWorld(), Bullet.StartTrace, Bullet.EndTrace, FColor::Orange, false, LyraConsoleVariables::DrawBulletTracesDuration, 0, DebugThickness);
+	}
+#endif // ENABLE_DRAW_DEBUG
+
+	// Mirrors DoSingleBulletTrace, the sweep was traced speculatively so only use it if the line trace didn't find a pawn
+	FHitResult Impact = FilterWeaponTraceHits(TraceResult.LineHits, Bullet.StartTrace, Bullet.EndTrace, /*out*/ OutHits);
+
+	if ((Bullet.SweepRadius > 0.0f) && (FindFirstPawnHitResult(OutHits) == INDEX_NONE))
+	{
+		TArray<FHitResult> SweepHits;
+		Impact = FilterWeaponTraceHits(TraceResult.SweepHits, Bullet.StartTrace, Bullet.EndTrace, /*out*/ SweepHits);
+
+		MergeSweepHits(SweepHits, /*inout*/ OutHits);
 	}
 
 	return Impact;
 }
 
-void ULyraGameplayAbility_RangedWeapon::PerformLocalTargeting(OUT TArray<FHitResult>& OutHits)
+bool ULyraGameplayAbility_RangedWeapon::MakeLocalFiringInput(OUT FRangedWeaponFiringInput& InputData)
 {
 	APawn* const AvatarPawn = Cast<APawn>(GetAvatarActorFromActorInfo());
 
 	ULyraRangedWeaponInstance* WeaponData = GetWeaponInstance();
 	if (AvatarPawn && AvatarPawn->IsLocallyControlled() && WeaponData)
 	{
-		FRangedWeaponFiringInput InputData;
 		InputData.WeaponData = WeaponData;
 		InputData.bCanPlayBulletFX = (AvatarPawn->GetNetMode() != NM_DedicatedServer);
 
@@ -375,10 +421,72 @@ void ULyraGameplayAbility_RangedWeapon::PerformLocalTargeting(OUT TArray<FHitRes
 		}
 #endif
 
+		return true;
+	}
+
+	return false;
+}
+
+void ULyraGameplayAbility_RangedWeapon::PerformLocalTargeting(OUT TArray<FHitResult>& OutHits)
+{
+	FRangedWeaponFiringInput InputData;
+	if (MakeLocalFiringInput(/*out*/ InputData))
+	{
 		TraceBulletsInCartridge(InputData, /*out*/ OutHits);
 	}
 }
 
+FVector ULyraGameplayAbility_RangedWeapon::CalculateBulletEndTrace(const FRangedWeaponFiringInput& InputData) const
+{
+	ULyraRangedWeaponInstance* WeaponData = InputData.WeaponData;
+	check(WeaponData);
+
+	const float BaseSpreadAngle = WeaponData->GetCalculatedSpreadAngle();
+	const float SpreadAngleMultiplier = WeaponData->GetCalculatedSpreadAngleMultiplier();
+	const float ActualSpreadAngle = BaseSpreadAngle * SpreadAngleMultiplier;
+
+	const float HalfSpreadAngleInRadians = FMath::DegreesToRadians(ActualSpreadAngle * 0.5f);
+
+	const FVector BulletDir = VRandConeNormalDistribution(InputData.AimDir, HalfSpreadAngleInRadians, WeaponData->GetSpreadExponent());
+
+	return InputData.StartTrace + (BulletDir * WeaponData->GetMaxDamageRange());
+}
+
+void ULyraGameplayAbility_RangedWeapon::AddBulletImpact(const FHitResult& InImpact, const TArray<FHitResult>& AllImpacts, const FVector& EndTrace, OUT TArray<FHitResult>& OutHits) const
+{
+	FHitResult Impact = InImpact;
+
+	const AActor* HitActor = Impact.GetActor();
+
+	if (HitActor)
+	{
+#if ENABLE_DRAW_DEBUG
+		if (LyraConsoleVariables::DrawBulletHitDuration > 0.0f)
+		{
+			DrawDebugPoint(GetWorld(), Impact.ImpactPoint, LyraConsoleVariables::DrawBulletHitRadius, FColor::Red, false, LyraConsoleVariables::DrawBulletHitRadius);
+		}
+#endif
+
+		if (AllImpacts.Num() > 0)
+		{
+			OutHits.Append(AllImpacts);
+		}
+	}
+
+	// Make sure there's always an entry in OutHits so the direction can be used for tracers, etc...
+	if (OutHits.Num() == 0)
+	{
+		if (!Impact.bBlockingHit)
+		{
+			// Locate the fake 'impact' at the end of the trace
+			Impact.Location = EndTrace;
+			Impact.ImpactPoint = EndTrace;
+		}
+
+		OutHits.Add(Impact);
+	}
+}
+
 void ULyraGameplayAbility_RangedWeapon::TraceBulletsInCartridge(const FRangedWeaponFiringInput& InputData, OUT TArray<FHitResult>& OutHits)
 {
 	ULyraRangedWeaponInstance* WeaponData = InputData.WeaponData;
@@ -388,53 +496,71 @@ void ULyraGameplayAbility_RangedWeapon::TraceBulletsInCartridge(const FRangedWea
 
 	for (int32 BulletIndex = 0; BulletIndex < BulletsPerCartridge; ++BulletIndex)
 	{
-		const float BaseSpreadAngle = WeaponData->GetCalculatedSpreadAngle();
-		const float SpreadAngleMultiplier = WeaponData->GetCalculatedSpreadAngleMultiplier();
-		const float ActualSpreadAngle = BaseSpreadAngle * SpreadAngleMultiplier;
+		const FVector EndTrace = CalculateBulletEndTrace(InputData);
 
-		const float HalfSpreadAngleInRadians = FMath::DegreesToRadians(ActualSpreadAngle * 0.5f);
+		TArray<FHitResult> AllImpacts;
 
-		const FVector BulletDir = VRandConeNormalDistribution(InputData.AimDir, HalfSpreadAngleInRadians, WeaponData->GetSpreadExponent());
+		FHitResult Impact = DoSingleBulletTrace(InputData.StartTrace, EndTrace, WeaponData->GetBulletTraceSweepRadius(), /*bIsSimulated=*/ false, /*out*/ AllImpacts);
 
-		const FVector EndTrace = InputData.StartTrace + (BulletDir * WeaponData->GetMaxDamageRange());
-		FVector HitLocation = EndTrace;
+		AddBulletImpact(Impact, AllImpacts, EndTrace, /*out*/ OutHits);
+	}
+}
 
-		TArray<FHitResult> AllImpacts;
+bool ULyraGameplayAbility_RangedWeapon::SubmitBatchedBulletsInCartridge(const FRangedWeaponFiringInput& InputData)
+{
+	ULyraRangedWeaponInstance* WeaponData = InputData.WeaponData;
+	check(WeaponData);
 
-		FHitResult Impact = DoSingleBulletTrace(InputData.StartTrace, EndTrace, WeaponData->GetBulletTraceSweepRadius(), /*bIsSimulated=*/ false, /*out*/ AllImpacts);
+	ULyraBulletTraceSubsystem* BulletTraceSubsystem = GetWorld()->GetSubsystem<ULyraBulletTraceSubsystem>();
+	if (BulletTraceSubsystem == nullptr)
+	{
+		return false;
+	}
 
-		const AActor* HitActor = Impact.GetActor();
+	const int32 BulletsPerCartridge = WeaponData->GetBulletsPerCartridge();
+	const float SweepRadius = WeaponData->GetBulletTraceSweepRadius();
 
-		if (HitActor)
-		{
-#if ENABLE_DRAW_DEBUG
-			if (LyraConsoleVariables::DrawBulletHitDuration > 0.0f)
-			{
-				DrawDebugPoint(GetWorld(), Impact.ImpactPoint, LyraConsoleVariables::DrawBulletHitRadius, FColor::Red, false, LyraConsoleVariables::DrawBulletHitRadius);
-			}
-#endif
+	TArray<FLyraBulletTraceRequest, TInlineAllocator<16>> Bullets;
+	Bullets.Reserve(BulletsPerCartridge);
+	for (int32 BulletIndex = 0; BulletIndex < BulletsPerCartridge; ++BulletIndex)
+	{
+		FLyraBulletTraceRequest& Bullet = Bullets.AddDefaulted_GetRef();
+		Bullet.StartTrace = InputData.StartTrace;
+		Bullet.EndTrace = CalculateBulletEndTrace(InputData);
+		Bullet.SweepRadius = SweepRadius;
+	}
 
-			if (AllImpacts.Num() > 0)
-			{
-				OutHits.Append(AllImpacts);
-			}
+	FCollisionQueryParams TraceParams = MakeWeaponTraceQueryParams();
+	const ECollisionChannel TraceChannel = DetermineTraceChannel(TraceParams, /*bIsSimulated=*/ false);
 
-			HitLocation = Impact.ImpactPoint;
-		}
+	BulletTraceSubsystem->SubmitCartridge(Bullets, TraceChannel, TraceParams, FLyraOnCartridgeTraced::CreateUObject(this, &ThisClass::OnBatchedCartridgeTraced));
+	return true;
+}
 
-		// Make sure there's always an entry in OutHits so the direction can be used for tracers, etc...
-		if (OutHits.Num() == 0)
-		{
-			if (!Impact.bBlockingHit)
-			{
-				// Locate the fake 'impact' at the end of the trace
-				Impact.Location = EndTrace;
-				Impact.ImpactPoint = EndTrace;
-			}
+void ULyraGameplayAbility_RangedWeapon::OnBatchedCartridgeTraced(const TArray<FLyraBulletTraceResult>& TraceResults)
+{
+	// EndAbility flushes our cartridges, this is only a safety net
+	if (!IsActive() || (CurrentActorInfo == nullptr))
+	{
+		return;
+	}
 
-			OutHits.Add(Impact);
-		}
+	TArray<FHitResult> FoundHits;
+	for (const FLyraBulletTraceResult& TraceResult : TraceResults)
+	{
+		TArray<FHitResult> AllImpacts;
+
+		FHitResult Impact = ResolveBatchedBulletTrace(TraceResult, /*out*/ AllImpacts);
+
+		AddBulletImpact(Impact, AllImpacts, TraceResult.Request.EndTrace, /*out*/ FoundHits);
 	}
+
+	UAbilitySystemComponent* MyAbilityComponent = CurrentActorInfo->AbilitySystemComponent.Get();
+	check(MyAbilityComponent);
+
+	FScopedPredictionWindow ScopedPrediction(MyAbilityComponent, CurrentActivationInfo.GetActivationPredictionKey());
+
+	FinishRangedWeaponTargeting(FoundHits);
 }
 
 void ULyraGameplayAbility_RangedWeapon::ActivateAbility(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo, const FGameplayEventData* TriggerEventData)
@@ -463,6 +589,18 @@ void ULyraGameplayAbility_RangedWeapon::EndAbility(const FGameplayAbilitySpecHan
 			return;
 		}
 
+		// Shots still waiting on batched traces would be dropped once we stop being active, fire them now
+		if (ULyraBulletTraceSubsystem* BulletTraceSubsystem = GetWorld()->GetSubsystem<ULyraBulletTraceSubsystem>())
+		{
+			BulletTraceSubsystem->FlushCartridges(this);
+
+			// Processing them may have ended the ability already (e.g. failing to commit)
+			if (!IsEndAbilityValid(Handle, ActorInfo))
+			{
+				return;
+			}
+		}
+
 		UAbilitySystemComponent* MyAbilityComponent = CurrentActorInfo->AbilitySystemComponent.Get();
 		check(MyAbilityComponent);
 
@@ -503,6 +641,12 @@ void ULyraGameplayAbility_RangedWeapon::OnTargetDataReadyCallback(const FGamepla
 			{
 				if (Controller->GetLocalRole() == ROLE_Authority)
 				{
+					// Hits from remote clients are checked against where the targets were when they fired
+					if (!CurrentActorInfo->IsLocallyControlled())
+					{
+						ValidateTargetDataWithLagCompensation(LocalTargetDataHandle);
+					}
+
 					// Confirm hit markers
 					if (ULyraWeaponStateComponent* WeaponStateComponent = Controller->FindComponentByClass<ULyraWeaponStateComponent>())
 					{
@@ -549,6 +693,45 @@ void ULyraGameplayAbility_RangedWeapon::OnTargetDataReadyCallback(const FGamepla
 	MyAbilityComponent->ConsumeClientReplicatedTargetData(CurrentSpecHandle, CurrentActivationInfo.GetActivationPredictionKey());
 }
 
+void ULyraGameplayAbility_RangedWeapon::ValidateTargetDataWithLagCompensation(FGameplayAbilityTargetDataHandle& TargetData) const
+{
+	const ULyraLagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<ULyraLagCompensationSubsystem>();
+	if (!ULyraLagCompensationSubsystem::IsEnabled() || (LagCompensation == nullptr))
+	{
+		return;
+	}
+
+	const ULyraRangedWeaponInstance* WeaponData = GetWeaponInstance();
+	if (WeaponData == nullptr)
+	{
+		return;
+	}
+
+	const float SweepRadius = WeaponData->GetBulletTraceSweepRadius();
+	const float MaxRange = WeaponData->GetMaxDamageRange();
+
+	// Where the server has the shooter, client traces start on the camera ray right next to it
+	const FVector ShooterLocation = GetWeaponTargetingSourceLocation();
+
+	for (int32 TargetDataIndex = 0; TargetDataIndex < TargetData.Num(); ++TargetDataIndex)
+	{
+		FGameplayAbilityTargetData* Data = TargetData.Get(TargetDataIndex);
+		if ((Data == nullptr) || (Data->GetScriptStruct() != FLyraGameplayAbilityTargetData_SingleTargetHit::StaticStruct()))
+		{
+			continue;
+		}
+
+		FLyraGameplayAbilityTargetData_SingleTargetHit* SingleTargetHit = static_cast<FLyraGameplayAbilityTargetData_SingleTargetHit*>(Data);
+		if (!SingleTargetHit->bHitReplaced && !LagCompensation->ValidateHit(SingleTargetHit->HitResult, SingleTargetHit->Timestamp, SweepRadius, ShooterLocation, MaxRange))
+		{
+			// Keep the impact for cosmetics but drop the target, so no effects are applied and the client's hit marker isn't confirmed
+			SingleTargetHit->HitResult.HitObjectHandle = FActorInstanceHandle();
+			SingleTargetHit->HitResult.Component = nullptr;
+			SingleTargetHit->bHitReplaced = true;
+		}
+	}
+}
+
 void ULyraGameplayAbility_RangedWeapon::StartRangedWeaponTargeting()
 {
 	check(CurrentActorInfo);
@@ -561,13 +744,32 @@ void ULyraGameplayAbility_RangedWeapon::StartRangedWeaponTargeting()
 
 	AController* Controller = GetControllerFromActorInfo();
 	check(Controller);
-	ULyraWeaponStateComponent* WeaponStateComponent = Controller->FindComponentByClass<ULyraWeaponStateComponent>();
+
+	// Multi-bullet cartridges can be traced asynchronously alongside every other cartridge fired this frame, targeting then finishes next tick
+	ULyraRangedWeaponInstance* WeaponData = GetWeaponInstance();
+	if (WeaponData && ULyraBulletTraceSubsystem::ShouldBatchCartridge(WeaponData->GetBulletsPerCartridge()))
+	{
+		FRangedWeaponFiringInput InputData;
+		if (MakeLocalFiringInput(/*out*/ InputData) && SubmitBatchedBulletsInCartridge(InputData))
+		{
+			return;
+		}
+	}
 
 	FScopedPredictionWindow ScopedPrediction(MyAbilityComponent, CurrentActivationInfo.GetActivationPredictionKey());
 
 	TArray<FHitResult> FoundHits;
 	PerformLocalTargeting(/*out*/ FoundHits);
 
+	FinishRangedWeaponTargeting(FoundHits);
+}
+
+void ULyraGameplayAbility_RangedWeapon::FinishRangedWeaponTargeting(const TArray<FHitResult>& FoundHits)
+{
+	AController* Controller = GetControllerFromActorInfo();
+	check(Controller);
+	ULyraWeaponStateComponent* WeaponStateComponent = Controller->FindComponentByClass<ULyraWeaponStateComponent>();
+
 	// Fill out the target data from the hit results
 	FGameplayAbilityTargetDataHandle TargetData;
 	TargetData.UniqueId = WeaponStateComponent ? WeaponStateComponent->GetUnconfirmedServerSideHitMarkerCount() : 0;
@@ -575,12 +777,14 @@ void ULyraGameplayAbility_RangedWeapon::StartRangedWeaponTargeting()
 	if (FoundHits.Num() > 0)
 	{
 		const int32 CartridgeID = FMath::Rand();
+		const double Timestamp = ULyraLagCompensationSubsystem::GetClientTimestamp(Controller);
 
 		for (const FHitResult& FoundHit : FoundHits)
 		{
 			FLyraGameplayAbilityTargetData_SingleTargetHit* NewTargetData = new FLyraGameplayAbilityTargetData_SingleTargetHit();
 			NewTargetData->HitResult = FoundHit;
 			NewTargetData->CartridgeID = CartridgeID;
+			NewTargetData->Timestamp = Timestamp;
 
 			TargetData.Add(NewTargetData);
 		}
@@ -17,6 +17,7 @@ struct FGameplayAbilityActorInfo;
 struct FGameplayEventData;
 struct FGameplayTag;
 struct FGameplayTagContainer;
+struct FLyraBulletTraceResult;
 
 /** Defines where an ability starts its trace from and where it should face */
 UENUM(BlueprintType)
@@ -90,27 +91,59 @@ protected:
 protected:
 	static int32 FindFirstPawnHitResult(const TArray<FHitResult>& HitResults);
 
+	// Adds the raw hits of one trace to OutHitResults, skipping repeated hits on the same object, and returns the last hit (or an empty hit spanning the trace)
+	static FHitResult FilterWeaponTraceHits(const TArray<FHitResult>& HitResults, const FVector& StartTrace, const FVector& EndTrace, OUT TArray<FHitResult>& OutHitResults);
+
+	// Replaces OutHits with SweepHits if the sweep found a pawn that is not blocked by something the line trace already hit
+	static void MergeSweepHits(const TArray<FHitResult>& SweepHits, OUT TArray<FHitResult>& OutHits);
+
+	// Builds the query params shared by every weapon trace of this ability
+	FCollisionQueryParams MakeWeaponTraceQueryParams() const;
+
 	// Does a single weapon trace, either sweeping or ray depending on if SweepRadius is above zero
 	FHitResult WeaponTrace(const FVector& StartTrace, const FVector& EndTrace, float SweepRadius, bool bIsSimulated, OUT TArray<FHitResult>& OutHitResults) const;
 
 	// Wrapper around WeaponTrace to handle trying to do a ray trace before falling back to a sweep trace if there were no hits and SweepRadius is above zero 
 	FHitResult DoSingleBulletTrace(const FVector& StartTrace, const FVector& EndTrace, float SweepRadius, bool bIsSimulated, OUT TArray<FHitResult>& OutHits) const;
 
+	// Same as DoSingleBulletTrace, but using line and sweep results that were traced ahead of time by ULyraBulletTraceSubsystem
+	FHitResult ResolveBatchedBulletTrace(const FLyraBulletTraceResult& TraceResult, OUT TArray<FHitResult>& OutHits) const;
+
+	// Picks a spread direction for the next bullet and returns where its trace ends
+	FVector CalculateBulletEndTrace(const FRangedWeaponFiringInput& InputData) const;
+
+	// Appends the impacts of one bullet to the cartridge hits
+	void AddBulletImpact(const FHitResult& Impact, const TArray<FHitResult>& AllImpacts, const FVector& EndTrace, OUT TArray<FHitResult>& OutHits) const;
+
 	// Traces all of the bullets in a single cartridge
 	void TraceBulletsInCartridge(const FRangedWeaponFiringInput& InputData, OUT TArray<FHitResult>& OutHits);
 
+	// Queues all of the bullets in a single cartridge with ULyraBulletTraceSubsystem, targeting finishes in OnBatchedCartridgeTraced next tick (or in EndAbility if that comes first)
+	bool SubmitBatchedBulletsInCartridge(const FRangedWeaponFiringInput& InputData);
+
+	void OnBatchedCartridgeTraced(const TArray<FLyraBulletTraceResult>& TraceResults);
+
 	virtual void AddAdditionalTraceIgnoreActors(FCollisionQueryParams& TraceParams) const;
 
 	// Determine the trace channel to use for the weapon trace(s)
 	virtual ECollisionChannel DetermineTraceChannel(FCollisionQueryParams& TraceParams, bool bIsSimulated) const;
 
+	// Fills out the firing input for a locally controlled pawn, returns false if we can't fire
+	bool MakeLocalFiringInput(OUT FRangedWeaponFiringInput& OutInputData);
+
 	void PerformLocalTargeting(OUT TArray<FHitResult>& OutHits);
 
+	// Turns the local hits into target data and processes it
+	void FinishRangedWeaponTargeting(const TArray<FHitResult>& FoundHits);
+
 	FVector GetWeaponTargetingSourceLocation() const;
 	FTransform GetTargetingTransform(APawn* SourcePawn, ELyraAbilityTargetingSource Source) const;
 
 	void OnTargetDataReadyCallback(const FGameplayAbilityTargetDataHandle& InData, FGameplayTag ApplicationTag);
 
+	// Rewinds the claimed targets to when the client fired, hits that don't line up are stripped and marked as replaced
+	void ValidateTargetDataWithLagCompensation(FGameplayAbilityTargetDataHandle& TargetData) const;
+
 	UFUNCTION(BlueprintCallable)
 	void StartRangedWeaponTargeting();
 
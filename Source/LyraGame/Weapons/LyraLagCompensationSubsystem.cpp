@@ -0,0 +1,596 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "LyraLagCompensationSubsystem.h"
+
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerState.h"
+#include "HAL/IConsoleManager.h"
+#include "LyraLogChannels.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "PhysicsEngine/PhysicsAsset.h"
+#include "Weapons/LyraBulletTraceSubsystem.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(LyraLagCompensationSubsystem)
+
+DECLARE_CYCLE_STAT(TEXT("Lag Compensation Record"), STAT_LyraLagCompensationRecord, STATGROUP_LyraWeapons);
+DECLARE_CYCLE_STAT(TEXT("Lag Compensation Validate"), STAT_LyraLagCompensationValidate, STATGROUP_LyraWeapons);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Lag Compensated Hits Validated"), STAT_LyraLagCompensatedHitsValidated, STATGROUP_LyraWeapons);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Lag Compensated Hits Rejected"), STAT_LyraLagCompensatedHitsRejected, STATGROUP_LyraWeapons);
+
+namespace LyraConsoleVariables
+{
+	static bool bEnableLagCompensation = true;
+	static FAutoConsoleVariableRef CVarEnableLagCompensation(
+		TEXT("lyra.LagCompensation.Enable"),
+		bEnableLagCompensation,
+		TEXT("Should the server record pawn hitboxes and reject client hits that don't match the rewound target?"),
+		ECVF_Default);
+
+	static int32 LagCompensationHistoryFrames = 64;
+	static FAutoConsoleVariableRef CVarLagCompensationHistoryFrames(
+		TEXT("lyra.LagCompensation.HistoryFrames"),
+		LagCompensationHistoryFrames,
+		TEXT("Number of server frames of hitbox history kept per pawn (applies to pawns registered after changing it)"),
+		ECVF_Default);
+
+	static float LagCompensationMaxRewindTime = 0.5f;
+	static FAutoConsoleVariableRef CVarLagCompensationMaxRewindTime(
+		TEXT("lyra.LagCompensation.MaxRewindTime"),
+		LagCompensationMaxRewindTime,
+		TEXT("Furthest back in time (in seconds) the server will rewind a target for a client shot"),
+		ECVF_Default);
+
+	static float LagCompensationHitTolerance = 20.0f;
+	static FAutoConsoleVariableRef CVarLagCompensationHitTolerance(
+		TEXT("lyra.LagCompensation.HitTolerance"),
+		LagCompensationHitTolerance,
+		TEXT("Distance (in cm) a rewound hitbox is grown by when re-tracing a client shot, to absorb interpolation differences"),
+		ECVF_Default);
+
+	static float LagCompensationMaxTraceStartError = 200.0f;
+	static FAutoConsoleVariableRef CVarLagCompensationMaxTraceStartError(
+		TEXT("lyra.LagCompensation.MaxTraceStartError"),
+		LagCompensationMaxTraceStartError,
+		TEXT("Distance (in cm) a client shot may start from where the server has the shooter, covering the camera offset and movement drift"),
+		ECVF_Default);
+
+	static float LagCompensationInterpolationDelay = -1.0f;
+	static FAutoConsoleVariableRef CVarLagCompensationInterpolationDelay(
+		TEXT("lyra.LagCompensation.InterpolationDelay"),
+		LagCompensationInterpolationDelay,
+		TEXT("Time (in seconds) clients display remote pawns behind the latest replicated state, subtracted from shot timestamps. Negative uses the shooter's character movement smoothing time"),
+		ECVF_Default);
+}
+
+//////////////////////////////////////////////////////////////////////
+// FLyraLagCompensationHistory
+
+void FLyraLagCompensationHistory::Init(TArrayView<const FBox> InLocalBoxes, int32 InCapacity)
+{
+	LocalBoxes.Reset();
+	LocalBoxes.Append(InLocalBoxes.GetData(), InLocalBoxes.Num());
+	Capacity = FMath::Max(InCapacity, 2);
+	FirstSlot = 0;
+	NumFrames = 0;
+
+	const int32 NumHitboxes = LocalBoxes.Num();
+	Timestamps.SetNumUninitialized(Capacity);
+	Bounds.SetNumUninitialized(Capacity);
+	Locations.SetNumUninitialized(Capacity * NumHitboxes);
+	Rotations.SetNumUninitialized(Capacity * NumHitboxes);
+}
+
+void FLyraLagCompensationHistory::Record(double Timestamp, TArrayView<const FTransform> Transforms)
+{
+	const int32 NumHitboxes = LocalBoxes.Num();
+	check(Transforms.Num() == NumHitboxes);
+
+	int32 Slot;
+	if ((NumFrames > 0) && (Timestamp <= GetNewestTimestamp()))
+	{
+		// Time didn't advance (paused world, several records in one frame), refresh the newest frame instead
+		Slot = GetFrameSlot(NumFrames - 1);
+	}
+	else if (NumFrames < Capacity)
+	{
+		Slot = GetFrameSlot(NumFrames);
+		++NumFrames;
+	}
+	else
+	{
+		Slot = FirstSlot;
+		FirstSlot = (FirstSlot + 1) % Capacity;
+	}
+
+	Timestamps[Slot] = Timestamp;
+
+	FBox FrameBounds(ForceInit);
+	const int32 Base = Slot * NumHitboxes;
+	for (int32 HitboxIndex = 0; HitboxIndex < NumHitboxes; ++HitboxIndex)
+	{
+		const FTransform& Transform = Transforms[HitboxIndex];
+		Locations[Base + HitboxIndex] = Transform.GetLocation();
+		Rotations[Base + HitboxIndex] = FQuat4f(Transform.GetRotation());
+
+		FrameBounds += LocalBoxes[HitboxIndex].TransformBy(FTransform(Transform.GetRotation(), Transform.GetLocation()));
+	}
+	Bounds[Slot] = FrameBounds;
+}
+
+double FLyraLagCompensationHistory::GetOldestTimestamp() const
+{
+	return (NumFrames > 0) ? Timestamps[GetFrameSlot(0)] : 0.0;
+}
+
+double FLyraLagCompensationHistory::GetNewestTimestamp() const
+{
+	return (NumFrames > 0) ? Timestamps[GetFrameSlot(NumFrames - 1)] : 0.0;
+}
+
+void FLyraLagCompensationHistory::FindFrameSlots(double Timestamp, int32& OutSlotA, int32& OutSlotB, float& OutAlpha) const
+{
+	check(NumFrames > 0);
+
+	OutAlpha = 0.0f;
+
+	if (Timestamp <= GetOldestTimestamp())
+	{
+		OutSlotA = OutSlotB = GetFrameSlot(0);
+		return;
+	}
+
+	if (Timestamp >= GetNewestTimestamp())
+	{
+		OutSlotA = OutSlotB = GetFrameSlot(NumFrames - 1);
+		return;
+	}
+
+	// Timestamps are increasing in frame order, find the last frame at or before Timestamp
+	int32 Low = 0;
+	int32 High = NumFrames - 1;
+	while (High - Low > 1)
+	{
+		const int32 Mid = (Low + High) / 2;
+		if (Timestamps[GetFrameSlot(Mid)] <= Timestamp)
+		{
+			Low = Mid;
+		}
+		else
+		{
+			High = Mid;
+		}
+	}
+
+	OutSlotA = GetFrameSlot(Low);
+	OutSlotB = GetFrameSlot(High);
+
+	const double FrameDelta = Timestamps[OutSlotB] - Timestamps[OutSlotA];
+	OutAlpha = (FrameDelta > 0.0) ? (float)((Timestamp - Timestamps[OutSlotA]) / FrameDelta) : 0.0f;
+}
+
+bool FLyraLagCompensationHistory::LineIntersectsAt(double Timestamp, const FVector& Start, const FVector& End, float Tolerance) const
+{
+	if (NumFrames == 0)
+	{
+		return false;
+	}
+
+	int32 SlotA;
+	int32 SlotB;
+	float Alpha;
+	FindFrameSlots(Timestamp, SlotA, SlotB, Alpha);
+
+	// Broad phase against the bounds of both frames, most misses stop here
+	const FBox BroadBounds = (Bounds[SlotA] + Bounds[SlotB]).ExpandBy(Tolerance);
+	if (!FMath::LineBoxIntersection(BroadBounds, Start, End, End - Start))
+	{
+		return false;
+	}
+
+	const int32 NumHitboxes = LocalBoxes.Num();
+	const int32 BaseA = SlotA * NumHitboxes;
+	const int32 BaseB = SlotB * NumHitboxes;
+	for (int32 HitboxIndex = 0; HitboxIndex < NumHitboxes; ++HitboxIndex)
+	{
+		const FVector Location = FMath::Lerp(Locations[BaseA + HitboxIndex], Locations[BaseB + HitboxIndex], (double)Alpha);
+		const FQuat Rotation = FQuat(FQuat4f::Slerp(Rotations[BaseA + HitboxIndex], Rotations[BaseB + HitboxIndex], Alpha));
+
+		// Test in the hitbox's space so the box stays axis aligned
+		const FVector LocalStart = Rotation.UnrotateVector(Start - Location);
+		const FVector LocalEnd = Rotation.UnrotateVector(End - Location);
+
+		if (FMath::LineBoxIntersection(LocalBoxes[HitboxIndex].ExpandBy(Tolerance), LocalStart, LocalEnd, LocalEnd - LocalStart))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+SIZE_T FLyraLagCompensationHistory::GetAllocatedSize() const
+{
+	return LocalBoxes.GetAllocatedSize() + Timestamps.GetAllocatedSize() + Bounds.GetAllocatedSize() + Locations.GetAllocatedSize() + Rotations.GetAllocatedSize();
+}
+
+//////////////////////////////////////////////////////////////////////
+// ULyraLagCompensationSubsystem
+
+bool ULyraLagCompensationSubsystem::IsEnabled()
+{
+	return LyraConsoleVariables::bEnableLagCompensation;
+}
+
+double ULyraLagCompensationSubsystem::GetClientTimestamp(const AController* Shooter)
+{
+	check(Shooter);
+	const UWorld* World = Shooter->GetWorld();
+	check(World);
+
+	const AGameStateBase* GameState = World->GetGameState();
+	if ((GameState == nullptr) || (World->GetNetMode() != NM_Client))
+	{
+		// The server sees pawns where they are right now
+		return World->GetTimeSeconds();
+	}
+
+	// GetServerWorldTimeSeconds is the client's estimate of the server clock right now, but the remote pawns the player
+	// aimed at are showing a server state that is half a round trip old, and are smoothed towards it on top of that
+	double RewindTime = 0.0;
+	if (const APlayerState* PlayerState = Shooter->PlayerState)
+	{
+		RewindTime += 0.5 * PlayerState->GetPingInMilliseconds() * 0.001;
+	}
+
+	if (LyraConsoleVariables::LagCompensationInterpolationDelay >= 0.0f)
+	{
+		RewindTime += LyraConsoleVariables::LagCompensationInterpolationDelay;
+	}
+	else if (const ACharacter* Character = Cast<ACharacter>(Shooter->GetPawn()))
+	{
+		// Remote characters use the same movement settings as ours, so their smoothing time is a good estimate
+		if (const UCharacterMovementComponent* MoveComp = Character->GetCharacterMovement())
+		{
+			RewindTime += MoveComp->NetworkSimulatedSmoothLocationTime;
+		}
+	}
+
+	return GameState->GetServerWorldTimeSeconds() - RewindTime;
+}
+
+void ULyraLagCompensationSubsystem::Deinitialize()
+{
+	TrackedPawns.Reset();
+	PawnToIndex.Reset();
+
+	Super::Deinitialize();
+}
+
+TStatId ULyraLagCompensationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(ULyraLagCompensationSubsystem, STATGROUP_Tickables);
+}
+
+void ULyraLagCompensationSubsystem::RegisterPawn(APawn* Pawn)
+{
+	if ((Pawn == nullptr) || PawnToIndex.Contains(Pawn))
+	{
+		return;
+	}
+
+	PawnToIndex.Add(Pawn, TrackedPawns.Num());
+
+	FTrackedPawn& Tracked = TrackedPawns.AddDefaulted_GetRef();
+	Tracked.Pawn = Pawn;
+}
+
+void ULyraLagCompensationSubsystem::UnregisterPawn(APawn* Pawn)
+{
+	int32 Index;
+	if (PawnToIndex.RemoveAndCopyValue(Pawn, Index))
+	{
+		RemoveTrackedPawnAt(Index);
+	}
+}
+
+void ULyraLagCompensationSubsystem::RemoveTrackedPawnAt(int32 Index)
+{
+	TrackedPawns.RemoveAtSwap(Index, EAllowShrinking::No);
+	if (!TrackedPawns.IsValidIndex(Index))
+	{
+		return;
+	}
+
+	// The entry swapped in may belong to a pawn that was destroyed without unregistering, its key can't be looked up anymore
+	if (APawn* MovedPawn = TrackedPawns[Index].Pawn.Get())
+	{
+		PawnToIndex.FindOrAdd(MovedPawn) = Index;
+	}
+	else
+	{
+		PurgeStalePawns();
+	}
+}
+
+void ULyraLagCompensationSubsystem::PurgeStalePawns()
+{
+	TrackedPawns.RemoveAllSwap([](const FTrackedPawn& Tracked) { return !Tracked.Pawn.IsValid(); }, EAllowShrinking::No);
+
+	PawnToIndex.Reset();
+	for (int32 Index = 0; Index < TrackedPawns.Num(); ++Index)
+	{
+		PawnToIndex.Add(TrackedPawns[Index].Pawn.Get(), Index);
+	}
+}
+
+void ULyraLagCompensationSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	UWorld* World = GetWorld();
+	const ENetMode NetMode = World->GetNetMode();
+	if (!IsEnabled() || ((NetMode != NM_DedicatedServer) && (NetMode != NM_ListenServer)))
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_LyraLagCompensationRecord);
+
+	const double Timestamp = World->GetTimeSeconds();
+
+	bool bHasStalePawns = false;
+	for (FTrackedPawn& Tracked : TrackedPawns)
+	{
+		if (Tracked.Pawn.IsValid())
+		{
+			RecordTrackedPawn(Tracked, Timestamp);
+		}
+		else
+		{
+			// Missed the unregister (e.g. destroyed without EndPlay)
+			bHasStalePawns = true;
+		}
+	}
+
+	if (bHasStalePawns)
+	{
+		PurgeStalePawns();
+	}
+}
+
+void ULyraLagCompensationSubsystem::InitTrackedPawn(FTrackedPawn& Tracked, const USkeletalMeshComponent* Mesh) const
+{
+	TArray<FBox, TInlineAllocator<32>> LocalBoxes;
+
+	if (Mesh != nullptr)
+	{
+		// One hitbox per physics body, the same shapes the weapon trace would have hit
+		for (const FBodyInstance* Body : Mesh->Bodies)
+		{
+			if ((Body != nullptr) && (Body->GetBodySetup() != nullptr))
+			{
+				const FVector Scale = Body->GetUnrealWorldTransform().GetScale3D();
+				LocalBoxes.Add(Body->GetBodySetup()->AggGeom.CalcAABB(FTransform(FQuat::Identity, FVector::ZeroVector, Scale)));
+			}
+		}
+
+		Tracked.SourcePhysicsAsset = TObjectKey<UPhysicsAsset>(Mesh->GetPhysicsAsset());
+		Tracked.NumSourceBodies = Mesh->Bodies.Num();
+	}
+
+	if (LocalBoxes.Num() == 0)
+	{
+		// No physics bodies, fall back to the collision cylinder
+		float Radius = 0.0f;
+		float HalfHeight = 0.0f;
+		Tracked.Pawn->GetSimpleCollisionCylinder(/*out*/ Radius, /*out*/ HalfHeight);
+		LocalBoxes.Add(FBox(FVector(-Radius, -Radius, -HalfHeight), FVector(Radius, Radius, HalfHeight)));
+
+		Tracked.SourcePhysicsAsset = TObjectKey<UPhysicsAsset>();
+		Tracked.NumSourceBodies = 0;
+	}
+
+	Tracked.History.Init(LocalBoxes, LyraConsoleVariables::LagCompensationHistoryFrames);
+}
+
+void ULyraLagCompensationSubsystem::RecordTrackedPawn(FTrackedPawn& Tracked, double Timestamp)
+{
+	APawn* Pawn = Tracked.Pawn.Get();
+
+	const ACharacter* Character = Cast<ACharacter>(Pawn);
+	const USkeletalMeshComponent* Mesh = Character ? Character->GetMesh() : nullptr;
+
+	const int32 NumBodies = Mesh ? Mesh->Bodies.Num() : 0;
+	const UPhysicsAsset* PhysicsAsset = Mesh ? Mesh->GetPhysicsAsset() : nullptr;
+	if ((Tracked.NumSourceBodies != NumBodies) || (Tracked.SourcePhysicsAsset != TObjectKey<UPhysicsAsset>(PhysicsAsset)))
+	{
+		InitTrackedPawn(Tracked, Mesh);
+	}
+
+	ScratchTransforms.Reset();
+	if (Tracked.NumSourceBodies > 0)
+	{
+		for (const FBodyInstance* Body : Mesh->Bodies)
+		{
+			if ((Body != nullptr) && (Body->GetBodySetup() != nullptr))
+			{
+				const FTransform BodyTransform = Body->GetUnrealWorldTransform();
+				ScratchTransforms.Emplace(BodyTransform.GetRotation(), BodyTransform.GetLocation());
+			}
+		}
+	}
+	else
+	{
+		ScratchTransforms.Emplace(Pawn->GetActorQuat(), Pawn->GetActorLocation());
+	}
+
+	// A body can lose its setup without the count changing, start over rather than record mismatched frames
+	if (ScratchTransforms.Num() != Tracked.History.GetNumHitboxes())
+	{
+		Tracked.NumSourceBodies = INDEX_NONE;
+		return;
+	}
+
+	Tracked.History.Record(Timestamp, ScratchTransforms);
+}
+
+bool ULyraLagCompensationSubsystem::ValidateHit(const FHitResult& Hit, double ClientTimestamp, float SweepRadius, const FVector& ShooterLocation, float MaxRange) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_LyraLagCompensationValidate);
+
+	const APawn* HitPawn = Cast<APawn>(Hit.GetActor());
+	const int32* TrackedIndex = HitPawn ? PawnToIndex.Find(HitPawn) : nullptr;
+	if (TrackedIndex == nullptr)
+	{
+		return true;
+	}
+
+	const FLyraLagCompensationHistory& History = TrackedPawns[*TrackedIndex].History;
+	if (History.GetNumFrames() == 0)
+	{
+		return true;
+	}
+
+	// Never trust the client further back than the window we allow, or into the future
+	const double Now = GetWorld()->GetTimeSeconds();
+	const double RewindTime = FMath::Clamp(ClientTimestamp, Now - LyraConsoleVariables::LagCompensationMaxRewindTime, Now);
+
+	// The segment the client sent can't be trusted, it could pass through the rewound hitbox from anywhere. Only a start
+	// close to where we have the shooter is accepted, and only the direction is kept, out to the weapon's range
+	const FVector ShotDir = (Hit.TraceEnd - Hit.TraceStart).GetSafeNormal();
+	const bool bPlausibleShot = !ShotDir.IsZero() && (FVector::DistSquared(Hit.TraceStart, ShooterLocation) <= FMath::Square((double)LyraConsoleVariables::LagCompensationMaxTraceStartError));
+
+	const float Tolerance = LyraConsoleVariables::LagCompensationHitTolerance + SweepRadius;
+	const bool bValid = bPlausibleShot && History.LineIntersectsAt(RewindTime, Hit.TraceStart, Hit.TraceStart + ShotDir * MaxRange, Tolerance);
+
+	if (bValid)
+	{
+		INC_DWORD_STAT(STAT_LyraLagCompensatedHitsValidated);
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_LyraLagCompensatedHitsRejected);
+		UE_LOG(LogLyra, Verbose, TEXT("Lag compensation rejected hit on %s (client time %.3f, rewound to %.3f, now %.3f, trace start %.1f cm from the shooter)"),
+			*GetNameSafe(HitPawn), ClientTimestamp, RewindTime, Now, FVector::Dist(Hit.TraceStart, ShooterLocation));
+	}
+
+	return bValid;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+#if !UE_BUILD_SHIPPING
+void ULyraLagCompensationSubsystem::RunBenchmark(int32 NumPawns, int32 NumShots, int32 NumHitboxes)
+{
+	FRandomStream Random(1234);
+
+	const int32 HistoryFrames = LyraConsoleVariables::LagCompensationHistoryFrames;
+	const double FrameTime = 1.0 / 30.0;
+
+	// Roughly the size of the bodies in a humanoid physics asset
+	TArray<FBox> LocalBoxes;
+	for (int32 HitboxIndex = 0; HitboxIndex < NumHitboxes; ++HitboxIndex)
+	{
+		const FVector Extent(Random.FRandRange(5.0f, 20.0f), Random.FRandRange(5.0f, 20.0f), Random.FRandRange(10.0f, 30.0f));
+		LocalBoxes.Add(FBox(-Extent, Extent));
+	}
+
+	TArray<FLyraLagCompensationHistory> Histories;
+	TArray<FVector> PawnLocations;
+	Histories.SetNum(NumPawns);
+	for (int32 PawnIndex = 0; PawnIndex < NumPawns; ++PawnIndex)
+	{
+		Histories[PawnIndex].Init(LocalBoxes, HistoryFrames);
+		PawnLocations.Add(FVector(Random.FRandRange(-5000.0f, 5000.0f), Random.FRandRange(-5000.0f, 5000.0f), 100.0f));
+	}
+
+	// Fill every history, timing the record pass like the subsystem tick would
+	TArray<FTransform> Transforms;
+	Transforms.SetNum(NumHitboxes);
+	double RecordSeconds = 0.0;
+	for (int32 FrameIndex = 0; FrameIndex < HistoryFrames; ++FrameIndex)
+	{
+		const double Timestamp = FrameIndex * FrameTime;
+
+		for (int32 PawnIndex = 0; PawnIndex < NumPawns; ++PawnIndex)
+		{
+			PawnLocations[PawnIndex] += FVector(Random.FRandRange(-20.0f, 20.0f), Random.FRandRange(-20.0f, 20.0f), 0.0f);
+			const FQuat PawnRotation(FVector::UpVector, Random.FRandRange(0.0f, UE_TWO_PI));
+
+			for (int32 HitboxIndex = 0; HitboxIndex < NumHitboxes; ++HitboxIndex)
+			{
+				const FVector Offset(0.0f, 0.0f, (HitboxIndex * 180.0f) / NumHitboxes - 90.0f);
+				Transforms[HitboxIndex] = FTransform(PawnRotation, PawnLocations[PawnIndex] + PawnRotation.RotateVector(Offset));
+			}
+
+			const double StartTime = FPlatformTime::Seconds();
+			Histories[PawnIndex].Record(Timestamp, Transforms);
+			RecordSeconds += FPlatformTime::Seconds() - StartTime;
+		}
+	}
+
+	// Shots from random positions at a random pawn, aimed at where it was at a random point in the window, with some misses
+	struct FBenchmarkShot
+	{
+		int32 PawnIndex;
+		double Timestamp;
+		FVector Start;
+		FVector End;
+	};
+
+	TArray<FBenchmarkShot> Shots;
+	Shots.Reserve(NumShots);
+	for (int32 ShotIndex = 0; ShotIndex < NumShots; ++ShotIndex)
+	{
+		FBenchmarkShot& Shot = Shots.AddDefaulted_GetRef();
+		Shot.PawnIndex = Random.RandHelper(NumPawns);
+		Shot.Timestamp = Random.FRandRange(0.0f, (HistoryFrames - 1) * FrameTime);
+
+		const FVector Target = PawnLocations[Shot.PawnIndex] + Random.GetUnitVector() * Random.FRandRange(0.0f, 150.0f);
+		Shot.Start = Target + Random.GetUnitVector() * 3000.0f;
+		Shot.End = Shot.Start + (Target - Shot.Start) * 2.0;
+	}
+
+	int32 NumValid = 0;
+	const double ValidateStartTime = FPlatformTime::Seconds();
+	for (const FBenchmarkShot& Shot : Shots)
+	{
+		if (Histories[Shot.PawnIndex].LineIntersectsAt(Shot.Timestamp, Shot.Start, Shot.End, LyraConsoleVariables::LagCompensationHitTolerance))
+		{
+			++NumValid;
+		}
+	}
+	const double ValidateSeconds = FPlatformTime::Seconds() - ValidateStartTime;
+
+	SIZE_T TotalBytes = 0;
+	for (const FLyraLagCompensationHistory& History : Histories)
+	{
+		TotalBytes += History.GetAllocatedSize();
+	}
+
+	UE_LOG(LogLyra, Display, TEXT("Lag compensation benchmark: %d pawns, %d hitboxes each, %d frames of history"), NumPawns, NumHitboxes, HistoryFrames);
+	UE_LOG(LogLyra, Display, TEXT("  Record:   %.3f us per server tick (all pawns)"), (RecordSeconds * 1000000.0) / HistoryFrames);
+	UE_LOG(LogLyra, Display, TEXT("  Validate: %.3f us per shot over %d shots (%d confirmed)"), (ValidateSeconds * 1000000.0) / FMath::Max(NumShots, 1), NumShots, NumValid);
+	UE_LOG(LogLyra, Display, TEXT("  Memory:   %.1f KB total, %.1f KB per pawn"), TotalBytes / 1024.0, TotalBytes / (1024.0 * NumPawns));
+}
+
+static FAutoConsoleCommandWithArgs LyraLagCompensationBenchmarkCmd(
+	TEXT("lyra.LagCompensation.Benchmark"),
+	TEXT("Usage: lyra.LagCompensation.Benchmark <NumPawns=64> <NumShots=10000> <HitboxesPerPawn=19>"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		int32 NumPawns = 64;
+		int32 NumShots = 10000;
+		int32 NumHitboxes = 19;
+		if (Args.Num() > 0) { LexTryParseString<int32>(NumPawns, *Args[0]); }
+		if (Args.Num() > 1) { LexTryParseString<int32>(NumShots, *Args[1]); }
+		if (Args.Num() > 2) { LexTryParseString<int32>(NumHitboxes, *Args[2]); }
+
+		ULyraLagCompensationSubsystem::RunBenchmark(FMath::Max(NumPawns, 1), FMath::Max(NumShots, 1), FMath::Max(NumHitboxes, 1));
+	}));
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,129 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+
+#include "LyraLagCompensationSubsystem.generated.h"
+
+class AController;
+class APawn;
+class UPhysicsAsset;
+class USkeletalMeshComponent;
+
+/**
+ * FLyraLagCompensationHistory
+ *
+ * Fixed size ring buffer of hitbox transforms for a single pawn. Frames are stored as parallel arrays (struct of arrays)
+ * so a rewind only touches the timestamps it searches and the two frames it interpolates between.
+ */
+struct FLyraLagCompensationHistory
+{
+public:
+	/** Resets the history, LocalBoxes are the hitbox extents in the space of each recorded transform */
+	void Init(TArrayView<const FBox> InLocalBoxes, int32 InCapacity);
+
+	/** Records one frame, Transforms must have one entry per hitbox. Overwrites the oldest frame once full. */
+	void Record(double Timestamp, TArrayView<const FTransform> Transforms);
+
+	/** Returns true if the segment touches any hitbox (grown by Tolerance) as it was at Timestamp. Timestamp is clamped to the recorded window. */
+	bool LineIntersectsAt(double Timestamp, const FVector& Start, const FVector& End, float Tolerance) const;
+
+	int32 GetNumHitboxes() const { return LocalBoxes.Num(); }
+	int32 GetNumFrames() const { return NumFrames; }
+	double GetOldestTimestamp() const;
+	double GetNewestTimestamp() const;
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	int32 GetFrameSlot(int32 FrameIndex) const { return (FirstSlot + FrameIndex) % Capacity; }
+
+	/** Finds the frames either side of Timestamp, as slots in the ring */
+	void FindFrameSlots(double Timestamp, int32& OutSlotA, int32& OutSlotB, float& OutAlpha) const;
+
+	TArray<FBox> LocalBoxes;
+
+	// Per frame
+	TArray<double> Timestamps;
+	TArray<FBox> Bounds;
+
+	// Per frame per hitbox, indexed by Slot * NumHitboxes + HitboxIndex
+	TArray<FVector> Locations;
+	TArray<FQuat4f> Rotations;
+
+	int32 Capacity = 0;
+	int32 FirstSlot = 0;
+	int32 NumFrames = 0;
+};
+
+/**
+ * ULyraLagCompensationSubsystem
+ *
+ * Server side record of where every registered pawn's hitboxes were over the last few frames. Hits claimed by
+ * clients are checked by rewinding the target to the time the client fired and re-tracing against that pawn only.
+ *
+ * History is recorded every server tick into a fixed number of frames per pawn (lyra.LagCompensation.HistoryFrames),
+ * so memory is bounded no matter how long the match runs.
+ */
+UCLASS()
+class ULyraLagCompensationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	//~UTickableWorldSubsystem interface
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	//~End of UTickableWorldSubsystem interface
+
+	void RegisterPawn(APawn* Pawn);
+	void UnregisterPawn(APawn* Pawn);
+
+	/**
+	 * Returns false if the hit claims a registered pawn that the shot could not have touched at ClientTimestamp.
+	 * The claimed trace has to start within lyra.LagCompensation.MaxTraceStartError of ShooterLocation (where the server
+	 * has the shooter) and only its direction is kept, the segment re-traced is clamped to MaxRange.
+	 * Hits on anything without a history (world geometry, unregistered actors) are accepted.
+	 */
+	bool ValidateHit(const FHitResult& Hit, double ClientTimestamp, float SweepRadius, const FVector& ShooterLocation, float MaxRange) const;
+
+	/**
+	 * The time shots should be stamped with: the server time of the remote pawn positions the shooter is looking at.
+	 * On clients this is the estimated server clock minus half the round trip time and the simulated proxy interpolation delay
+	 */
+	static double GetClientTimestamp(const AController* Shooter);
+
+	static bool IsEnabled();
+
+#if !UE_BUILD_SHIPPING
+	/** Measures record cost per tick and validation cost per shot against synthetic histories */
+	static void RunBenchmark(int32 NumPawns, int32 NumShots, int32 NumHitboxes);
+#endif
+
+private:
+	struct FTrackedPawn
+	{
+		TWeakObjectPtr<APawn> Pawn;
+		FLyraLagCompensationHistory History;
+
+		// Used to rebuild the history if the physics asset changes, e.g. when cosmetics are applied
+		TObjectKey<UPhysicsAsset> SourcePhysicsAsset;
+		int32 NumSourceBodies = INDEX_NONE;
+	};
+
+	void InitTrackedPawn(FTrackedPawn& Tracked, const USkeletalMeshComponent* Mesh) const;
+	void RemoveTrackedPawnAt(int32 Index);
+
+	// Drops entries whose pawn was destroyed without unregistering and rebuilds PawnToIndex
+	void PurgeStalePawns();
+	void RecordTrackedPawn(FTrackedPawn& Tracked, double Timestamp);
+
+	TArray<FTrackedPawn> TrackedPawns;
+	TMap<TObjectKey<APawn>, int32> PawnToIndex;
+
+	// Scratch space for recording, to avoid allocating each tick
+	TArray<FTransform> ScratchTransforms;
+};